@@ -0,0 +1,447 @@
+
+/**
+ * @brief - Benchmark of the simulation engine: runs a set of patterns from
+ *          the brushes shipped with the application along with some random
+ *          soups for various configurations of the engine (size of blocks,
+ *          number of threads) and reports the performance of each run as a
+ *          JSON document so that it can be compared from one version to the
+ *          next.
+ */
+
+# include <chrono>
+# include <fstream>
+# include <iostream>
+# include <sstream>
+# include <sys/resource.h>
+# include <core_utils/log/Locator.hh>
+# include <core_utils/log/PrefixedLogger.hh>
+# include <core_utils/log/StdLogger.hh>
+# include <core_utils/CoreException.hh>
+# include "Colony.hh"
+# include "ColonyScheduler.hh"
+# include "CellBrush.hh"
+# include "CellEvolver.hh"
+
+namespace {
+
+  /**
+   * @brief - Convenience structure holding the options of the benchmark.
+   */
+  struct Options {
+    std::string directory;
+    std::vector<std::string> patterns;
+    std::vector<float> densities;
+    utils::Sizei soup;
+    std::vector<int> blocks;
+    std::vector<unsigned> threads;
+    unsigned generations;
+    unsigned warmup;
+    unsigned temporal;
+    unsigned seed;
+    std::string rule;
+    std::string output;
+    bool pin;
+  };
+
+  /**
+   * @brief - Describe the initial content of a single scenario: either one
+   *          of the patterns or a random soup with a given density.
+   */
+  struct Scenario {
+    std::string name;
+    std::string pattern;
+    float density;
+  };
+
+  /**
+   * @brief - The measurements performed for a single run.
+   */
+  struct Result {
+    Scenario scenario;
+    int block;
+    unsigned threads;
+    unsigned generations;
+    unsigned population;
+    double elapsed;
+    double cpu;
+    long peakMemory;
+    cellulator::ColonyScheduler::Statistics stats;
+  };
+
+  void
+  usage(const std::string& program) {
+    std::cout
+      << "Usage: " << program << " [options]" << std::endl
+      << "  -d, --directory DIR     directory containing the patterns (default: data/brushes)" << std::endl
+      << "  -p, --patterns LIST     comma separated list of patterns to run" << std::endl
+      << "      --densities LIST    comma separated densities of the random soups (default: 0.1,0.3,0.5)" << std::endl
+      << "      --soup WxH          dimensions of the random soups (default: 512x512)" << std::endl
+      << "  -b, --blocks LIST       comma separated sizes of the blocks (default: 64,128,256)" << std::endl
+      << "  -t, --threads LIST      comma separated numbers of threads (default: 1,2,4)" << std::endl
+      << "  -g, --generations N     number of generations measured for each run (default: 1000)" << std::endl
+      << "  -w, --warmup N          number of generations simulated before measuring (default: 50)" << std::endl
+      << "  -k, --temporal K        generations computed between two synchronizations (default: 1)" << std::endl
+      << "      --seed N            seed used to generate the random soups (default: 42)" << std::endl
+      << "  -r, --rule RULE         rule to use (default: B3/S23)" << std::endl
+      << "  -o, --output FILE       file where the results are written (default: standard output)" << std::endl
+      << "      --pin               pin each worker thread to a distinct core" << std::endl
+      << "  -h, --help              display this message" << std::endl;
+  }
+
+  std::vector<std::string>
+  split(const std::string& str) {
+    std::vector<std::string> tokens;
+    std::stringstream in(str);
+    std::string token;
+
+    while (std::getline(in, token, ',')) {
+      if (!token.empty()) {
+        tokens.push_back(token);
+      }
+    }
+
+    return tokens;
+  }
+
+  template <typename Value, typename Converter>
+  std::vector<Value>
+  splitAs(const std::string& str,
+          Converter convert)
+  {
+    std::vector<Value> out;
+    for (const std::string& token : split(str)) {
+      out.push_back(static_cast<Value>(convert(token)));
+    }
+
+    if (out.empty()) {
+      throw std::invalid_argument("Empty list \"" + str + "\"");
+    }
+
+    return out;
+  }
+
+  utils::Sizei
+  parseSize(const std::string& str) {
+    std::string::size_type sep = str.find('x');
+    if (sep == std::string::npos) {
+      throw std::invalid_argument("Invalid size \"" + str + "\", expected WxH");
+    }
+
+    return utils::Sizei(std::stoi(str.substr(0u, sep)), std::stoi(str.substr(sep + 1u)));
+  }
+
+  /**
+   * @brief - Parse the arguments provided to the program.
+   * @param argc - the number of arguments.
+   * @param argv - the arguments.
+   * @param options - output options filled from the arguments.
+   * @return - `false` if the program should exit right away.
+   */
+  bool
+  parseArguments(int argc,
+                 char** argv,
+                 Options& options)
+  {
+    auto toInt = [](const std::string& s) { return std::stoi(s); };
+    auto toUnsigned = [](const std::string& s) { return std::stoul(s); };
+    auto toFloat = [](const std::string& s) { return std::stof(s); };
+
+    for (int id = 1 ; id < argc ; ++id) {
+      std::string arg(argv[id]);
+
+      if (arg == "-h" || arg == "--help") {
+        usage(argv[0]);
+        return false;
+      }
+
+      if (arg == "--pin") {
+        options.pin = true;
+        continue;
+      }
+
+      // All other options expect a value.
+      if (id + 1 >= argc) {
+        throw std::invalid_argument("Missing value for option \"" + arg + "\"");
+      }
+
+      std::string value(argv[++id]);
+
+      if (arg == "-d" || arg == "--directory") {
+        options.directory = value;
+      }
+      else if (arg == "-p" || arg == "--patterns") {
+        options.patterns = split(value);
+      }
+      else if (arg == "--densities") {
+        options.densities = splitAs<float>(value, toFloat);
+      }
+      else if (arg == "--soup") {
+        options.soup = parseSize(value);
+      }
+      else if (arg == "-b" || arg == "--blocks") {
+        options.blocks = splitAs<int>(value, toInt);
+      }
+      else if (arg == "-t" || arg == "--threads") {
+        options.threads = splitAs<unsigned>(value, toUnsigned);
+      }
+      else if (arg == "-g" || arg == "--generations") {
+        options.generations = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "-w" || arg == "--warmup") {
+        options.warmup = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "-k" || arg == "--temporal") {
+        options.temporal = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "--seed") {
+        options.seed = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "-r" || arg == "--rule") {
+        options.rule = value;
+      }
+      else if (arg == "-o" || arg == "--output") {
+        options.output = value;
+      }
+      else {
+        throw std::invalid_argument("Unknown option \"" + arg + "\"");
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief - Retrieve the peak resident memory of the process and the total
+   *          CPU time consumed so far.
+   * @param cpu - output argument holding the CPU time in seconds.
+   * @return - the peak resident memory in kilobytes.
+   */
+  long
+  fetchUsage(double& cpu) {
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+      cpu = 0.0;
+      return 0;
+    }
+
+    cpu =
+      usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1000000.0 +
+      usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1000000.0
+    ;
+
+    return usage.ru_maxrss;
+  }
+
+  /**
+   * @brief - Run a single scenario with the specified configuration.
+   * @param scenario - the initial content of the colony.
+   * @param block - the size of the blocks of the colony.
+   * @param threads - the number of worker threads.
+   * @param options - the general options of the benchmark.
+   * @return - the measurements for this run.
+   */
+  Result
+  run(const Scenario& scenario,
+      int block,
+      unsigned threads,
+      const Options& options)
+  {
+    utils::Sizei dims = (scenario.pattern.empty() ? options.soup : utils::Sizei(block, block));
+
+    cellulator::ColonyShPtr colony = std::make_shared<cellulator::Colony>(
+      dims,
+      utils::Sizei(block, block),
+      scenario.name
+    );
+
+    cellulator::ColonyScheduler scheduler(colony, threads, options.pin);
+
+    scheduler.onRulesetChanged(cellulator::CellEvolver::fromRule(options.rule));
+    scheduler.setTemporalBlocking(options.temporal);
+
+    if (scenario.pattern.empty()) {
+      colony->generate(scenario.density, options.seed);
+    }
+    else {
+      scheduler.paint(cellulator::CellBrush::fromFile(scenario.pattern), utils::Vector2i(0, 0));
+    }
+
+    // Warm up the caches and the cost estimations of the scheduler.
+    if (options.warmup > 0u) {
+      scheduler.advance(options.warmup);
+      scheduler.waitUntilIdle();
+    }
+
+    scheduler.resetStatistics();
+
+    double cpu = 0.0;
+    fetchUsage(cpu);
+
+    unsigned start = colony->getGeneration();
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    scheduler.advance(options.generations);
+    scheduler.waitUntilIdle();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+    Result res;
+    res.scenario = scenario;
+    res.block = block;
+    res.threads = threads;
+    res.generations = colony->getGeneration() - start;
+    res.population = colony->getLiveCellsCount();
+    res.elapsed = elapsed.count();
+    res.peakMemory = fetchUsage(res.cpu);
+    res.cpu -= cpu;
+    res.stats = scheduler.getStatistics();
+
+    return res;
+  }
+
+  /**
+   * @brief - Serialize the results of the benchmark as a JSON document.
+   * @param out - the stream to write the results to.
+   * @param results - the results of the benchmark.
+   * @param options - the options used to run the benchmark.
+   */
+  void
+  dump(std::ostream& out,
+       const std::vector<Result>& results,
+       const Options& options)
+  {
+    auto rate = [](double count, double elapsed) {
+      return (elapsed > 0.0 ? count / elapsed : 0.0);
+    };
+
+    out << "{" << std::endl
+        << "  \"rule\": \"" << options.rule << "\"," << std::endl
+        << "  \"generations\": " << options.generations << "," << std::endl
+        << "  \"warmup\": " << options.warmup << "," << std::endl
+        << "  \"temporal\": " << options.temporal << "," << std::endl
+        << "  \"seed\": " << options.seed << "," << std::endl
+        << "  \"pinned\": " << (options.pin ? "true" : "false") << "," << std::endl
+        << "  \"runs\": [" << std::endl;
+
+    for (unsigned id = 0u ; id < results.size() ; ++id) {
+      const Result& r = results[id];
+      double cells = 1.0 * r.stats.blocks * r.block * r.block;
+
+      out << "    {" << std::endl
+          << "      \"scenario\": \"" << r.scenario.name << "\"," << std::endl
+          << "      \"block\": " << r.block << "," << std::endl
+          << "      \"threads\": " << r.threads << "," << std::endl
+          << "      \"generations\": " << r.generations << "," << std::endl
+          << "      \"population\": " << r.population << "," << std::endl
+          << "      \"elapsed_s\": " << r.elapsed << "," << std::endl
+          << "      \"cpu_s\": " << r.cpu << "," << std::endl
+          << "      \"generations_per_s\": " << rate(r.generations, r.elapsed) << "," << std::endl
+          << "      \"cells_per_s\": " << rate(cells, r.elapsed) << "," << std::endl
+          << "      \"peak_memory_kb\": " << r.peakMemory << "," << std::endl
+          << "      \"phases_s\": {" << std::endl
+          << "        \"compute\": " << r.stats.compute << "," << std::endl
+          << "        \"commit\": " << r.stats.commit << "," << std::endl
+          << "        \"schedule\": " << r.stats.schedule << "," << std::endl
+          << "        \"publish\": " << r.stats.publish << std::endl
+          << "      }" << std::endl
+          << "    }" << (id + 1u < results.size() ? "," : "") << std::endl;
+    }
+
+    out << "  ]" << std::endl
+        << "}" << std::endl;
+  }
+
+}
+
+int main(int argc, char** argv) {
+  // Create the logger.
+  utils::log::StdLogger raw;
+  raw.setLevel(utils::log::Severity::WARNING);
+  utils::log::PrefixedLogger logger("automaton", "benchmark");
+  utils::log::Locator::provide(&raw);
+
+  Options options{
+    std::string("data/brushes"),
+    std::vector<std::string>{"golgun", "backRake", "spaceRake", "puffer2", "blockLayingSwitchEngine"},
+    std::vector<float>{0.1f, 0.3f, 0.5f},
+    utils::Sizei(512, 512),
+    std::vector<int>{64, 128, 256},
+    std::vector<unsigned>{1u, 2u, 4u},
+    1000u,
+    50u,
+    1u,
+    42u,
+    std::string("B3/S23"),
+    std::string(),
+    false
+  };
+
+  try {
+    if (!parseArguments(argc, argv, options)) {
+      return EXIT_SUCCESS;
+    }
+  }
+  catch (const std::exception& e) {
+    logger.error("Invalid arguments", e.what());
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  try {
+    // Build the list of scenarios.
+    std::vector<Scenario> scenarios;
+
+    for (const std::string& pattern : options.patterns) {
+      scenarios.push_back(Scenario{pattern, options.directory + "/" + pattern + ".brush", 0.0f});
+    }
+
+    for (float density : options.densities) {
+      std::stringstream name;
+      name << "soup_" << density;
+      scenarios.push_back(Scenario{name.str(), std::string(), density});
+    }
+
+    // Run each scenario for each configuration.
+    std::vector<Result> results;
+
+    for (const Scenario& scenario : scenarios) {
+      for (int block : options.blocks) {
+        for (unsigned threads : options.threads) {
+          results.push_back(run(scenario, block, threads, options));
+
+          const Result& r = results.back();
+          std::cerr
+            << scenario.name << " (block: " << block << ", threads: " << threads << "): "
+            << (r.elapsed > 0.0 ? r.generations / r.elapsed : 0.0) << " gen/s" << std::endl;
+        }
+      }
+    }
+
+    if (options.output.empty()) {
+      dump(std::cout, results, options);
+    }
+    else {
+      std::ofstream out(options.output);
+      if (!out.good()) {
+        throw std::invalid_argument("Could not open output file \"" + options.output + "\"");
+      }
+
+      dump(out, results, options);
+    }
+  }
+  catch (const utils::CoreException& e) {
+    logger.error("Caught internal exception while running benchmark", e.what());
+    return EXIT_FAILURE;
+  }
+  catch (const std::exception& e) {
+    logger.error("Caught internal exception while running benchmark", e.what());
+    return EXIT_FAILURE;
+  }
+  catch (...) {
+    logger.error("Unexpected error while running benchmark");
+    return EXIT_FAILURE;
+  }
+
+  // All is good.
+  return EXIT_SUCCESS;
+}
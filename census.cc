@@ -0,0 +1,296 @@
+/**
+ * @brief - Census of the objects produced by random soups: a large number
+ *          of seeded soups are run until they stabilize and the objects
+ *          remaining (still lifes, oscillators and spaceships) are counted.
+ *          The soups are split among all the available cores.
+ */
+
+# include <chrono>
+# include <iostream>
+# include <iomanip>
+# include <mutex>
+# include <condition_variable>
+# include <thread>
+# include <core_utils/log/Locator.hh>
+# include <core_utils/log/PrefixedLogger.hh>
+# include <core_utils/log/StdLogger.hh>
+# include <core_utils/CoreException.hh>
+# include <core_utils/ThreadPool.hh>
+# include "SoupCensus.hh"
+# include "CellEvolver.hh"
+
+namespace {
+
+  /**
+   * @brief - Convenience structure holding the options of the census.
+   */
+  struct Options {
+    unsigned soups;
+    utils::Sizei size;
+    float density;
+    unsigned seed;
+    unsigned threads;
+    std::string rule;
+    unsigned maxGenerations;
+    unsigned maxPeriod;
+    unsigned top;
+  };
+
+  /**
+   * @brief - Used to wait for the completion of the jobs submitted to a
+   *          thread pool.
+   */
+  struct Waiter {
+    std::mutex locker;
+    std::condition_variable cv;
+    unsigned pending;
+
+    void
+    handleJobsCompleted(const std::vector<utils::AsynchronousJobShPtr>& jobs) {
+      {
+        const std::lock_guard guard(locker);
+        pending -= std::min(pending, static_cast<unsigned>(jobs.size()));
+      }
+
+      cv.notify_all();
+    }
+  };
+
+  void
+  usage(const std::string& program) {
+    std::cout
+      << "Usage: " << program << " [options]" << std::endl
+      << "  -n, --soups N           number of soups to run (default: 1000)" << std::endl
+      << "  -s, --size WxH          dimensions of the soups (default: 16x16)" << std::endl
+      << "      --density D         proportion of live cells in the soups (default: 0.5)" << std::endl
+      << "      --seed S            seed of the first soup, incremented for each soup (default: 0)" << std::endl
+      << "  -t, --threads T         number of threads running soups (default: one per core)" << std::endl
+      << "  -r, --rule RULE         rule to use, e.g. B3/S23 (default) or 23/3" << std::endl
+      << "      --max-generations N generations after which a soup is abandoned (default: 10000)" << std::endl
+      << "      --max-period P      largest period detected for soups and objects (default: 30)" << std::endl
+      << "      --top N             number of objects to display, 0 for all (default: 0)" << std::endl
+      << "  -h, --help              display this message" << std::endl;
+  }
+
+  utils::Sizei
+  parseSize(const std::string& str) {
+    std::string::size_type sep = str.find('x');
+    if (sep == std::string::npos) {
+      throw std::invalid_argument("Invalid size \"" + str + "\", expected WxH");
+    }
+
+    return utils::Sizei(std::stoi(str.substr(0u, sep)), std::stoi(str.substr(sep + 1u)));
+  }
+
+  /**
+   * @brief - Parse the arguments provided to the program.
+   * @param argc - the number of arguments.
+   * @param argv - the arguments.
+   * @param options - output options filled from the arguments.
+   * @return - `false` if the program should exit right away.
+   */
+  bool
+  parseArguments(int argc,
+                 char** argv,
+                 Options& options)
+  {
+    for (int id = 1 ; id < argc ; ++id) {
+      std::string arg(argv[id]);
+
+      if (arg == "-h" || arg == "--help") {
+        usage(argv[0]);
+        return false;
+      }
+
+      // All other options expect a value.
+      if (id + 1 >= argc) {
+        throw std::invalid_argument("Missing value for option \"" + arg + "\"");
+      }
+
+      std::string value(argv[++id]);
+
+      if (arg == "-n" || arg == "--soups") {
+        options.soups = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "-s" || arg == "--size") {
+        options.size = parseSize(value);
+      }
+      else if (arg == "--density") {
+        options.density = std::stof(value);
+      }
+      else if (arg == "--seed") {
+        options.seed = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "-t" || arg == "--threads") {
+        options.threads = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "-r" || arg == "--rule") {
+        options.rule = value;
+      }
+      else if (arg == "--max-generations") {
+        options.maxGenerations = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "--max-period") {
+        options.maxPeriod = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "--top") {
+        options.top = static_cast<unsigned>(std::stoul(value));
+      }
+      else {
+        throw std::invalid_argument("Unknown option \"" + arg + "\"");
+      }
+    }
+
+    if (!options.size.valid()) {
+      throw std::invalid_argument("Invalid soup dimensions " + options.size.toString());
+    }
+
+    return true;
+  }
+
+}
+
+int main(int argc, char** argv) {
+  // Create the logger.
+  utils::log::StdLogger raw;
+  raw.setLevel(utils::log::Severity::WARNING);
+  utils::log::PrefixedLogger logger("automaton", "census");
+  utils::log::Locator::provide(&raw);
+
+  Options options{
+    1000u,
+    utils::Sizei(16, 16),
+    0.5f,
+    0u,
+    std::max(std::thread::hardware_concurrency(), 1u),
+    std::string("B3/S23"),
+    10000u,
+    30u,
+    0u
+  };
+
+  try {
+    if (!parseArguments(argc, argv, options)) {
+      return EXIT_SUCCESS;
+    }
+  }
+  catch (const std::exception& e) {
+    logger.error("Invalid arguments", e.what());
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  try {
+    cellulator::CellEvolverShPtr ruleset = cellulator::CellEvolver::fromRule(options.rule);
+
+    // Split the soups among the threads: each job owns its colony so that
+    // soups can run without any synchronization.
+    unsigned threads = std::max(std::min(options.threads, options.soups), 1u);
+
+    std::vector<cellulator::SoupCensusShPtr> census;
+    std::vector<utils::AsynchronousJobShPtr> jobs;
+
+    unsigned seed = options.seed;
+    for (unsigned id = 0u ; id < threads ; ++id) {
+      unsigned count = options.soups / threads + (id < options.soups % threads ? 1u : 0u);
+
+      cellulator::SoupCensusShPtr job = std::make_shared<cellulator::SoupCensus>(
+        ruleset,
+        options.size,
+        options.density,
+        seed,
+        count
+      );
+
+      job->setLimits(options.maxGenerations, options.maxPeriod);
+
+      census.push_back(job);
+      jobs.push_back(job);
+
+      seed += count;
+    }
+
+    Waiter waiter;
+    waiter.pending = jobs.size();
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    {
+      utils::ThreadPool pool(threads);
+      pool.setAllowLog(false);
+      pool.onJobsCompleted.connect_member<Waiter>(&waiter, &Waiter::handleJobsCompleted);
+
+      pool.enqueueJobs(jobs, false);
+      pool.notifyJobs();
+
+      std::unique_lock lock(waiter.locker);
+      waiter.cv.wait(
+        lock,
+        [&waiter]() {
+          return waiter.pending == 0u;
+        }
+      );
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+    // Merge the results of all the jobs.
+    cellulator::SoupCensus::Tally tally;
+    cellulator::SoupCensus::Statistics stats{0u, 0u, 0u, 0u};
+
+    for (unsigned id = 0u ; id < census.size() ; ++id) {
+      for (const std::pair<const std::string, unsigned long>& object : census[id]->getTally()) {
+        tally[object.first] += object.second;
+      }
+
+      const cellulator::SoupCensus::Statistics& s = census[id]->getStatistics();
+      stats.soups += s.soups;
+      stats.stabilized += s.stabilized;
+      stats.generations += s.generations;
+      stats.objects += s.objects;
+    }
+
+    std::vector<std::pair<std::string, unsigned long>> sorted(tally.cbegin(), tally.cend());
+    std::stable_sort(
+      sorted.begin(),
+      sorted.end(),
+      [](const std::pair<std::string, unsigned long>& lhs, const std::pair<std::string, unsigned long>& rhs) {
+        return lhs.second > rhs.second;
+      }
+    );
+
+    unsigned shown = (options.top == 0u ? sorted.size() : std::min<unsigned>(options.top, sorted.size()));
+
+    for (unsigned id = 0u ; id < shown ; ++id) {
+      std::string name = census.front()->getObjectName(sorted[id].first);
+
+      std::cout
+        << std::setw(10) << sorted[id].second << " " << sorted[id].first
+        << (name.empty() ? std::string() : " (" + name + ")") << std::endl;
+    }
+
+    std::cout
+      << "rule:        " << options.rule << std::endl
+      << "soups:       " << stats.soups << " (stabilized: " << stats.stabilized << ")" << std::endl
+      << "objects:     " << stats.objects << " (distinct: " << tally.size() << ")" << std::endl
+      << "generations: " << stats.generations << std::endl
+      << "elapsed:     " << elapsed.count() << "s with " << threads << " thread(s)" << std::endl
+      << "rate:        " << (elapsed.count() > 0.0 ? stats.soups / elapsed.count() : 0.0) << " soups/s, "
+      << (elapsed.count() > 0.0 ? stats.generations / elapsed.count() : 0.0) << " gen/s" << std::endl;
+  }
+  catch (const utils::CoreException& e) {
+    logger.error("Caught internal exception while running census", e.what());
+    return EXIT_FAILURE;
+  }
+  catch (const std::exception& e) {
+    logger.error("Caught internal exception while running census", e.what());
+    return EXIT_FAILURE;
+  }
+  catch (...) {
+    logger.error("Unexpected error while running census");
+    return EXIT_FAILURE;
+  }
+
+  // All is good.
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,500 @@
+
+/**
+ * @brief - Differential testing of the simulation engines: runs the patterns
+ *          shipped with the application and some random soups through all
+ *          the available configurations of the engine and compares the live
+ *          cells at regular intervals with the ones computed by the simple
+ *          reference implementation. Each pattern is painted at the origin
+ *          of a colony made of a single block and also in a colony several
+ *          blocks wide with its edges on the boundaries of the blocks. The
+ *          program exits with a failure code as soon as one engine diverges
+ *          from the reference.
+ */
+
+# include <algorithm>
+# include <filesystem>
+# include <iomanip>
+# include <iostream>
+# include <map>
+# include <sstream>
+# include <core_utils/log/Locator.hh>
+# include <core_utils/log/PrefixedLogger.hh>
+# include <core_utils/log/StdLogger.hh>
+# include <core_utils/CoreException.hh>
+# include "Colony.hh"
+# include "ColonyScheduler.hh"
+# include "CellBrush.hh"
+# include "CellEvolver.hh"
+# include "ReferenceColony.hh"
+
+namespace {
+
+  /**
+   * @brief - Convenience structure holding the options of the program.
+   */
+  struct Options {
+    std::string directory;
+    std::vector<std::string> patterns;
+    std::vector<float> densities;
+    utils::Sizei soup;
+    unsigned generations;
+    unsigned interval;
+    unsigned seed;
+    std::string rule;
+  };
+
+  /**
+   * @brief - The possible locations of a pattern in the colony.
+   */
+  enum class Placement {
+    Origin,         //< At the origin of a colony made of a single block.
+    LowEdges,       //< Left column and bottom row on the first cells of blocks.
+    HighEdges       //< Right column and top row on the last cells of blocks.
+  };
+
+  /**
+   * @brief - Describe the initial content of a single scenario: either one
+   *          of the patterns painted at a given location or a random soup
+   *          with a given density.
+   */
+  struct Scenario {
+    std::string name;
+    std::string pattern;
+    Placement placement;
+    float density;
+  };
+
+  /**
+   * @brief - Describe a configuration of the engine to verify. A number of
+   *          threads of `0` means that the blocks are evolved sequentially
+   *          without any scheduler. A `cold` threshold of `0` keeps all the
+   *          blocks inflated.
+   */
+  struct EngineDesc {
+    std::string name;
+    int block;
+    unsigned threads;
+    unsigned temporal;
+    unsigned cold;
+  };
+
+  /**
+   * @brief - The population and hash of the live cells of a colony at a
+   *          given generation.
+   */
+  struct Checkpoint {
+    unsigned generation;
+    unsigned population;
+    std::uint64_t hash;
+  };
+
+  using Trajectory = std::vector<Checkpoint>;
+
+  void
+  usage(const std::string& program) {
+    std::cout
+      << "Usage: " << program << " [options]" << std::endl
+      << "  -d, --directory DIR     directory containing the patterns (default: data/brushes)" << std::endl
+      << "  -p, --patterns LIST     comma separated list of patterns to run (default: all)" << std::endl
+      << "      --densities LIST    comma separated densities of the random soups (default: 0.2,0.5)" << std::endl
+      << "      --soup WxH          dimensions of the random soups (default: 256x256)" << std::endl
+      << "  -g, --generations N     number of generations to simulate (default: 200)" << std::endl
+      << "  -i, --interval N        number of generations between two comparisons (default: 10)" << std::endl
+      << "      --seed N            seed used to generate the random soups (default: 42)" << std::endl
+      << "  -r, --rule RULE         rule to use (default: B3/S23)" << std::endl
+      << "  -h, --help              display this message" << std::endl;
+  }
+
+  std::vector<std::string>
+  split(const std::string& str) {
+    std::vector<std::string> tokens;
+    std::stringstream in(str);
+    std::string token;
+
+    while (std::getline(in, token, ',')) {
+      if (!token.empty()) {
+        tokens.push_back(token);
+      }
+    }
+
+    return tokens;
+  }
+
+  utils::Sizei
+  parseSize(const std::string& str) {
+    std::string::size_type sep = str.find('x');
+    if (sep == std::string::npos) {
+      throw std::invalid_argument("Invalid size \"" + str + "\", expected WxH");
+    }
+
+    return utils::Sizei(std::stoi(str.substr(0u, sep)), std::stoi(str.substr(sep + 1u)));
+  }
+
+  bool
+  parseArguments(int argc,
+                 char** argv,
+                 Options& options)
+  {
+    for (int id = 1 ; id < argc ; ++id) {
+      std::string arg(argv[id]);
+
+      if (arg == "-h" || arg == "--help") {
+        usage(argv[0]);
+        return false;
+      }
+
+      // All other options expect a value.
+      if (id + 1 >= argc) {
+        throw std::invalid_argument("Missing value for option \"" + arg + "\"");
+      }
+
+      std::string value(argv[++id]);
+
+      if (arg == "-d" || arg == "--directory") {
+        options.directory = value;
+      }
+      else if (arg == "-p" || arg == "--patterns") {
+        options.patterns = split(value);
+      }
+      else if (arg == "--densities") {
+        options.densities.clear();
+        for (const std::string& d : split(value)) {
+          options.densities.push_back(std::stof(d));
+        }
+      }
+      else if (arg == "--soup") {
+        options.soup = parseSize(value);
+      }
+      else if (arg == "-g" || arg == "--generations") {
+        options.generations = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "-i" || arg == "--interval") {
+        options.interval = std::max(static_cast<unsigned>(std::stoul(value)), 1u);
+      }
+      else if (arg == "--seed") {
+        options.seed = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "-r" || arg == "--rule") {
+        options.rule = value;
+      }
+      else {
+        throw std::invalid_argument("Unknown option \"" + arg + "\"");
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief - Wrap a colony and the way it is evolved for a given engine.
+   */
+  class Engine {
+    public:
+
+      Engine(const EngineDesc& desc,
+             const Scenario& scenario,
+             const Options& options):
+        m_desc(desc),
+        m_colony(),
+        m_scheduler(),
+        m_schedule()
+      {
+        // Patterns painted on the edges of blocks use a colony several
+        // blocks wide: the blocks on both sides of each edge exist from
+        // the start rather than being created when the pattern is painted.
+        utils::Sizei dims = options.soup;
+        if (!scenario.pattern.empty()) {
+          int count = (scenario.placement == Placement::Origin ? 1 : 4);
+          dims = utils::Sizei(count * desc.block, count * desc.block);
+        }
+
+        m_colony = std::make_shared<cellulator::Colony>(
+          dims,
+          utils::Sizei(desc.block, desc.block),
+          scenario.name + "_" + desc.name
+        );
+
+        m_colony->setRuleset(cellulator::CellEvolver::fromRule(options.rule));
+        m_colony->setColdThreshold(m_desc.cold);
+
+        if (scenario.pattern.empty()) {
+          m_colony->generate(scenario.density, options.seed);
+        }
+        else {
+          cellulator::CellBrushShPtr brush = cellulator::CellBrush::fromFile(scenario.pattern);
+          m_colony->paint(*brush, getLocation(scenario.placement, brush->getSize()));
+        }
+
+        if (m_desc.threads > 0u) {
+          m_scheduler = std::make_shared<cellulator::ColonyScheduler>(m_colony, m_desc.threads);
+          m_scheduler->setTemporalBlocking(m_desc.temporal);
+        }
+      }
+
+      /**
+       * @brief - Evolve the colony for the specified number of generations. The
+       *          evolution stops early in case no cells are alive anymore.
+       * @param generations - the number of generations to compute.
+       */
+      void
+      advance(unsigned generations) {
+        if (m_scheduler != nullptr) {
+          m_scheduler->advance(generations);
+          m_scheduler->waitUntilIdle();
+
+          return;
+        }
+
+        for (unsigned gen = 0u ; gen < generations ; ++gen) {
+          m_colony->generateSchedule(m_schedule);
+          if (m_schedule.empty()) {
+            return;
+          }
+
+          for (unsigned id = 0u ; id < m_schedule.size() ; ++id) {
+            m_colony->evolve(m_schedule[id]);
+          }
+
+          m_colony->step();
+        }
+      }
+
+      cellulator::Colony&
+      colony() noexcept {
+        return *m_colony;
+      }
+
+    private:
+
+      /**
+       * @brief - Compute the coordinates at which a brush should be painted to
+       *          match the placement in argument. The colony being made of an
+       *          even number of blocks centered on the origin, the axes are on
+       *          the boundaries of the blocks whatever their dimensions.
+       * @param placement - the placement of the brush.
+       * @param size - the dimensions of the brush.
+       * @return - the coordinates of the center of the brush.
+       */
+      static
+      utils::Vector2i
+      getLocation(const Placement& placement,
+                  const utils::Sizei& size) noexcept
+      {
+        switch (placement) {
+          case Placement::LowEdges:
+            return utils::Vector2i(size.w() / 2, size.h() / 2);
+          case Placement::HighEdges:
+            return utils::Vector2i(size.w() / 2 - size.w(), size.h() / 2 - size.h());
+          case Placement::Origin:
+          default:
+            return utils::Vector2i(0, 0);
+        }
+      }
+
+      EngineDesc m_desc;
+      cellulator::ColonyShPtr m_colony;
+      cellulator::ColonySchedulerShPtr m_scheduler;
+      std::vector<unsigned> m_schedule;
+  };
+
+  /**
+   * @brief - Compute the trajectory of the reference colony starting from the
+   *          cells in input.
+   * @param cells - the initial live cells.
+   * @param options - the options of the program.
+   * @return - the checkpoints of the reference colony.
+   */
+  Trajectory
+  reference(const std::vector<utils::Vector2i>& cells,
+            const Options& options)
+  {
+    cellulator::ReferenceColony colony(cellulator::CellEvolver::fromRule(options.rule));
+    colony.assign(cells);
+
+    Trajectory out;
+    std::vector<utils::Vector2i> live;
+
+    for (unsigned gen = options.interval ; gen <= options.generations ; gen += options.interval) {
+      colony.step(options.interval);
+      colony.getLiveCells(live);
+
+      out.push_back(Checkpoint{colony.getGeneration(), colony.getLiveCellsCount(), cellulator::ReferenceColony::hash(live)});
+    }
+
+    return out;
+  }
+
+  std::string
+  toHex(std::uint64_t hash) {
+    std::stringstream out;
+    out << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return out.str();
+  }
+
+}
+
+int main(int argc, char** argv) {
+  // Create the logger.
+  utils::log::StdLogger raw;
+  raw.setLevel(utils::log::Severity::WARNING);
+  utils::log::PrefixedLogger logger("automaton", "differential");
+  utils::log::Locator::provide(&raw);
+
+  Options options{
+    std::string("data/brushes"),
+    std::vector<std::string>(),
+    std::vector<float>{0.2f, 0.5f},
+    utils::Sizei(256, 256),
+    200u,
+    10u,
+    42u,
+    std::string("B3/S23")
+  };
+
+  try {
+    if (!parseArguments(argc, argv, options)) {
+      return EXIT_SUCCESS;
+    }
+  }
+  catch (const std::exception& e) {
+    logger.error("Invalid arguments", e.what());
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  unsigned failures = 0u;
+
+  try {
+    // Build the list of scenarios: use all the available patterns if none
+    // is specified.
+    if (options.patterns.empty()) {
+      for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(options.directory)) {
+        if (entry.path().extension() == ".brush") {
+          options.patterns.push_back(entry.path().stem().string());
+        }
+      }
+
+      std::sort(options.patterns.begin(), options.patterns.end());
+    }
+
+    std::vector<Scenario> scenarios;
+
+    for (const std::string& pattern : options.patterns) {
+      std::string file = options.directory + "/" + pattern + ".brush";
+
+      scenarios.push_back(Scenario{pattern, file, Placement::Origin, 0.0f});
+      scenarios.push_back(Scenario{pattern + "_low_edges", file, Placement::LowEdges, 0.0f});
+      scenarios.push_back(Scenario{pattern + "_high_edges", file, Placement::HighEdges, 0.0f});
+    }
+
+    for (float density : options.densities) {
+      std::stringstream name;
+      name << "soup_" << density;
+      scenarios.push_back(Scenario{name.str(), std::string(), Placement::Origin, density});
+    }
+
+    // The engines to verify.
+    std::vector<EngineDesc> engines{
+      EngineDesc{"serial", 256, 0u, 1u, 0u},
+      EngineDesc{"serial_small_blocks", 32, 0u, 1u, 0u},
+      EngineDesc{"serial_cold", 32, 0u, 1u, 4u},
+      EngineDesc{"scheduler", 256, 3u, 1u, 0u},
+      EngineDesc{"scheduler_temporal", 64, 3u, 8u, 0u},
+      EngineDesc{"scheduler_temporal_small_blocks", 16, 2u, 15u, 0u},
+      EngineDesc{"scheduler_temporal_cold", 16, 2u, 7u, 14u}
+    };
+
+    for (const Scenario& scenario : scenarios) {
+      // Some of the brushes might not be valid: they are reported but do
+      // not count as a failure of the engines.
+      if (!scenario.pattern.empty()) {
+        try {
+          cellulator::CellBrush::fromFile(scenario.pattern);
+        }
+        catch (const utils::CoreException& e) {
+          std::cout << std::left << std::setw(28) << scenario.name << "skipped (" << e.what() << ")" << std::endl;
+          continue;
+        }
+      }
+
+      // The reference only depends on the initial cells which may vary with
+      // the dimensions of the blocks for soups.
+      std::map<std::uint64_t, Trajectory> references;
+
+      for (const EngineDesc& desc : engines) {
+        Engine engine(desc, scenario, options);
+
+        std::vector<utils::Vector2i> cells;
+        engine.colony().getLiveCells(cells);
+
+        std::uint64_t initial = cellulator::ReferenceColony::hash(cells);
+        if (references.count(initial) == 0u) {
+          references[initial] = reference(cells, options);
+        }
+
+        const Trajectory& expected = references[initial];
+
+        // Compare the engine at each checkpoint.
+        std::string status("ok");
+
+        for (unsigned id = 0u ; id < expected.size() ; ++id) {
+          const Checkpoint& e = expected[id];
+
+          engine.advance(options.interval);
+          engine.colony().getLiveCells(cells);
+
+          Checkpoint c{engine.colony().getGeneration(), static_cast<unsigned>(cells.size()), cellulator::ReferenceColony::hash(cells)};
+
+          // A colony with no live cells stops evolving.
+          bool sameGen = (c.generation == e.generation || e.population == 0u);
+
+          if (!sameGen || c.population != e.population || c.hash != e.hash) {
+            status =
+              "MISMATCH at generation " + std::to_string(e.generation) +
+              " (got generation " + std::to_string(c.generation) +
+              ", population " + std::to_string(c.population) + " vs " + std::to_string(e.population) +
+              ", hash " + toHex(c.hash) + " vs " + toHex(e.hash) + ")"
+            ;
+
+            ++failures;
+            break;
+          }
+
+          // Also verify the count of live cells maintained by the colony.
+          if (engine.colony().getLiveCellsCount() != c.population) {
+            status =
+              "MISMATCH at generation " + std::to_string(e.generation) +
+              " (live cells count " + std::to_string(engine.colony().getLiveCellsCount()) +
+              " but " + std::to_string(c.population) + " live cells)"
+            ;
+
+            ++failures;
+            break;
+          }
+        }
+
+        std::cout << std::left << std::setw(28) << scenario.name << std::setw(34) << desc.name << status << std::endl;
+      }
+    }
+  }
+  catch (const utils::CoreException& e) {
+    logger.error("Caught internal exception while running differential tests", e.what());
+    return EXIT_FAILURE;
+  }
+  catch (const std::exception& e) {
+    logger.error("Caught internal exception while running differential tests", e.what());
+    return EXIT_FAILURE;
+  }
+  catch (...) {
+    logger.error("Unexpected error while running differential tests");
+    return EXIT_FAILURE;
+  }
+
+  if (failures > 0u) {
+    std::cout << failures << " engine(s) diverged from the reference" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // All is good.
+  return EXIT_SUCCESS;
+}
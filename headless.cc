@@ -0,0 +1,644 @@
+
+/**
+ * @brief - Headless version of the cellular automaton: allows to simulate
+ *          a colony for a given number of generations without any display
+ *          and to report some statistics about the run. This is typically
+ *          useful to run simulations on machines without a display.
+ */
+
+# include <chrono>
+# include <cstring>
+# include <fstream>
+# include <iostream>
+# include <core_utils/log/Locator.hh>
+# include <core_utils/log/PrefixedLogger.hh>
+# include <core_utils/log/StdLogger.hh>
+# include <core_utils/CoreException.hh>
+# include "Colony.hh"
+# include "ColonyScheduler.hh"
+# include "ColonyBatch.hh"
+# include "CellBrush.hh"
+# include "CellEvolver.hh"
+# include "RleReader.hh"
+# include "Macrocell.hh"
+# include "CheckpointLog.hh"
+# include "Recorder.hh"
+# include "RecordingPlayer.hh"
+# include "PeriodDetector.hh"
+
+namespace {
+
+  /**
+   * @brief - Convenience structure holding the options of the run.
+   */
+  struct Options {
+    std::string pattern;
+    std::string rule;
+    unsigned generations;
+    bool random;
+    utils::Sizei size;
+    unsigned temporal;
+    int block;
+    unsigned cold;
+    unsigned batch;
+    unsigned threads;
+    float density;
+    unsigned seed;
+    std::string output;
+    std::string checkpoint;
+    std::string resume;
+    std::string log;
+    unsigned logInterval;
+    unsigned baseInterval;
+    std::string record;
+    unsigned keyframes;
+    std::string play;
+    long long seek;
+    unsigned rate;
+    unsigned renderEvery;
+    bool pin;
+    long long untilPopulation;
+    bool untilStable;
+  };
+
+  void
+  usage(const std::string& program) {
+    std::cout
+      << "Usage: " << program << " [options]" << std::endl
+      << "  -p, --pattern FILE      brush, RLE or macrocell file to paint at the origin of the colony" << std::endl
+      << "  -r, --rule RULE         rule to use, e.g. B3/S23 (default) or 23/3, overrides the rule of pattern files" << std::endl
+      << "  -g, --generations N     number of generations to simulate (default: 1000)" << std::endl
+      << "      --until-population N  stop as soon as the population is at most N, within --generations" << std::endl
+      << "      --until-stable      stop as soon as the population is periodic, within --generations" << std::endl
+      << "      --random            fill the colony with random cells" << std::endl
+      << "  -s, --size WxH          initial dimensions of the colony (default: 256x256)" << std::endl
+      << "  -k, --temporal K        generations computed between two synchronizations" << std::endl
+      << "      --rate N            simulate at most N generations per second (default: 0, unlimited)" << std::endl
+      << "      --render-every N    print the progress of the simulation every N generations" << std::endl
+      << "      --block N           dimensions of the blocks of cells (default: 256)" << std::endl
+      << "      --cold N            compress the blocks which did not change for N generations (default: 0, disabled)" << std::endl
+      << "  -b, --batch N           simulate N independent colonies in parallel" << std::endl
+      << "  -t, --threads T         number of threads used to simulate (default: one per core for batches)" << std::endl
+      << "      --pin               pin each thread simulating the colony to a distinct core" << std::endl
+      << "      --density D         proportion of live cells for --random (default: 0.3)" << std::endl
+      << "      --seed S            seed for --random, incremented for each colony of a batch" << std::endl
+      << "  -o, --output FILE       macrocell file receiving the final state of the colony" << std::endl
+      << "      --checkpoint FILE   checkpoint file receiving the complete final state of the colony" << std::endl
+      << "      --resume FILE       resume the simulation from a checkpoint file or log" << std::endl
+      << "      --log FILE          checkpoint log receiving the modified blocks periodically" << std::endl
+      << "      --log-interval N    generations between two records of the log (default: 100)" << std::endl
+      << "      --base-interval N   records between two complete records of the log (default: 16)" << std::endl
+      << "      --record FILE       recording receiving the changes of the cells at each generation" << std::endl
+      << "      --keyframes N       frames between two keyframes of the recording (default: 64)" << std::endl
+      << "      --play FILE         play a recording instead of simulating the colony" << std::endl
+      << "      --seek GEN          only display the first frame of the recording reaching GEN" << std::endl
+      << "  -h, --help              display this message" << std::endl;
+  }
+
+  /**
+   * @brief - Whether the file in argument has the specified extension, used to
+   *          determine the format of patterns.
+   * @param file - the name of the file.
+   * @param ext - the extension, including the leading `.`.
+   * @return - `true` if the file has the extension.
+   */
+  bool
+  hasExtension(const std::string& file,
+               const std::string& ext)
+  {
+    return file.size() >= ext.size() && file.compare(file.size() - ext.size(), ext.size(), ext) == 0;
+  }
+
+  /**
+   * @brief - Whether the file in argument is a checkpoint log rather than a
+   *          checkpoint, used to determine how to resume a colony.
+   * @param file - the name of the file.
+   * @return - `true` if the file starts with a record of a checkpoint log.
+   */
+  bool
+  isCheckpointLog(const std::string& file) {
+    char magic[8] = {0};
+
+    std::ifstream in(file.c_str(), std::ios::binary);
+    in.read(magic, sizeof(magic));
+
+    return in.good() && std::memcmp(magic, cellulator::CheckpointLog::getMagic(), sizeof(magic)) == 0;
+  }
+
+  utils::Sizei
+  parseSize(const std::string& str) {
+    std::string::size_type sep = str.find('x');
+    if (sep == std::string::npos) {
+      throw std::invalid_argument("Invalid size \"" + str + "\", expected WxH");
+    }
+
+    return utils::Sizei(std::stoi(str.substr(0u, sep)), std::stoi(str.substr(sep + 1u)));
+  }
+
+  /**
+   * @brief - Parse the arguments provided to the program.
+   * @param argc - the number of arguments.
+   * @param argv - the arguments.
+   * @param options - output options filled from the arguments.
+   * @return - `false` if the program should exit right away.
+   */
+  bool
+  parseArguments(int argc,
+                 char** argv,
+                 Options& options)
+  {
+    for (int id = 1 ; id < argc ; ++id) {
+      std::string arg(argv[id]);
+
+      if (arg == "-h" || arg == "--help") {
+        usage(argv[0]);
+        return false;
+      }
+
+      if (arg == "--random") {
+        options.random = true;
+        continue;
+      }
+      if (arg == "--pin") {
+        options.pin = true;
+        continue;
+      }
+      if (arg == "--until-stable") {
+        options.untilStable = true;
+        continue;
+      }
+
+      // All other options expect a value.
+      if (id + 1 >= argc) {
+        throw std::invalid_argument("Missing value for option \"" + arg + "\"");
+      }
+
+      std::string value(argv[++id]);
+
+      if (arg == "-p" || arg == "--pattern") {
+        options.pattern = value;
+      }
+      else if (arg == "-o" || arg == "--output") {
+        options.output = value;
+      }
+      else if (arg == "--checkpoint") {
+        options.checkpoint = value;
+      }
+      else if (arg == "--resume") {
+        options.resume = value;
+      }
+      else if (arg == "--log") {
+        options.log = value;
+      }
+      else if (arg == "--log-interval") {
+        options.logInterval = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "--base-interval") {
+        options.baseInterval = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "--record") {
+        options.record = value;
+      }
+      else if (arg == "--keyframes") {
+        options.keyframes = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "--play") {
+        options.play = value;
+      }
+      else if (arg == "--seek") {
+        options.seek = std::stoll(value);
+      }
+      else if (arg == "-r" || arg == "--rule") {
+        options.rule = value;
+      }
+      else if (arg == "-g" || arg == "--generations") {
+        options.generations = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "--until-population") {
+        options.untilPopulation = std::stoll(value);
+      }
+      else if (arg == "-s" || arg == "--size") {
+        options.size = parseSize(value);
+      }
+      else if (arg == "-k" || arg == "--temporal") {
+        options.temporal = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "--rate") {
+        options.rate = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "--render-every") {
+        options.renderEvery = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "--block") {
+        options.block = std::stoi(value);
+      }
+      else if (arg == "--cold") {
+        options.cold = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "-b" || arg == "--batch") {
+        options.batch = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "-t" || arg == "--threads") {
+        options.threads = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "--density") {
+        options.density = std::stof(value);
+      }
+      else if (arg == "--seed") {
+        options.seed = static_cast<unsigned>(std::stoul(value));
+      }
+      else {
+        throw std::invalid_argument("Unknown option \"" + arg + "\"");
+      }
+    }
+
+    if (options.batch > 0u && (!options.output.empty() || !options.checkpoint.empty() || !options.resume.empty() || !options.log.empty() ||
+                               !options.record.empty() || !options.play.empty())) {
+      throw std::invalid_argument("Saving or resuming the colony is not supported with --batch");
+    }
+
+    if (!options.resume.empty() && (!options.pattern.empty() || options.random)) {
+      throw std::invalid_argument("A resumed colony can't be combined with --pattern or --random");
+    }
+
+    if (!options.play.empty() && (!options.pattern.empty() || options.random || !options.resume.empty() ||
+                                  !options.log.empty() || !options.record.empty()))
+    {
+      throw std::invalid_argument("A recording can only be played on its own");
+    }
+
+    if (options.pattern.empty() && !options.random && options.resume.empty() && options.play.empty()) {
+      throw std::invalid_argument("No initial content for the colony, use either --pattern, --random, --resume or --play");
+    }
+
+    if (options.logInterval == 0u) {
+      throw std::invalid_argument("Invalid interval between two records of the log");
+    }
+
+    if (options.rate > 0u && options.renderEvery > 0u) {
+      throw std::invalid_argument("A fixed rate can't be combined with --render-every");
+    }
+
+    if ((options.rate > 0u || options.renderEvery > 0u) && (options.batch > 0u || !options.play.empty())) {
+      throw std::invalid_argument("Controlling the rate is only supported when simulating a single colony");
+    }
+
+    if (options.pin && options.batch > 0u) {
+      throw std::invalid_argument("Pinning threads is not supported with --batch");
+    }
+
+    if ((options.untilPopulation >= 0 || options.untilStable) && (options.batch > 0u || !options.play.empty() || !options.log.empty())) {
+      throw std::invalid_argument("Stopping on a condition is not supported with --batch, --play or --log");
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief - Simulate a batch of independent colonies with a shared pool of
+   *          threads and print the results for each colony.
+   * @param options - the options of the run.
+   * @param macrocell - the pattern to load in each colony when the pattern
+   *                    is a macrocell file.
+   */
+  void
+  runBatch(const Options& options,
+           cellulator::MacrocellShPtr macrocell)
+  {
+    cellulator::ColonyBatch batch(options.threads);
+    cellulator::CellEvolverShPtr ruleset = cellulator::CellEvolver::fromRule(options.rule);
+
+    cellulator::CellBrushShPtr brush;
+    if (!options.pattern.empty() && macrocell == nullptr) {
+      brush = cellulator::CellBrush::fromFile(options.pattern);
+    }
+
+    for (unsigned id = 0u ; id < options.batch ; ++id) {
+      cellulator::ColonyShPtr colony = std::make_shared<cellulator::Colony>(
+        options.size,
+        utils::Sizei(options.block, options.block),
+        std::string("colony_") + std::to_string(id)
+      );
+
+      colony->setRuleset(ruleset);
+
+      if (options.random) {
+        colony->generate(options.density, options.seed + id);
+      }
+      if (brush != nullptr) {
+        colony->paint(*brush, utils::Vector2i(0, 0));
+      }
+      if (macrocell != nullptr) {
+        colony->load(*macrocell, utils::Vector2i(0, 0));
+      }
+
+      batch.add(colony);
+    }
+
+    std::vector<cellulator::ColonyResult> results = batch.run(options.generations, options.temporal);
+
+    for (const cellulator::ColonyResult& r : results) {
+      std::cout
+        << r.name << ": generation " << r.generation << ", population " << r.alive
+        << ", " << r.elapsed << "s" << (r.success ? std::string() : " (failed: " + r.error + ")") << std::endl;
+    }
+
+    cellulator::ColonyBatch::Statistics stats = batch.getStatistics();
+
+    std::cout
+      << "rule:        " << options.rule << std::endl
+      << "colonies:    " << stats.colonies << " (failed: " << stats.failures << ")" << std::endl
+      << "generations: " << stats.generations << std::endl
+      << "elapsed:     " << stats.elapsed << "s (busy: " << stats.busy << "s)" << std::endl
+      << "rate:        " << (stats.elapsed > 0.0 ? stats.generations / stats.elapsed : 0.0) << " gen/s, "
+      << (stats.elapsed > 0.0 ? stats.colonies / stats.elapsed : 0.0) << " colonies/s" << std::endl;
+  }
+
+}
+
+int main(int argc, char** argv) {
+  // Create the logger.
+  utils::log::StdLogger raw;
+  raw.setLevel(utils::log::Severity::WARNING);
+  utils::log::PrefixedLogger logger("automaton", "headless");
+  utils::log::Locator::provide(&raw);
+
+  Options options{
+    std::string(),
+    std::string(),
+    1000u,
+    false,
+    utils::Sizei(256, 256),
+    1u,
+    256,
+    0u,
+    0u,
+    0u,
+    0.3f,
+    0u,
+    std::string(),
+    std::string(),
+    std::string(),
+    std::string(),
+    100u,
+    16u,
+    std::string(),
+    64u,
+    std::string(),
+    -1ll,
+    0u,
+    0u,
+    false,
+    -1ll,
+    false
+  };
+
+  try {
+    if (!parseArguments(argc, argv, options)) {
+      return EXIT_SUCCESS;
+    }
+  }
+  catch (const std::exception& e) {
+    logger.error("Invalid arguments", e.what());
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  try {
+    // Use the rule of the pattern unless one is provided.
+    cellulator::MacrocellShPtr macrocell;
+    if (hasExtension(options.pattern, ".mc")) {
+      macrocell = cellulator::Macrocell::fromFile(options.pattern);
+    }
+
+    if (options.rule.empty() && hasExtension(options.pattern, ".rle")) {
+      cellulator::RleReader reader(options.pattern);
+      if (reader.getRuleset() != nullptr) {
+        options.rule = reader.getRule();
+      }
+    }
+    if (options.rule.empty() && macrocell != nullptr && macrocell->getRuleset() != nullptr) {
+      options.rule = macrocell->getRule();
+    }
+    // The rule of a resumed colony is saved in the checkpoint.
+    bool overrideRule = !options.rule.empty();
+    if (options.rule.empty()) {
+      options.rule = "B3/S23";
+    }
+
+    if (options.batch > 0u) {
+      runBatch(options, macrocell);
+      return EXIT_SUCCESS;
+    }
+
+    // Create the colony and its scheduler.
+    cellulator::ColonyShPtr colony = std::make_shared<cellulator::Colony>(
+      options.size,
+      utils::Sizei(options.block, options.block),
+      std::string("headless")
+    );
+
+    cellulator::ColonyScheduler scheduler(colony, options.threads, options.pin);
+
+    scheduler.onRulesetChanged(cellulator::CellEvolver::fromRule(options.rule));
+    scheduler.setTemporalBlocking(options.temporal);
+    colony->setColdThreshold(options.cold);
+
+    if (options.rate > 0u) {
+      scheduler.setRateControl(cellulator::ColonyScheduler::RateControl::FixedRate, options.rate);
+    }
+    if (options.renderEvery > 0u) {
+      scheduler.setRateControl(cellulator::ColonyScheduler::RateControl::RenderEveryN, options.renderEvery);
+
+      // The notifications are emitted by the scheduler while the workers
+      // wait, which is cheap enough to print the progress.
+      scheduler.onGenerationComputed.connect(
+        [](unsigned generation, unsigned alive) {
+          std::cout << "progress:    generation " << generation << ", population " << alive << std::endl;
+        }
+      );
+    }
+
+    // Create the initial content of the colony.
+    if (options.random) {
+      colony->generate(options.density, options.seed);
+    }
+
+    if (!options.resume.empty()) {
+      std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+      if (isCheckpointLog(options.resume)) {
+        colony->replay(options.resume);
+      }
+      else {
+        colony->restore(options.resume);
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+      if (overrideRule) {
+        scheduler.onRulesetChanged(cellulator::CellEvolver::fromRule(options.rule));
+      }
+      else {
+        options.rule = colony->getRuleset()->toRule();
+      }
+
+      std::cout
+        << "resumed:     generation " << colony->getGeneration() << " in " << elapsed.count() << "s" << std::endl;
+    }
+
+    if (macrocell != nullptr) {
+      colony->load(*macrocell, utils::Vector2i(0, 0));
+      macrocell.reset();
+    }
+    else if (hasExtension(options.pattern, ".rle")) {
+      // Stream the cells from the file: large patterns would not fit
+      // in a brush.
+      cellulator::RleReader reader(options.pattern);
+      colony->load(reader, utils::Vector2i(0, 0));
+    }
+    else if (!options.pattern.empty()) {
+      scheduler.paint(cellulator::CellBrush::fromFile(options.pattern), utils::Vector2i(0, 0));
+    }
+
+    unsigned start = colony->getLiveCellsCount();
+    unsigned first = colony->getGeneration();
+
+    // The initial content of the colony is recorded right away.
+    cellulator::RecorderShPtr recorder;
+    if (!options.record.empty()) {
+      recorder = std::make_shared<cellulator::Recorder>(options.record, options.keyframes);
+      scheduler.setRecorder(recorder);
+    }
+
+    // Run the simulation.
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    if (!options.play.empty()) {
+      // The frames are applied to the colony without simulating it.
+      cellulator::RecordingPlayer player(options.play);
+      cellulator::RecordingFrame frame;
+
+      if (options.seek >= 0) {
+        player.seek(player.find(static_cast<std::uint64_t>(options.seek)), frame);
+        colony->play(frame);
+      }
+
+      while (options.seek < 0 && player.next(frame)) {
+        colony->play(frame);
+      }
+
+      std::cout << "played:      " << player.getFramesCount() << " frame(s) from " << options.play << std::endl;
+    }
+    else if (options.untilPopulation >= 0 || options.untilStable) {
+      // The condition is evaluated by the scheduler after each generation:
+      // the number of generations is used as a limit.
+      bool reached = false;
+      cellulator::PeriodDetector detector;
+
+      scheduler.advanceUntil(
+        [&options, &reached, detector, first](unsigned generation, unsigned alive) mutable {
+          reached = (options.untilPopulation >= 0 && alive <= options.untilPopulation);
+
+          if (options.untilStable && detector.push(alive) > 0u) {
+            reached = true;
+          }
+
+          return reached || generation - first >= options.generations;
+        }
+      );
+      scheduler.waitUntilIdle();
+
+      std::cout << "condition:   " << (reached ? "reached" : "not reached") << " at generation " << colony->getGeneration() << std::endl;
+    }
+    else if (options.log.empty()) {
+      scheduler.advance(options.generations);
+      scheduler.waitUntilIdle();
+    }
+    else {
+      // Records are captured between chunks of generations: the log
+      // writes them in the background while the simulation goes on.
+      cellulator::CheckpointLog log(options.log, options.baseInterval);
+      colony->capture(log);
+
+      for (unsigned done = 0u ; done < options.generations ; done += options.logInterval) {
+        scheduler.advance(std::min(options.logInterval, options.generations - done));
+        scheduler.waitUntilIdle();
+
+        colony->capture(log);
+      }
+
+      log.flush();
+
+      cellulator::CheckpointLog::Statistics stats = log.getStatistics();
+
+      std::cout
+        << "log:         " << stats.records << " record(s), " << stats.bases << " base(s), "
+        << stats.bytes << " byte(s) written, " << stats.size << " byte(s) in " << options.log << std::endl;
+    }
+
+    if (recorder != nullptr) {
+      scheduler.setRecorder(nullptr);
+      recorder->flush();
+
+      cellulator::Recorder::Statistics stats = recorder->getStatistics();
+
+      std::cout
+        << "recorded:    " << stats.frames << " frame(s), " << stats.keyframes << " keyframe(s), "
+        << stats.changes << " change(s) in " << stats.bytes << " byte(s)" << std::endl;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+    unsigned gen = colony->getGeneration();
+
+    std::cout
+      << "rule:        " << options.rule << std::endl
+      << "generation:  " << gen << std::endl
+      << "population:  " << colony->getLiveCellsCount() << " (initial: " << start << ")" << std::endl
+      << "elapsed:     " << elapsed.count() << "s" << std::endl
+      << "rate:        " << (elapsed.count() > 0.0 ? (gen - first) / elapsed.count() : 0.0) << " gen/s" << std::endl;
+
+    if (options.cold > 0u) {
+      cellulator::CellsBlocks::Storage storage = colony->getStorage();
+
+      std::cout
+        << "storage:     " << storage.blocks << " block(s), " << storage.cold << " cold, "
+        << storage.cells << " cell(s) allocated, " << storage.compressed << " byte(s) compressed" << std::endl;
+    }
+
+    if (!options.checkpoint.empty()) {
+      begin = std::chrono::steady_clock::now();
+      colony->checkpoint(options.checkpoint);
+      elapsed = std::chrono::steady_clock::now() - begin;
+
+      std::cout << "checkpoint:  " << options.checkpoint << " in " << elapsed.count() << "s" << std::endl;
+    }
+
+    if (!options.output.empty()) {
+      cellulator::Macrocell pattern;
+
+      begin = std::chrono::steady_clock::now();
+      colony->save(pattern);
+      pattern.save(options.output);
+      elapsed = std::chrono::steady_clock::now() - begin;
+
+      std::cout
+        << "saved:       " << pattern.getNodesCount() << " node(s), level " << pattern.getLevel()
+        << " in " << elapsed.count() << "s" << std::endl;
+    }
+  }
+  catch (const utils::CoreException& e) {
+    logger.error("Caught internal exception while running simulation", e.what());
+    return EXIT_FAILURE;
+  }
+  catch (const std::exception& e) {
+    logger.error("Caught internal exception while running simulation", e.what());
+    return EXIT_FAILURE;
+  }
+  catch (...) {
+    logger.error("Unexpected error while running simulation");
+    return EXIT_FAILURE;
+  }
+
+  // All is good.
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,532 @@
+
+/**
+ * @brief - Microbenchmarks of the primitives used by the simulation engine:
+ *          each benchmark measures a single operation in isolation so that
+ *          the effect of an optimization can be verified without having to
+ *          run a complete simulation. Results are reported in nanoseconds
+ *          per operation as a JSON document.
+ */
+
+# include <algorithm>
+# include <chrono>
+# include <cmath>
+# include <fstream>
+# include <functional>
+# include <iostream>
+# include <random>
+# include <core_utils/log/Locator.hh>
+# include <core_utils/log/PrefixedLogger.hh>
+# include <core_utils/log/StdLogger.hh>
+# include <core_utils/CoreException.hh>
+# include "CellsBlocks.hh"
+# include "CellBrush.hh"
+# ifdef CELLULATOR_WITH_GUI
+#  include "ColorPalette.hh"
+# endif
+
+namespace cellulator {
+
+  /**
+   * @brief - Provide access to the internal primitives of a `CellsBlocks`
+   *          object. The probe does not acquire the locker of the blocks
+   *          and should only be used from a single thread.
+   */
+  class CellsBlocksProbe {
+    public:
+
+      CellsBlocksProbe(CellsBlocks& blocks):
+        m_blocks(blocks)
+      {}
+
+      unsigned
+      count() const noexcept {
+        return m_blocks.m_blocks.size();
+      }
+
+      const utils::Boxi&
+      area(unsigned blockID) const noexcept {
+        return m_blocks.m_blocks[blockID].area;
+      }
+
+      void
+      updateAdjacency(unsigned blockID,
+                      const utils::Vector2i& coord)
+      {
+        m_blocks.updateAdjacency(m_blocks.m_blocks[blockID], coord, false);
+      }
+
+      bool
+      find(const utils::Boxi& area,
+           int& id)
+      {
+        return m_blocks.find(area, id);
+      }
+
+      unsigned
+      findBlock(const utils::Vector2i& coord,
+                bool& found)
+      {
+        return m_blocks.findBlock(coord, found);
+      }
+
+      unsigned
+      registerNewBlock(const utils::Boxi& area) {
+        return m_blocks.registerNewBlock(area).id;
+      }
+
+      bool
+      destroyBlock(unsigned blockID) {
+        return m_blocks.destroyBlock(blockID);
+      }
+
+    private:
+
+      CellsBlocks& m_blocks;
+  };
+
+}
+
+namespace {
+
+  /**
+   * @brief - Convenience structure holding the options of the program.
+   */
+  struct Options {
+    std::string directory;
+    std::string filter;
+    double minTime;
+    std::string output;
+  };
+
+  /**
+   * @brief - The result of a single microbenchmark.
+   */
+  struct Measure {
+    std::string name;
+    unsigned long iterations;
+    double nsPerOp;
+  };
+
+  /**
+   * @brief - Used to prevent the compiler from optimizing away the results
+   *          of the measured operations.
+   */
+  volatile unsigned long sink = 0ul;
+
+  void
+  usage(const std::string& program) {
+    std::cout
+      << "Usage: " << program << " [options]" << std::endl
+      << "  -d, --directory DIR     directory containing the brushes (default: data/brushes)" << std::endl
+      << "  -f, --filter STR        only run the benchmarks whose name contains STR" << std::endl
+      << "  -m, --min-time S        minimum duration of each benchmark in seconds (default: 0.2)" << std::endl
+      << "  -o, --output FILE       file where the results are written (default: standard output)" << std::endl
+      << "  -h, --help              display this message" << std::endl;
+  }
+
+  bool
+  parseArguments(int argc,
+                 char** argv,
+                 Options& options)
+  {
+    for (int id = 1 ; id < argc ; ++id) {
+      std::string arg(argv[id]);
+
+      if (arg == "-h" || arg == "--help") {
+        usage(argv[0]);
+        return false;
+      }
+
+      // All other options expect a value.
+      if (id + 1 >= argc) {
+        throw std::invalid_argument("Missing value for option \"" + arg + "\"");
+      }
+
+      std::string value(argv[++id]);
+
+      if (arg == "-d" || arg == "--directory") {
+        options.directory = value;
+      }
+      else if (arg == "-f" || arg == "--filter") {
+        options.filter = value;
+      }
+      else if (arg == "-m" || arg == "--min-time") {
+        options.minTime = std::stod(value);
+      }
+      else if (arg == "-o" || arg == "--output") {
+        options.output = value;
+      }
+      else {
+        throw std::invalid_argument("Unknown option \"" + arg + "\"");
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief - Collect the microbenchmarks and run the ones matching the filter.
+   */
+  class Runner {
+    public:
+
+      Runner(const Options& options):
+        m_options(options),
+        m_measures()
+      {}
+
+      /**
+       * @brief - Measure the operation in argument: it is repeated with an
+       *          increasing number of iterations until the measurement lasts
+       *          at least the minimum time.
+       * @param name - the name of the benchmark.
+       * @param op - the operation to measure, receiving the index of the
+       *             iteration.
+       */
+      void
+      measure(const std::string& name,
+              const std::function<void(unsigned long)>& op)
+      {
+        if (!m_options.filter.empty() && name.find(m_options.filter) == std::string::npos) {
+          return;
+        }
+
+        unsigned long iterations = 1ul;
+        double elapsed = 0.0;
+
+        while (true) {
+          std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+          for (unsigned long id = 0ul ; id < iterations ; ++id) {
+            op(id);
+          }
+
+          elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+          if (elapsed >= m_options.minTime || iterations >= (1ul << 40)) {
+            break;
+          }
+
+          // Aim slightly above the minimum time for the next attempt.
+          double factor = (elapsed > 0.0 ? 1.2 * m_options.minTime / elapsed : 10.0);
+          iterations = static_cast<unsigned long>(iterations * std::min(std::max(factor, 2.0), 100.0));
+        }
+
+        m_measures.push_back(Measure{name, iterations, 1.0e9 * elapsed / iterations});
+
+        std::cerr << name << ": " << m_measures.back().nsPerOp << " ns/op" << std::endl;
+      }
+
+      void
+      dump(std::ostream& out) const {
+        out << "{" << std::endl
+            << "  \"benchmarks\": [" << std::endl;
+
+        for (unsigned id = 0u ; id < m_measures.size() ; ++id) {
+          const Measure& m = m_measures[id];
+
+          out << "    {"
+              << "\"name\": \"" << m.name << "\", "
+              << "\"iterations\": " << m.iterations << ", "
+              << "\"ns_per_op\": " << m.nsPerOp
+              << "}" << (id + 1u < m_measures.size() ? "," : "") << std::endl;
+        }
+
+        out << "  ]" << std::endl
+            << "}" << std::endl;
+      }
+
+    private:
+
+      const Options& m_options;
+      std::vector<Measure> m_measures;
+  };
+
+  /**
+   * @brief - Measure the update of the adjacency for cells in the interior of
+   *          a block and on its border (which touches the neighboring blocks).
+   */
+  void
+  adjacency(Runner& runner) {
+    const int size = 64;
+
+    cellulator::CellsBlocks blocks(utils::Sizei(size, size));
+    blocks.allocateTo(utils::Sizei(3 * size, 3 * size));
+
+    cellulator::CellsBlocksProbe probe(blocks);
+
+    // The central block has all its neighbors allocated.
+    bool found = false;
+    unsigned center = probe.findBlock(utils::Vector2i(0, 0), found);
+
+    std::vector<utils::Vector2i> interior;
+    std::vector<utils::Vector2i> border;
+
+    for (int y = 0 ; y < size ; ++y) {
+      for (int x = 0 ; x < size ; ++x) {
+        bool edge = (x < 2 || x >= size - 2 || y < 2 || y >= size - 2);
+        (edge ? border : interior).push_back(utils::Vector2i(x, y));
+      }
+    }
+
+    runner.measure(
+      "updateAdjacency/interior",
+      [&](unsigned long id) {
+        probe.updateAdjacency(center, interior[id % interior.size()]);
+      }
+    );
+
+    runner.measure(
+      "updateAdjacency/border",
+      [&](unsigned long id) {
+        probe.updateAdjacency(center, border[id % border.size()]);
+      }
+    );
+  }
+
+  /**
+   * @brief - Measure the lookup of blocks by area and by coordinate for an
+   *          increasing number of blocks.
+   */
+  void
+  lookup(Runner& runner) {
+    const int size = 8;
+
+    for (unsigned count : {10u, 100u, 1000u, 10000u, 100000u}) {
+      int side = static_cast<int>(std::ceil(std::sqrt(1.0f * count)));
+
+      cellulator::CellsBlocks blocks(utils::Sizei(size, size));
+      utils::Boxi total = blocks.allocateTo(utils::Sizei(side * size, side * size));
+
+      cellulator::CellsBlocksProbe probe(blocks);
+
+      // Query random blocks and coordinates, always the same ones.
+      std::minstd_rand rng(count);
+      std::uniform_int_distribution<int> xDist(total.getLeftBound(), total.getRightBound() - 1);
+      std::uniform_int_distribution<int> yDist(total.getBottomBound(), total.getTopBound() - 1);
+      std::uniform_int_distribution<unsigned> bDist(0u, probe.count() - 1u);
+
+      std::vector<utils::Vector2i> coords;
+      std::vector<utils::Boxi> areas;
+
+      for (unsigned id = 0u ; id < 1024u ; ++id) {
+        coords.push_back(utils::Vector2i(xDist(rng), yDist(rng)));
+        areas.push_back(probe.area(bDist(rng)));
+      }
+
+      std::string suffix = "/" + std::to_string(probe.count());
+
+      runner.measure(
+        "find" + suffix,
+        [&](unsigned long id) {
+          int block = -1;
+          probe.find(areas[id % areas.size()], block);
+          sink = sink + block;
+        }
+      );
+
+      runner.measure(
+        "findBlock" + suffix,
+        [&](unsigned long id) {
+          bool found = false;
+          sink = sink + probe.findBlock(coords[id % coords.size()], found);
+        }
+      );
+    }
+  }
+
+  /**
+   * @brief - Measure the creation and destruction of blocks, as happens when
+   *          a pattern moves across the colony.
+   */
+  void
+  churn(Runner& runner) {
+    for (int size : {32, 256}) {
+      cellulator::CellsBlocks blocks(utils::Sizei(size, size));
+      utils::Boxi total = blocks.allocateTo(utils::Sizei(4 * size, 4 * size));
+
+      cellulator::CellsBlocksProbe probe(blocks);
+
+      // Create blocks alongside the allocated area so that they are attached
+      // to existing neighbors.
+      std::vector<utils::Boxi> areas;
+      for (int id = 0 ; id < 4 ; ++id) {
+        areas.push_back(
+          utils::Boxi(
+            total.getRightBound() + size / 2,
+            total.getBottomBound() + size / 2 + id * size,
+            size,
+            size
+          )
+        );
+      }
+
+      runner.measure(
+        "registerNewBlock+destroyBlock/" + std::to_string(size),
+        [&](unsigned long id) {
+          unsigned block = probe.registerNewBlock(areas[id % areas.size()]);
+          probe.destroyBlock(block);
+        }
+      );
+    }
+  }
+
+  /**
+   * @brief - Measure the extraction of the cells for viewports of increasing
+   *          dimensions.
+   */
+  void
+  viewport(Runner& runner) {
+    cellulator::CellsBlocks blocks(utils::Sizei(256, 256));
+    blocks.allocateTo(utils::Sizei(1024, 1024));
+    blocks.randomize(0.7f, 42u);
+
+    for (int size : {64, 256, 1024}) {
+      std::vector<std::pair<cellulator::State, unsigned>> cells(size * size);
+      utils::Boxi area(0, 0, size, size);
+
+      runner.measure(
+        "fetchCells/" + std::to_string(size) + "x" + std::to_string(size),
+        [&](unsigned long) {
+          blocks.fetchCells(cells, area);
+          sink = sink + static_cast<unsigned long>(cells[0].second);
+        }
+      );
+    }
+  }
+
+  /**
+   * @brief - Measure the loading and the painting of the biggest brushes
+   *          shipped with the application.
+   */
+  void
+  brushes(Runner& runner,
+          const Options& options)
+  {
+    for (std::string name : {"halfmax", "backRake2", "backRake", "golgun"}) {
+      std::string file = options.directory + "/" + name + ".brush";
+
+      runner.measure(
+        "loadFromFile/" + name,
+        [&](unsigned long) {
+          cellulator::CellBrushShPtr brush = cellulator::CellBrush::fromFile(file);
+          sink = sink + static_cast<unsigned long>(brush->getSize().area());
+        }
+      );
+    }
+
+    // Paint alternatively a brush and an eraser covering it at the same
+    // position so that each operation modifies the cells, in all the
+    // orientations of the brush.
+    cellulator::CellsBlocks blocks(utils::Sizei(32, 32));
+    blocks.allocateTo(utils::Sizei(512, 512));
+    blocks.randomize(0.3f, 42u);
+
+    for (std::string name : {"halfmax", "golgun"}) {
+      cellulator::CellBrushShPtr brush = cellulator::CellBrush::fromFile(options.directory + "/" + name + ".brush");
+      int side = std::max(brush->getSize().w(), brush->getSize().h());
+      cellulator::CellBrush eraser(utils::Sizei(side, side), cellulator::State::Dead);
+
+      runner.measure(
+        "paint/" + name,
+        [&](unsigned long id) {
+          cellulator::BrushOrientation orientation = static_cast<cellulator::BrushOrientation>(
+            (id / 2u) % cellulator::CellBrush::getOrientationsCount()
+          );
+
+          if (id % 2u == 0u) {
+            sink = sink + blocks.paint(*brush, utils::Vector2i(0, 0), orientation);
+          }
+          else {
+            sink = sink + blocks.paint(eraser, utils::Vector2i(0, 0));
+          }
+        }
+      );
+    }
+  }
+
+# ifdef CELLULATOR_WITH_GUI
+  /**
+   * @brief - Measure the computation of the color of a cell from its age.
+   */
+  void
+  palette(Runner& runner) {
+    cellulator::ColorPalette palette(10u);
+    std::vector<sdl::core::engine::Color> colors(64u);
+
+    runner.measure(
+      "colorize",
+      [&](unsigned long id) {
+        colors[id % colors.size()] = palette.colorize(1u + id % 16u);
+      }
+    );
+  }
+# endif
+
+}
+
+int main(int argc, char** argv) {
+  // Create the logger.
+  utils::log::StdLogger raw;
+  raw.setLevel(utils::log::Severity::WARNING);
+  utils::log::PrefixedLogger logger("automaton", "microbenchmarks");
+  utils::log::Locator::provide(&raw);
+
+  Options options{
+    std::string("data/brushes"),
+    std::string(),
+    0.2,
+    std::string()
+  };
+
+  try {
+    if (!parseArguments(argc, argv, options)) {
+      return EXIT_SUCCESS;
+    }
+  }
+  catch (const std::exception& e) {
+    logger.error("Invalid arguments", e.what());
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  try {
+    Runner runner(options);
+
+    adjacency(runner);
+    lookup(runner);
+    churn(runner);
+    viewport(runner);
+    brushes(runner, options);
+# ifdef CELLULATOR_WITH_GUI
+    palette(runner);
+# endif
+
+    if (options.output.empty()) {
+      runner.dump(std::cout);
+    }
+    else {
+      std::ofstream out(options.output);
+      if (!out.good()) {
+        throw std::invalid_argument("Could not open output file \"" + options.output + "\"");
+      }
+
+      runner.dump(out);
+    }
+  }
+  catch (const utils::CoreException& e) {
+    logger.error("Caught internal exception while running microbenchmarks", e.what());
+    return EXIT_FAILURE;
+  }
+  catch (const std::exception& e) {
+    logger.error("Caught internal exception while running microbenchmarks", e.what());
+    return EXIT_FAILURE;
+  }
+  catch (...) {
+    logger.error("Unexpected error while running microbenchmarks");
+    return EXIT_FAILURE;
+  }
+
+  // All is good.
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,362 @@
+# include "BrushLibrary.hh"
+# include <cctype>
+# include <chrono>
+# include <fstream>
+# include <exception>
+# include <algorithm>
+# include <filesystem>
+# include <core_utils/CoreException.hh>
+
+namespace cellulator {
+
+  BrushLibrary::BrushLibrary(const std::string& path,
+                             unsigned capacity):
+    utils::CoreObject(path),
+
+    m_propsLocker(),
+    m_waiter(),
+
+    m_entries(),
+    m_status(),
+    m_names(),
+
+    m_cache(),
+    m_capacity(std::max(capacity, 1u)),
+    m_requests(0ull),
+
+    m_pending(),
+    m_stop(false),
+    m_statistics{0u, 0u, 0u, 0u, 0u, 0u, 0.0},
+
+    m_loader(),
+
+    onBrushLoaded()
+  {
+    setService("brush_library");
+
+    std::error_code err;
+    if (std::filesystem::is_directory(path, err)) {
+      scanDirectory(path);
+    }
+    else {
+      scanIndex(path);
+    }
+
+    m_status.resize(m_entries.size(), Status::Unloaded);
+    m_statistics.entries = static_cast<unsigned>(m_entries.size());
+
+    m_loader = std::thread(&BrushLibrary::parse, this);
+  }
+
+  BrushLibrary::~BrushLibrary() {
+    {
+      const std::lock_guard guard(m_propsLocker);
+      m_stop = true;
+    }
+
+    m_waiter.notify_all();
+
+    m_loader.join();
+  }
+
+  std::vector<BrushLibrary::Entry>
+  BrushLibrary::getEntries() {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    return m_entries;
+  }
+
+  CellBrushShPtr
+  BrushLibrary::request(const std::string& name) {
+    CellBrushShPtr brush;
+
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
+
+      std::unordered_map<std::string, unsigned>::const_iterator it = m_names.find(name);
+      if (it == m_names.cend()) {
+        warn("Could not find brush \"" + name + "\" in library");
+        return nullptr;
+      }
+
+      brush = requestPrivate(it->second);
+
+      if (m_status[it->second] == Status::Failed) {
+        warn("Brush \"" + name + "\" could not be parsed from \"" + m_entries[it->second].file + "\"");
+      }
+    }
+
+    m_waiter.notify_all();
+
+    return brush;
+  }
+
+  CellBrushShPtr
+  BrushLibrary::load(const std::string& name) {
+    std::unique_lock lock(m_propsLocker);
+
+    std::unordered_map<std::string, unsigned>::const_iterator it = m_names.find(name);
+    if (it == m_names.cend()) {
+      warn("Could not find brush \"" + name + "\" in library");
+      return nullptr;
+    }
+
+    unsigned id = it->second;
+
+    // The brush might be evicted from the cache before we get a chance
+    // to retrieve it in case the capacity is very small: in this case
+    // we request it again.
+    while (!m_stop) {
+      CellBrushShPtr brush = requestPrivate(id);
+      if (brush != nullptr || m_status[id] == Status::Failed) {
+        return brush;
+      }
+
+      m_waiter.notify_all();
+      m_waiter.wait(
+        lock,
+        [this, id]() {
+          return m_status[id] != Status::Pending || m_stop;
+        }
+      );
+    }
+
+    return nullptr;
+  }
+
+  BrushLibrary::Statistics
+  BrushLibrary::getStatistics() noexcept {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    Statistics out = m_statistics;
+    out.cached = static_cast<unsigned>(m_cache.size());
+
+    return out;
+  }
+
+  void
+  BrushLibrary::scanDirectory(const std::string& directory) {
+    // Only the names of the files are considered here: sort them so
+    // that the content of the library does not depend on the order
+    // of the entries in the file system.
+    std::vector<Entry> found;
+
+    try {
+      for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(directory)) {
+        const std::filesystem::path& file = entry.path();
+
+        if (!entry.is_regular_file() || (file.extension() != ".brush" && file.extension() != ".rle")) {
+          continue;
+        }
+
+        std::filesystem::path name = std::filesystem::relative(file, directory);
+        name.replace_extension();
+
+        found.push_back(Entry{name.generic_string(), file.string()});
+      }
+    }
+    catch (const std::filesystem::filesystem_error& err) {
+      error(
+        std::string("Could not scan brushes in \"") + directory + "\"",
+        err.what()
+      );
+    }
+
+    std::sort(
+      found.begin(),
+      found.end(),
+      [](const Entry& lhs, const Entry& rhs) {
+        return lhs.name < rhs.name || (lhs.name == rhs.name && lhs.file < rhs.file);
+      }
+    );
+
+    for (unsigned id = 0u ; id < found.size() ; ++id) {
+      registerEntry(found[id].name, found[id].file);
+    }
+  }
+
+  void
+  BrushLibrary::scanIndex(const std::string& index) {
+    std::ifstream in(index.c_str());
+
+    if (!in.good()) {
+      error(
+        std::string("Could not read brushes from \"") + index + "\"",
+        std::string("Cannot open file")
+      );
+    }
+
+    // Files are expressed relatively to the index.
+    std::filesystem::path root = std::filesystem::path(index).parent_path();
+
+    auto isSpace = [](char c) {
+      return std::isspace(static_cast<unsigned char>(c)) != 0;
+    };
+
+    std::string line;
+
+    while (std::getline(in, line)) {
+      // Skip the leading spaces, empty lines and comments.
+      std::string::iterator start = std::find_if_not(line.begin(), line.end(), isSpace);
+
+      if (start == line.end() || *start == getCommentCharacter()) {
+        continue;
+      }
+
+      // The file is the first word of the line and the rest is the name
+      // of the brush if any.
+      std::string::iterator end = std::find_if(start, line.end(), isSpace);
+      std::filesystem::path file(std::string(start, end));
+
+      std::string::iterator nStart = std::find_if_not(end, line.end(), isSpace);
+      std::string name(nStart, line.end());
+      name.erase(std::find_if_not(name.rbegin(), name.rend(), isSpace).base(), name.end());
+
+      if (name.empty()) {
+        name = file.stem().string();
+      }
+
+      registerEntry(name, (root / file).string());
+    }
+  }
+
+  void
+  BrushLibrary::registerEntry(const std::string& name,
+                              const std::string& file)
+  {
+    if (m_names.count(name) > 0u) {
+      warn("Ignoring brush \"" + file + "\", name \"" + name + "\" already used by \"" + m_entries[m_names[name]].file + "\"");
+      return;
+    }
+
+    m_names[name] = static_cast<unsigned>(m_entries.size());
+    m_entries.push_back(Entry{name, file});
+  }
+
+  CellBrushShPtr
+  BrushLibrary::requestPrivate(unsigned id) {
+    ++m_requests;
+
+    switch (m_status[id]) {
+      case Status::Loaded:
+        {
+          CachedBrush& cached = m_cache[id];
+          cached.used = m_requests;
+          ++m_statistics.hits;
+
+          return cached.brush;
+        }
+      case Status::Failed:
+        return nullptr;
+      case Status::Pending:
+        {
+          // Move the brush at the front of the queue: the last requested
+          // brush is usually the one the user is waiting for.
+          std::deque<unsigned>::iterator it = std::find(m_pending.begin(), m_pending.end(), id);
+          if (it != m_pending.end()) {
+            m_pending.erase(it);
+            m_pending.push_front(id);
+          }
+        }
+        return nullptr;
+      case Status::Unloaded:
+      default:
+        break;
+    }
+
+    m_status[id] = Status::Pending;
+    m_pending.push_front(id);
+    ++m_statistics.misses;
+
+    return nullptr;
+  }
+
+  void
+  BrushLibrary::parse() {
+    while (true) {
+      unsigned id = 0u;
+      Entry entry;
+
+      {
+        std::unique_lock lock(m_propsLocker);
+        m_waiter.wait(
+          lock,
+          [this]() {
+            return !m_pending.empty() || m_stop;
+          }
+        );
+
+        if (m_stop) {
+          return;
+        }
+
+        id = m_pending.front();
+        m_pending.pop_front();
+        entry = m_entries[id];
+      }
+
+      // Parse the brush without holding the locker so that requests can
+      // still be served from the cache.
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      CellBrushShPtr brush;
+
+      try {
+        brush = CellBrush::fromFile(entry.file);
+      }
+      catch (const utils::CoreException& err) {
+        warn("Could not load brush \"" + entry.name + "\": " + err.what());
+        brush = nullptr;
+      }
+      catch (const std::exception& err) {
+        // Malformed files may fail in unexpected ways (e.g. huge dimensions):
+        // this should never escape the thread.
+        warn("Could not load brush \"" + entry.name + "\": " + err.what());
+        brush = nullptr;
+      }
+
+      double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      {
+        const std::lock_guard guard(m_propsLocker);
+
+        m_statistics.parsing += elapsed;
+
+        if (brush == nullptr) {
+          m_status[id] = Status::Failed;
+          ++m_statistics.failures;
+        }
+        else {
+          // Make room for the brush by discarding the least recently
+          // used one if needed.
+          if (m_cache.size() >= m_capacity) {
+            std::unordered_map<unsigned, CachedBrush>::iterator oldest = m_cache.begin();
+            for (std::unordered_map<unsigned, CachedBrush>::iterator it = m_cache.begin() ; it != m_cache.end() ; ++it) {
+              if (it->second.used < oldest->second.used) {
+                oldest = it;
+              }
+            }
+
+            m_status[oldest->first] = Status::Unloaded;
+            m_cache.erase(oldest);
+            ++m_statistics.evictions;
+          }
+
+          m_cache[id] = CachedBrush{brush, m_requests};
+          m_status[id] = Status::Loaded;
+        }
+      }
+
+      m_waiter.notify_all();
+
+      onBrushLoaded.safeEmit(
+        std::string("onBrushLoaded(") + entry.name + ")",
+        entry.name,
+        brush
+      );
+    }
+  }
+
+}
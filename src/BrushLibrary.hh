@@ -0,0 +1,253 @@
+#ifndef    BRUSH_LIBRARY_HH
+# define   BRUSH_LIBRARY_HH
+
+# include <mutex>
+# include <deque>
+# include <thread>
+# include <memory>
+# include <string>
+# include <vector>
+# include <cstdint>
+# include <unordered_map>
+# include <condition_variable>
+# include <core_utils/Signal.hh>
+# include <core_utils/CoreObject.hh>
+# include "CellBrush.hh"
+
+namespace cellulator {
+
+  class BrushLibrary: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Create a library referencing the brushes described by the path in
+       *          argument. In case it is a directory, all the files with a `.brush`
+       *          or `.rle` extension found in it (and in its sub-directories) are
+       *          registered and named after their path relative to the directory,
+       *          without the extension. Otherwise the path is interpreted as an
+       *          index file listing one brush per line: the name of the file comes
+       *          first (relative to the directory of the index) and is optionally
+       *          followed by the name of the brush. Empty lines and lines starting
+       *          with a `#` are ignored.
+       *          No brush is parsed at this point: the files are only loaded when
+       *          they are requested, by a background thread. The parsed brushes
+       *          are kept in a cache holding at most `capacity` brushes, the least
+       *          recently used ones being discarded first.
+       *          An error is raised in case the path can't be read.
+       * @param path - the directory or the index file describing the brushes.
+       * @param capacity - the maximum number of parsed brushes kept in memory.
+       */
+      BrushLibrary(const std::string& path,
+                   unsigned capacity = 64u);
+
+      /**
+       * @brief - Stop the thread loading the brushes. Brushes being loaded are not
+       *          waited for.
+       */
+      ~BrushLibrary();
+
+      /**
+       * @brief - Convenience structure describing a brush of the library.
+       */
+      struct Entry {
+        std::string name;         //< The name of the brush.
+        std::string file;         //< The file describing the brush.
+      };
+
+      /**
+       * @brief - Retrieve the brushes referenced by this library, in the order of
+       *          the index file or sorted by name for a directory.
+       * @return - the brushes of the library.
+       */
+      std::vector<Entry>
+      getEntries();
+
+      /**
+       * @brief - Retrieve the brush with the specified name without waiting. If the
+       *          brush is not parsed yet it is queued for loading (before any other
+       *          pending brush) and `null` is returned: the `onBrushLoaded` signal
+       *          will be emitted when it is available.
+       *          Brushes which could not be parsed are not loaded again and yield a
+       *          `null` value as well.
+       * @param name - the name of the brush.
+       * @return - the brush if it is already parsed and `null` otherwise.
+       */
+      CellBrushShPtr
+      request(const std::string& name);
+
+      /**
+       * @brief - Similar to `request` but waits for the brush to be parsed in case it
+       *          is not in the cache yet.
+       * @param name - the name of the brush.
+       * @return - the brush or `null` if it could not be parsed (or does not exist).
+       */
+      CellBrushShPtr
+      load(const std::string& name);
+
+      /**
+       * @brief - Convenience structure describing the activity of the library.
+       */
+      struct Statistics {
+        unsigned entries;         //< The number of brushes referenced.
+        unsigned cached;          //< The number of brushes currently parsed.
+        unsigned hits;            //< The number of requests served by the cache.
+        unsigned misses;          //< The number of requests which had to be loaded.
+        unsigned failures;        //< The number of brushes which could not be parsed.
+        unsigned evictions;       //< The number of brushes discarded from the cache.
+        double parsing;           //< The time spent parsing brushes in seconds.
+      };
+
+      /**
+       * @brief - Retrieve the activity of the library so far.
+       * @return - the statistics of the library.
+       */
+      Statistics
+      getStatistics() noexcept;
+
+    private:
+
+      /**
+       * @brief - The character starting a comment in an index file.
+       * @return - the comment character.
+       */
+      static
+      constexpr char
+      getCommentCharacter() noexcept;
+
+      /**
+       * @brief - Register all the brushes found in the directory in argument.
+       * @param directory - the directory to scan.
+       */
+      void
+      scanDirectory(const std::string& directory);
+
+      /**
+       * @brief - Register all the brushes listed in the index file in argument.
+       * @param index - the index file to read.
+       */
+      void
+      scanIndex(const std::string& index);
+
+      /**
+       * @brief - Register a new brush in the library. Brushes with an already used
+       *          name are ignored.
+       * @param name - the name of the brush.
+       * @param file - the file describing the brush.
+       */
+      void
+      registerEntry(const std::string& name,
+                    const std::string& file);
+
+      /**
+       * @brief - Used to queue the brush in argument for loading in case it is not
+       *          available yet. Assumes that the locker is already acquired.
+       * @param id - the index of the brush.
+       * @return - the brush if it is cached and `null` otherwise.
+       */
+      CellBrushShPtr
+      requestPrivate(unsigned id);
+
+      /**
+       * @brief - Main loop of the thread parsing the brushes.
+       */
+      void
+      parse();
+
+    private:
+
+      /**
+       * @brief - The loading status of a brush of the library.
+       */
+      enum class Status {
+        Unloaded,
+        Pending,
+        Loaded,
+        Failed
+      };
+
+      /**
+       * @brief - The parsed brush and the last time it was used, in number of
+       *          requests made to the library.
+       */
+      struct CachedBrush {
+        CellBrushShPtr brush;
+        std::uint64_t used;
+      };
+
+      /**
+       * @brief - Protect this object from concurrent accesses.
+       */
+      std::mutex m_propsLocker;
+
+      /**
+       * @brief - Used to notify the loader when a brush is requested and the callers
+       *          of `load` when a brush is parsed.
+       */
+      std::condition_variable m_waiter;
+
+      /**
+       * @brief - The brushes referenced by the library.
+       */
+      std::vector<Entry> m_entries;
+
+      /**
+       * @brief - The loading status of each brush, indexed like `m_entries`.
+       */
+      std::vector<Status> m_status;
+
+      /**
+       * @brief - The index of each brush in `m_entries` by name.
+       */
+      std::unordered_map<std::string, unsigned> m_names;
+
+      /**
+       * @brief - The parsed brushes, indexed by their position in `m_entries`.
+       */
+      std::unordered_map<unsigned, CachedBrush> m_cache;
+
+      /**
+       * @brief - The maximum number of brushes in the cache.
+       */
+      unsigned m_capacity;
+
+      /**
+       * @brief - The number of requests made to the library so far, used to find the
+       *          least recently used brush in the cache.
+       */
+      std::uint64_t m_requests;
+
+      /**
+       * @brief - The brushes waiting to be parsed, the most urgent one first.
+       */
+      std::deque<unsigned> m_pending;
+
+      /**
+       * @brief - Whether the loader should stop.
+       */
+      bool m_stop;
+
+      /**
+       * @brief - The activity of the library.
+       */
+      Statistics m_statistics;
+
+      /**
+       * @brief - The thread parsing the brushes.
+       */
+      std::thread m_loader;
+
+    public:
+
+      /**
+       * @brief - Signal emitted by the loading thread when a requested brush has been
+       *          parsed. The brush is `null` in case the file could not be parsed.
+       */
+      utils::Signal<std::string, CellBrushShPtr> onBrushLoaded;
+  };
+
+  using BrushLibraryShPtr = std::shared_ptr<BrushLibrary>;
+}
+
+# include "BrushLibrary.hxx"
+
+#endif    /* BRUSH_LIBRARY_HH */
@@ -0,0 +1,16 @@
+#ifndef    BRUSH_LIBRARY_HXX
+# define   BRUSH_LIBRARY_HXX
+
+# include "BrushLibrary.hh"
+
+namespace cellulator {
+
+  inline
+  constexpr char
+  BrushLibrary::getCommentCharacter() noexcept {
+    return '#';
+  }
+
+}
+
+#endif    /* BRUSH_LIBRARY_HXX */
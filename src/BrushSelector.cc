@@ -20,11 +20,23 @@ namespace cellulator {
       1
     }),
 
+    m_library(std::make_shared<BrushLibrary>(getBrushesLibrary())),
+
     onBrushChanged()
   {
+    m_library->onBrushLoaded.connect_member<BrushSelector>(
+      this,
+      &BrushSelector::onBrushLoaded
+    );
+
     build();
   }
 
+  BrushSelector::~BrushSelector() {
+    // Wait for the loading thread to stop.
+    m_library.reset();
+  }
+
   void
   BrushSelector::build() {
     // Create the layout to receive all the registered brushes.
@@ -82,32 +94,14 @@ namespace cellulator {
     b = createButtonFromBrushName("Eraser", "");
     layout->addItem(b);
 
-    b = createButtonFromBrushName("Gosper glider gun", "");
-    layout->addItem(b);
-
-    b = createButtonFromBrushName("Backrake", "");
-    layout->addItem(b);
-
-    b = createButtonFromBrushName("Backrake2", "");
-    layout->addItem(b);
-
-    b = createButtonFromBrushName("Ecologist", "");
-    layout->addItem(b);
-
-    b = createButtonFromBrushName("Halfmax", "");
-    layout->addItem(b);
+    // Create a button for each brush of the library: the brushes are
+    // not parsed until they are selected.
+    std::vector<BrushLibrary::Entry> entries = m_library->getEntries();
 
-    b = createButtonFromBrushName("LWSW", "");
-    layout->addItem(b);
-
-    b = createButtonFromBrushName("Puffer", "");
-    layout->addItem(b);
-
-    b = createButtonFromBrushName("Spacerake", "");
-    layout->addItem(b);
-
-    b = createButtonFromBrushName("Shick engine", "");
-    layout->addItem(b);
+    for (unsigned id = 0u ; id < entries.size() ; ++id) {
+      b = createButtonFromBrushName(entries[id].name, "");
+      layout->addItem(b);
+    }
   }
 
   CellBrushShPtr
@@ -123,46 +117,8 @@ namespace cellulator {
       return std::make_shared<CellBrush>(size, State::Dead);
     }
 
-    if (name == "Gosper glider gun") {
-      return CellBrush::fromFile("data/brushes/golgun.brush");
-    }
-
-    if (name == "Backrake") {
-      return CellBrush::fromFile("data/brushes/backRake.brush");
-    }
-
-    if (name == "Backrake2") {
-      return CellBrush::fromFile("data/brushes/backRake2.brush");
-    }
-
-    if (name == "Ecologist") {
-      return CellBrush::fromFile("data/brushes/ecologist.brush");
-    }
-
-    if (name == "Halfmax") {
-      return CellBrush::fromFile("data/brushes/halfmax.brush");
-    }
-
-    if (name == "LWSW") {
-      return CellBrush::fromFile("data/brushes/LWSW.brush");
-    }
-
-    if (name == "Puffer") {
-      return CellBrush::fromFile("data/brushes/puffer2.brush");
-    }
-
-    if (name == "Spacerake") {
-      return CellBrush::fromFile("data/brushes/spaceRake.brush");
-    }
-
-    if (name == "Shick engine") {
-      return CellBrush::fromFile("data/brushes/shickEngine.brush");
-    }
-
-    // Unknown brush.
-    warn("Could not create brush from unknown name " + name);
-
-    return nullptr;
+    // Any other brush comes from the library.
+    return m_library->request(name);
   }
 
   void
@@ -251,6 +207,13 @@ namespace cellulator {
       brushSize
     };
 
+    // Brushes of the library might not be available yet: in this case
+    // listeners are notified when the library is done loading it.
+    if (nb == nullptr) {
+      debug("Waiting for brush \"" + brushName + "\" to be loaded");
+      return;
+    }
+
     // Notify external listeners.
     onBrushChanged.safeEmit(
       std::string("onBrushChanged(") + brushName + ")",
@@ -258,4 +221,23 @@ namespace cellulator {
     );
   }
 
+  void
+  BrushSelector::onBrushLoaded(std::string brushName,
+                               CellBrushShPtr brush)
+  {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    // Only the active brush is propagated: other brushes might have
+    // been selected in the meantime.
+    if (!m_currentBrush.valid || m_currentBrush.name != brushName) {
+      return;
+    }
+
+    onBrushChanged.safeEmit(
+      std::string("onBrushChanged(") + brushName + ")",
+      brush
+    );
+  }
+
 }
@@ -8,6 +8,7 @@
 # include <core_utils/Signal.hh>
 # include <sdl_graphic/Slider.hh>
 # include "CellBrush.hh"
+# include "BrushLibrary.hh"
 
 namespace cellulator {
 
@@ -17,14 +18,20 @@ namespace cellulator {
       /**
        * @brief - Perform the creation of a panel that allows to select and
        *          apply a brush to add some cells to the colony.
-       *          The selection itself is done through toggle buttons.
+       *          The selection itself is done through toggle buttons: one for
+       *          each brush of the library described by `getBrushesLibrary`
+       *          in addition to the standard and eraser brushes.
        * @param hint - the size hint for this widget.
        * @param parent - the parent of this widget.
        */
       BrushSelector(const utils::Sizef& hint = utils::Sizef(),
                     sdl::core::SdlWidget* parent = nullptr);
 
-      ~BrushSelector() = default;
+      /**
+       * @brief - Stop the loading of the brushes of the library before destroying
+       *          the rest of the selector, as a brush might still be notified.
+       */
+      ~BrushSelector();
 
     protected:
 
@@ -52,6 +59,14 @@ namespace cellulator {
       const char*
       getBrushSizeSliderName() noexcept;
 
+      /**
+       * @brief - The index file listing the brushes displayed by the selector.
+       * @return - the path to the index of the brushes.
+       */
+      static
+      const char*
+      getBrushesLibrary() noexcept;
+
       /**
        * @brief - Used to build the content of this widget so that it can be
        *          readily displayed.
@@ -66,14 +81,17 @@ namespace cellulator {
       getBrushSizeSlize();
 
       /**
-       * @brief - Create a brush from the input name. The name will be scanned
-       *          against matching patterns to allow the creation of the brush
-       *          either from a file or from any other mean necessary.
+       * @brief - Create a brush from the input name. The standard and eraser
+       *          brushes are created right away while the other ones are taken
+       *          from the library: in case they are not parsed yet they are
+       *          loaded in the background and `null` is returned. The library
+       *          notifies the brush through `onBrushLoaded` once available.
        * @param name - the name of the brush to create.
        * @param size - the size of the brush. Note that this parameter is used
        *               mostly for monotonic brushes and not ones loaded from
        *               a file (as the file obviously describes everything).
-       * @return - the created brush or `null` if the brush cannot be created.
+       * @return - the created brush or `null` if the brush is not available yet
+       *           or cannot be created.
        */
       CellBrushShPtr
       createBrushFromName(const std::string& name,
@@ -129,6 +147,17 @@ namespace cellulator {
       notifyBrushChanged(const std::string& brushName,
                          int brushSize);
 
+      /**
+       * @brief - Local slot connected to the library and called from its loading
+       *          thread whenever a brush has been parsed. In case the brush is the
+       *          one selected the change is propagated to external listeners.
+       * @param brushName - the name of the loaded brush.
+       * @param brush - the brush or `null` if it could not be loaded.
+       */
+      void
+      onBrushLoaded(std::string brushName,
+                    CellBrushShPtr brush);
+
     private:
 
       /**
@@ -165,6 +194,12 @@ namespace cellulator {
        */
       BrushDesc m_currentBrush;
 
+      /**
+       * @brief - The library of brushes which can be selected: the brushes are only
+       *          parsed when they are selected for the first time.
+       */
+      BrushLibraryShPtr m_library;
+
     public:
 
       /**
@@ -41,6 +41,12 @@ namespace cellulator {
     return "brush_size_slider";
   }
 
+  inline
+  const char*
+  BrushSelector::getBrushesLibrary() noexcept {
+    return "data/brushes/index.txt";
+  }
+
   inline
   sdl::graphic::Button*
   BrushSelector::getBrushButtonFromName(const std::string& name) {
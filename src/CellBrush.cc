@@ -3,6 +3,7 @@
 # include <fstream>
 # include <sstream>
 # include <algorithm>
+# include "RleReader.hh"
 
 namespace {
 
@@ -39,6 +40,63 @@ namespace {
     ltrim(s);
   }
 
+  /**
+   * @brief - Whether the orientation in argument exchanges the `x` and
+   *          `y` axes of the brush.
+   * @param orientation - the orientation of the brush.
+   * @return - `true` if the dimensions of the brush are swapped.
+   */
+  inline
+  bool
+  swapsAxes(const cellulator::BrushOrientation& orientation) noexcept {
+    switch (orientation) {
+      case cellulator::BrushOrientation::Rotate90:
+      case cellulator::BrushOrientation::Rotate270:
+      case cellulator::BrushOrientation::Transpose:
+      case cellulator::BrushOrientation::AntiTranspose:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  /**
+   * @brief - Convert a coordinate in the frame of the oriented brush into
+   *          the corresponding coordinate in the brush as it was loaded.
+   * @param orientation - the orientation of the brush.
+   * @param size - the dimensions of the brush as it was loaded.
+   * @param x - the coordinate along the `x` axis in the oriented brush.
+   * @param y - the coordinate along the `y` axis in the oriented brush.
+   * @return - the coordinate of the cell in the loaded brush.
+   */
+  inline
+  utils::Vector2i
+  sourceCoordinate(const cellulator::BrushOrientation& orientation,
+                   const utils::Sizei& size,
+                   int x,
+                   int y) noexcept
+  {
+    switch (orientation) {
+      case cellulator::BrushOrientation::Rotate90:
+        return utils::Vector2i(y, size.h() - 1 - x);
+      case cellulator::BrushOrientation::Rotate180:
+        return utils::Vector2i(size.w() - 1 - x, size.h() - 1 - y);
+      case cellulator::BrushOrientation::Rotate270:
+        return utils::Vector2i(size.w() - 1 - y, x);
+      case cellulator::BrushOrientation::FlipX:
+        return utils::Vector2i(size.w() - 1 - x, y);
+      case cellulator::BrushOrientation::FlipY:
+        return utils::Vector2i(x, size.h() - 1 - y);
+      case cellulator::BrushOrientation::Transpose:
+        return utils::Vector2i(y, x);
+      case cellulator::BrushOrientation::AntiTranspose:
+        return utils::Vector2i(size.w() - 1 - y, size.h() - 1 - x);
+      case cellulator::BrushOrientation::Identity:
+      default:
+        return utils::Vector2i(x, y);
+    }
+  }
+
 }
 
 namespace cellulator {
@@ -51,7 +109,7 @@ namespace cellulator {
     m_monotonic(true),
     m_monotonicState(State::Alive),
 
-    m_data()
+    m_orientations()
   {
     setService("brush");
   }
@@ -81,18 +139,32 @@ namespace cellulator {
     m_monotonicState = state;
   }
 
+  utils::Sizei
+  CellBrush::getSize(const BrushOrientation& orientation) const noexcept {
+    return (swapsAxes(orientation) ? utils::Sizei(m_size.h(), m_size.w()) : m_size);
+  }
+
   State
   CellBrush::getStateAt(int x,
                         int y) const noexcept
   {
+    // Use the dedicated handler.
+    return getStateAt(x, y, BrushOrientation::Identity);
+  }
 
+  State
+  CellBrush::getStateAt(int x,
+                        int y,
+                        const BrushOrientation& orientation) const noexcept
+  {
     if (!valid()) {
       return State::Dead;
     }
 
     // In case the coordinate is not inside the area covered by this
     // brush return `Dead` as well.
-    if (x < 0 || y < 0 || x >= m_size.w() || y >= m_size.h()) {
+    utils::Sizei size = getSize(orientation);
+    if (x < 0 || y < 0 || x >= size.w() || y >= size.h()) {
       return State::Dead;
     }
 
@@ -101,18 +173,90 @@ namespace cellulator {
       return m_monotonicState;
     }
 
-    // Convert the coordinate to a one-dimensional offset. We can be
-    // certain that this will yield a valid index as we checked that
-    // the coordinate was inside the area covered by this brush.
-    int off = y * m_size.w() + x;
+    // Fetch the bit representing the cell in the packed rows: we can
+    // be certain that it exists as the coordinate is inside the area
+    // covered by this brush.
+    const PackedRows& rows = m_orientations[static_cast<unsigned>(orientation)];
+    std::uint64_t word = rows.bits[y * rows.stride + static_cast<unsigned>(x) / 64u];
+
+    return ((word >> (static_cast<unsigned>(x) % 64u)) & 1u ? State::Alive : State::Dead);
+  }
 
-    return m_data[off];
+  void
+  CellBrush::stamp(int y,
+                   std::uint64_t* row,
+                   unsigned width,
+                   int offset,
+                   const StampMode& mode,
+                   const BrushOrientation& orientation) const noexcept
+  {
+    if (!valid()) {
+      return;
+    }
+
+    utils::Sizei size = getSize(orientation);
+    if (y < 0 || y >= size.h()) {
+      return;
+    }
+
+    // Compute the range of cells of the destination covered by the brush.
+    int first = std::max(0, offset);
+    int last = std::min(static_cast<int>(width), offset + size.w());
+
+    if (first >= last) {
+      return;
+    }
+
+    // Monotonic brushes don't have packed rows: all their cells share
+    // the same state.
+    const std::uint64_t* src = nullptr;
+    unsigned words = 0u;
+    std::uint64_t fill = (m_monotonicState == State::Alive ? ~std::uint64_t(0u) : std::uint64_t(0u));
+
+    if (!isMonotonic()) {
+      const PackedRows& rows = m_orientations[static_cast<unsigned>(orientation)];
+      src = rows.bits.data() + y * rows.stride;
+      words = rows.stride;
+    }
+
+    for (int word = first / 64 ; word <= (last - 1) / 64 ; ++word) {
+      // Build the mask of the cells of this word covered by the brush.
+      int lo = std::max(first, word * 64);
+      int hi = std::min(last, word * 64 + 64);
+
+      std::uint64_t mask = ~std::uint64_t(0u);
+      if (hi - lo < 64) {
+        mask = ((std::uint64_t(1u) << (hi - lo)) - 1u) << (lo - word * 64);
+      }
+
+      std::uint64_t cells = mask & (src != nullptr ? extract(src, words, word * 64 - offset) : fill);
+
+      switch (mode) {
+        case StampMode::Overlay:
+          row[word] |= cells;
+          break;
+        case StampMode::Erase:
+          row[word] &= ~cells;
+          break;
+        case StampMode::Replace:
+        default:
+          row[word] = (row[word] & ~mask) | cells;
+          break;
+      }
+    }
   }
 
   void
   CellBrush::loadFromFile(const std::string& file,
                           bool invertY)
   {
+    // Patterns in the RLE format use a dedicated reader.
+    const std::string rle(".rle");
+    if (file.size() >= rle.size() && file.compare(file.size() - rle.size(), rle.size(), rle) == 0) {
+      loadFromRle(file, invertY);
+      return;
+    }
+
     // Open the file associated to the brush' data.
     std::ifstream in(file.c_str());
 
@@ -232,10 +376,76 @@ namespace cellulator {
     }
 
     // Assign the parsed data.
-    m_size = utils::Sizei(w, h);
-    m_data.swap(brush);
+    pack(utils::Sizei(w, h), brush);
+  }
+
+  void
+  CellBrush::loadFromRle(const std::string& file,
+                         bool invertY)
+  {
+    RleReader reader(file);
+
+    const utils::Sizei& size = reader.getSize();
+    const int w = size.w();
+    const int h = size.h();
+
+    std::vector<State> brush(w * h, State::Dead);
+
+    // Runs are expressed from the top of the pattern: cells outside of
+    // the dimensions of the header are dropped (the reader already warns
+    // about them).
+    CellsRun run;
+
+    while (reader.next(run)) {
+      if (run.y < 0 || run.y >= h) {
+        continue;
+      }
+
+      int offset = (invertY ? h - 1 - run.y : run.y) * w;
+      int end = std::min(w, run.x + static_cast<int>(run.length));
+
+      for (int x = std::max(0, run.x) ; x < end ; ++x) {
+        brush[offset + x] = State::Alive;
+      }
+    }
+
+    // Assign the parsed data.
+    pack(size, brush);
+  }
+
+  void
+  CellBrush::pack(const utils::Sizei& size,
+                  const std::vector<State>& cells)
+  {
+    // Precompute the rows of all the orientations: this makes the
+    // loading a bit longer but painting the brush in any direction
+    // then comes down to copying words.
+    std::vector<PackedRows> orientations(getOrientationsCount());
+
+    for (unsigned id = 0u ; id < orientations.size() ; ++id) {
+      BrushOrientation orientation = static_cast<BrushOrientation>(id);
+      PackedRows& rows = orientations[id];
+
+      rows.size = (swapsAxes(orientation) ? utils::Sizei(size.h(), size.w()) : size);
+      rows.stride = (static_cast<unsigned>(rows.size.w()) + 63u) / 64u;
+      rows.bits.resize(rows.stride * rows.size.h(), 0u);
+
+      for (int y = 0 ; y < rows.size.h() ; ++y) {
+        std::uint64_t* row = rows.bits.data() + y * rows.stride;
+
+        for (int x = 0 ; x < rows.size.w() ; ++x) {
+          utils::Vector2i c = sourceCoordinate(orientation, size, x, y);
+
+          if (cells[c.y() * size.w() + c.x()] == State::Alive) {
+            row[x / 64] |= (std::uint64_t(1u) << (x % 64));
+          }
+        }
+      }
+    }
+
+    m_size = size;
+    m_orientations.swap(orientations);
     m_monotonic = false;
   }
 
 }
-
@@ -2,6 +2,8 @@
 # define   CELL_BRUSH_HH
 
 # include <memory>
+# include <vector>
+# include <cstdint>
 # include <core_utils/CoreObject.hh>
 # include "CellsBlocks.hh"
 
@@ -15,6 +17,17 @@ namespace cellulator {
   // Forward declaration of a cell state as this file is also needed
   // in the `CellsBlocks` class where the `State` is defined.
   enum class State;
+  enum class BrushOrientation;
+
+  /**
+   * @brief - The ways a row of a brush can be combined with the cells of a
+   *          row where it is stamped.
+   */
+  enum class StampMode {
+    Overlay,      //< Bring to life the live cells of the brush, keep the others.
+    Replace,      //< Copy all the cells covered by the brush.
+    Erase         //< Kill the cells corresponding to live cells of the brush.
+  };
 
   class CellBrush: public utils::CoreObject {
     public:
@@ -51,6 +64,14 @@ namespace cellulator {
       CellBrushShPtr
       fromFile(const std::string& file);
 
+      /**
+       * @brief - The number of orientations in which a brush can be painted.
+       * @return - the number of orientations.
+       */
+      static
+      constexpr unsigned
+      getOrientationsCount() noexcept;
+
       /**
        * @brief - Determine whether this brush is valid. We consider that the brush
        *          is valid if its associated size is not empty and if its internal
@@ -73,6 +94,16 @@ namespace cellulator {
       utils::Sizei
       getSize() const noexcept;
 
+      /**
+       * @brief - Similar to `getSize` but for the brush painted in the orientation
+       *          in argument: the dimensions are swapped for rotations of a quarter
+       *          turn and for transpositions.
+       * @param orientation - the orientation of the brush.
+       * @return - the size of the brush in this orientation.
+       */
+      utils::Sizei
+      getSize(const BrushOrientation& orientation) const noexcept;
+
       /**
        * @brief - Retrieve the state of the cell at the specified coordinate for
        *          this brush. The coordinates are expected to be expressed in the
@@ -101,6 +132,49 @@ namespace cellulator {
       getStateAt(int x,
                  int y) const noexcept;
 
+      /**
+       * @brief - Similar to `getStateAt` but for the brush painted in the orientation
+       *          in argument. The coordinates are expressed in the local frame of the
+       *          oriented brush, which has the dimensions returned by `getSize` for
+       *          the same orientation.
+       * @param x - the coordinate along the `x` axis to retrieve.
+       * @param y - the coordinate along the `y` axis to retrieve.
+       * @param orientation - the orientation of the brush.
+       * @return - the state of said coordinate or `Dead` if such a cell does not
+       *           exist (or if the brush is not valid).
+       */
+      State
+      getStateAt(int x,
+                 int y,
+                 const BrushOrientation& orientation) const noexcept;
+
+      /**
+       * @brief - Stamp a row of the brush in the row of bits in argument, where each
+       *          bit represents a cell (set for a live cell) and the cells are packed
+       *          in words starting with the least significant bit. The row is copied
+       *          a word at a time with the `mode` in argument and the cells of the
+       *          brush falling outside of the `width` cells of the destination are
+       *          discarded.
+       *          The rows of the brush are precomputed for all the orientations when
+       *          the brush is loaded, so that stamping does not depend on it. Nothing
+       *          happens if the brush is not valid or if the row does not exist.
+       * @param y - the index of the row of the oriented brush to stamp.
+       * @param row - the destination row, which should hold at least `width` bits.
+       * @param width - the number of cells of the destination row.
+       * @param offset - the position in the destination row of the first cell of the
+       *                 brush. It can be negative in which case the beginning of the
+       *                 brush is discarded.
+       * @param mode - how the cells of the brush are combined with the row.
+       * @param orientation - the orientation of the brush.
+       */
+      void
+      stamp(int y,
+            std::uint64_t* row,
+            unsigned width,
+            int offset,
+            const StampMode& mode,
+            const BrushOrientation& orientation) const noexcept;
+
     private:
 
       /**
@@ -120,6 +194,21 @@ namespace cellulator {
       constexpr char
       getLiveCellCharacter() noexcept;
 
+      /**
+       * @brief - Retrieve the 64 cells of a packed row of bits starting at the cell in
+       *          argument. Cells before the beginning or after the end of the row are
+       *          reported as dead.
+       * @param row - the packed row.
+       * @param words - the number of words of the row.
+       * @param start - the index of the first cell to retrieve, might be negative.
+       * @return - the packed cells.
+       */
+      static
+      std::uint64_t
+      extract(const std::uint64_t* row,
+              unsigned words,
+              int start) noexcept;
+
       /**
        * @brief - Default constructor creating a one by one `Alive` cell. This is
        *          used as a default initializer for other constructors but is only
@@ -152,6 +241,30 @@ namespace cellulator {
       loadFromFile(const std::string& file,
                    bool invertY);
 
+      /**
+       * @brief - Similar to `loadFromFile` but interprets the file as a pattern in
+       *          the RLE format. Only the cells are kept: the rule described in
+       *          the header of the file is ignored. Called by `loadFromFile` when
+       *          the extension of the file is `.rle`.
+       * @param file - the name of the file from which the data for this brush should
+       *               be fetched.
+       * @param invertY - `true` if the data contained in the file should be registered
+       *                  upside-down in the internal array.
+       */
+      void
+      loadFromRle(const std::string& file,
+                  bool invertY);
+
+      /**
+       * @brief - Build the packed rows of the brush for all the orientations from the
+       *          cells in argument. The brush is not monotonic afterwards.
+       * @param size - the dimensions of the brush.
+       * @param cells - the cells of the brush, from bottom left to top right.
+       */
+      void
+      pack(const utils::Sizei& size,
+           const std::vector<State>& cells);
+
     private:
 
       /**
@@ -179,14 +292,25 @@ namespace cellulator {
       State m_monotonicState;
 
       /**
-       * @brief - The vector containing the individual cells for the brush. This array
-       *          contains data from bottom left to top right and should have a size of
-       *          `m_size.area`. If this is not the case the brush is not considered to
-       *          be valid. That is except it is monotonic.
-       *          This array is populated in the case of brushes created from a data
-       *          file.
+       * @brief - The cells of the brush in a given orientation, stored as rows of bits
+       *          from bottom to top. Each row is made of `stride` words where the cell
+       *          `x` is the bit `x % 64` of the word `x / 64`: the bits past the width
+       *          of the brush are always cleared.
+       */
+      struct PackedRows {
+        utils::Sizei size;
+        unsigned stride;
+        std::vector<std::uint64_t> bits;
+      };
+
+      /**
+       * @brief - The packed cells of the brush for each orientation, indexed by the
+       *          value of the orientation. This array is populated in the case of
+       *          brushes created from a data file and empty for monotonic brushes.
+       *          If it does not hold all the cells of `m_size` the brush is not
+       *          considered to be valid.
        */
-      std::vector<State> m_data;
+      std::vector<PackedRows> m_orientations;
   };
 
 }
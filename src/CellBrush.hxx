@@ -17,7 +17,11 @@ namespace cellulator {
   inline
   bool
   CellBrush::valid() const noexcept {
-    return isMonotonic() || (m_size.valid() && m_size.area() == static_cast<int>(m_data.size()));
+    return isMonotonic() || (
+      m_size.valid() &&
+      m_orientations.size() == getOrientationsCount() &&
+      m_orientations[0u].bits.size() == m_orientations[0u].stride * m_size.h()
+    );
   }
 
   inline
@@ -45,6 +49,34 @@ namespace cellulator {
     return '2';
   }
 
+  inline
+  constexpr unsigned
+  CellBrush::getOrientationsCount() noexcept {
+    return 8u;
+  }
+
+  inline
+  std::uint64_t
+  CellBrush::extract(const std::uint64_t* row,
+                     unsigned words,
+                     int start) noexcept
+  {
+    // A start before the beginning of the row shifts the first word up.
+    if (start < 0) {
+      return (start > -64 && words > 0u ? row[0u] << -start : 0u);
+    }
+
+    unsigned word = static_cast<unsigned>(start) / 64u;
+    unsigned shift = static_cast<unsigned>(start) % 64u;
+
+    std::uint64_t out = (word < words ? row[word] >> shift : 0u);
+    if (shift > 0u && word + 1u < words) {
+      out |= row[word + 1u] << (64u - shift);
+    }
+
+    return out;
+  }
+
   inline
   bool
   CellBrush::isMonotonic() const noexcept {
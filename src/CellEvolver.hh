@@ -2,12 +2,18 @@
 # define   CELL_EVOLVER_HH
 
 # include <memory>
+# include <string>
 # include <vector>
-# include <unordered_set>
+# include <cstdint>
 # include <core_utils/CoreObject.hh>
 
 namespace cellulator {
 
+  // Forward declaration of the evolver to be able to use `CellEvolverShPtr`
+  // right away.
+  class CellEvolver;
+  using CellEvolverShPtr = std::shared_ptr<CellEvolver>;
+
   class CellEvolver: public utils::CoreObject {
     public:
 
@@ -24,6 +30,68 @@ namespace cellulator {
 
       ~CellEvolver() = default;
 
+      /**
+       * @brief - Used to create an evolver from the textual description of a rule.
+       *          Both the `B3/S23` notation (where the counts following the `B` are
+       *          the ones for which a cell is born and the ones following the `S`
+       *          are the ones for which it survives) and the classic `23/3` one (in
+       *          which the survival counts come first) are supported.
+       *          An error is raised if the rule can't be parsed.
+       * @param rule - the description of the rule.
+       * @return - the evolver implementing the rule.
+       */
+      static
+      CellEvolverShPtr
+      fromRule(const std::string& rule);
+
+      /**
+       * @brief - Used to create an evolver from a compiled table of rules, as returned
+       *          by `getTable`. Any bit beyond the ones describing the rules is ignored.
+       * @param table - the compiled rules.
+       * @return - the evolver implementing the rules.
+       */
+      static
+      CellEvolverShPtr
+      fromTable(std::uint32_t table);
+
+      /**
+       * @brief - The number of distinct rules which can be described by an evolver,
+       *          which is also the number of distinct tables.
+       * @return - the number of distinct rules.
+       */
+      static
+      std::uint32_t
+      getRulesCount() noexcept;
+
+      /**
+       * @brief - Used to retrieve the compiled version of the rules of this evolver:
+       *          the bit `n` is set if a dead cell with `n` live neighbors is born and
+       *          the bit `9 + n` is set if a live cell with `n` neighbors survives.
+       *          This is suited to index rules or to evaluate them without querying
+       *          the evolver for each cell.
+       * @return - the compiled rules.
+       */
+      std::uint32_t
+      getTable() const noexcept;
+
+      /**
+       * @brief - Used to replace the rules of this evolver with the ones described in
+       *          the input string. See `fromRule` for the supported formats. An error
+       *          is raised if the rule can't be parsed: in this case the rules of the
+       *          evolver are left unchanged.
+       * @param rule - the description of the rule.
+       */
+      void
+      parseRule(const std::string& rule);
+
+      /**
+       * @brief - Used to produce a textual description of the rules of this evolver
+       *          in the `B3/S23` notation.
+       * @return - a string describing the rules.
+       */
+      std::string
+      toRule() const;
+
       /**
        * @brief - Clear any existing option for cells to be born or surviving.
        */
@@ -60,7 +128,7 @@ namespace cellulator {
        *           cell stays dead).
        */
       bool
-      isBorn(unsigned neighbor);
+      isBorn(unsigned neighbor) const noexcept;
 
       /**
        * @brief - Used to determine whether a cell with the specified number
@@ -71,37 +139,43 @@ namespace cellulator {
        *           cell dies).
        */
       bool
-      survives(unsigned neighbor);
+      survives(unsigned neighbor) const noexcept;
 
     protected:
 
       /**
-       * @brief - Register a vector into the internal sets.
+       * @brief - Register a vector into the internal table.
        * @param vec - the vector to register.
-       * @param live - `true` if the vector should be assigned to the `m_born`
-       *               set and `false` if the vector should be added to the
-       *               `m_survive` vector.
+       * @param live - `true` if the vector describes the counts for a cell to
+       *               be born and `false` if it describes the counts for a cell
+       *               to survive.
        */
       void
       registerVector(const std::vector<unsigned>& vec,
                      bool live) noexcept;
 
-    private:
-
       /**
-       * @brief - Holds the set describing how many cells should be surrounding
-       *          a dead cell for it to become alive.
+       * @brief - The number of neighbors a cell can have, used to size the table
+       *          of rules: the counts range from `0` to this value excluded.
+       * @return - the number of possible neighbors counts.
        */
-      std::unordered_set<unsigned> m_born;
+      static
+      unsigned
+      getNeighborsCounts() noexcept;
+
+    private:
 
       /**
-       * @brief - Holds the set describing how many living cells should surround
-       *          a live cell for it to stay alive.
+       * @brief - Holds the compiled rules: the lower bits describe how many cells
+       *          should be surrounding a dead cell for it to become alive and the
+       *          upper ones how many living cells should surround a live cell for
+       *          it to stay alive. See `getTable` for more details.
+       *          Using a bit field rather than sets allows the rules to be checked
+       *          for each cell cheaply.
        */
-      std::unordered_set<unsigned> m_survive;
+      std::uint32_t m_table;
   };
 
-  using CellEvolverShPtr = std::shared_ptr<CellEvolver>;
 }
 
 # include "CellEvolver.hxx"
@@ -1,6 +1,7 @@
 #ifndef    CELL_EVOLVER_HXX
 # define   CELL_EVOLVER_HXX
 
+# include <cctype>
 # include "CellEvolver.hh"
 
 namespace cellulator {
@@ -10,8 +11,7 @@ namespace cellulator {
                            const std::vector<unsigned>& survive):
     utils::CoreObject(std::string("evolver")),
 
-    m_born(),
-    m_survive()
+    m_table(0u)
   {
     setService("cells");
 
@@ -19,37 +19,161 @@ namespace cellulator {
     registerVector(survive, false);
   }
 
+  inline
+  CellEvolverShPtr
+  CellEvolver::fromRule(const std::string& rule) {
+    CellEvolverShPtr evolver = std::make_shared<CellEvolver>();
+    evolver->parseRule(rule);
+
+    return evolver;
+  }
+
+  inline
+  CellEvolverShPtr
+  CellEvolver::fromTable(std::uint32_t table) {
+    CellEvolverShPtr evolver = std::make_shared<CellEvolver>();
+    evolver->m_table = table & (getRulesCount() - 1u);
+
+    return evolver;
+  }
+
+  inline
+  std::uint32_t
+  CellEvolver::getRulesCount() noexcept {
+    return 1u << (2u * getNeighborsCounts());
+  }
+
+  inline
+  std::uint32_t
+  CellEvolver::getTable() const noexcept {
+    return m_table;
+  }
+
+  inline
+  void
+  CellEvolver::parseRule(const std::string& rule) {
+    std::vector<unsigned> born;
+    std::vector<unsigned> survive;
+
+    // Split the rule on the separator: we expect exactly two parts.
+    std::string::size_type sep = rule.find('/');
+    if (sep == std::string::npos || rule.find('/', sep + 1) != std::string::npos) {
+      error(
+        std::string("Could not parse rule \"") + rule + "\"",
+        std::string("Expected two parts separated by '/'")
+      );
+    }
+
+    std::string parts[2] = {rule.substr(0u, sep), rule.substr(sep + 1u)};
+
+    // Without prefixes the first part describes the survival counts.
+    bool sFirst = true;
+
+    for (unsigned id = 0u ; id < 2u ; ++id) {
+      const std::string& part = parts[id];
+
+      std::string::size_type start = 0u;
+      bool isBorn = (id == 0u ? !sFirst : sFirst);
+
+      if (!part.empty() && std::isalpha(static_cast<unsigned char>(part[0]))) {
+        char prefix = static_cast<char>(std::toupper(static_cast<unsigned char>(part[0])));
+
+        if (prefix != 'B' && prefix != 'S') {
+          error(
+            std::string("Could not parse rule \"") + rule + "\"",
+            std::string("Unknown prefix '") + part[0] + "'"
+          );
+        }
+
+        isBorn = (prefix == 'B');
+        start = 1u;
+      }
+
+      std::vector<unsigned>& counts = (isBorn ? born : survive);
+
+      for (std::string::size_type c = start ; c < part.size() ; ++c) {
+        if (part[c] < '0' || part[c] > '8') {
+          error(
+            std::string("Could not parse rule \"") + rule + "\"",
+            std::string("Invalid neighbors count '") + part[c] + "'"
+          );
+        }
+
+        counts.push_back(static_cast<unsigned>(part[c] - '0'));
+      }
+    }
+
+    clear();
+    registerVector(born, true);
+    registerVector(survive, false);
+  }
+
+  inline
+  std::string
+  CellEvolver::toRule() const {
+    std::string out("B");
+
+    for (unsigned n = 0u ; n < getNeighborsCounts() ; ++n) {
+      if (isBorn(n)) {
+        out += std::to_string(n);
+      }
+    }
+
+    out += "/S";
+
+    for (unsigned n = 0u ; n < getNeighborsCounts() ; ++n) {
+      if (survives(n)) {
+        out += std::to_string(n);
+      }
+    }
+
+    return out;
+  }
+
   inline
   void
   CellEvolver::clear() noexcept {
-    m_born.clear();
-    m_survive.clear();
+    m_table = 0u;
   }
 
   inline
   bool
   CellEvolver::addBornOption(unsigned neighbor) noexcept {
-    std::pair<std::unordered_set<unsigned>::iterator, bool> check = m_born.insert(neighbor);
-    return check.second;
+    if (neighbor >= getNeighborsCounts() || isBorn(neighbor)) {
+      return false;
+    }
+
+    m_table |= (1u << neighbor);
+    return true;
   }
 
   inline
   bool
   CellEvolver::addSurvivingOption(unsigned neighbor) noexcept {
-    std::pair<std::unordered_set<unsigned>::iterator, bool> check = m_survive.insert(neighbor);
-    return check.second;
+    if (neighbor >= getNeighborsCounts() || survives(neighbor)) {
+      return false;
+    }
+
+    m_table |= (1u << (getNeighborsCounts() + neighbor));
+    return true;
   }
 
   inline
   bool
-  CellEvolver::isBorn(unsigned neighbor) {
-    return m_born.count(neighbor) > 0;
+  CellEvolver::isBorn(unsigned neighbor) const noexcept {
+    return neighbor < getNeighborsCounts() && ((m_table >> neighbor) & 1u) != 0u;
   }
 
   inline
   bool
-  CellEvolver::survives(unsigned neighbor) {
-    return m_survive.count(neighbor) > 0;
+  CellEvolver::survives(unsigned neighbor) const noexcept {
+    return neighbor < getNeighborsCounts() && ((m_table >> (getNeighborsCounts() + neighbor)) & 1u) != 0u;
+  }
+
+  inline
+  unsigned
+  CellEvolver::getNeighborsCounts() noexcept {
+    return 9u;
   }
 
   inline
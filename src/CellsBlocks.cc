@@ -1,8 +1,10 @@
 
 # include "CellsBlocks.hh"
 # include <numeric>
+# include <algorithm>
+# include <fstream>
+# include <cstring>
 # include <unordered_set>
-# include "ColonyTile.hh"
 
 namespace {
 
@@ -17,6 +19,86 @@ namespace {
     return ((v.x() < 0 && v.y() < 0) || (v.x() >= 0 && v.y() >= 0)) ? C : -C - 1;
   }
 
+  inline
+  void
+  appendVarint(std::uint64_t value,
+               std::vector<std::uint8_t>& out)
+  {
+    while (value >= 0x80u) {
+      out.push_back(static_cast<std::uint8_t>(value & 0x7Fu) | 0x80u);
+      value >>= 7u;
+    }
+
+    out.push_back(static_cast<std::uint8_t>(value));
+  }
+
+  inline
+  std::uint64_t
+  readVarint(const std::uint8_t*& in) {
+    std::uint64_t value = 0u;
+    unsigned shift = 0u;
+
+    while ((*in & 0x80u) != 0u) {
+      value |= static_cast<std::uint64_t>(*in & 0x7Fu) << shift;
+      shift += 7u;
+      ++in;
+    }
+
+    value |= static_cast<std::uint64_t>(*in) << shift;
+    ++in;
+
+    return value;
+  }
+
+  /**
+   * @brief - Run-length encode the bytes in argument: each run of identical
+   *          bytes is saved as its length followed by the repeated byte.
+   * @param data - the bytes to encode.
+   * @param size - the number of bytes.
+   * @param out - output vector receiving the runs.
+   */
+  void
+  appendRuns(const std::uint8_t* data,
+             std::size_t size,
+             std::vector<std::uint8_t>& out)
+  {
+    std::size_t id = 0u;
+
+    while (id < size) {
+      std::size_t end = id + 1u;
+      while (end < size && data[end] == data[id]) {
+        ++end;
+      }
+
+      appendVarint(end - id, out);
+      out.push_back(data[id]);
+
+      id = end;
+    }
+  }
+
+  /**
+   * @brief - Decode the runs produced by `appendRuns`.
+   * @param in - the runs to decode, moved past the decoded runs.
+   * @param out - output buffer receiving the bytes.
+   * @param size - the number of bytes to decode.
+   */
+  void
+  readRuns(const std::uint8_t*& in,
+           std::uint8_t* out,
+           std::size_t size)
+  {
+    std::size_t id = 0u;
+
+    while (id < size) {
+      std::size_t count = static_cast<std::size_t>(readVarint(in));
+      std::fill(out + id, out + std::min(id + count, size), *in);
+      ++in;
+
+      id += count;
+    }
+  }
+
 }
 
 namespace cellulator {
@@ -35,6 +117,7 @@ namespace cellulator {
     m_nextAdjacency(),
     m_adjacencyLocker(),
     m_ages(),
+    m_nextAges(),
 
     m_liveBlocks(0u),
     m_blocks(),
@@ -42,7 +125,12 @@ namespace cellulator {
     m_blocksIndex(),
 
     m_totalArea(),
-    m_liveArea()
+    m_liveArea(),
+
+    m_freeSlots(),
+    m_coldThreshold(0u),
+    m_coldBlocks(),
+    m_elapsed(0u)
   {
     setService("blocks");
 
@@ -77,12 +165,22 @@ namespace cellulator {
 
   unsigned
   CellsBlocks::randomize() {
+    return randomize(getDeadCellProbability(), static_cast<unsigned>(std::rand()));
+  }
+
+  unsigned
+  CellsBlocks::randomize(float deadProb,
+                         unsigned seed)
+  {
     // Protect from concurrent accesses.
     const std::lock_guard guard(m_propsLocker);
 
     // We want to randomize only currently active blocks.
     unsigned count = 0u;
 
+    // All the cells are about to change.
+    thawAll();
+
     // In case there are no active blocks, reallocate the
     // colony as it was at the beginning.
     if (m_liveBlocks == 0u) {
@@ -117,55 +215,65 @@ namespace cellulator {
 
     // Randomize the list of nodes that already existed in the
     // colony (but not the newly created boundaries).
+    std::minstd_rand rng(seed);
+
     for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
       if (blocks.count(m_blocks[id].id) > 0) {
-        makeRandom(m_blocks[id], getDeadCellProbability());
-
-        count += m_blocks[id].alive;
+        makeRandom(m_blocks[id], deadProb, rng);
       }
     }
 
-    // Update live area to reflect the newly generated cells.
-    stepPrivate();
+    // Update live area to reflect the newly generated cells. The
+    // number of live cells is only known once the step is done.
+    count = stepPrivate();
 
     return count;
   }
 
   void
-  CellsBlocks::generateSchedule(std::vector<ColonyTileShPtr>& tiles) {
+  CellsBlocks::generateSchedule(std::vector<unsigned>& blocks) {
     // Protect from concurrent accesses.
     const std::lock_guard guard(m_propsLocker);
 
-    // Clear exsiting jobs.
-    tiles.clear();
+    // Clear existing schedule: we don't release the memory though as
+    // this is typically called once per generation.
+    blocks.clear();
 
-    // We want to generate colony tiles for all active blocks.
+    // Move the blocks to and from the cold tier: this is the last point
+    // before the evolution where the blocks can be modified.
+    if (m_coldThreshold > 0u || !m_coldBlocks.empty()) {
+      updateColdTier();
+    }
+
+    // We want to schedule all active blocks: the cold ones are kept so
+    // that an empty schedule still means that no block is active.
     for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
       // Only handle this block if it is active.
       if (m_blocks[id].active) {
-        tiles.push_back(
-          std::make_shared<ColonyTile>(
-            m_blocks[id].id,
-            this
-          )
-        );
+        blocks.push_back(m_blocks[id].id);
       }
     }
-
-    // In case no job were generated, create a dummy job which will indicate
-    // to listeners that the evolution is actually terminated.
-    if (tiles.empty()) {
-      tiles.push_back(
-        std::make_shared<ColonyTile>()
-      );
-    }
   }
 
-  void
-  CellsBlocks::evolve(unsigned blockID) {
+  bool
+  CellsBlocks::evolve(unsigned blockID,
+                      unsigned generations,
+                      const std::atomic<bool>* interrupt)
+  {
     // Retrieve the block's description.
     BlockDesc& b = m_blocks[blockID];
 
+    // Cold blocks are not modified: their contribution to the adjacency
+    // of their neighbors is restored when the step is applied.
+    if (b.cold) {
+      return true;
+    }
+
+    // Evolving over several generations is handled by a dedicated method.
+    if (generations > 1u) {
+      return evolveMany(b, generations, interrupt);
+    }
+
     // Handle cases where there were no changes in this block: we will just copy and
     // paste the value to the next generation.
     if (b.changed == 0u) {
@@ -180,13 +288,20 @@ namespace cellulator {
         }
       }
 
-      return;
+      return true;
     }
 
     b.nAlive = 0u;
 
+    unsigned w = static_cast<unsigned>(b.area.w());
+
     // Evolve each cell.
     for (unsigned id = b.start ; id < b.end ; ++id) {
+      // Check for interruption at the beginning of each row.
+      if (interrupt != nullptr && (id - b.start) % w == 0u && interrupt->load(std::memory_order_relaxed)) {
+        return false;
+      }
+
       State s = m_states[id];
       unsigned nghbr = m_adjacency[id];
 
@@ -209,6 +324,220 @@ namespace cellulator {
         updateAdjacency(b, coordFromIndex(b, id, false), false);
       }
     }
+
+    return true;
+  }
+
+  bool
+  CellsBlocks::evolveMany(BlockDesc& b,
+                          unsigned generations,
+                          const std::atomic<bool>* interrupt)
+  {
+    // Consistency check.
+    if (generations > getMaxGenerationsPerEvolution()) {
+      error(
+        std::string("Could not evolve block ") + std::to_string(b.id),
+        std::string("Requested ") + std::to_string(generations) + " generation(s) but at most " +
+        std::to_string(getMaxGenerationsPerEvolution()) + " can be computed at once"
+      );
+    }
+
+    int w = b.area.w();
+    int h = b.area.h();
+
+    // Gather the neighboring blocks: they are arranged so that the first
+    // index corresponds to the vertical position (south, center, north)
+    // and the second to the horizontal position (west, center, east).
+    const BlockDesc* nghbrs[3][3] = {
+      {
+        (b.sw >= 0 ? &m_blocks[b.sw] : nullptr),
+        (b.south >= 0 ? &m_blocks[b.south] : nullptr),
+        (b.se >= 0 ? &m_blocks[b.se] : nullptr)
+      },
+      {
+        (b.west >= 0 ? &m_blocks[b.west] : nullptr),
+        &b,
+        (b.east >= 0 ? &m_blocks[b.east] : nullptr)
+      },
+      {
+        (b.nw >= 0 ? &m_blocks[b.nw] : nullptr),
+        (b.north >= 0 ? &m_blocks[b.north] : nullptr),
+        (b.ne >= 0 ? &m_blocks[b.ne] : nullptr)
+      }
+    };
+
+    // Handle cases where neither the block nor its neighbors changed in the
+    // last generation: the block only contains still life forms and none
+    // can reach it during the requested generations. We can just copy its
+    // content to the next generation.
+    bool still = true;
+    for (unsigned v = 0u ; v < 3u && still ; ++v) {
+      for (unsigned u = 0u ; u < 3u && still ; ++u) {
+        still = (nghbrs[v][u] == nullptr || nghbrs[v][u]->changed == 0u);
+      }
+    }
+
+    if (still) {
+      b.nAlive = b.alive;
+      b.nChanged = 0u;
+
+      for (unsigned id = b.start ; id < b.end ; ++id) {
+        m_nextStates[id] = m_states[id];
+        m_nextAdjacency[id] = m_adjacency[id];
+        m_nextAges[id] = (m_states[id] == State::Alive ? m_ages[id] + static_cast<int>(generations) : 0);
+      }
+
+      return true;
+    }
+
+    // The cells of the block are about to change.
+    b.dirty = true;
+
+    // Build a local copy of the block with a halo large enough to compute
+    // the requested number of generations: each generation shrinks the
+    // valid area by one cell on each side. We keep one more cell so that
+    // the adjacency of the block can be computed at the last generation.
+    int m = static_cast<int>(generations) + 1;
+    int W = w + 2 * m;
+    int H = h + 2 * m;
+
+    thread_local std::vector<unsigned char> cur;
+    thread_local std::vector<unsigned char> nxt;
+    thread_local std::vector<int> ages;
+
+    // The states of cold neighbors are decoded: they can't change during
+    // the evolution as none of their neighbors changed.
+    thread_local BlockCells decoded[3][3];
+    const State* states[3][3];
+
+    for (unsigned v = 0u ; v < 3u ; ++v) {
+      for (unsigned u = 0u ; u < 3u ; ++u) {
+        const unsigned* adjacency = nullptr;
+        const int* cellsAges = nullptr;
+
+        states[v][u] = nullptr;
+        if (nghbrs[v][u] != nullptr) {
+          readBlock(*nghbrs[v][u], states[v][u], adjacency, cellsAges, decoded[v][u]);
+        }
+      }
+    }
+
+    cur.resize(W * H);
+    nxt.resize(W * H);
+    ages.resize(w * h);
+
+    for (int y = 0 ; y < H ; ++y) {
+      int by = y - m;
+      unsigned v = (by < 0 ? 0u : (by >= h ? 2u : 1u));
+      int row = (by + h) % h;
+
+      unsigned char* out = cur.data() + y * W;
+
+      // Columns of the halo are split between the west, center and east
+      // blocks.
+      int bounds[4] = {0, m, m + w, W};
+
+      for (unsigned u = 0u ; u < 3u ; ++u) {
+        const State* src = states[v][u];
+
+        if (src == nullptr) {
+          std::fill(out + bounds[u], out + bounds[u + 1], 0u);
+          continue;
+        }
+
+        for (int x = bounds[u] ; x < bounds[u + 1] ; ++x) {
+          int col = (x - m + w) % w;
+          out[x] = (src[row * w + col] == State::Alive ? 1u : 0u);
+        }
+      }
+    }
+
+    for (int y = 0 ; y < h ; ++y) {
+      for (int x = 0 ; x < w ; ++x) {
+        ages[y * w + x] = m_ages[b.start + y * w + x];
+      }
+    }
+
+    // Precompute the rules so that we don't need to query the ruleset for
+    // each cell: the first half is used for dead cells and the second one
+    // for alive cells.
+    unsigned char rules[18];
+    for (unsigned n = 0u ; n < 9u ; ++n) {
+      rules[n] = (m_ruleset->isBorn(n) ? 1u : 0u);
+      rules[9u + n] = (m_ruleset->survives(n) ? 1u : 0u);
+    }
+
+    b.nChanged = 0u;
+
+    for (int t = 1 ; t <= static_cast<int>(generations) ; ++t) {
+      // Check for interruption before each generation.
+      if (interrupt != nullptr && interrupt->load(std::memory_order_relaxed)) {
+        return false;
+      }
+
+      bool last = (t == static_cast<int>(generations));
+
+      for (int y = t ; y < H - t ; ++y) {
+        const unsigned char* s = cur.data() + (y - 1) * W;
+        const unsigned char* c = cur.data() + y * W;
+        const unsigned char* n = cur.data() + (y + 1) * W;
+        unsigned char* out = nxt.data() + y * W;
+
+        for (int x = t ; x < W - t ; ++x) {
+          unsigned count =
+            s[x - 1] + s[x] + s[x + 1] +
+            c[x - 1] +        c[x + 1] +
+            n[x - 1] + n[x] + n[x + 1]
+          ;
+
+          out[x] = rules[9u * c[x] + count];
+
+          // The number of changes is computed on the block and its direct
+          // neighbors, similarly to what is done when the adjacency is used.
+          if (last && out[x] != c[x]) {
+            ++b.nChanged;
+          }
+        }
+      }
+
+      cur.swap(nxt);
+
+      // Update the age of the cells of the block.
+      for (int y = 0 ; y < h ; ++y) {
+        const unsigned char* c = cur.data() + (y + m) * W + m;
+
+        for (int x = 0 ; x < w ; ++x) {
+          ages[y * w + x] = (c[x] != 0u ? ages[y * w + x] + 1 : 0);
+        }
+      }
+    }
+
+    // Save the content of the block at the last generation. As we have a
+    // valid halo of one cell, we can compute the adjacency directly rather
+    // than scattering it to the neighboring blocks.
+    b.nAlive = 0u;
+
+    for (int y = 0 ; y < h ; ++y) {
+      const unsigned char* s = cur.data() + (y + m - 1) * W + m;
+      const unsigned char* c = cur.data() + (y + m) * W + m;
+      const unsigned char* n = cur.data() + (y + m + 1) * W + m;
+
+      unsigned offset = b.start + y * w;
+
+      for (int x = 0 ; x < w ; ++x) {
+        m_nextStates[offset + x] = (c[x] != 0u ? State::Alive : State::Dead);
+        m_nextAdjacency[offset + x] =
+          s[x - 1] + s[x] + s[x + 1] +
+          c[x - 1] +        c[x + 1] +
+          n[x - 1] + n[x] + n[x + 1]
+        ;
+        m_nextAges[offset + x] = ages[y * w + x];
+
+        b.nAlive += c[x];
+      }
+    }
+
+    return true;
   }
 
   std::pair<State, int>
@@ -236,14 +565,90 @@ namespace cellulator {
     }
 
     // Return the corresponding cell.
-    int dataID = indexFromCoord(m_blocks[id], coord, true);
+    const BlockDesc& b = m_blocks[id];
 
-    out.first = m_states[dataID];
-    out.second = m_ages[dataID];
+    const State* states = nullptr;
+    const unsigned* adjacency = nullptr;
+    const int* ages = nullptr;
+    BlockCells buffer;
+
+    readBlock(b, states, adjacency, ages, buffer);
+
+    int cell = indexFromCoord(b, coord, true) - static_cast<int>(b.start);
+
+    out.first = states[cell];
+    out.second = ages[cell];
 
     return out;
   }
 
+  void
+  CellsBlocks::getLiveCells(std::vector<utils::Vector2i>& cells) {
+    cells.clear();
+
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    const State* states = nullptr;
+    const unsigned* adjacency = nullptr;
+    const int* ages = nullptr;
+    BlockCells buffer;
+
+    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
+      const BlockDesc& b = m_blocks[id];
+
+      // Only handle active blocks: we don't rely on the count of live
+      // cells as this method is used to verify the content of blocks.
+      if (!b.active) {
+        continue;
+      }
+
+      readBlock(b, states, adjacency, ages, buffer);
+
+      for (unsigned cell = 0u ; cell < sizeOfBlock() ; ++cell) {
+        if (states[cell] == State::Alive) {
+          cells.push_back(coordFromIndex(b, b.start + cell, true));
+        }
+      }
+    }
+  }
+
+  void
+  CellsBlocks::visitLiveCells(const CellsVisitor& visitor) {
+    std::vector<utils::Vector2i> cells;
+    cells.reserve(sizeOfBlock());
+
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    const State* states = nullptr;
+    const unsigned* adjacency = nullptr;
+    const int* ages = nullptr;
+    BlockCells buffer;
+
+    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
+      const BlockDesc& b = m_blocks[id];
+
+      if (!b.active || b.alive == 0u) {
+        continue;
+      }
+
+      cells.clear();
+
+      readBlock(b, states, adjacency, ages, buffer);
+
+      for (unsigned cell = 0u ; cell < sizeOfBlock() ; ++cell) {
+        if (states[cell] == State::Alive) {
+          cells.push_back(coordFromIndex(b, b.start + cell, true));
+        }
+      }
+
+      if (!cells.empty()) {
+        visitor(cells);
+      }
+    }
+  }
+
   void
   CellsBlocks::fetchCells(std::vector<std::pair<State, unsigned>>& cells,
                           const utils::Boxi& area)
@@ -254,6 +659,11 @@ namespace cellulator {
     // Protect from concurrent accesses.
     const std::lock_guard guard(m_propsLocker);
 
+    const State* states = nullptr;
+    const unsigned* adjacency = nullptr;
+    const int* ages = nullptr;
+    BlockCells buffer;
+
     // Traverse the blocks and fill in any element requested from
     // the input area.
     for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
@@ -284,7 +694,14 @@ namespace cellulator {
       int xMax = std::min(gXMax, lXMax);
       int yMax = std::min(gYMax, lYMax);
 
-      int uB = static_cast<int>(b.end - b.start);
+      int uB = static_cast<int>(sizeOfBlock());
+
+      // Only decode the cells of cold blocks intersecting the area.
+      if (xMin >= xMax || yMin >= yMax) {
+        continue;
+      }
+
+      readBlock(b, states, adjacency, ages, buffer);
 
       for (int y = yMin ; y < yMax ; ++y) {
         // Convert logical coordinates to valid cells coordinates.
@@ -303,8 +720,8 @@ namespace cellulator {
               rXOff >= 0 && rXOff < b.area.w())
           {
             cells[offset + xOff] = std::make_pair(
-              m_states[b.start + coord],
-              m_ages[b.start + coord]
+              states[coord],
+              ages[coord]
             );
           }
         }
@@ -313,165 +730,851 @@ namespace cellulator {
   }
 
   unsigned
-  CellsBlocks::paint(const CellBrush& brush,
-                     const utils::Vector2i& coord)
+  CellsBlocks::paint(const CellBrush& brush,
+                     const utils::Vector2i& coord,
+                     const BrushOrientation& orientation)
+  {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    // We need to paint the brush at the specified coordinates.
+    // Rather than locating the block of each cell of the brush,
+    // we traverse the blocks covered by the brush and stamp the
+    // rows of the brush overlapping each one as bits: they are
+    // compared to the cells of the block so that only the cells
+    // which actually change are modified.
+    utils::Sizei size = brush.getSize(orientation);
+
+    int xMin = coord.x() - size.w() / 2;
+    int yMin = coord.y() - size.h() / 2;
+    int xMax = xMin + size.w();
+    int yMax = yMin + size.h();
+
+    // The blocks are aligned on a lattice which can be determined
+    // from any active block. Just like in `locateBlock` we create
+    // the blocks covering the total area in case none exist yet.
+    if (m_liveBlocks == 0u) {
+      allocate(m_totalArea);
+    }
+
+    int ref = -1;
+    for (unsigned id = 0u ; id < m_blocks.size() && ref < 0 ; ++id) {
+      if (m_blocks[id].active) {
+        ref = static_cast<int>(id);
+      }
+    }
+
+    if (ref < 0) {
+      warn("Could not paint brush at " + coord.toString() + ", no valid block to register the cells");
+      return consolidate();
+    }
+
+    const int w = m_nodesDims.w();
+    const int h = m_nodesDims.h();
+
+    utils::Vector2i center = m_blocks[ref].area.getCenter();
+    int left = m_blocks[ref].area.getLeftBound();
+    int bottom = m_blocks[ref].area.getBottomBound();
+
+    // Floor division used to find the blocks of the lattice covering
+    // the brush.
+    auto lattice = [](int v, int d) {
+      return (v >= 0 ? v / d : -((-v + d - 1) / d));
+    };
+
+    int bxMin = lattice(xMin - left, w), bxMax = lattice(xMax - 1 - left, w);
+    int byMin = lattice(yMin - bottom, h), byMax = lattice(yMax - 1 - bottom, h);
+
+    const unsigned stride = (static_cast<unsigned>(w) + 63u) / 64u;
+    std::vector<std::uint64_t> rows;
+    std::vector<std::pair<utils::Vector2i, State>> changes;
+
+    const State* states = nullptr;
+    const unsigned* adjacency = nullptr;
+    const int* ages = nullptr;
+    BlockCells buffer;
+
+    for (int by = byMin ; by <= byMax ; ++by) {
+      for (int bx = bxMin ; bx <= bxMax ; ++bx) {
+        utils::Boxi area(center.x() + bx * w, center.y() + by * h, w, h);
+
+        int lx = left + bx * w;
+        int ly = bottom + by * h;
+
+        // Restrict to the part of the block covered by the brush.
+        int cxMin = std::max(xMin, lx), cxMax = std::min(xMax, lx + w);
+        int cyMin = std::max(yMin, ly), cyMax = std::min(yMax, ly + h);
+
+        // Stamp the rows of the brush in the frame of the block.
+        rows.assign(stride * (cyMax - cyMin), 0u);
+        bool live = false;
+
+        for (int y = cyMin ; y < cyMax ; ++y) {
+          std::uint64_t* row = rows.data() + (y - cyMin) * stride;
+          brush.stamp(y - yMin, row, w, xMin - lx, StampMode::Overlay, orientation);
+
+          for (unsigned word = 0u ; word < stride && !live ; ++word) {
+            live = (row[word] != 0u);
+          }
+        }
+
+        // A missing block only holds dead cells: it is only needed
+        // if the brush brings some cells to life in it.
+        int id = -1;
+        if (!find(area, id)) {
+          if (!live) {
+            continue;
+          }
+
+          id = static_cast<int>(registerNewBlock(area).id);
+        }
+
+        if (!live && m_blocks[id].alive == 0u) {
+          continue;
+        }
+
+        // Compare the stamped rows with the cells of the block.
+        changes.clear();
+        readBlock(m_blocks[id], states, adjacency, ages, buffer);
+
+        for (int y = cyMin ; y < cyMax ; ++y) {
+          const std::uint64_t* row = rows.data() + (y - cyMin) * stride;
+          const State* cells = states + (y - ly) * w;
+
+          for (int x = cxMin - lx ; x < cxMax - lx ; ++x) {
+            State s = ((row[x / 64] >> (x % 64)) & 1u ? State::Alive : State::Dead);
+
+            if (cells[x] != s) {
+              changes.push_back(std::make_pair(utils::Vector2i(lx + x, y), s));
+            }
+          }
+        }
+
+        if (changes.empty()) {
+          continue;
+        }
+
+        // Allocate boundaries for this block so that we are sure that we
+        // can update the adjacency. If the blocks are not needed we will
+        // perform a cleanup pass afterwards anyways.
+        allocateBoundary(id, true);
+
+        for (unsigned change = 0u ; change < changes.size() ; ++change) {
+          setCellState(m_blocks[id], changes[change].first, changes[change].second);
+        }
+      }
+    }
+
+    return consolidate();
+  }
+
+  void
+  CellsBlocks::checkpoint(const std::string& file,
+                          std::uint64_t generation)
+  {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    CheckpointHeader header;
+    std::memset(&header, 0, sizeof(CheckpointHeader));
+
+    std::memcpy(header.magic, Checkpoint::getMagic(), sizeof(header.magic));
+    header.version = Checkpoint::getVersion();
+    header.byteOrder = Checkpoint::getByteOrderMarker();
+
+    header.generation = generation;
+    header.rules = (m_ruleset != nullptr ? m_ruleset->getTable() : CellEvolver().getTable());
+    header.blockW = m_nodesDims.w();
+    header.blockH = m_nodesDims.h();
+    header.blocks = static_cast<std::uint32_t>(m_blocks.size());
+    header.freeBlocks = static_cast<std::uint32_t>(m_freeBlocks.size());
+    header.liveBlocks = m_liveBlocks;
+    header.cells = static_cast<std::uint64_t>(m_blocks.size()) * sizeOfBlock();
+
+    header.totalArea[0] = m_totalArea.x();
+    header.totalArea[1] = m_totalArea.y();
+    header.totalArea[2] = m_totalArea.w();
+    header.totalArea[3] = m_totalArea.h();
+
+    header.liveArea[0] = m_liveArea.x();
+    header.liveArea[1] = m_liveArea.y();
+    header.liveArea[2] = m_liveArea.w();
+    header.liveArea[3] = m_liveArea.h();
+
+    Checkpoint::computeLayout(header);
+
+    std::ofstream out(file.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out.good()) {
+      error(
+        std::string("Could not write checkpoint to \"") + file + "\"",
+        std::string("Cannot open file")
+      );
+    }
+
+    // Pad the file up to the beginning of the next section.
+    auto seek = [&out](std::uint64_t offset) {
+      static const char zeros[64] = {0};
+
+      std::uint64_t pos = static_cast<std::uint64_t>(out.tellp());
+      while (pos < offset) {
+        std::uint64_t count = std::min<std::uint64_t>(offset - pos, sizeof(zeros));
+        out.write(zeros, count);
+        pos += count;
+      }
+    };
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(CheckpointHeader));
+
+    seek(header.blocksOffset);
+    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
+      BlockRecord r = toRecord(m_blocks[id]);
+      out.write(reinterpret_cast<const char*>(&r), sizeof(BlockRecord));
+    }
+
+    seek(header.freeOffset);
+    for (unsigned id = 0u ; id < m_freeBlocks.size() ; ++id) {
+      std::uint32_t free = m_freeBlocks[id];
+      out.write(reinterpret_cast<const char*>(&free), sizeof(std::uint32_t));
+    }
+
+    // The cells are saved block by block in the order of their identifiers:
+    // cold blocks are decoded and blocks which are not active do not own any
+    // cells so they are saved as dead cells.
+    const unsigned area = sizeOfBlock();
+
+    std::vector<std::uint8_t> bytes(area);
+    std::vector<std::int32_t> empty(area, 0);
+    BlockCells buffer;
+
+    auto writeSection = [&](std::uint64_t offset, unsigned section) {
+      seek(offset);
+
+      const State* states = nullptr;
+      const unsigned* adjacency = nullptr;
+      const int* ages = nullptr;
+
+      for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
+        if (!m_blocks[id].active) {
+          std::fill(bytes.begin(), bytes.end(), 0u);
+          out.write(
+            (section == 2u ? reinterpret_cast<const char*>(empty.data()) : reinterpret_cast<const char*>(bytes.data())),
+            (section == 2u ? area * sizeof(std::int32_t) : area)
+          );
+
+          continue;
+        }
+
+        readBlock(m_blocks[id], states, adjacency, ages, buffer);
+
+        if (section == 2u) {
+          out.write(reinterpret_cast<const char*>(ages), area * sizeof(std::int32_t));
+          continue;
+        }
+
+        for (unsigned cell = 0u ; cell < area ; ++cell) {
+          bytes[cell] = (section == 0u ?
+            (states[cell] == State::Alive ? 1u : 0u) :
+            static_cast<std::uint8_t>(adjacency[cell])
+          );
+        }
+
+        out.write(reinterpret_cast<const char*>(bytes.data()), area);
+      }
+    };
+
+    static_assert(sizeof(int) == sizeof(std::int32_t), "Ages are saved as 32 bits integers");
+
+    writeSection(header.statesOffset, 0u);
+    writeSection(header.adjacencyOffset, 1u);
+    writeSection(header.agesOffset, 2u);
+
+    out.flush();
+
+    if (!out.good()) {
+      error(
+        std::string("Could not write checkpoint to \"") + file + "\"",
+        std::string("Failed to write data")
+      );
+    }
+  }
+
+  unsigned
+  CellsBlocks::restore(const Checkpoint& checkpoint) {
+    const CheckpointHeader& header = checkpoint.getHeader();
+    const BlockRecord* records = checkpoint.getBlocks();
+    const std::uint32_t* free = checkpoint.getFreeBlocks();
+
+    // Verify that the blocks reference valid cells and blocks before
+    // modifying anything.
+    const std::uint64_t area = static_cast<std::uint64_t>(header.blockW) * header.blockH;
+    validateRecords(records, header.blocks, area, free, header.freeBlocks, "Could not restore checkpoint");
+
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    m_nodesDims = utils::Sizei(header.blockW, header.blockH);
+    m_ruleset = CellEvolver::fromTable(header.rules);
+
+    const std::size_t cells = static_cast<std::size_t>(header.cells);
+    const std::uint8_t* states = checkpoint.getStates();
+    const std::uint8_t* adjacency = checkpoint.getAdjacency();
+    const std::int32_t* ages = checkpoint.getAges();
+
+    m_states.resize(cells);
+    m_adjacency.resize(cells);
+    for (std::size_t id = 0u ; id < cells ; ++id) {
+      m_states[id] = (states[id] != 0u ? State::Alive : State::Dead);
+      m_adjacency[id] = adjacency[id];
+    }
+
+    m_ages.assign(ages, ages + cells);
+
+    m_nextStates.assign(cells, State::Dead);
+    m_nextAdjacency.assign(cells, 0u);
+    m_nextAges.assign(cells, 0);
+
+    m_blocks.clear();
+    m_blocks.reserve(header.blocks);
+    m_blocksIndex.clear();
+
+    unsigned alive = 0u;
+
+    for (unsigned id = 0u ; id < header.blocks ; ++id) {
+      BlockDesc b = fromRecord(records[id]);
+      m_blocks.push_back(b);
+
+      if (b.active) {
+        m_blocksIndex[hashCoordinate(b.area.getCenter())] = b.id;
+        alive += b.alive;
+      }
+    }
+
+    m_freeBlocks.assign(free, free + header.freeBlocks);
+    m_liveBlocks = header.liveBlocks;
+
+    // The cells of the inactive blocks can be reused.
+    m_coldBlocks.clear();
+    m_freeSlots.clear();
+    for (unsigned id = 0u ; id < m_freeBlocks.size() ; ++id) {
+      m_freeSlots.push_back(m_blocks[m_freeBlocks[id]].start);
+    }
+
+    m_totalArea = utils::Boxi(header.totalArea[0], header.totalArea[1], header.totalArea[2], header.totalArea[3]);
+    m_liveArea = utils::Boxf(header.liveArea[0], header.liveArea[1], header.liveArea[2], header.liveArea[3]);
+
+    return alive;
+  }
+
+  void
+  CellsBlocks::capture(std::vector<char>& record,
+                       std::uint64_t generation,
+                       bool base)
+  {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    std::vector<std::uint32_t> dirty;
+    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
+      if (m_blocks[id].active && (base || m_blocks[id].dirty)) {
+        dirty.push_back(id);
+      }
+    }
+
+    LogRecordHeader header;
+    std::memset(&header, 0, sizeof(LogRecordHeader));
+
+    std::memcpy(header.magic, CheckpointLog::getMagic(), sizeof(header.magic));
+    header.version = CheckpointLog::getVersion();
+    header.byteOrder = Checkpoint::getByteOrderMarker();
+
+    header.generation = generation;
+    header.base = (base ? 1u : 0u);
+    header.rules = (m_ruleset != nullptr ? m_ruleset->getTable() : CellEvolver().getTable());
+    header.blockW = m_nodesDims.w();
+    header.blockH = m_nodesDims.h();
+    header.blocks = static_cast<std::uint32_t>(m_blocks.size());
+    header.freeBlocks = static_cast<std::uint32_t>(m_freeBlocks.size());
+    header.liveBlocks = m_liveBlocks;
+    header.dirty = static_cast<std::uint32_t>(dirty.size());
+
+    header.totalArea[0] = m_totalArea.x();
+    header.totalArea[1] = m_totalArea.y();
+    header.totalArea[2] = m_totalArea.w();
+    header.totalArea[3] = m_totalArea.h();
+
+    header.liveArea[0] = m_liveArea.x();
+    header.liveArea[1] = m_liveArea.y();
+    header.liveArea[2] = m_liveArea.w();
+    header.liveArea[3] = m_liveArea.h();
+
+    const LogRecordLayout layout = CheckpointLog::computeLayout(header);
+    header.size = layout.size;
+
+    // The record is zero initialized so that the padding is deterministic.
+    record.assign(layout.size, 0);
+    char* data = record.data();
+
+    std::memcpy(data, &header, sizeof(LogRecordHeader));
+
+    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
+      BlockRecord r = toRecord(m_blocks[id]);
+      std::memcpy(data + layout.blocks + id * sizeof(BlockRecord), &r, sizeof(BlockRecord));
+    }
+
+    std::memcpy(data + layout.free, m_freeBlocks.data(), m_freeBlocks.size() * sizeof(std::uint32_t));
+    std::memcpy(data + layout.dirty, dirty.data(), dirty.size() * sizeof(std::uint32_t));
+
+    const unsigned area = sizeOfBlock();
+
+    const State* states = nullptr;
+    const unsigned* adjacency = nullptr;
+    const int* ages = nullptr;
+    BlockCells buffer;
+
+    for (unsigned id = 0u ; id < dirty.size() ; ++id) {
+      readBlock(m_blocks[dirty[id]], states, adjacency, ages, buffer);
+
+      std::uint8_t* cells = reinterpret_cast<std::uint8_t*>(data + layout.cells + id * layout.stride);
+
+      for (unsigned cell = 0u ; cell < area ; ++cell) {
+        cells[cell] = (states[cell] == State::Alive ? 1u : 0u);
+        cells[area + cell] = static_cast<std::uint8_t>(adjacency[cell]);
+      }
+
+      std::memcpy(cells + 2u * area, ages, area * sizeof(std::int32_t));
+    }
+
+    std::memcpy(data + layout.size - sizeof(std::uint64_t), &layout.size, sizeof(std::uint64_t));
+
+    // The next record only needs the blocks modified from now on.
+    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
+      m_blocks[id].dirty = false;
+    }
+  }
+
+  unsigned
+  CellsBlocks::replay(const CheckpointReplay& log) {
+    const std::vector<const LogRecordHeader*>& records = log.getRecords();
+    const LogRecordHeader& last = *records.back();
+
+    const std::uint64_t area = static_cast<std::uint64_t>(last.blockW) * last.blockH;
+
+    // Verify the records and find the last record saving each block
+    // before modifying anything. The log might have been produced by
+    // a colony with more blocks at some point so the number of blocks
+    // is the largest one of all the records.
+    std::uint32_t blocks = 0u;
+    for (unsigned id = 0u ; id < records.size() ; ++id) {
+      blocks = std::max(blocks, records[id]->blocks);
+    }
+
+    std::vector<int> sources(blocks, -1);
+
+    for (unsigned id = 0u ; id < records.size() ; ++id) {
+      const LogRecordHeader& header = *records[id];
+      const LogRecordLayout layout = CheckpointLog::computeLayout(header);
+      const char* data = reinterpret_cast<const char*>(records[id]);
+
+      validateRecords(
+        reinterpret_cast<const BlockRecord*>(data + layout.blocks),
+        header.blocks,
+        area,
+        reinterpret_cast<const std::uint32_t*>(data + layout.free),
+        header.freeBlocks,
+        "Could not replay checkpoint log"
+      );
+
+      const std::uint32_t* dirty = reinterpret_cast<const std::uint32_t*>(data + layout.dirty);
+      for (unsigned block = 0u ; block < header.dirty ; ++block) {
+        if (dirty[block] >= header.blocks) {
+          error(
+            std::string("Could not replay checkpoint log"),
+            std::string("Invalid saved block ") + std::to_string(dirty[block]) +
+            " in record at generation " + std::to_string(header.generation)
+          );
+        }
+
+        sources[dirty[block]] = static_cast<int>(id);
+      }
+    }
+
+    const LogRecordLayout lastLayout = CheckpointLog::computeLayout(last);
+    const BlockRecord* lastBlocks = reinterpret_cast<const BlockRecord*>(reinterpret_cast<const char*>(&last) + lastLayout.blocks);
+
+    for (unsigned id = 0u ; id < last.blocks ; ++id) {
+      if (lastBlocks[id].active != 0u && sources[id] < 0) {
+        error(
+          std::string("Could not replay checkpoint log"),
+          std::string("Block ") + std::to_string(id) + " is not saved in the log"
+        );
+      }
+    }
+
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    m_nodesDims = utils::Sizei(last.blockW, last.blockH);
+    m_ruleset = CellEvolver::fromTable(last.rules);
+
+    const std::size_t cells = static_cast<std::size_t>(last.blocks * area);
+
+    m_states.assign(cells, State::Dead);
+    m_adjacency.assign(cells, 0u);
+    m_ages.assign(cells, 0);
+
+    // Only the last saved version of each active block is copied.
+    for (unsigned id = 0u ; id < last.blocks ; ++id) {
+      if (lastBlocks[id].active == 0u) {
+        continue;
+      }
+
+      const LogRecordHeader& header = *records[sources[id]];
+      const LogRecordLayout layout = CheckpointLog::computeLayout(header);
+      const char* data = reinterpret_cast<const char*>(&header);
+
+      const std::uint32_t* dirty = reinterpret_cast<const std::uint32_t*>(data + layout.dirty);
+      const std::uint32_t* slot = std::lower_bound(dirty, dirty + header.dirty, id);
+
+      const std::uint8_t* saved = reinterpret_cast<const std::uint8_t*>(
+        data + layout.cells + (slot - dirty) * layout.stride
+      );
+
+      const std::size_t start = id * area;
+
+      for (unsigned cell = 0u ; cell < area ; ++cell) {
+        m_states[start + cell] = (saved[cell] != 0u ? State::Alive : State::Dead);
+        m_adjacency[start + cell] = saved[area + cell];
+      }
+
+      std::memcpy(m_ages.data() + start, saved + 2u * area, area * sizeof(std::int32_t));
+
+      // The block did not change since it was saved: its live cells only
+      // got older.
+      const int elapsed = static_cast<int>(last.generation - header.generation);
+
+      if (elapsed > 0) {
+        for (unsigned cell = 0u ; cell < area ; ++cell) {
+          if (m_states[start + cell] == State::Alive) {
+            m_ages[start + cell] += elapsed;
+          }
+        }
+      }
+    }
+
+    m_nextStates.assign(cells, State::Dead);
+    m_nextAdjacency.assign(cells, 0u);
+    m_nextAges.assign(cells, 0);
+
+    m_blocks.clear();
+    m_blocks.reserve(last.blocks);
+    m_blocksIndex.clear();
+
+    unsigned alive = 0u;
+
+    for (unsigned id = 0u ; id < last.blocks ; ++id) {
+      BlockDesc b = fromRecord(lastBlocks[id]);
+      m_blocks.push_back(b);
+
+      if (b.active) {
+        m_blocksIndex[hashCoordinate(b.area.getCenter())] = b.id;
+        alive += b.alive;
+      }
+    }
+
+    const std::uint32_t* free = reinterpret_cast<const std::uint32_t*>(reinterpret_cast<const char*>(&last) + lastLayout.free);
+
+    m_freeBlocks.assign(free, free + last.freeBlocks);
+    m_liveBlocks = last.liveBlocks;
+
+    // The cells of the inactive blocks can be reused.
+    m_coldBlocks.clear();
+    m_freeSlots.clear();
+    for (unsigned id = 0u ; id < m_freeBlocks.size() ; ++id) {
+      m_freeSlots.push_back(m_blocks[m_freeBlocks[id]].start);
+    }
+
+    m_totalArea = utils::Boxi(last.totalArea[0], last.totalArea[1], last.totalArea[2], last.totalArea[3]);
+    m_liveArea = utils::Boxf(last.liveArea[0], last.liveArea[1], last.liveArea[2], last.liveArea[3]);
+
+    return alive;
+  }
+
+  void
+  CellsBlocks::setColdThreshold(unsigned generations) {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    m_coldThreshold = generations;
+
+    if (m_coldThreshold == 0u) {
+      thawAll();
+    }
+  }
+
+  CellsBlocks::Storage
+  CellsBlocks::getStorage() {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    Storage out{m_liveBlocks, static_cast<unsigned>(m_coldBlocks.size()), m_states.size(), 0u};
+
+    for (const std::pair<const unsigned, ColdBlock>& cold : m_coldBlocks) {
+      out.compressed += cold.second.data.size() + cold.second.edges.size() * sizeof(unsigned);
+    }
+
+    return out;
+  }
+
+  void
+  CellsBlocks::validateRecords(const BlockRecord* records,
+                               unsigned blocks,
+                               std::uint64_t area,
+                               const std::uint32_t* free,
+                               unsigned freeBlocks,
+                               const std::string& context)
+  {
+    for (unsigned id = 0u ; id < blocks ; ++id) {
+      const BlockRecord& r = records[id];
+
+      bool valid = (r.id == id && r.start == id * area && r.end == r.start + area);
+      for (unsigned link = 0u ; link < 8u && valid ; ++link) {
+        valid = (r.links[link] >= -1 && r.links[link] < static_cast<std::int32_t>(blocks));
+      }
+
+      if (!valid) {
+        error(
+          context,
+          std::string("Invalid description for block ") + std::to_string(id)
+        );
+      }
+    }
+
+    for (unsigned id = 0u ; id < freeBlocks ; ++id) {
+      if (free[id] >= blocks || records[free[id]].active != 0u) {
+        error(
+          context,
+          std::string("Invalid free block ") + std::to_string(free[id])
+        );
+      }
+    }
+  }
+
+  unsigned
+  CellsBlocks::spawn(const std::vector<utils::Vector2i>& cells,
+                     bool finalize)
+  {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    setCellsState(cells, State::Alive);
+
+    return (finalize ? consolidate() : 0u);
+  }
+
+  unsigned
+  CellsBlocks::apply(const std::vector<utils::Vector2i>& births,
+                     const std::vector<utils::Vector2i>& deaths)
   {
     // Protect from concurrent accesses.
     const std::lock_guard guard(m_propsLocker);
 
-    // We need to paint the brush at the specified coordinates.
-    // To do so we will traverse each cell of the brush and paint
-    // each one in the required block. If the block does not exist
-    // yet we should create it.
-    utils::Sizei size = brush.getSize();
+    setCellsState(deaths, State::Dead);
+    setCellsState(births, State::Alive);
 
-    int offX = size.w() / 2;
-    int offY = size.h() / 2;
+    return consolidate();
+  }
 
-    for (int y = 0 ; y < size.h() ; ++y) {
-      for (int x = 0 ; x < size.w() ; ++x) {
-        // Retrieve the state of the cell in the brush at the current
-        // coordinates: we will check it against the current state of
-        // the cell and make modifications if needed.
-        State s = brush.getStateAt(x, y);
+  void
+  CellsBlocks::copyLiveBlocks(std::vector<utils::Boxi>& areas,
+                              std::vector<std::uint8_t>& cells)
+  {
+    areas.clear();
+    cells.clear();
 
-        // Compute the absolute coordinates of the cell so that we can
-        // check against local data.
-        utils::Vector2i c(coord.x() - offX + x, coord.y() - offY + y);
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
 
-        // Search the cell among the registered blocks.
-        unsigned id = 0u;
-        bool found = false;
+    const State* states = nullptr;
+    const unsigned* adjacency = nullptr;
+    const int* ages = nullptr;
+    BlockCells buffer;
 
-        id = findBlock(c, found);
+    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
+      const BlockDesc& b = m_blocks[id];
 
-        // In case the block is not found, we need to allocate the
-        // block so that we can register the cell.
-        if (!found) {
-          // In order to allocate the block we need to compute its area.
-          // This can be computed by fetching any active block and using
-          // it as a reference frame to get information on the lattice
-          // on which blocks' centers are aligned.
-          if (m_liveBlocks == 0u) {
-            allocate(m_totalArea);
-          }
+      if (!b.active || b.alive == 0u) {
+        continue;
+      }
 
-          BlockDesc b = m_blocks[0u];
-          id = 0u;
-          while (id < m_blocks.size() && !found) {
-            if (m_blocks[id].active) {
-              b = m_blocks[id];
-              found = true;
-            }
+      areas.push_back(b.area);
 
-            if (!found) {
-              ++id;
-            }
-          }
+      readBlock(b, states, adjacency, ages, buffer);
 
-          if (!b.active) {
-            warn(
-              "Could not set cell " + std::to_string(x) + "x" + std::to_string(y) + " for brush \"" +
-              brush.getName() + "\", no valid block to register the cell"
-            );
+      for (unsigned cell = 0u ; cell < sizeOfBlock() ; ++cell) {
+        cells.push_back(states[cell] == State::Alive ? 1u : 0u);
+      }
+    }
+  }
 
-            continue;
-          }
+  int
+  CellsBlocks::locateBlock(const utils::Vector2i& c) {
+    // Search the cell among the registered blocks.
+    unsigned id = 0u;
+    bool found = false;
 
-          // Determine what would be the area of the block containing the
-          // current cell using the center of an existing block.
-          // We need to consolidate the compute center: indeed in the situation
-          // where for example `area.w() = 8`, `area.x() = 0` and `c.x() = -4`,
-          // we can get `offX = int(round((-4 - 0) / 8)) = int(round(-0.5)) = -1`
-          // while in fact the coordinate `-4` belongs to the cell `0`.
-          // To do so we introduce a threshold which offset slightly the pos
-          // we consider and allows to find the right coordinate.
-          // Typically in the example, the offset will be computed as below:
-          // `offX = int(round((-4 - 0 + 0.01) / 8)) = int(round(-0.49) = 0`.
-          // On the other hand, we also have:
-          // `offX = int(round((4 - 0 + 0.01) / 8)) = int(round(0.501)) = 1`.
-          // Note finally that in the case there were no valid blocks at all
-          // in the colony, we performed a `allocate` operation which has created
-          // some new blocks (the ones representing the `m_totalArea`): this can
-          // lead to creating some blocks that might contain the input `c` cell.
-          // If this is the case we shouldn't try to contain the block. Hence the
-          // test before creating the cell.
-          utils::Boxi area = b.area;
-
-          int offX = static_cast<int>(std::round(1.0f * (c.x() - area.x() + getThresholdForBlockSearch()) / area.w()));
-          int offY = static_cast<int>(std::round(1.0f * (c.y() - area.y() + getThresholdForBlockSearch()) / area.h()));
-
-          area.x() = area.x() + offX * area.w();
-          area.y() = area.y() + offY * area.h();
-
-          // Consistency check.
-          if (!area.contains(c) ||
-              c.x() >= area.getRightBound() ||
-              c.y() >= area.getTopBound())
-          {
-            warn("Could not determine area containing " + c.toString() + ", candidate " + area.toString() + " does not contain it");
+    id = findBlock(c, found);
 
-            // Discard this cell, better not correctly create the brush than crashing.
-            continue;
-          }
+    // In case the block is not found, we need to allocate the
+    // block so that we can register the cell.
+    if (!found) {
+      // In order to allocate the block we need to compute its area.
+      // This can be computed by fetching any active block and using
+      // it as a reference frame to get information on the lattice
+      // on which blocks' centers are aligned.
+      if (m_liveBlocks == 0u) {
+        allocate(m_totalArea);
+      }
 
-          // Allocate the block if needed. Indeed in case we `allocate`d the block to
-          // cover the `m_totalArea` we could have recreated a block containing the
-          // cell `c` in which case we don't want to create it again.
-          if (area != b.area) {
-            b = registerNewBlock(area);
-            id = b.id;
-          }
+      BlockDesc b = m_blocks[0u];
+      id = 0u;
+      while (id < m_blocks.size() && !found) {
+        if (m_blocks[id].active) {
+          b = m_blocks[id];
+          found = true;
         }
 
-        // Allocate boundaries for this block so that we are sure that we
-        // can update the adjacency. If the blocks are not needed we will
-        // perform a cleanup pass afterwards anyways.
-        allocateBoundary(id, true);
+        if (!found) {
+          ++id;
+        }
+      }
 
-        BlockDesc& b = m_blocks[id];
-
-        // Update the status of the cell: we want to create the cell
-        // and update the adjacency if the brush defines a `Alive`
-        // cell at this coordinate and kill any existing cell in the
-        // case of a `Dead` cell defined in the brush.
-        // In case the cell is already of the required state we don't
-        // do anything.
-        int dataID = indexFromCoord(b, c, true);
-
-        // Only make modifications if the current state of the cell
-        // is not what it should be.
-        if (m_states[dataID] != s) {
-          // Update the state.
-          m_states[dataID] = s;
-
-          // Update age of the cell.
-          m_ages[dataID] = (s == State::Alive ? 1 : 0);
-
-          // Update the adjacency.
-          utils::Vector2i lCoord(c.x() - b.area.getLeftBound(), c.y() - b.area.getBottomBound());
-          updateAdjacency(b, lCoord, true, s == State::Dead);
-
-          // One more cell has changed and we need to keep the number
-          // of alive cells for this block consistent.
-          if (s == State::Alive) {
-            ++b.alive;
-          }
-          else {
-            --b.alive;
-          }
+      if (!b.active) {
+        warn("Could not set cell " + c.toString() + ", no valid block to register the cell");
+
+        return -1;
+      }
+
+      // Determine what would be the area of the block containing the
+      // current cell using the center of an existing block.
+      // We need to consolidate the compute center: indeed in the situation
+      // where for example `area.w() = 8`, `area.x() = 0` and `c.x() = -4`,
+      // we can get `offX = int(round((-4 - 0) / 8)) = int(round(-0.5)) = -1`
+      // while in fact the coordinate `-4` belongs to the cell `0`.
+      // To do so we introduce a threshold which offset slightly the pos
+      // we consider and allows to find the right coordinate.
+      // Typically in the example, the offset will be computed as below:
+      // `offX = int(round((-4 - 0 + 0.01) / 8)) = int(round(-0.49) = 0`.
+      // On the other hand, we also have:
+      // `offX = int(round((4 - 0 + 0.01) / 8)) = int(round(0.501)) = 1`.
+      // Note finally that in the case there were no valid blocks at all
+      // in the colony, we performed a `allocate` operation which has created
+      // some new blocks (the ones representing the `m_totalArea`): this can
+      // lead to creating some blocks that might contain the input `c` cell.
+      // If this is the case we shouldn't try to contain the block. Hence the
+      // test before creating the cell.
+      utils::Boxi area = b.area;
+
+      int offX = static_cast<int>(std::round(1.0f * (c.x() - area.x() + getThresholdForBlockSearch()) / area.w()));
+      int offY = static_cast<int>(std::round(1.0f * (c.y() - area.y() + getThresholdForBlockSearch()) / area.h()));
+
+      area.x() = area.x() + offX * area.w();
+      area.y() = area.y() + offY * area.h();
+
+      // Consistency check.
+      if (!area.contains(c) ||
+          c.x() >= area.getRightBound() ||
+          c.y() >= area.getTopBound())
+      {
+        warn("Could not determine area containing " + c.toString() + ", candidate " + area.toString() + " does not contain it");
+
+        // Discard this cell, better not correctly create the brush than crashing.
+        return -1;
+      }
+
+      // Allocate the block if needed. Indeed in case we `allocate`d the block to
+      // cover the `m_totalArea` we could have recreated a block containing the
+      // cell `c` in which case we don't want to create it again.
+      if (area != b.area) {
+        b = registerNewBlock(area);
+        id = b.id;
+      }
+    }
+
+    return static_cast<int>(id);
+  }
+
+  void
+  CellsBlocks::setCellState(BlockDesc& b,
+                            const utils::Vector2i& c,
+                            State s)
+  {
+    // Update the status of the cell: we want to create the cell
+    // and update the adjacency if the state is `Alive` and kill
+    // any existing cell in the case of a `Dead` state.
+    // In case the cell is already of the required state we don't
+    // do anything.
+    // The block and its neighbors can't be modified while they are
+    // compressed.
+    wake(b);
+
+    int dataID = indexFromCoord(b, c, true);
+
+    // Only make modifications if the current state of the cell
+    // is not what it should be.
+    if (m_states[dataID] != s) {
+      // Update the state.
+      m_states[dataID] = s;
+
+      // The adjacency of the neighboring blocks might change as well.
+      markDirty(b);
+
+      // Update age of the cell.
+      m_ages[dataID] = (s == State::Alive ? 1 : 0);
+
+      // Update the adjacency.
+      utils::Vector2i lCoord(c.x() - b.area.getLeftBound(), c.y() - b.area.getBottomBound());
+      updateAdjacency(b, lCoord, true, s == State::Dead);
+
+      // One more cell has changed and we need to keep the number
+      // of alive cells for this block consistent.
+      if (s == State::Alive) {
+        ++b.alive;
+      }
+      else {
+        --b.alive;
+      }
 
-          // One more cell has changed in the block. Note that this might
-          // count some cells twice (in the case the block already existed
-          // and a previous step of the colony already changed this cell)
-          // but it's not a problem: indeed the change count is mostly a
-          // way to detect still blocks to speed up the processing so we
-          // can get away with a bit more change than really needed.
-          ++b.changed;
+      // One more cell has changed in the block. Note that this might
+      // count some cells twice (in the case the block already existed
+      // and a previous step of the colony already changed this cell)
+      // but it's not a problem: indeed the change count is mostly a
+      // way to detect still blocks to speed up the processing so we
+      // can get away with a bit more change than really needed.
+      ++b.changed;
+
+      // The adjacency of the neighboring blocks also changed in case
+      // the cell lies on the border of the block: they should not be
+      // considered still even though none of their cells changed or
+      // the births caused by the cell would be missed.
+      int dx = (lCoord.x() == 0 ? -1 : (lCoord.x() == b.area.w() - 1 ? 1 : 0));
+      int dy = (lCoord.y() == 0 ? -1 : (lCoord.y() == b.area.h() - 1 ? 1 : 0));
+
+      const int touched[3] = {
+        (dx < 0 ? b.west : (dx > 0 ? b.east : -1)),
+        (dy < 0 ? b.south : (dy > 0 ? b.north : -1)),
+        (dx == 0 || dy == 0 ? -1 : (dy < 0 ? (dx < 0 ? b.sw : b.se) : (dx < 0 ? b.nw : b.ne)))
+      };
+
+      for (unsigned id = 0u ; id < 3u ; ++id) {
+        if (touched[id] >= 0) {
+          ++m_blocks[touched[id]].changed;
         }
       }
     }
+  }
 
+  unsigned
+  CellsBlocks::consolidate() {
     unsigned alive = 0u;
 
     // Make a pass to verify that no blocks are left in an invalid state.
@@ -481,6 +1584,13 @@ namespace cellulator {
         continue;
       }
 
+      alive += m_blocks[id].alive;
+
+      // Cold blocks are never destroyed: their neighbors did not change.
+      if (m_blocks[id].cold) {
+        continue;
+      }
+
       // Destroy the block if needed, that is if it does not contain any
       // cells and no neighbors are registered.
       unsigned neighbors = std::accumulate(
@@ -489,8 +1599,6 @@ namespace cellulator {
         0u
       );
 
-      alive += m_blocks[id].alive;
-
       if (m_blocks[id].alive == 0u && neighbors == 0u) {
         destroyBlock(m_blocks[id].id);
       }
@@ -582,7 +1690,9 @@ namespace cellulator {
       newB = false;
     }
 
-    unsigned s = dataIDFromBlock(id);
+    // The cells of the block are not necessarily located at the index
+    // matching its identifier.
+    unsigned s = acquireSlot();
 
     BlockDesc block{
       id,
@@ -595,6 +1705,10 @@ namespace cellulator {
       0u,
       0u,
       0u,
+      0u,
+      true,
+      false,
+      0u,
 
       -1,
       -1,
@@ -607,26 +1721,6 @@ namespace cellulator {
       -1
     };
 
-    verbose(
-      "Created block " + std::to_string(id) + " for " + area.toString() +
-      " (range: " + std::to_string(block.start) + " - " + std::to_string(block.end) + ")"
-    );
-
-    // Allocate cells data if needed and reset the existing data.
-    if (newB) {
-      m_states.resize(block.end, State::Dead);
-      m_adjacency.resize(block.end, 0u);
-      m_ages.resize(block.end, 0);
-
-      m_nextStates.resize(block.end, State::Dead);
-      m_nextAdjacency.resize(block.end, 0u);
-    }
-    else {
-      std::fill(m_states.begin() + block.start, m_states.begin() + block.end, State::Dead);
-      std::fill(m_ages.begin() + block.start, m_ages.begin() + block.end, 0);
-      std::fill(m_adjacency.begin() + block.start, m_adjacency.begin() + block.end, 0u);
-      std::fill(m_nextAdjacency.begin() + block.start, m_nextAdjacency.begin() + block.end, 0u);
-    }
 
     // Register the block and return it.
     if (newB) {
@@ -664,6 +1758,42 @@ namespace cellulator {
     return block;
   }
 
+  void
+  CellsBlocks::setCellsState(const std::vector<utils::Vector2i>& cells,
+                             State s)
+  {
+    int id = -1;
+
+    for (unsigned cell = 0u ; cell < cells.size() ; ++cell) {
+      const utils::Vector2i& c = cells[cell];
+
+      // Cells usually come in rows so the block of the previous cell can
+      // often be reused: in this case its boundaries are already there.
+      if (id < 0 ||
+          c.x() < m_blocks[id].area.getLeftBound() || c.x() >= m_blocks[id].area.getRightBound() ||
+          c.y() < m_blocks[id].area.getBottomBound() || c.y() >= m_blocks[id].area.getTopBound())
+      {
+        // A cell outside of any block is already dead.
+        if (s == State::Dead) {
+          bool found = false;
+          unsigned bID = findBlock(c, found);
+          id = (found ? static_cast<int>(bID) : -1);
+        }
+        else {
+          id = locateBlock(c);
+        }
+
+        if (id < 0) {
+          continue;
+        }
+
+        allocateBoundary(id, true);
+      }
+
+      setCellState(m_blocks[id], c, s);
+    }
+  }
+
   bool
   CellsBlocks::destroyBlock(unsigned blockID) {
     // Check whether the speciifed block exists.
@@ -672,11 +1802,6 @@ namespace cellulator {
       return false;
     }
 
-    verbose(
-      "Destroying block " + std::to_string(blockID) +
-      " (internal: " + std::to_string(m_blocks[blockID].id) + ") spanning " +
-      m_blocks[blockID].area.toString()
-    );
 
     bool save = m_blocks[blockID].active;
     if (save) {
@@ -685,10 +1810,20 @@ namespace cellulator {
       m_blocks[blockID].active = false;
       m_freeBlocks.push_back(blockID);
 
+      // Release the cells of the block.
+      if (m_blocks[blockID].cold) {
+        m_coldBlocks.erase(blockID);
+        m_blocks[blockID].cold = false;
+      }
+      else {
+        m_freeSlots.push_back(m_blocks[blockID].start);
+      }
+
       // Deactivate some properties to be on the safe side.
       m_blocks[blockID].alive = 0u;
       m_blocks[blockID].nAlive = 0u;
       m_blocks[blockID].changed = 0u;
+      m_blocks[blockID].nChanged = 0u;
 
       // Finally unregister its key from the internal table.
       unsigned key = hashCoordinate(m_blocks[blockID].area.getCenter());
@@ -857,6 +1992,12 @@ namespace cellulator {
           continue;
         }
 
+        // The adjacency of cold blocks does not change: it is saved along
+        // with their cells.
+        if (toUse->cold) {
+          continue;
+        }
+
         if (makeCurrent) {
           if (erase) {
             --m_adjacency[indexFromCoord(*toUse, cell, false)];
@@ -879,16 +2020,20 @@ namespace cellulator {
 
   void
   CellsBlocks::makeRandom(BlockDesc& desc,
-                          float deadProb)
+                          float deadProb,
+                          std::minstd_rand& rng)
   {
     // Traverse the cells for this block and randomize each one.
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
     float prob = 0.0f;
 
     desc.nAlive = 0u;
     desc.changed = 0u;
 
+    markDirty(desc);
+
     for (unsigned id = desc.start ; id < desc.end ; ++id) {
-      prob = 1.0f * std::rand() / RAND_MAX;
+      prob = dist(rng);
 
       State s = State::Dead;
       if (prob >= deadProb) {
@@ -1094,7 +2239,6 @@ namespace cellulator {
 
     bool f = find(area, o);
     if (f) {
-      verbose("Linking " + m_blocks[o].area.toString() + " to north east of " + b.area.toString());
       b.ne = m_blocks[o].id;
       m_blocks[o].sw = b.id;
     }
@@ -1105,7 +2249,6 @@ namespace cellulator {
 
     f = find(area, o);
     if (f) {
-      verbose("Linking " + m_blocks[o].area.toString() + " to north of " + b.area.toString());
       b.north = m_blocks[o].id;
       m_blocks[o].south = b.id;
     }
@@ -1116,7 +2259,6 @@ namespace cellulator {
 
     f = find(area, o);
     if (f) {
-      verbose("Linking " + m_blocks[o].area.toString() + " to north west of " + b.area.toString());
       b.nw = m_blocks[o].id;
       m_blocks[o].se = b.id;
     }
@@ -1127,7 +2269,6 @@ namespace cellulator {
 
     f = find(area, o);
     if (f) {
-      verbose("Linking " + m_blocks[o].area.toString() + " to west of " + b.area.toString());
       b.west = m_blocks[o].id;
       m_blocks[o].east = b.id;
     }
@@ -1138,7 +2279,6 @@ namespace cellulator {
 
     f = find(area, o);
     if (f) {
-      verbose("Linking " + m_blocks[o].area.toString() + " to south west of " + b.area.toString());
       b.sw = m_blocks[o].id;
       m_blocks[o].ne = b.id;
     }
@@ -1149,7 +2289,6 @@ namespace cellulator {
 
     f = find(area, o);
     if (f) {
-      verbose("Linking " + m_blocks[o].area.toString() + " to south of " + b.area.toString());
       b.south = m_blocks[o].id;
       m_blocks[o].north = b.id;
     }
@@ -1160,7 +2299,6 @@ namespace cellulator {
 
     f = find(area, o);
     if (f) {
-      verbose("Linking " + m_blocks[o].area.toString() + " to south east of " + b.area.toString());
       b.se = m_blocks[o].id;
       m_blocks[o].nw = b.id;
     }
@@ -1171,7 +2309,6 @@ namespace cellulator {
 
     f = find(area, o);
     if (f) {
-      verbose("Linking " + m_blocks[o].area.toString() + " to east of " + b.area.toString());
       b.east = m_blocks[o].id;
       m_blocks[o].west = b.id;
     }
@@ -1186,93 +2323,430 @@ namespace cellulator {
 
     // North east.
     if (b.ne >= 0) {
-      verbose("Unlinking " + m_blocks[b.ne].area.toString() + " at north east from " + b.area.toString());
       m_blocks[b.ne].sw = -1;
       b.ne = -1;
     }
 
     // North.
     if (b.north >= 0) {
-      verbose("Unlinking " + m_blocks[b.ne].area.toString() + " at north from " + b.area.toString());
       m_blocks[b.north].south = -1;
       b.north = -1;
     }
 
     // North west.
     if (b.nw >= 0) {
-      verbose("Unlinking " + m_blocks[b.nw].area.toString() + " at north west from " + b.area.toString());
       m_blocks[b.nw].se = -1;
       b.nw = -1;
     }
 
     // West.
     if (b.west >= 0) {
-      verbose("Unlinking " + m_blocks[b.west].area.toString() + " at west from " + b.area.toString());
       m_blocks[b.west].east = -1;
       b.west = -1;
     }
 
     // South west.
     if (b.sw >= 0) {
-      verbose("Unlinking " + m_blocks[b.sw].area.toString() + " at south west from " + b.area.toString());
       m_blocks[b.sw].ne = -1;
       b.sw = -1;
     }
 
     // South.
     if (b.south >= 0) {
-      verbose("Unlinking " + m_blocks[b.south].area.toString() + " at south from " + b.area.toString());
       m_blocks[b.south].north = -1;
       b.south = -1;
     }
 
     // South east.
     if (b.se >= 0) {
-      verbose("Unlinking " + m_blocks[b.se].area.toString() + " at south east from " + b.area.toString());
       m_blocks[b.se].nw = -1;
       b.se = -1;
     }
 
     // East.
     if (b.east >= 0) {
-      verbose("Unlinking " + m_blocks[b.east].area.toString() + " at east from " + b.area.toString());
       m_blocks[b.east].west = -1;
       b.east = -1;
     }
   }
 
   unsigned
-  CellsBlocks::stepPrivate() {
+  CellsBlocks::acquireSlot() {
+    const unsigned area = sizeOfBlock();
+
+    // Reuse a free range if possible: it might contain the cells of a
+    // previous block.
+    if (!m_freeSlots.empty()) {
+      unsigned s = m_freeSlots.back();
+      m_freeSlots.pop_back();
+
+      std::fill(m_states.begin() + s, m_states.begin() + s + area, State::Dead);
+      std::fill(m_ages.begin() + s, m_ages.begin() + s + area, 0);
+      std::fill(m_adjacency.begin() + s, m_adjacency.begin() + s + area, 0u);
+      std::fill(m_nextAdjacency.begin() + s, m_nextAdjacency.begin() + s + area, 0u);
+
+      return s;
+    }
+
+    unsigned s = static_cast<unsigned>(m_states.size());
+
+    m_states.resize(s + area, State::Dead);
+    m_adjacency.resize(s + area, 0u);
+    m_ages.resize(s + area, 0);
+
+    m_nextStates.resize(s + area, State::Dead);
+    m_nextAdjacency.resize(s + area, 0u);
+    m_nextAges.resize(s + area, 0);
+
+    return s;
+  }
+
+  void
+  CellsBlocks::freeze(BlockDesc& b) {
+    if (b.cold) {
+      return;
+    }
+
+    const unsigned area = sizeOfBlock();
+    const int w = b.area.w();
+    const int h = b.area.h();
+
+    ColdBlock cold{std::vector<std::uint8_t>(), std::vector<unsigned>(), m_elapsed, {w, h, -1, -1}};
+
+    // Pack the states, 8 cells per byte.
+    std::vector<std::uint8_t> bytes((area + 7u) / 8u, 0u);
+
+    for (unsigned cell = 0u ; cell < area ; ++cell) {
+      if (m_states[b.start + cell] != State::Alive) {
+        continue;
+      }
+
+      bytes[cell / 8u] |= static_cast<std::uint8_t>(1u << (cell % 8u));
+
+      int x = static_cast<int>(cell) % w;
+      int y = static_cast<int>(cell) / w;
+
+      cold.bounds[0] = std::min(cold.bounds[0], x);
+      cold.bounds[1] = std::min(cold.bounds[1], y);
+      cold.bounds[2] = std::max(cold.bounds[2], x);
+      cold.bounds[3] = std::max(cold.bounds[3], y);
+
+      if (x == 0 || y == 0 || x == w - 1 || y == h - 1) {
+        cold.edges.push_back(cell);
+      }
+    }
+
+    appendRuns(bytes.data(), bytes.size(), cold.data);
+
+    // The adjacency is at most `8` so it fits in a byte.
+    bytes.resize(area);
+    for (unsigned cell = 0u ; cell < area ; ++cell) {
+      bytes[cell] = static_cast<std::uint8_t>(m_adjacency[b.start + cell]);
+    }
+
+    appendRuns(bytes.data(), bytes.size(), cold.data);
+
+    for (unsigned cell = 0u ; cell < area ; ++cell) {
+      if (m_states[b.start + cell] == State::Alive) {
+        appendVarint(static_cast<std::uint64_t>(std::max(m_ages[b.start + cell], 0)), cold.data);
+      }
+    }
+
+    cold.data.shrink_to_fit();
+    cold.edges.shrink_to_fit();
+
+    m_coldBlocks[b.id] = std::move(cold);
+    m_freeSlots.push_back(b.start);
+
+    b.cold = true;
+  }
+
+  void
+  CellsBlocks::thaw(BlockDesc& b) {
+    if (!b.cold) {
+      return;
+    }
+
+    unsigned s = acquireSlot();
+
+    BlockCells buffer;
+    const State* states = nullptr;
+    const unsigned* adjacency = nullptr;
+    const int* ages = nullptr;
+
+    readBlock(b, states, adjacency, ages, buffer);
+
+    std::copy(buffer.states.cbegin(), buffer.states.cend(), m_states.begin() + s);
+    std::copy(buffer.adjacency.cbegin(), buffer.adjacency.cend(), m_adjacency.begin() + s);
+    std::copy(buffer.ages.cbegin(), buffer.ages.cend(), m_ages.begin() + s);
+
+    m_coldBlocks.erase(b.id);
+
+    b.start = s;
+    b.end = s + sizeOfBlock();
+    b.cold = false;
+    b.quiet = 0u;
+  }
+
+  void
+  CellsBlocks::wake(BlockDesc& b) {
+    if (m_coldBlocks.empty()) {
+      return;
+    }
+
+    thaw(b);
+
+    const int neighbors[8] = {b.west, b.east, b.south, b.north, b.nw, b.ne, b.sw, b.se};
+
+    for (unsigned id = 0u ; id < 8u ; ++id) {
+      if (neighbors[id] >= 0) {
+        thaw(m_blocks[neighbors[id]]);
+      }
+    }
+  }
+
+  void
+  CellsBlocks::thawAll() {
+    for (unsigned id = 0u ; id < m_blocks.size() && !m_coldBlocks.empty() ; ++id) {
+      thaw(m_blocks[id]);
+    }
+  }
+
+  void
+  CellsBlocks::updateColdTier() {
+    // Flag the blocks which changed or have a neighbor which changed: the
+    // other blocks are calm and are only copied by the next evolution.
+    std::vector<char> near(m_blocks.size(), 0);
+
+    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
+      const BlockDesc& b = m_blocks[id];
+
+      if (!b.active || b.changed == 0u) {
+        continue;
+      }
+
+      const int neighbors[8] = {b.west, b.east, b.south, b.north, b.nw, b.ne, b.sw, b.se};
+
+      near[id] = 1;
+      for (unsigned n = 0u ; n < 8u ; ++n) {
+        if (neighbors[n] >= 0) {
+          near[neighbors[n]] = 1;
+        }
+      }
+    }
+
+    bool frozen = false;
+
+    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
+      BlockDesc& b = m_blocks[id];
+
+      if (!b.active) {
+        continue;
+      }
+
+      bool calm = (near[id] == 0);
+
+      if (b.cold && !calm) {
+        thaw(b);
+        continue;
+      }
+
+      // The live cells on the border of a cold block are scattered to the
+      // neighbors at each step so they should all exist.
+      bool complete = (
+        b.east >= 0 && b.west >= 0 && b.south >= 0 && b.north >= 0 &&
+        b.ne >= 0 && b.nw >= 0 && b.se >= 0 && b.sw >= 0
+      );
+
+      if (!b.cold && calm && m_coldThreshold > 0u && b.quiet >= m_coldThreshold && (b.alive == 0u || complete)) {
+        freeze(b);
+        frozen = true;
+      }
+    }
+
+    if (frozen) {
+      compactSlots();
+    }
+  }
+
+  void
+  CellsBlocks::compactSlots() {
+    const unsigned area = sizeOfBlock();
+    const std::size_t slots = m_states.size() / area;
+
+    // Only compact when a significant part of the arrays is unused, so
+    // that the memory is not reallocated too often.
+    if (m_freeSlots.size() * 2u <= slots) {
+      return;
+    }
+
+    const unsigned used = static_cast<unsigned>(slots - m_freeSlots.size());
+
+    // The free ranges located before the end of the compacted arrays
+    // receive the blocks located after it.
+    std::vector<unsigned> targets;
+    for (unsigned id = 0u ; id < m_freeSlots.size() ; ++id) {
+      if (m_freeSlots[id] < used * area) {
+        targets.push_back(m_freeSlots[id]);
+      }
+    }
+
+    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
+      BlockDesc& b = m_blocks[id];
+
+      if (!b.active || b.cold || b.start < used * area) {
+        continue;
+      }
+
+      unsigned s = targets.back();
+      targets.pop_back();
+
+      std::copy(m_states.begin() + b.start, m_states.begin() + b.end, m_states.begin() + s);
+      std::copy(m_adjacency.begin() + b.start, m_adjacency.begin() + b.end, m_adjacency.begin() + s);
+      std::copy(m_ages.begin() + b.start, m_ages.begin() + b.end, m_ages.begin() + s);
+      std::copy(m_nextAdjacency.begin() + b.start, m_nextAdjacency.begin() + b.end, m_nextAdjacency.begin() + s);
+
+      b.start = s;
+      b.end = s + area;
+    }
+
+    m_freeSlots.clear();
+
+    m_states.resize(used * area);
+    m_adjacency.resize(used * area);
+    m_ages.resize(used * area);
+    m_nextStates.resize(used * area);
+    m_nextAdjacency.resize(used * area);
+    m_nextAges.resize(used * area);
+
+    m_states.shrink_to_fit();
+    m_adjacency.shrink_to_fit();
+    m_ages.shrink_to_fit();
+    m_nextStates.shrink_to_fit();
+    m_nextAdjacency.shrink_to_fit();
+    m_nextAges.shrink_to_fit();
+
+    verbose(
+      "Compacted cells to " + std::to_string(used) + " block(s) out of " + std::to_string(slots) +
+      ", " + std::to_string(m_coldBlocks.size()) + " cold block(s)"
+    );
+  }
+
+  void
+  CellsBlocks::readBlock(const BlockDesc& b,
+                         const State*& states,
+                         const unsigned*& adjacency,
+                         const int*& ages,
+                         BlockCells& buffer) const
+  {
+    if (!b.cold) {
+      states = m_states.data() + b.start;
+      adjacency = m_adjacency.data() + b.start;
+      ages = m_ages.data() + b.start;
+
+      return;
+    }
+
+    const ColdBlock& cold = m_coldBlocks.find(b.id)->second;
+    const unsigned area = sizeOfBlock();
+
+    buffer.states.resize(area);
+    buffer.adjacency.resize(area);
+    buffer.ages.resize(area);
+    buffer.bytes.resize(area);
+
+    const std::uint8_t* in = cold.data.data();
+    std::vector<std::uint8_t>& bytes = buffer.bytes;
+
+    // The states are packed as bits and the adjacency as bytes.
+    readRuns(in, bytes.data(), (area + 7u) / 8u);
+
+    for (unsigned cell = 0u ; cell < area ; ++cell) {
+      buffer.states[cell] = ((bytes[cell / 8u] >> (cell % 8u)) & 1u) != 0u ? State::Alive : State::Dead;
+    }
+
+    readRuns(in, bytes.data(), area);
+
+    // The live cells got older since the block was frozen.
+    const int elapsed = static_cast<int>(m_elapsed - cold.since);
+
+    for (unsigned cell = 0u ; cell < area ; ++cell) {
+      buffer.adjacency[cell] = bytes[cell];
+      buffer.ages[cell] = (buffer.states[cell] == State::Alive ? static_cast<int>(readVarint(in)) + elapsed : 0);
+    }
+
+    states = buffer.states.data();
+    adjacency = buffer.adjacency.data();
+    ages = buffer.ages.data();
+  }
+
+  unsigned
+  CellsBlocks::stepPrivate(unsigned generations) {
     // We first need to evolve all the cells to their next state. This is
     // achieved by swapping the internal vectors, which is cheap and fast.
     m_states.swap(m_nextStates);
+    m_elapsed += generations;
+
+    // The live cells on the border of cold blocks were not scattered to
+    // the adjacency of their neighbors during the evolution. This is not
+    // needed when evolving several generations at once as the adjacency
+    // of the blocks is then computed from their halo.
+    if (generations == 1u) {
+      for (const std::pair<const unsigned, ColdBlock>& cold : m_coldBlocks) {
+        const BlockDesc& b = m_blocks[cold.first];
+
+        for (unsigned id = 0u ; id < cold.second.edges.size() ; ++id) {
+          updateAdjacency(b, coordFromIndex(b, b.start + cold.second.edges[id], false), false);
+        }
+      }
+    }
 
     // Update change count: this is computed by checking whether at least
     // one adjacency value has been updated.
     for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
-      // Only handle active blocks.
-      if (!m_blocks[id].active) {
+      // Only handle active blocks: cold blocks do not change.
+      if (!m_blocks[id].active || m_blocks[id].cold) {
         continue;
       }
 
-      // Update change count: this is computed by checking whether at least
-      // an adjacency value has been updated.
-      m_blocks[id].changed = 0u;
+      // In case the blocks were evolved over several generations, the
+      // adjacency only reflects the difference with the generation we
+      // started from. The count of changes was computed for the last
+      // generation during the evolution so we can use it directly.
+      if (generations > 1u) {
+        m_blocks[id].changed = m_blocks[id].nChanged;
+      }
+      else {
+        // Update change count: this is computed by checking whether at least
+        // an adjacency value has been updated.
+        m_blocks[id].changed = 0u;
 
-      for (unsigned cell = m_blocks[id].start ; cell < m_blocks[id].end ; ++cell) {
-        if (m_adjacency[cell] != m_nextAdjacency[cell]) {
-          ++m_blocks[id].changed;
+        for (unsigned cell = m_blocks[id].start ; cell < m_blocks[id].end ; ++cell) {
+          if (m_adjacency[cell] != m_nextAdjacency[cell]) {
+            ++m_blocks[id].changed;
+          }
         }
+
+        m_blocks[id].dirty = m_blocks[id].dirty || m_blocks[id].changed > 0u;
       }
 
+      // Keep track of the blocks which did not change for a while: they
+      // are candidates for the cold tier.
+      m_blocks[id].quiet = (m_blocks[id].changed == 0u ? m_blocks[id].quiet + generations : 0u);
     }
 
     // Swap the adjacencies now that we're done checking for differences.
     m_adjacency.swap(m_nextAdjacency);
     std::fill(m_nextAdjacency.begin(), m_nextAdjacency.end(), 0u);
 
-    // Update cells' age.
-    updateCellsAge();
+    // Update cells' age: when evolving several generations at once the
+    // ages were already computed during the evolution.
+    if (generations > 1u) {
+      m_ages.swap(m_nextAges);
+    }
+    else {
+      updateCellsAge();
+    }
 
     // Now we need to update the alive count for each block.
     unsigned alive = 0u;
@@ -1286,6 +2760,11 @@ namespace cellulator {
       m_blocks[id].alive = m_blocks[id].nAlive;
       alive += m_blocks[id].alive;
 
+      // Cold blocks are never destroyed: their neighbors did not change.
+      if (m_blocks[id].cold) {
+        continue;
+      }
+
       unsigned neighbors = std::accumulate(
         m_adjacency.begin() + m_blocks[id].start,
         m_adjacency.begin() + m_blocks[id].end,
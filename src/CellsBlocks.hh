@@ -2,8 +2,12 @@
 # define   CELLS_BLOCKS_HH
 
 # include <mutex>
+# include <atomic>
 # include <memory>
 # include <vector>
+# include <random>
+# include <cstdint>
+# include <functional>
 # include <unordered_map>
 # include <core_utils/CoreObject.hh>
 # include <maths_utils/Box.hh>
@@ -11,6 +15,8 @@
 # include <maths_utils/Vector2.hh>
 # include "CellEvolver.hh"
 # include "CellBrush.hh"
+# include "Checkpoint.hh"
+# include "CheckpointReplay.hh"
 
 namespace cellulator {
 
@@ -22,15 +28,37 @@ namespace cellulator {
     Alive
   };
 
-  // Forward declaration to be able to use a shared pointer on a colony tile
-  // right away.
-  class ColonyTile;
-  using ColonyTileShPtr = std::shared_ptr<ColonyTile>;
+  /**
+   * @brief - Define the orientations in which a brush can be painted. The
+   *          rotations are counter-clockwise and the flips mirror the brush
+   *          along the corresponding axis. The transpositions exchange the
+   *          `x` and `y` axes, either along the main or the anti diagonal.
+   */
+  enum class BrushOrientation {
+    Identity,
+    Rotate90,
+    Rotate180,
+    Rotate270,
+    FlipX,
+    FlipY,
+    Transpose,
+    AntiTranspose
+  };
+
+  /**
+   * @brief - Callback receiving a batch of cells, used to process the cells
+   *          of a colony or of a pattern without gathering all of them.
+   */
+  using CellsVisitor = std::function<void(const std::vector<utils::Vector2i>&)>;
 
   // Forward declaration of the `CellBrush` class as it also includes this
   // file for the `State` declaration.
   class CellBrush;
 
+  // Forward declaration of the class used by the microbenchmarks to access
+  // the internal primitives of the blocks.
+  class CellsBlocksProbe;
+
   class CellsBlocks: public utils::CoreObject {
     public:
 
@@ -81,24 +109,51 @@ namespace cellulator {
       unsigned
       randomize();
 
+      /**
+       * @brief - Used to bring the blocks back to the state they were in right after the
+       *          call to `allocateTo`: all the blocks are removed and the initial area is
+       *          allocated again with dead cells. The memory used by the cells is kept
+       *          so that no allocation is needed when the blocks are filled again.
+       */
+      void
+      reset();
+
+      /**
+       * @brief - Similar to `randomize` but allows to control the probability for a
+       *          cell to be dead and the seed used to generate the states, so that
+       *          the process is reproducible.
+       * @param deadProb - the probability to generate a dead cell.
+       * @param seed - the seed of the random generator.
+       * @return - the number of live cells created during the process.
+       */
+      unsigned
+      randomize(float deadProb,
+                unsigned seed);
+
       /**
        * @brief - Wrapper to the internal `stepPrivate` method. ALlows for external elements
        *          to trigger the next step of the colony. Basically just acquire the internal
        *          locker and transmit the call to `stepPrivate`.
+       * @param generations - the number of generations each block has been evolved with
+       *                      since the last step. Should match the value provided to the
+       *                      `evolve` method.
        * @return - the number of alive cells at the current generation.
        */
       unsigned
-      step();
+      step(unsigned generations = 1u);
 
       /**
        * @brief - Used to generate a schedule of all the blocks currently registered in this
-       *          object and wrap them in the input vector as `ColonyTile`s. This can then
-       *          be used for example to perform the evolution of the colony.
-       *          Note that no nodes are created nor destroyed during this operation.
-       * @param tiles - the output vector to use to register the tiles.
+       *          object and register their indices in the input vector. Each index can then
+       *          be used with the `evolve` method, for example to perform the evolution of
+       *          the colony.
+       *          Note that no nodes are created nor destroyed during this operation. If the
+       *          output vector is empty it means that no block is active anymore: nothing
+       *          will change in the colony unless some cells are added.
+       * @param blocks - the output vector to use to register the blocks' indices.
        */
       void
-      generateSchedule(std::vector<ColonyTileShPtr>& tiles);
+      generateSchedule(std::vector<unsigned>& blocks);
 
       /**
        * @brief - Used to perform the evolution of the block represetned by the input index.
@@ -108,10 +163,43 @@ namespace cellulator {
        *          Note that the state is not actually applied in order to allow other blocks
        *          to get evolved: this only happens upon calling the `step` method which will
        *          evolve all the blocks at once.
+       *          The block can be evolved several generations at once: in this case a halo
+       *          of cells is copied from the neighboring blocks and evolved along with the
+       *          block so that the result is identical to evolving it one generation at a
+       *          time. All the blocks of a schedule should be evolved with the same number
+       *          of generations, which cannot exceed `getMaxGenerationsPerEvolution`.
+       *          The evolution can be interrupted through the input flag which is polled
+       *          regularly: in this case the next state of the block is inconsistent and
+       *          the generation should be discarded with `rollback`. The current state of
+       *          the block is never modified by this method.
        * @param blockID - the index of the block to evolve.
+       * @param generations - the number of generations to evolve the block with.
+       * @param interrupt - a flag indicating that the evolution should be interrupted as
+       *                    soon as possible. Ignored if `null`.
+       * @return - `true` if the block was evolved and `false` if it was interrupted.
+       */
+      bool
+      evolve(unsigned blockID,
+             unsigned generations = 1u,
+             const std::atomic<bool>* interrupt = nullptr);
+
+      /**
+       * @brief - Used to discard the partial results of the evolution of the blocks since
+       *          the last call to `step`. This is typically used when the evolution of the
+       *          blocks was interrupted. The colony is left in the state of the last step.
+       *          Note that it should not be called while blocks are being evolved.
        */
       void
-      evolve(unsigned blockID);
+      rollback();
+
+      /**
+       * @brief - Used to retrieve the maximum number of generations that can be simulated
+       *          in a single call to `evolve`. This is bounded by the dimensions of blocks
+       *          as we need the halo to be entirely contained in the neighboring blocks.
+       * @return - the maximum number of generations for a single evolution.
+       */
+      unsigned
+      getMaxGenerationsPerEvolution() const noexcept;
 
       /**
        * @brief - Used to retrieve the current live area for this object. This encompasses any
@@ -134,6 +222,26 @@ namespace cellulator {
       std::pair<State, int>
       getCellStatus(const utils::Vector2i& coord);
 
+      /**
+       * @brief - Used to retrieve the coordinates of all the live cells registered in
+       *          the blocks. The order of the cells is not specified. This is mostly
+       *          meant to compare the content of the colony with other engines.
+       * @param cells - output vector receiving the coordinates of the live cells.
+       */
+      void
+      getLiveCells(std::vector<utils::Vector2i>& cells);
+
+      /**
+       * @brief - Similar to `getLiveCells` but provides the live cells block by block
+       *          to the visitor, so that the memory needed does not depend on the size
+       *          of the colony. The visitor is not called for blocks without any live
+       *          cell. Note that the blocks are locked during the whole traversal so
+       *          the visitor should not access them.
+       * @param visitor - the callback receiving the live cells of each block.
+       */
+      void
+      visitLiveCells(const CellsVisitor& visitor);
+
       /**
        * @brief - Used to retrieve the cells from the area described in input into the specified
        *          vector. Internal blocks will be scanned for any matching the corresponding area
@@ -160,24 +268,171 @@ namespace cellulator {
       void
       setRuleset(CellEvolverShPtr ruleset);
 
+      /**
+       * @brief - Retrieve the ruleset used to evolve the cells.
+       * @return - the current ruleset, may be `null` if none was provided.
+       */
+      CellEvolverShPtr
+      getRuleset();
+
       /**
        * @brief - Used to paint the input `brush` on this blocks of cells. The area covered by the
-       *          brush is scanned in order to add the required cells. If blocks need to be created
-       *          to accomodate with the brush they are.
+       *          brush is processed one block at a time: the rows of the brush overlapping the
+       *          block are stamped as bits and compared to the cells of the block so that only
+       *          the cells which actually change are updated. Blocks are only created when the
+       *          brush brings some cells to life in them.
        *          The brush is not checked for validity so failure to guarantee that may cause some
        *          undefined behavior.
        *          Note that the modifications are applied to the current state of the colony so that
        *          it can be directly used when computing the next generation of cells.
        * @param brush - the brush to repaint.
        * @param coord - the position at which the brush should be repainted.
+       * @param orientation - the orientation in which the brush is painted.
        * @return - the number of alive cells in the colony after the paint operation.
        */
       unsigned
       paint(const CellBrush& brush,
-            const utils::Vector2i& coord);
+            const utils::Vector2i& coord,
+            const BrushOrientation& orientation = BrushOrientation::Identity);
+
+      /**
+       * @brief - Bulk version of `paint` bringing to life all the cells in argument. It
+       *          is much faster than painting the cells with a brush as no dead cells are
+       *          scanned, the block of the previous cell is reused when possible and the
+       *          blocks are only cleaned up once at the end of the operation.
+       *          When the cells are provided in several batches (typically when they are
+       *          streamed from a file) the cleanup can be skipped for all but the last
+       *          one by setting `finalize` to `false`.
+       * @param cells - the coordinates of the cells to bring to life.
+       * @param finalize - `true` if the blocks should be cleaned up after the cells
+       *                   have been created.
+       * @return - the number of alive cells in the colony after the operation, or `0`
+       *           if `finalize` is `false`.
+       */
+      unsigned
+      spawn(const std::vector<utils::Vector2i>& cells,
+            bool finalize = true);
+
+      /**
+       * @brief - Similar to `spawn` but also kills the cells listed in `deaths`. This
+       *          is used to apply the changes between two frames of a recording: the
+       *          deaths are applied before the births.
+       * @param births - the coordinates of the cells to bring to life.
+       * @param deaths - the coordinates of the cells to kill.
+       * @return - the number of alive cells in the colony after the operation.
+       */
+      unsigned
+      apply(const std::vector<utils::Vector2i>& births,
+            const std::vector<utils::Vector2i>& deaths);
+
+      /**
+       * @brief - Copy the states of the cells of all the blocks containing at least a
+       *          live cell. This is used to record the colony: the copy is cheap and
+       *          can then be processed without holding the locker of the blocks.
+       * @param areas - output argument receiving the area of each copied block.
+       * @param cells - output argument receiving the states of the cells of each copied
+       *                block one after the other, `1` for a live cell.
+       */
+      void
+      copyLiveBlocks(std::vector<utils::Boxi>& areas,
+                     std::vector<std::uint8_t>& cells);
+
+      /**
+       * @brief - Write the complete state of the blocks to the file in argument: the
+       *          description of the blocks, the states, adjacency and ages of their
+       *          cells and the ruleset. The layout of the file is the one of the
+       *          `Checkpoint` class so that it can be restored from a mapping of the
+       *          file without parsing anything.
+       *          An error is raised if the file can't be written.
+       * @param file - the name of the checkpoint file.
+       * @param generation - the generation of the colony, saved in the checkpoint.
+       */
+      void
+      checkpoint(const std::string& file,
+                 std::uint64_t generation);
+
+      /**
+       * @brief - Replace the state of the blocks with the one saved in the checkpoint
+       *          in argument. The dimensions of the blocks are also restored from the
+       *          checkpoint.
+       *          An error is raised if the checkpoint is not consistent, in which case
+       *          the blocks are not modified.
+       * @param checkpoint - the checkpoint to restore.
+       * @return - the number of alive cells after the operation.
+       */
+      unsigned
+      restore(const Checkpoint& checkpoint);
+
+      /**
+       * @brief - Produce a record for a checkpoint log describing the current state of
+       *          the blocks. Unless `base` is `true`, only the cells of the blocks which
+       *          were modified since the previous capture are saved in the record: the
+       *          other blocks can be rebuilt from the previous records of the log.
+       *          The layout of the record is described by `CheckpointLog`.
+       * @param record - output argument receiving the record.
+       * @param generation - the generation of the colony, saved in the record.
+       * @param base - `true` if the cells of all the active blocks should be saved.
+       */
+      void
+      capture(std::vector<char>& record,
+              std::uint64_t generation,
+              bool base);
+
+      /**
+       * @brief - Replace the state of the blocks with the one obtained by replaying the
+       *          records of the log in argument: the cells of each block are the ones
+       *          from the last record where the block was saved, and the description
+       *          of the blocks is the one of the last record.
+       *          An error is raised if the records are not consistent, in which case
+       *          the blocks are not modified.
+       * @param log - the checkpoint log to replay.
+       * @return - the number of alive cells after the operation.
+       */
+      unsigned
+      replay(const CheckpointReplay& log);
+
+      /**
+       * @brief - Define the number of generations after which a block which did not
+       *          change is moved to the cold tier: its cells are compressed and the
+       *          memory they used is made available to other blocks. Long runs are
+       *          usually dominated by still life forms which can be stored this way
+       *          in a fraction of the memory.
+       *          A cold block is transparently inflated again when a change happens
+       *          close enough to reach it, or when its cells are modified. Reading
+       *          its cells (for example through `fetchCells`) decodes them without
+       *          inflating the block.
+       *          A value of `0` disables the cold tier and inflates all the blocks.
+       * @param generations - the number of generations without changes needed for a
+       *                      block to be compressed.
+       */
+      void
+      setColdThreshold(unsigned generations);
+
+      /**
+       * @brief - Convenience structure describing the memory used by the blocks.
+       */
+      struct Storage {
+        unsigned blocks;          //< The number of active blocks.
+        unsigned cold;            //< The number of blocks in the cold tier.
+        std::size_t cells;        //< The number of cells allocated in the arrays.
+        std::size_t compressed;   //< The number of bytes used by the cold blocks.
+      };
+
+      /**
+       * @brief - Retrieve the memory used by the blocks.
+       * @return - the description of the storage of the blocks.
+       */
+      Storage
+      getStorage();
 
     private:
 
+      /**
+       * @brief - Allows the microbenchmarks to measure the internal primitives
+       *          used to manage the blocks without making them public.
+       */
+      friend class CellsBlocksProbe;
+
       /**
        * @brief - Describe a cell block with all its associated properties. Note that we
        *          have convenience attributes which can speed up the access and fetching
@@ -202,6 +457,16 @@ namespace cellulator {
         unsigned changed; //< The number of cells which changed in the previous iteration.
                           //< If this value is `0` and `alive > 0` it means that only still
                           //< life forms are present in the block so we can skip it.
+        unsigned nChanged;//< The number of cells which changed during the last generation
+                          //< when the block is evolved over several generations at once.
+                          //< Becomes the `changed` value when the step is applied.
+        bool dirty;       //< `true` if the cells or the adjacency of the block changed
+                          //< since the last capture of the blocks in a checkpoint log.
+        bool cold;        //< `true` if the cells of the block are compressed in the cold
+                          //< tier: the block does not own any cells in the arrays and
+                          //< the `start` and `end` indices are meaningless.
+        unsigned quiet;   //< The number of generations since the last change of a cell
+                          //< of the block, used to move it to the cold tier.
 
         int west;         //< The index of the block directly on the left of this one.
                           //< The value is set to `-1` if the block does not exist.
@@ -291,8 +556,9 @@ namespace cellulator {
 
       /**
        * @brief - Used to retrieve the index at which the data for a block with the
-       *          specified index should begin in the internal vectors. This value
-       *          is usually stored directly in the block (see `start`).
+       *          specified index begins in checkpoint files. The cells of a block are
+       *          not necessarily located at this index in the internal vectors: the
+       *          actual value is stored directly in the block (see `start`).
        *          Note that the locker is assumed to be locked upon calling this
        *          method.
        * @param blockID - the index of the block for which the data index should be
@@ -387,6 +653,24 @@ namespace cellulator {
                       bool makeCurrent,
                       bool erase = false);
 
+      /**
+       * @brief - Used to perform the evolution of the block over several generations. A
+       *          local copy of the block along with a halo of `generations + 1` cells is
+       *          built from the neighboring blocks and evolved until the block's content
+       *          is known at the target generation. The extra layer of cells is used to
+       *          directly compute the next adjacency of the block rather than having to
+       *          update the neighboring blocks.
+       *          The next states, adjacency and ages of the block are updated.
+       * @param block - the block to evolve.
+       * @param generations - the number of generations to evolve the block with.
+       * @param interrupt - a flag polled after each generation to interrupt the process.
+       * @return - `true` if the block was evolved and `false` if it was interrupted.
+       */
+      bool
+      evolveMany(BlockDesc& block,
+                 unsigned generations,
+                 const std::atomic<bool>* interrupt);
+
       /**
        * @brief - Used to randomize the content of the block described in input. The
        *          cells composing this node will be assigned random state based on
@@ -397,10 +681,12 @@ namespace cellulator {
        * @param desc - the block description to be randomized.
        * @param deadProb - the probability to generate a dead cell. Should be in the
        *                   range `[0; 1]` but we don't check it.
+       * @param rng - the random generator to use.
        */
       void
       makeRandom(BlockDesc& desc,
-                 float deadProb);
+                 float deadProb,
+                 std::minstd_rand& rng);
 
       /**
        * @brief - Used to update the age of all the cells registered in the blocks.
@@ -478,6 +764,199 @@ namespace cellulator {
       findBlock(const utils::Vector2i& coord,
                 bool& found);
 
+      /**
+       * @brief - Similar to `findBlock` but creates the block containing the input
+       *          coordinate if it does not exist yet. The boundaries of the block are
+       *          not allocated. Note that the locker is assumed to already be acquired.
+       * @param c - the coordinate that should be included in a block, expressed in the
+       *            real world coordinate frame.
+       * @return - the index of the block containing the coordinate or a negative value
+       *           if no block could be created.
+       */
+      int
+      locateBlock(const utils::Vector2i& c);
+
+      /**
+       * @brief - Used to flag the block in argument and its neighbors as modified since
+       *          the last capture in a checkpoint log: changing a cell of a block also
+       *          modifies the adjacency of the cells of the neighboring blocks.
+       * @param b - the block which is modified.
+       */
+      void
+      markDirty(const BlockDesc& b) noexcept;
+
+      /**
+       * @brief - Convert the description of a block to the representation used in the
+       *          checkpoint files. The cells of the blocks are saved in the order of
+       *          their identifiers whatever their location in the internal arrays.
+       * @param b - the block to convert.
+       * @return - the record describing the block.
+       */
+      BlockRecord
+      toRecord(const BlockDesc& b) const noexcept;
+
+      /**
+       * @brief - Convert a record read from a checkpoint file to the description of a
+       *          block. The block is flagged as modified.
+       * @param r - the record to convert.
+       * @return - the description of the block.
+       */
+      static
+      BlockDesc
+      fromRecord(const BlockRecord& r) noexcept;
+
+      /**
+       * @brief - Verify that the records of blocks and the list of free blocks read from
+       *          a checkpoint file reference valid cells and blocks. An error is raised
+       *          if this is not the case.
+       * @param records - the records of the blocks.
+       * @param blocks - the number of records.
+       * @param area - the number of cells of a block.
+       * @param free - the indices of the free blocks.
+       * @param freeBlocks - the number of free blocks.
+       * @param context - a description of the operation, used to report errors.
+       */
+      void
+      validateRecords(const BlockRecord* records,
+                      unsigned blocks,
+                      std::uint64_t area,
+                      const std::uint32_t* free,
+                      unsigned freeBlocks,
+                      const std::string& context);
+
+      /**
+       * @brief - Used to change the state of a single cell of a block and to update the
+       *          adjacency and the counters of the block accordingly. The boundaries of
+       *          the block are assumed to be allocated. Note that the locker is assumed
+       *          to already be acquired.
+       * @param b - the block containing the cell.
+       * @param c - the coordinate of the cell, expressed in the real world coordinate
+       *            frame.
+       * @param s - the new state of the cell.
+       */
+      void
+      setCellState(BlockDesc& b,
+                   const utils::Vector2i& c,
+                   State s);
+
+      /**
+       * @brief - Used to change the state of all the cells in argument. Blocks are only
+       *          created to bring cells to life and they are not cleaned up. Note that
+       *          the locker is assumed to already be acquired.
+       * @param cells - the coordinates of the cells to update.
+       * @param s - the new state of the cells.
+       */
+      void
+      setCellsState(const std::vector<utils::Vector2i>& cells,
+                    State s);
+
+      /**
+       * @brief - Used after some cells have been modified externally (through `paint`
+       *          or `spawn`) to destroy the blocks which became useless and to allocate
+       *          the boundaries which will be needed for the next generation. Note that
+       *          the locker is assumed to already be acquired.
+       * @return - the number of alive cells in the colony.
+       */
+      unsigned
+      consolidate();
+
+      /**
+       * @brief - Retrieve a free range of cells in the internal arrays, large enough
+       *          to hold a block. The arrays are expanded if no range is available.
+       *          The cells of the range are dead and have no neighbors.
+       * @return - the index of the first cell of the range.
+       */
+      unsigned
+      acquireSlot();
+
+      /**
+       * @brief - Compress the cells of the block in argument and release the range
+       *          of cells it used in the internal arrays. The states are bit-packed
+       *          and run-length encoded, the adjacency is run-length encoded and the
+       *          ages of the live cells are saved relatively to the current step so
+       *          that they can be updated when the block is inflated.
+       *          Nothing happens if the block is already cold.
+       * @param b - the block to compress.
+       */
+      void
+      freeze(BlockDesc& b);
+
+      /**
+       * @brief - Reverse operation of `freeze`: the cells of the block are decoded
+       *          into a range of the internal arrays. Nothing happens if the block
+       *          is not cold.
+       * @param b - the block to inflate.
+       */
+      void
+      thaw(BlockDesc& b);
+
+      /**
+       * @brief - Inflate the block in argument and its neighbors: this is needed
+       *          before modifying a cell as the adjacency of the neighbors is also
+       *          updated.
+       * @param b - the block about to be modified.
+       */
+      void
+      wake(BlockDesc& b);
+
+      /**
+       * @brief - Inflate all the cold blocks.
+       */
+      void
+      thawAll();
+
+      /**
+       * @brief - Move the blocks to and from the cold tier before an evolution. A
+       *          cold block is inflated as soon as it or one of its neighbors has
+       *          changed: this guarantees that the blocks next to a cold one are
+       *          only copied when evolving a single generation, and that a change
+       *          can't reach the cold block when evolving several generations at
+       *          once. Blocks which did not change for more than the threshold and
+       *          whose neighbors did not change are frozen.
+       *          When enough ranges of cells are free, the arrays are compacted.
+       */
+      void
+      updateColdTier();
+
+      /**
+       * @brief - Move the cells of the inflated blocks to the beginning of the
+       *          internal arrays and release the memory of the free ranges.
+       */
+      void
+      compactSlots();
+
+      /**
+       * @brief - Buffers receiving the decoded cells of a cold block. The bytes are
+       *          used to expand the runs of the compressed cells: keeping them here
+       *          allows to decode blocks without allocating once the buffers reach
+       *          the size of a block.
+       */
+      struct BlockCells {
+        std::vector<State> states;
+        std::vector<unsigned> adjacency;
+        std::vector<int> ages;
+        std::vector<std::uint8_t> bytes;
+      };
+
+      /**
+       * @brief - Retrieve the cells of a block, whether it is cold or not. In the
+       *          case of a cold block the cells are decoded in the buffers, which
+       *          are otherwise left untouched. The output pointers reference the
+       *          first cell of the block.
+       * @param b - the block to read.
+       * @param states - output argument receiving the states of the cells.
+       * @param adjacency - output argument receiving the adjacency of the cells.
+       * @param ages - output argument receiving the ages of the cells.
+       * @param buffer - storage used to decode the cells of a cold block. It can be
+       *                 reused from one call to the next to avoid allocations.
+       */
+      void
+      readBlock(const BlockDesc& b,
+                const State*& states,
+                const unsigned*& adjacency,
+                const int*& ages,
+                BlockCells& buffer) const;
+
       /**
        * @brief - Used to perform the necessary modification to the internal blocks so
        *          that the `from` node is related to its neighbors. We will scan the
@@ -510,13 +989,30 @@ namespace cellulator {
        *          the internal arrays representing the next step with the current one. We also
        *          need to perform the expansion of the colony in case some cells are now on the
        *          boundaries so that we can continue simulating them properly.
+       * @param generations - the number of generations the blocks have been evolved with.
        * @return - the number of alive cells at the current generation.
        */
       unsigned
-      stepPrivate();
+      stepPrivate(unsigned generations = 1u);
 
     private:
 
+      /**
+       * @brief - The cells of a block in the cold tier. The `data` holds, one after
+       *          the other, the bit-packed states of the cells and their adjacency
+       *          both run-length encoded, followed by the ages of the live cells.
+       */
+      struct ColdBlock {
+        std::vector<std::uint8_t> data;   //< The compressed cells.
+        std::vector<unsigned> edges;      //< The local index of the live cells on the
+                                          //< border of the block, which contribute to
+                                          //< the adjacency of the neighbors.
+        std::uint64_t since;              //< The value of `m_elapsed` when the block
+                                          //< was frozen.
+        int bounds[4];                    //< The local bounds of the live cells (min
+                                          //< and max along `x` and `y`).
+      };
+
       /**
        * @brief - Convenience typedef to be able to refer to a map storing a unique identifier
        *          for a coordinate and its associated position in the `m_blocksIndex` array.
@@ -599,6 +1095,13 @@ namespace cellulator {
        */
       std::vector<int> m_ages;
 
+      /**
+       * @brief - Similar to `m_nextAdjacency` but for the age of cells: it is only used when
+       *          blocks are evolved over several generations at once, in which case it holds
+       *          the age of the cells at the target generation.
+       */
+      std::vector<int> m_nextAges;
+
       /**
        * @brief - Holds a count of the number of active blocks currently registered in the
        *          object. When this value drops to `0` it means that there are no remaining
@@ -656,6 +1159,31 @@ namespace cellulator {
        *          fit to content operation needs to be performed.
        */
       utils::Boxf m_liveArea;
+
+      /**
+       * @brief - The ranges of cells of the internal arrays which are not used by any
+       *          block, described by the index of their first cell. These are reused
+       *          before expanding the arrays.
+       */
+      std::vector<unsigned> m_freeSlots;
+
+      /**
+       * @brief - The number of generations without changes after which a block moves
+       *          to the cold tier. `0` disables the cold tier.
+       */
+      unsigned m_coldThreshold;
+
+      /**
+       * @brief - The compressed cells of the blocks of the cold tier, indexed by the
+       *          identifier of the blocks.
+       */
+      std::unordered_map<unsigned, ColdBlock> m_coldBlocks;
+
+      /**
+       * @brief - The number of generations applied to the blocks so far, used to age
+       *          the cells of cold blocks.
+       */
+      std::uint64_t m_elapsed;
   };
 
   using CellsBlocksShPtr = std::shared_ptr<CellsBlocks>;
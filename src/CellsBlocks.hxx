@@ -7,11 +7,42 @@ namespace cellulator {
 
   inline
   unsigned
-  CellsBlocks::step() {
+  CellsBlocks::step(unsigned generations) {
     // Protect from concurrent accesses.
     const std::lock_guard guard(m_propsLocker);
 
-    return stepPrivate();
+    return stepPrivate(generations);
+  }
+
+  inline
+  void
+  CellsBlocks::reset() {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    // Clearing the vectors keeps their capacity so the allocation below
+    // reuses the existing memory.
+    clear();
+    allocate(m_totalArea);
+  }
+
+  inline
+  void
+  CellsBlocks::rollback() {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    // The evolution only modifies the next state of the cells: as it is
+    // entirely overwritten except for the adjacency which is accumulated
+    // we just have to reset it.
+    std::fill(m_nextAdjacency.begin(), m_nextAdjacency.end(), 0u);
+  }
+
+  inline
+  unsigned
+  CellsBlocks::getMaxGenerationsPerEvolution() const noexcept {
+    // We need a halo of one more cell than the number of generations.
+    return static_cast<unsigned>(std::min(m_nodesDims.w(), m_nodesDims.h()) - 1);
   }
 
   inline
@@ -32,6 +63,15 @@ namespace cellulator {
     m_ruleset = ruleset;
   }
 
+  inline
+  CellEvolverShPtr
+  CellsBlocks::getRuleset() {
+    // Protect from concurrnet access.
+    const std::lock_guard guard(m_propsLocker);
+
+    return m_ruleset;
+  }
+
   inline
   float
   CellsBlocks::getDeadCellProbability() noexcept {
@@ -52,8 +92,17 @@ namespace cellulator {
 
     m_nextStates.clear();
     m_nextAdjacency.clear();
+    m_ages.clear();
+    m_nextAges.clear();
 
     m_blocks.clear();
+    m_freeBlocks.clear();
+    m_blocksIndex.clear();
+
+    m_freeSlots.clear();
+    m_coldBlocks.clear();
+
+    m_liveBlocks = 0u;
   }
 
   inline
@@ -62,6 +111,66 @@ namespace cellulator {
     return blockID * sizeOfBlock();
   }
 
+  inline
+  void
+  CellsBlocks::markDirty(const BlockDesc& b) noexcept {
+    m_blocks[b.id].dirty = true;
+
+    const int neighbors[8] = {b.west, b.east, b.south, b.north, b.nw, b.ne, b.sw, b.se};
+
+    for (unsigned id = 0u ; id < 8u ; ++id) {
+      if (neighbors[id] >= 0) {
+        m_blocks[neighbors[id]].dirty = true;
+      }
+    }
+  }
+
+  inline
+  BlockRecord
+  CellsBlocks::toRecord(const BlockDesc& b) const noexcept {
+    return BlockRecord{
+      b.id,
+      {b.area.x(), b.area.y(), b.area.w(), b.area.h()},
+      dataIDFromBlock(b.id),
+      dataIDFromBlock(b.id) + sizeOfBlock(),
+      b.active ? 1u : 0u,
+      b.alive,
+      b.changed,
+      {b.west, b.east, b.south, b.north, b.nw, b.ne, b.sw, b.se}
+    };
+  }
+
+  inline
+  CellsBlocks::BlockDesc
+  CellsBlocks::fromRecord(const BlockRecord& r) noexcept {
+    return BlockDesc{
+      r.id,
+
+      utils::Boxi(r.area[0], r.area[1], r.area[2], r.area[3]),
+      r.start,
+      r.end,
+
+      r.active != 0u,
+      r.alive,
+      r.alive,
+      r.changed,
+      r.changed,
+      true,
+      false,
+      0u,
+
+      r.links[0],
+      r.links[1],
+      r.links[2],
+      r.links[3],
+
+      r.links[4],
+      r.links[5],
+      r.links[6],
+      r.links[7]
+    };
+  }
+
   inline
   unsigned
   CellsBlocks::sizeOfBlock() const noexcept {
@@ -143,6 +252,19 @@ namespace cellulator {
       ++cnt;
 
       const BlockDesc& b = m_blocks[id];
+
+      // The bounds of the live cells of cold blocks are cached.
+      if (b.cold) {
+        const int* bounds = m_coldBlocks.find(b.id)->second.bounds;
+
+        xMin = std::min(xMin, b.area.getLeftBound() + bounds[0]);
+        yMin = std::min(yMin, b.area.getBottomBound() + bounds[1]);
+        xMax = std::max(xMax, b.area.getLeftBound() + bounds[2]);
+        yMax = std::max(yMax, b.area.getBottomBound() + bounds[3]);
+
+        continue;
+      }
+
       for (unsigned idC = b.start ; idC < b.end ; ++idC) {
         if (m_states[idC] == State::Alive) {
           utils::Vector2i c = coordFromIndex(b, idC, true);
@@ -0,0 +1,127 @@
+
+# include "Checkpoint.hh"
+# include <cerrno>
+# include <cstring>
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+
+namespace cellulator {
+
+  Checkpoint::Checkpoint(const std::string& file):
+    utils::CoreObject(file),
+
+    m_file(file),
+    m_data(nullptr),
+    m_size(0u)
+  {
+    setService("checkpoint");
+
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+      error(
+        std::string("Could not read checkpoint from \"") + m_file + "\"",
+        std::string("Cannot open file")
+      );
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(CheckpointHeader))) {
+      ::close(fd);
+      error(
+        std::string("Could not read checkpoint from \"") + m_file + "\"",
+        std::string("File is too small to contain a checkpoint")
+      );
+    }
+
+    m_size = static_cast<std::uint64_t>(info.st_size);
+
+    // The mapping stays valid once the file is closed.
+    void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (data == MAP_FAILED) {
+      error(
+        std::string("Could not read checkpoint from \"") + m_file + "\"",
+        std::string("Cannot map file: ") + std::strerror(errno)
+      );
+    }
+
+    m_data = static_cast<const std::uint8_t*>(data);
+
+    // The cells are read sequentially when restoring the checkpoint.
+    ::madvise(data, m_size, MADV_SEQUENTIAL);
+
+    try {
+      validate();
+    }
+    catch (...) {
+      ::munmap(const_cast<std::uint8_t*>(m_data), m_size);
+      m_data = nullptr;
+      throw;
+    }
+  }
+
+  Checkpoint::~Checkpoint() {
+    if (m_data != nullptr) {
+      ::munmap(const_cast<std::uint8_t*>(m_data), m_size);
+    }
+  }
+
+  void
+  Checkpoint::validate() {
+    const CheckpointHeader& header = getHeader();
+
+    if (std::memcmp(header.magic, getMagic(), sizeof(header.magic)) != 0) {
+      error(
+        std::string("Could not read checkpoint from \"") + m_file + "\"",
+        std::string("File is not a checkpoint")
+      );
+    }
+
+    if (header.byteOrder != getByteOrderMarker()) {
+      error(
+        std::string("Could not read checkpoint from \"") + m_file + "\"",
+        std::string("Checkpoint was produced on a machine with a different byte order")
+      );
+    }
+
+    if (header.version != getVersion()) {
+      error(
+        std::string("Could not read checkpoint from \"") + m_file + "\"",
+        std::string("Unsupported version ") + std::to_string(header.version) +
+        " (expected " + std::to_string(getVersion()) + ")"
+      );
+    }
+
+    // The offsets are not trusted: recompute them from the counts.
+    CheckpointHeader expected = header;
+    computeLayout(expected);
+
+    if (expected.size != m_size ||
+        expected.blocksOffset != header.blocksOffset ||
+        expected.freeOffset != header.freeOffset ||
+        expected.statesOffset != header.statesOffset ||
+        expected.adjacencyOffset != header.adjacencyOffset ||
+        expected.agesOffset != header.agesOffset)
+    {
+      error(
+        std::string("Could not read checkpoint from \"") + m_file + "\"",
+        std::string("Invalid layout for ") + std::to_string(header.blocks) + " block(s) and " +
+        std::to_string(header.cells) + " cell(s) in " + std::to_string(m_size) + " byte(s)"
+      );
+    }
+
+    if (header.blockW <= 0 || header.blockH <= 0 ||
+        header.cells != static_cast<std::uint64_t>(header.blocks) * header.blockW * header.blockH)
+    {
+      error(
+        std::string("Could not read checkpoint from \"") + m_file + "\"",
+        std::string("Invalid dimensions ") + std::to_string(header.blockW) + "x" +
+        std::to_string(header.blockH) + " for blocks"
+      );
+    }
+  }
+
+}
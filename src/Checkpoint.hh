@@ -0,0 +1,207 @@
+#ifndef    CHECKPOINT_HH
+# define   CHECKPOINT_HH
+
+# include <memory>
+# include <string>
+# include <cstdint>
+# include <core_utils/CoreObject.hh>
+
+namespace cellulator {
+
+  /**
+   * @brief - The header of a checkpoint file. The header is followed by the
+   *          sections holding the blocks and the cells, each one starting at
+   *          the offset indicated in the header. All the values are stored in
+   *          the byte order of the machine which produced the checkpoint so
+   *          that they can be used directly from a mapping of the file.
+   */
+  struct CheckpointHeader {
+    char magic[8];                //< Identifies checkpoint files.
+    std::uint32_t version;        //< The version of the layout.
+    std::uint32_t byteOrder;      //< Used to detect files produced on a machine
+                                  //< with a different byte order.
+    std::uint64_t size;           //< The total size of the file in bytes.
+
+    std::uint64_t generation;     //< The generation of the colony.
+    std::uint32_t rules;          //< The table of the ruleset of the colony.
+    std::int32_t blockW;          //< The width of a block of cells.
+    std::int32_t blockH;          //< The height of a block of cells.
+    std::uint32_t blocks;         //< The number of blocks, including inactive ones.
+    std::uint32_t freeBlocks;     //< The number of blocks available for reuse.
+    std::uint32_t liveBlocks;     //< The number of active blocks.
+    std::uint64_t cells;          //< The number of cells of all the blocks.
+
+    std::int32_t totalArea[4];    //< The area covered by the blocks (x, y, w, h).
+    float liveArea[4];            //< The area containing live cells (x, y, w, h).
+
+    std::uint64_t blocksOffset;   //< Offset of the `BlockRecord` section.
+    std::uint64_t freeOffset;     //< Offset of the free blocks section.
+    std::uint64_t statesOffset;   //< Offset of the states of the cells: one byte
+                                  //< per cell.
+    std::uint64_t adjacencyOffset;//< Offset of the adjacency of the cells: one
+                                  //< byte per cell.
+    std::uint64_t agesOffset;     //< Offset of the ages of the cells: four bytes
+                                  //< per cell.
+  };
+
+  /**
+   * @brief - The description of a block of cells in a checkpoint. This mirrors
+   *          the internal description of blocks used by `CellsBlocks` with a
+   *          layout independent of the compiler.
+   */
+  struct BlockRecord {
+    std::uint32_t id;             //< The index of the block.
+    std::int32_t area[4];         //< The area covered by the block (x, y, w, h).
+    std::uint32_t start;          //< The index of the first cell of the block.
+    std::uint32_t end;            //< The index past the last cell of the block.
+    std::uint32_t active;         //< Whether the block is active.
+    std::uint32_t alive;          //< The number of live cells.
+    std::uint32_t changed;        //< The number of cells which changed during the
+                                  //< last generation.
+    std::int32_t links[8];        //< The indices of the neighboring blocks in the
+                                  //< order west, east, south, north, north west,
+                                  //< north east, south west and south east.
+  };
+
+  class Checkpoint: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Open the checkpoint file in argument. The file is mapped in memory
+       *          and only its header is verified: the blocks and the cells are then
+       *          accessed directly from the mapping.
+       *          An error is raised if the file can't be mapped or if its layout is
+       *          not valid.
+       * @param file - the name of the checkpoint file.
+       */
+      Checkpoint(const std::string& file);
+
+      /**
+       * @brief - Release the mapping of the file.
+       */
+      ~Checkpoint();
+
+      Checkpoint(const Checkpoint&) = delete;
+
+      Checkpoint&
+      operator=(const Checkpoint&) = delete;
+
+      /**
+       * @brief - Retrieve the header of the checkpoint.
+       * @return - the header of the checkpoint.
+       */
+      const CheckpointHeader&
+      getHeader() const noexcept;
+
+      /**
+       * @brief - Retrieve the description of the blocks: there are `blocks` of them
+       *          as indicated by the header.
+       * @return - the description of the blocks.
+       */
+      const BlockRecord*
+      getBlocks() const noexcept;
+
+      /**
+       * @brief - Retrieve the indices of the blocks available for reuse.
+       * @return - the free blocks.
+       */
+      const std::uint32_t*
+      getFreeBlocks() const noexcept;
+
+      /**
+       * @brief - Retrieve the states of the cells, `1` for a live cell.
+       * @return - the states of the cells.
+       */
+      const std::uint8_t*
+      getStates() const noexcept;
+
+      /**
+       * @brief - Retrieve the number of live neighbors of each cell.
+       * @return - the adjacency of the cells.
+       */
+      const std::uint8_t*
+      getAdjacency() const noexcept;
+
+      /**
+       * @brief - Retrieve the age of each cell.
+       * @return - the ages of the cells.
+       */
+      const std::int32_t*
+      getAges() const noexcept;
+
+      /**
+       * @brief - The magic string identifying checkpoint files.
+       * @return - the magic string, made of 8 characters.
+       */
+      static
+      const char*
+      getMagic() noexcept;
+
+      /**
+       * @brief - The version of the layout of checkpoints.
+       * @return - the current version of the layout.
+       */
+      static
+      std::uint32_t
+      getVersion() noexcept;
+
+      /**
+       * @brief - The value written in the header to detect files written with a
+       *          different byte order.
+       * @return - the byte order marker.
+       */
+      static
+      std::uint32_t
+      getByteOrderMarker() noexcept;
+
+      /**
+       * @brief - Compute the offsets of the sections of a checkpoint file from the
+       *          counts of blocks and cells of its header. Each section starts on a
+       *          cache line so that it can be used directly from a mapping.
+       * @param header - the header to update, where the counts are already set.
+       */
+      static
+      void
+      computeLayout(CheckpointHeader& header) noexcept;
+
+    private:
+
+      /**
+       * @brief - The alignment of the sections of the file.
+       * @return - the alignment in bytes.
+       */
+      static
+      std::uint64_t
+      getAlignment() noexcept;
+
+      /**
+       * @brief - Verify that the header describes a valid layout for the mapped file
+       *          and raise an error if this is not the case.
+       */
+      void
+      validate();
+
+    private:
+
+      /**
+       * @brief - The name of the file, used to report errors.
+       */
+      std::string m_file;
+
+      /**
+       * @brief - The mapping of the file.
+       */
+      const std::uint8_t* m_data;
+
+      /**
+       * @brief - The size of the mapping in bytes.
+       */
+      std::uint64_t m_size;
+  };
+
+  using CheckpointShPtr = std::shared_ptr<Checkpoint>;
+}
+
+# include "Checkpoint.hxx"
+
+#endif    /* CHECKPOINT_HH */
@@ -0,0 +1,85 @@
+#ifndef    CHECKPOINT_HXX
+# define   CHECKPOINT_HXX
+
+# include "Checkpoint.hh"
+
+namespace cellulator {
+
+  inline
+  const CheckpointHeader&
+  Checkpoint::getHeader() const noexcept {
+    return *reinterpret_cast<const CheckpointHeader*>(m_data);
+  }
+
+  inline
+  const BlockRecord*
+  Checkpoint::getBlocks() const noexcept {
+    return reinterpret_cast<const BlockRecord*>(m_data + getHeader().blocksOffset);
+  }
+
+  inline
+  const std::uint32_t*
+  Checkpoint::getFreeBlocks() const noexcept {
+    return reinterpret_cast<const std::uint32_t*>(m_data + getHeader().freeOffset);
+  }
+
+  inline
+  const std::uint8_t*
+  Checkpoint::getStates() const noexcept {
+    return m_data + getHeader().statesOffset;
+  }
+
+  inline
+  const std::uint8_t*
+  Checkpoint::getAdjacency() const noexcept {
+    return m_data + getHeader().adjacencyOffset;
+  }
+
+  inline
+  const std::int32_t*
+  Checkpoint::getAges() const noexcept {
+    return reinterpret_cast<const std::int32_t*>(m_data + getHeader().agesOffset);
+  }
+
+  inline
+  const char*
+  Checkpoint::getMagic() noexcept {
+    return "CELLCKPT";
+  }
+
+  inline
+  std::uint32_t
+  Checkpoint::getVersion() noexcept {
+    return 1u;
+  }
+
+  inline
+  std::uint32_t
+  Checkpoint::getByteOrderMarker() noexcept {
+    return 0x01020304u;
+  }
+
+  inline
+  std::uint64_t
+  Checkpoint::getAlignment() noexcept {
+    return 64u;
+  }
+
+  inline
+  void
+  Checkpoint::computeLayout(CheckpointHeader& header) noexcept {
+    auto align = [](std::uint64_t offset) {
+      return (offset + getAlignment() - 1u) / getAlignment() * getAlignment();
+    };
+
+    header.blocksOffset = align(sizeof(CheckpointHeader));
+    header.freeOffset = align(header.blocksOffset + header.blocks * sizeof(BlockRecord));
+    header.statesOffset = align(header.freeOffset + header.freeBlocks * sizeof(std::uint32_t));
+    header.adjacencyOffset = align(header.statesOffset + header.cells * sizeof(std::uint8_t));
+    header.agesOffset = align(header.adjacencyOffset + header.cells * sizeof(std::uint8_t));
+    header.size = header.agesOffset + header.cells * sizeof(std::int32_t);
+  }
+
+}
+
+#endif    /* CHECKPOINT_HXX */
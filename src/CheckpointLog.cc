@@ -0,0 +1,218 @@
+
+# include "CheckpointLog.hh"
+# include <cerrno>
+# include <algorithm>
+# include <cstring>
+# include <cstdio>
+# include <fcntl.h>
+# include <unistd.h>
+
+namespace cellulator {
+
+  CheckpointLog::CheckpointLog(const std::string& file,
+                               unsigned baseInterval):
+    utils::CoreObject(file),
+
+    m_propsLocker(),
+    m_waiter(),
+
+    m_file(file),
+    m_baseInterval(std::max(baseInterval, 1u)),
+    m_sinceBase(std::max(baseInterval, 1u)),
+
+    m_pending(),
+    m_writing(false),
+    m_stop(false),
+    m_error(),
+    m_statistics{0u, 0u, 0ull, 0ull},
+
+    m_fd(-1),
+    m_writer()
+  {
+    setService("checkpoint_log");
+
+    m_writer = std::thread(&CheckpointLog::write, this);
+  }
+
+  CheckpointLog::~CheckpointLog() {
+    {
+      const std::lock_guard guard(m_propsLocker);
+      m_stop = true;
+    }
+
+    m_waiter.notify_all();
+    m_writer.join();
+
+    if (m_fd >= 0) {
+      ::close(m_fd);
+    }
+  }
+
+  bool
+  CheckpointLog::needsBase() {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    return m_sinceBase >= m_baseInterval;
+  }
+
+  void
+  CheckpointLog::push(std::vector<char>&& record) {
+    if (record.size() < sizeof(LogRecordHeader)) {
+      error(
+        std::string("Could not append record to \"") + m_file + "\"",
+        std::string("Invalid record of ") + std::to_string(record.size()) + " byte(s)"
+      );
+    }
+
+    const LogRecordHeader* header = reinterpret_cast<const LogRecordHeader*>(record.data());
+    bool base = (header->base != 0u);
+
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
+
+      if (!m_error.empty()) {
+        error(
+          std::string("Could not append record to \"") + m_file + "\"",
+          m_error
+        );
+      }
+
+      // The log can only be replayed from a base record.
+      if (!base && m_statistics.bases == 0u && m_sinceBase >= m_baseInterval) {
+        error(
+          std::string("Could not append record to \"") + m_file + "\"",
+          std::string("Log should start with a base record")
+        );
+      }
+
+      m_sinceBase = (base ? 1u : m_sinceBase + 1u);
+      m_pending.push_back(std::move(record));
+    }
+
+    m_waiter.notify_all();
+  }
+
+  void
+  CheckpointLog::flush() {
+    std::unique_lock lock(m_propsLocker);
+    m_waiter.wait(
+      lock,
+      [this]() {
+        return m_pending.empty() && !m_writing;
+      }
+    );
+  }
+
+  CheckpointLog::Statistics
+  CheckpointLog::getStatistics() noexcept {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    return m_statistics;
+  }
+
+  void
+  CheckpointLog::write() {
+    while (true) {
+      std::vector<char> record;
+
+      {
+        std::unique_lock lock(m_propsLocker);
+        m_waiter.wait(
+          lock,
+          [this]() {
+            return !m_pending.empty() || m_stop;
+          }
+        );
+
+        // Pending records are written before stopping.
+        if (m_pending.empty()) {
+          return;
+        }
+
+        record.swap(m_pending.front());
+        m_pending.pop_front();
+        m_writing = true;
+      }
+
+      bool base = (reinterpret_cast<const LogRecordHeader*>(record.data())->base != 0u);
+      bool success = (base ? compact(record) : append(m_fd, record));
+
+      {
+        const std::lock_guard guard(m_propsLocker);
+
+        m_writing = false;
+
+        if (success) {
+          ++m_statistics.records;
+          m_statistics.bases += (base ? 1u : 0u);
+          m_statistics.bytes += record.size();
+          m_statistics.size = (base ? 0ull : m_statistics.size) + record.size();
+        }
+        else if (m_error.empty()) {
+          m_error = std::string("Failed to write record: ") + std::strerror(errno);
+        }
+      }
+
+      m_waiter.notify_all();
+    }
+  }
+
+  bool
+  CheckpointLog::compact(const std::vector<char>& record) {
+    // The base record is written to a new file which then replaces the
+    // log: the previous records are not needed anymore and the log is
+    // never left without a valid base record.
+    std::string next = m_file + ".compact";
+
+    int fd = ::open(next.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      return false;
+    }
+
+    if (!append(fd, record) || ::fdatasync(fd) != 0 || ::rename(next.c_str(), m_file.c_str()) != 0) {
+      ::close(fd);
+      ::unlink(next.c_str());
+      return false;
+    }
+
+    if (m_fd >= 0) {
+      ::close(m_fd);
+    }
+
+    m_fd = fd;
+
+    return true;
+  }
+
+  bool
+  CheckpointLog::append(int fd,
+                        const std::vector<char>& record)
+  {
+    if (fd < 0) {
+      errno = EBADF;
+      return false;
+    }
+
+    std::size_t written = 0u;
+
+    while (written < record.size()) {
+      ssize_t count = ::write(fd, record.data() + written, record.size() - written);
+
+      if (count < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+
+        return false;
+      }
+
+      written += static_cast<std::size_t>(count);
+    }
+
+    return true;
+  }
+
+}
@@ -0,0 +1,256 @@
+#ifndef    CHECKPOINT_LOG_HH
+# define   CHECKPOINT_LOG_HH
+
+# include <mutex>
+# include <deque>
+# include <thread>
+# include <memory>
+# include <string>
+# include <vector>
+# include <cstdint>
+# include <condition_variable>
+# include <core_utils/CoreObject.hh>
+# include "Checkpoint.hh"
+
+namespace cellulator {
+
+  /**
+   * @brief - The header of a record of a checkpoint log. A record describes all
+   *          the blocks of a colony but only holds the cells of the blocks that
+   *          were modified since the previous record (or of all the blocks for
+   *          a base record). The header is followed by the sections described
+   *          by `LogRecordLayout` and by a copy of the size of the record, used
+   *          to detect records which were not completely written.
+   */
+  struct LogRecordHeader {
+    char magic[8];                //< Identifies records of checkpoint logs.
+    std::uint32_t version;        //< The version of the layout.
+    std::uint32_t byteOrder;      //< Used to detect logs produced on a machine
+                                  //< with a different byte order.
+    std::uint64_t size;           //< The total size of the record in bytes.
+
+    std::uint64_t generation;     //< The generation of the colony.
+    std::uint32_t base;           //< `1` if the record holds all the blocks.
+    std::uint32_t rules;          //< The table of the ruleset of the colony.
+    std::int32_t blockW;          //< The width of a block of cells.
+    std::int32_t blockH;          //< The height of a block of cells.
+    std::uint32_t blocks;         //< The number of blocks, including inactive ones.
+    std::uint32_t freeBlocks;     //< The number of blocks available for reuse.
+    std::uint32_t liveBlocks;     //< The number of active blocks.
+    std::uint32_t dirty;          //< The number of blocks whose cells are saved.
+
+    std::int32_t totalArea[4];    //< The area covered by the blocks (x, y, w, h).
+    float liveArea[4];            //< The area containing live cells (x, y, w, h).
+  };
+
+  /**
+   * @brief - The offsets of the sections of a record, relative to the start of
+   *          the record. The cells of each saved block are stored as the states
+   *          (one byte per cell), the adjacency (one byte per cell) and the ages
+   *          (four bytes per cell) of the block.
+   */
+  struct LogRecordLayout {
+    std::uint64_t blocks;         //< Offset of the `BlockRecord` section.
+    std::uint64_t free;           //< Offset of the free blocks section.
+    std::uint64_t dirty;          //< Offset of the indices of the saved blocks.
+    std::uint64_t cells;          //< Offset of the cells of the saved blocks.
+    std::uint64_t stride;         //< The size of the cells of a single block.
+    std::uint64_t size;           //< The total size of the record.
+  };
+
+  class CheckpointLog: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Create a new checkpoint log writing to the file in argument. The
+       *          records are appended to the file by a background thread so that
+       *          the simulation only pays for the capture of the modified blocks.
+       *          A base record is written every `baseInterval` records: the log is
+       *          then compacted, which means that the file is replaced by a new
+       *          one starting with the base record.
+       *          The first record of a log is always a base record so any existing
+       *          content of the file is discarded when it is written.
+       * @param file - the name of the file receiving the log.
+       * @param baseInterval - the number of records between two base records.
+       */
+      CheckpointLog(const std::string& file,
+                    unsigned baseInterval = 16u);
+
+      /**
+       * @brief - Wait for all the pending records to be written and stop the thread
+       *          writing the records.
+       */
+      ~CheckpointLog();
+
+      /**
+       * @brief - Whether the next record should be a base record.
+       * @return - `true` if the next record should hold all the blocks.
+       */
+      bool
+      needsBase();
+
+      /**
+       * @brief - Register a new record to append to the log. The record should have
+       *          been produced by `CellsBlocks::capture`. The method returns as soon
+       *          as the record is queued.
+       *          An error is raised in case a previous record could not be written.
+       * @param record - the record to append, moved into the log.
+       */
+      void
+      push(std::vector<char>&& record);
+
+      /**
+       * @brief - Wait until all the records pushed so far are written to the disk.
+       */
+      void
+      flush();
+
+      /**
+       * @brief - Convenience structure describing the activity of the log.
+       */
+      struct Statistics {
+        unsigned records;         //< The number of records written.
+        unsigned bases;           //< The number of base records written.
+        std::uint64_t bytes;      //< The number of bytes written.
+        std::uint64_t size;       //< The current size of the file.
+      };
+
+      /**
+       * @brief - Retrieve the activity of the log so far.
+       * @return - the statistics of the log.
+       */
+      Statistics
+      getStatistics() noexcept;
+
+      /**
+       * @brief - The magic string identifying records of checkpoint logs.
+       * @return - the magic string, made of 8 characters.
+       */
+      static
+      const char*
+      getMagic() noexcept;
+
+      /**
+       * @brief - The version of the layout of records.
+       * @return - the current version of the layout.
+       */
+      static
+      std::uint32_t
+      getVersion() noexcept;
+
+      /**
+       * @brief - Compute the offsets of the sections of a record from the counts of
+       *          its header.
+       * @param header - the header of the record.
+       * @return - the layout of the record.
+       */
+      static
+      LogRecordLayout
+      computeLayout(const LogRecordHeader& header) noexcept;
+
+    private:
+
+      /**
+       * @brief - The alignment of the sections of a record.
+       * @return - the alignment in bytes.
+       */
+      static
+      std::uint64_t
+      getAlignment() noexcept;
+
+      /**
+       * @brief - Main loop of the thread writing the records.
+       */
+      void
+      write();
+
+      /**
+       * @brief - Write a base record to a new file and replace the log with it. The
+       *          previous records are not needed anymore.
+       * @param record - the base record.
+       * @return - `false` if the record could not be written.
+       */
+      bool
+      compact(const std::vector<char>& record);
+
+      /**
+       * @brief - Append the record in argument to the file of the log.
+       * @param fd - the descriptor of the file.
+       * @param record - the record to write.
+       * @return - `false` if the record could not be written.
+       */
+      static
+      bool
+      append(int fd,
+             const std::vector<char>& record);
+
+    private:
+
+      /**
+       * @brief - Protect this object from concurrent accesses.
+       */
+      std::mutex m_propsLocker;
+
+      /**
+       * @brief - Used to notify the writer when a record is pushed and the callers of
+       *          `flush` when the records are written.
+       */
+      std::condition_variable m_waiter;
+
+      /**
+       * @brief - The name of the file receiving the log.
+       */
+      std::string m_file;
+
+      /**
+       * @brief - The number of records between two base records.
+       */
+      unsigned m_baseInterval;
+
+      /**
+       * @brief - The number of records pushed since the last base record.
+       */
+      unsigned m_sinceBase;
+
+      /**
+       * @brief - The records waiting to be written.
+       */
+      std::deque<std::vector<char>> m_pending;
+
+      /**
+       * @brief - Whether the writer is currently writing a record.
+       */
+      bool m_writing;
+
+      /**
+       * @brief - Whether the writer should stop.
+       */
+      bool m_stop;
+
+      /**
+       * @brief - The error which occurred while writing a record if any.
+       */
+      std::string m_error;
+
+      /**
+       * @brief - The activity of the log.
+       */
+      Statistics m_statistics;
+
+      /**
+       * @brief - The descriptor of the file of the log, only accessed by the writer.
+       */
+      int m_fd;
+
+      /**
+       * @brief - The thread writing the records.
+       */
+      std::thread m_writer;
+  };
+
+  using CheckpointLogShPtr = std::shared_ptr<CheckpointLog>;
+}
+
+# include "CheckpointLog.hxx"
+
+#endif    /* CHECKPOINT_LOG_HH */
@@ -0,0 +1,49 @@
+#ifndef    CHECKPOINT_LOG_HXX
+# define   CHECKPOINT_LOG_HXX
+
+# include "CheckpointLog.hh"
+
+namespace cellulator {
+
+  inline
+  const char*
+  CheckpointLog::getMagic() noexcept {
+    return "CELLDIFF";
+  }
+
+  inline
+  std::uint32_t
+  CheckpointLog::getVersion() noexcept {
+    return 1u;
+  }
+
+  inline
+  std::uint64_t
+  CheckpointLog::getAlignment() noexcept {
+    return 8u;
+  }
+
+  inline
+  LogRecordLayout
+  CheckpointLog::computeLayout(const LogRecordHeader& header) noexcept {
+    auto align = [](std::uint64_t offset) {
+      return (offset + getAlignment() - 1u) / getAlignment() * getAlignment();
+    };
+
+    LogRecordLayout layout;
+
+    const std::uint64_t area = static_cast<std::uint64_t>(header.blockW) * static_cast<std::uint64_t>(header.blockH);
+
+    layout.blocks = align(sizeof(LogRecordHeader));
+    layout.free = align(layout.blocks + header.blocks * sizeof(BlockRecord));
+    layout.dirty = align(layout.free + header.freeBlocks * sizeof(std::uint32_t));
+    layout.cells = align(layout.dirty + header.dirty * sizeof(std::uint32_t));
+    layout.stride = align(area * (2u * sizeof(std::uint8_t) + sizeof(std::int32_t)));
+    layout.size = layout.cells + header.dirty * layout.stride + sizeof(std::uint64_t);
+
+    return layout;
+  }
+
+}
+
+#endif    /* CHECKPOINT_LOG_HXX */
@@ -0,0 +1,168 @@
+
+# include "CheckpointReplay.hh"
+# include <cerrno>
+# include <cstring>
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+
+namespace cellulator {
+
+  CheckpointReplay::CheckpointReplay(const std::string& file):
+    utils::CoreObject(file),
+
+    m_file(file),
+    m_data(nullptr),
+    m_size(0u),
+    m_records(),
+    m_discarded(0u)
+  {
+    setService("checkpoint_replay");
+
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+      error(
+        std::string("Could not read checkpoint log from \"") + m_file + "\"",
+        std::string("Cannot open file")
+      );
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(LogRecordHeader))) {
+      ::close(fd);
+      error(
+        std::string("Could not read checkpoint log from \"") + m_file + "\"",
+        std::string("File is too small to contain a record")
+      );
+    }
+
+    m_size = static_cast<std::uint64_t>(info.st_size);
+
+    // The mapping stays valid once the file is closed.
+    void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (data == MAP_FAILED) {
+      error(
+        std::string("Could not read checkpoint log from \"") + m_file + "\"",
+        std::string("Cannot map file: ") + std::strerror(errno)
+      );
+    }
+
+    m_data = static_cast<const std::uint8_t*>(data);
+
+    // The records are read sequentially when replaying the log.
+    ::madvise(data, m_size, MADV_SEQUENTIAL);
+
+    try {
+      scan();
+    }
+    catch (...) {
+      ::munmap(const_cast<std::uint8_t*>(m_data), m_size);
+      m_data = nullptr;
+      throw;
+    }
+  }
+
+  CheckpointReplay::~CheckpointReplay() {
+    if (m_data != nullptr) {
+      ::munmap(const_cast<std::uint8_t*>(m_data), m_size);
+    }
+  }
+
+  void
+  CheckpointReplay::scan() {
+    const LogRecordHeader& first = *reinterpret_cast<const LogRecordHeader*>(m_data);
+
+    if (std::memcmp(first.magic, CheckpointLog::getMagic(), sizeof(first.magic)) != 0) {
+      error(
+        std::string("Could not read checkpoint log from \"") + m_file + "\"",
+        std::string("File is not a checkpoint log")
+      );
+    }
+
+    if (first.byteOrder != Checkpoint::getByteOrderMarker()) {
+      error(
+        std::string("Could not read checkpoint log from \"") + m_file + "\"",
+        std::string("Log was produced on a machine with a different byte order")
+      );
+    }
+
+    if (first.version != CheckpointLog::getVersion()) {
+      error(
+        std::string("Could not read checkpoint log from \"") + m_file + "\"",
+        std::string("Unsupported version ") + std::to_string(first.version) +
+        " (expected " + std::to_string(CheckpointLog::getVersion()) + ")"
+      );
+    }
+
+    if (first.blockW <= 0 || first.blockH <= 0) {
+      error(
+        std::string("Could not read checkpoint log from \"") + m_file + "\"",
+        std::string("Invalid dimensions ") + std::to_string(first.blockW) + "x" +
+        std::to_string(first.blockH) + " for blocks"
+      );
+    }
+
+    // Records are always a multiple of the alignment so each one starts
+    // where the previous one ends. Any record which does not look valid
+    // is considered as the end of the log: this is what happens when the
+    // program is interrupted while a record is written.
+    std::uint64_t offset = 0u;
+
+    while (offset + sizeof(LogRecordHeader) <= m_size) {
+      const LogRecordHeader& header = *reinterpret_cast<const LogRecordHeader*>(m_data + offset);
+
+      if (std::memcmp(header.magic, CheckpointLog::getMagic(), sizeof(header.magic)) != 0 ||
+          header.byteOrder != first.byteOrder ||
+          header.version != first.version ||
+          header.blockW != first.blockW ||
+          header.blockH != first.blockH ||
+          header.dirty > header.blocks)
+      {
+        break;
+      }
+
+      // The sizes are not trusted: recompute them from the counts.
+      LogRecordLayout layout = CheckpointLog::computeLayout(header);
+      if (layout.size != header.size || layout.size > m_size - offset) {
+        break;
+      }
+
+      std::uint64_t trailer;
+      std::memcpy(&trailer, m_data + offset + layout.size - sizeof(std::uint64_t), sizeof(std::uint64_t));
+      if (trailer != layout.size) {
+        break;
+      }
+
+      // A base record makes all the previous ones useless.
+      if (header.base != 0u) {
+        m_records.clear();
+      }
+
+      if (!m_records.empty() || header.base != 0u) {
+        m_records.push_back(&header);
+      }
+
+      offset += layout.size;
+    }
+
+    m_discarded = m_size - offset;
+
+    if (m_records.empty()) {
+      error(
+        std::string("Could not read checkpoint log from \"") + m_file + "\"",
+        std::string("Log does not contain a complete base record")
+      );
+    }
+
+    if (m_discarded > 0u) {
+      warn(
+        "Ignored " + std::to_string(m_discarded) + " byte(s) at the end of checkpoint log \"" +
+        m_file + "\""
+      );
+    }
+  }
+
+}
@@ -0,0 +1,104 @@
+#ifndef    CHECKPOINT_REPLAY_HH
+# define   CHECKPOINT_REPLAY_HH
+
+# include <memory>
+# include <string>
+# include <vector>
+# include <cstdint>
+# include <core_utils/CoreObject.hh>
+# include "CheckpointLog.hh"
+
+namespace cellulator {
+
+  class CheckpointReplay: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Open the checkpoint log in argument. The file is mapped in memory
+       *          and scanned to find the records needed to rebuild the last state
+       *          saved in the log: the last base record and the records following
+       *          it. A record which was not completely written (typically because
+       *          the program was interrupted while writing it) ends the log.
+       *          An error is raised if the file can't be mapped or if it does not
+       *          contain at least a complete base record.
+       * @param file - the name of the checkpoint log.
+       */
+      CheckpointReplay(const std::string& file);
+
+      /**
+       * @brief - Release the mapping of the file.
+       */
+      ~CheckpointReplay();
+
+      CheckpointReplay(const CheckpointReplay&) = delete;
+
+      CheckpointReplay&
+      operator=(const CheckpointReplay&) = delete;
+
+      /**
+       * @brief - Retrieve the records to replay, in the order they were written. The
+       *          first one is always a base record.
+       * @return - the headers of the records to replay, each one followed by the
+       *           sections described by `CheckpointLog::computeLayout`.
+       */
+      const std::vector<const LogRecordHeader*>&
+      getRecords() const noexcept;
+
+      /**
+       * @brief - Retrieve the generation of the last record of the log.
+       * @return - the generation reached by replaying the log.
+       */
+      std::uint64_t
+      getGeneration() const noexcept;
+
+      /**
+       * @brief - Retrieve the number of bytes at the end of the file which do not
+       *          form a complete record and were ignored.
+       * @return - the number of ignored bytes.
+       */
+      std::uint64_t
+      getDiscardedBytes() const noexcept;
+
+    private:
+
+      /**
+       * @brief - Scan the records of the log and keep the ones starting from the last
+       *          base record.
+       */
+      void
+      scan();
+
+    private:
+
+      /**
+       * @brief - The name of the file, used to report errors.
+       */
+      std::string m_file;
+
+      /**
+       * @brief - The mapping of the file.
+       */
+      const std::uint8_t* m_data;
+
+      /**
+       * @brief - The size of the mapping in bytes.
+       */
+      std::uint64_t m_size;
+
+      /**
+       * @brief - The records to replay.
+       */
+      std::vector<const LogRecordHeader*> m_records;
+
+      /**
+       * @brief - The number of bytes ignored at the end of the file.
+       */
+      std::uint64_t m_discarded;
+  };
+
+  using CheckpointReplayShPtr = std::shared_ptr<CheckpointReplay>;
+}
+
+# include "CheckpointReplay.hxx"
+
+#endif    /* CHECKPOINT_REPLAY_HH */
@@ -0,0 +1,28 @@
+#ifndef    CHECKPOINT_REPLAY_HXX
+# define   CHECKPOINT_REPLAY_HXX
+
+# include "CheckpointReplay.hh"
+
+namespace cellulator {
+
+  inline
+  const std::vector<const LogRecordHeader*>&
+  CheckpointReplay::getRecords() const noexcept {
+    return m_records;
+  }
+
+  inline
+  std::uint64_t
+  CheckpointReplay::getGeneration() const noexcept {
+    return m_records.empty() ? 0u : m_records.back()->generation;
+  }
+
+  inline
+  std::uint64_t
+  CheckpointReplay::getDiscardedBytes() const noexcept {
+    return m_discarded;
+  }
+
+}
+
+#endif    /* CHECKPOINT_REPLAY_HXX */
@@ -1,5 +1,6 @@
 
 # include "Colony.hh"
+# include <algorithm>
 
 namespace cellulator {
 
@@ -12,7 +13,46 @@ namespace cellulator {
     m_generation(0u),
     m_liveCells(0u),
 
-    m_cells()
+    m_cells(),
+
+    m_viewportLocker(),
+    m_viewport(),
+    m_publishLocker(),
+    m_readLocker(),
+    m_snapshots(),
+    m_schedule()
+  {
+    setService("cells");
+
+    // Check consistency.
+    if (!dims.valid()) {
+      error(
+        std::string("Could not create colony"),
+        std::string("Invalid dimensions ") + dims.toString()
+      );
+    }
+
+    build(dims, getCellBlockDims());
+  }
+
+  Colony::Colony(const utils::Sizei& dims,
+                 const utils::Sizei& blockDims,
+                 const std::string& name):
+    utils::CoreObject(name),
+
+    m_propsLocker(),
+
+    m_generation(0u),
+    m_liveCells(0u),
+
+    m_cells(),
+
+    m_viewportLocker(),
+    m_viewport(),
+    m_publishLocker(),
+    m_readLocker(),
+    m_snapshots(),
+    m_schedule()
   {
     setService("cells");
 
@@ -24,19 +64,21 @@ namespace cellulator {
       );
     }
 
-    build(dims);
+    build(dims, blockDims);
   }
 
   unsigned
-  Colony::step(unsigned* alive) {
+  Colony::step(unsigned* alive,
+               unsigned generations)
+  {
     // Protect from concurrent accesses.
     const std::lock_guard guard(m_propsLocker);
 
     // We need to swap the internal arrays to move on to the next state.
-    m_liveCells = m_cells->step();
+    m_liveCells = m_cells->step(generations);
 
-    // One more generation has been computed.
-    ++m_generation;
+    // Some more generations have been computed.
+    m_generation += generations;
 
     // Fill in the number of alive cells if needed.
     if (alive != nullptr) {
@@ -46,6 +88,20 @@ namespace cellulator {
     return m_generation;
   }
 
+  void
+  Colony::reset() {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    m_cells->reset();
+
+    m_generation = 0u;
+    m_liveCells = 0u;
+
+    // Make the new cells visible to readers.
+    publishSnapshotPrivate();
+  }
+
   unsigned
   Colony::generate() {
     // Protect from concurrent accesses.
@@ -56,32 +112,346 @@ namespace cellulator {
     // The colony is back to square one.
     m_generation = 0u;
 
+    // Make the new cells visible to readers.
+    publishSnapshotPrivate();
+
     return m_liveCells;
   }
 
-  std::vector<ColonyTileShPtr>
-  Colony::generateSchedule() {
-    // Generate the schedule using the internal cells' data.
-    std::vector<ColonyTileShPtr> tiles;
-    m_cells->generateSchedule(tiles);
-
-    // In case the generated schedule is empty, it means that
-    // we don't have any evolution for this generation.
-    // we still need to move forward of one generation though
-    // as it still counts as a time step.
-    if (tiles.empty()) {
+  unsigned
+  Colony::generate(float density,
+                   unsigned seed)
+  {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    m_liveCells = m_cells->randomize(1.0f - std::clamp(density, 0.0f, 1.0f), seed);
+
+    // The colony is back to square one.
+    m_generation = 0u;
+
+    // Make the new cells visible to readers.
+    publishSnapshotPrivate();
+
+    return m_liveCells;
+  }
+
+  utils::Boxi
+  Colony::fetchCells(std::vector<std::pair<State, unsigned>>& cells,
+                     const utils::Boxf& area,
+                     bool* complete)
+  {
+    // Clamp the area to get only relevant cells.
+    utils::Boxi evenized = fromFPCoordinates(area);
+
+    // Register the area so that the next snapshots cover it: this is done
+    // on every call so that the snapshots follow the requested area even
+    // when it shrinks.
+    {
+      const std::lock_guard guard(m_viewportLocker);
+      m_viewport = evenized;
+    }
+
+    // Reset the output vector: cells which are not covered by the snapshot
+    // are considered dead.
+    cells.assign(evenized.area(), std::make_pair(State::Dead, 0u));
+
+    // Protect from concurrent readers: the cells of the colony are never
+    // accessed here so that the simulation is not slowed down.
+    const std::lock_guard guard(m_readLocker);
+
+    // Fetch the latest snapshot and copy the part overlapping the area.
+    m_snapshots.update();
+    const ColonySnapshot& snap = m_snapshots.getFrontBuffer();
+
+    int xMin = evenized.getLeftBound(), xMax = xMin + evenized.w();
+    int yMin = evenized.getBottomBound(), yMax = yMin + evenized.h();
+
+    int sxMin = snap.area.getLeftBound(), sxMax = sxMin + snap.area.w();
+    int syMin = snap.area.getBottomBound(), syMax = syMin + snap.area.h();
+
+    if (complete != nullptr) {
+      *complete = (snap.valid && sxMin <= xMin && sxMax >= xMax && syMin <= yMin && syMax >= yMax);
+    }
+
+    if (!snap.valid) {
+      return evenized;
+    }
+
+    int x0 = std::max(xMin, sxMin), x1 = std::min(xMax, sxMax);
+    int y0 = std::max(yMin, syMin), y1 = std::min(yMax, syMax);
+
+    for (int y = y0 ; y < y1 && x0 < x1 ; ++y) {
+      std::vector<std::pair<State, unsigned>>::const_iterator row =
+        snap.cells.cbegin() + (y - syMin) * snap.area.w() + (x0 - sxMin);
+
+      std::copy(row, row + (x1 - x0), cells.begin() + (y - yMin) * evenized.w() + (x0 - xMin));
+    }
+
+    return evenized;
+  }
+
+  unsigned
+  Colony::load(RleReader& reader,
+               const utils::Vector2i& coord)
+  {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    // The runs are expressed from the top of the pattern while the `y`
+    // axis of the colony goes up: mirror them so that the pattern is
+    // positioned like a brush loaded from the same file.
+    const utils::Sizei& size = reader.getSize();
+
+    int offX = coord.x() - size.w() / 2;
+    int offY = coord.y() - size.h() / 2 + size.h() - 1;
+
+    std::vector<utils::Vector2i> batch;
+    batch.reserve(getLoadBatchSize());
+
+    CellsRun run;
+
+    while (reader.next(run)) {
+      for (unsigned id = 0u ; id < run.length ; ++id) {
+        batch.push_back(utils::Vector2i(offX + run.x + static_cast<int>(id), offY - run.y));
+
+        // Blocks are only cleaned up once all the cells are created.
+        if (batch.size() >= getLoadBatchSize()) {
+          m_cells->spawn(batch, false);
+          batch.clear();
+        }
+      }
+    }
+
+    m_liveCells = m_cells->spawn(batch, true);
+
+    // Make the new cells visible to readers.
+    publishSnapshotPrivate();
+
+    return m_liveCells;
+  }
+
+  unsigned
+  Colony::load(const Macrocell& pattern,
+               const utils::Vector2i& coord)
+  {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    // Blocks are only cleaned up once all the cells are created.
+    pattern.visit(
+      coord,
+      getLoadBatchSize(),
+      [this](const std::vector<utils::Vector2i>& cells) {
+        m_cells->spawn(cells, false);
+      }
+    );
+
+    m_liveCells = m_cells->spawn(std::vector<utils::Vector2i>(), true);
+
+    // Resume from the generation saved in the pattern, if any.
+    m_generation = static_cast<unsigned>(pattern.getGeneration());
+
+    // Make the new cells visible to readers.
+    publishSnapshotPrivate();
+
+    return m_liveCells;
+  }
+
+  void
+  Colony::save(Macrocell& pattern) {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    pattern.clear();
+
+    m_cells->visitLiveCells(
+      [&pattern](const std::vector<utils::Vector2i>& cells) {
+        pattern.add(cells);
+      }
+    );
+
+    pattern.compact();
+
+    CellEvolverShPtr ruleset = m_cells->getRuleset();
+    pattern.setRule(ruleset != nullptr ? ruleset->toRule() : std::string());
+    pattern.setGeneration(m_generation);
+  }
+
+  void
+  Colony::checkpoint(const std::string& file) {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    m_cells->checkpoint(file, m_generation);
+  }
+
+  unsigned
+  Colony::restore(const std::string& file) {
+    // The checkpoint is mapped before acquiring the locker: this can take
+    // some time for large files.
+    Checkpoint checkpoint(file);
+
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    m_liveCells = m_cells->restore(checkpoint);
+    m_generation = static_cast<unsigned>(checkpoint.getHeader().generation);
+
+    // Make the new cells visible to readers.
+    publishSnapshotPrivate();
+
+    return m_liveCells;
+  }
+
+  void
+  Colony::capture(CheckpointLog& log) {
+    std::vector<char> record;
+
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
+
+      m_cells->capture(record, m_generation, log.needsBase());
+    }
+
+    // Queuing the record might wait for the log: do it without
+    // holding the locker.
+    log.push(std::move(record));
+  }
+
+  unsigned
+  Colony::replay(const std::string& file) {
+    // The log is mapped and scanned before acquiring the locker: this
+    // can take some time for large files.
+    CheckpointReplay log(file);
+
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    m_liveCells = m_cells->replay(log);
+    m_generation = static_cast<unsigned>(log.getGeneration());
+
+    // Make the new cells visible to readers.
+    publishSnapshotPrivate();
+
+    return m_liveCells;
+  }
+
+  void
+  Colony::record(Recorder& recorder) {
+    RecordedFrame frame;
+
+    {
+      // Protect from concurrent accesses.
       const std::lock_guard guard(m_propsLocker);
 
-      ++m_generation;
+      frame.generation = m_generation;
+      frame.alive = m_liveCells;
+
+      m_cells->copyLiveBlocks(frame.areas, frame.cells);
+    }
+
+    recorder.push(std::move(frame));
+  }
+
+  unsigned
+  Colony::play(const RecordingFrame& frame) {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    if (frame.keyframe) {
+      m_cells->reset();
     }
 
-    return tiles;
+    m_liveCells = m_cells->apply(frame.births, frame.deaths);
+    m_generation = static_cast<unsigned>(frame.generation);
+
+    // Make the new cells visible to readers.
+    publishSnapshotPrivate();
+
+    return m_liveCells;
+  }
+
+  void
+  Colony::publishSnapshot() {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    publishSnapshotPrivate();
   }
 
   void
-  Colony::build(const utils::Sizei& dims) {
+  Colony::publishSnapshotPrivate() {
+    utils::Boxi area;
+
+    {
+      const std::lock_guard guard(m_viewportLocker);
+      area = m_viewport;
+    }
+
+    // Nothing to do in case no area has been requested yet.
+    if (!area.valid()) {
+      return;
+    }
+
+    const std::lock_guard guard(m_publishLocker);
+
+    // Fill the back buffer: its memory is reused from a previous snapshot
+    // so this usually does not allocate anything.
+    ColonySnapshot& snap = m_snapshots.getBackBuffer();
+
+    snap.generation = m_generation;
+    snap.area = area;
+    snap.cells.resize(area.area());
+
+    m_cells->fetchCells(snap.cells, area);
+
+    snap.valid = true;
+
+    m_snapshots.publish();
+  }
+
+  void
+  Colony::generateSchedule(std::vector<unsigned>& blocks) {
+    // Generate the schedule using the internal cells' data.
+    m_cells->generateSchedule(blocks);
+  }
+
+  unsigned
+  Colony::simulate(unsigned generations,
+                   unsigned temporal)
+  {
+    unsigned batch = std::max(std::min(temporal, getMaxGenerationsPerEvolution()), 1u);
+    unsigned done = 0u;
+
+    while (done < generations) {
+      m_cells->generateSchedule(m_schedule);
+
+      // No more blocks to evolve: all cells are dead.
+      if (m_schedule.empty()) {
+        break;
+      }
+
+      unsigned count = std::min(batch, generations - done);
+
+      for (unsigned id = 0u ; id < m_schedule.size() ; ++id) {
+        m_cells->evolve(m_schedule[id], count);
+      }
+
+      step(nullptr, count);
+      done += count;
+    }
+
+    return done;
+  }
+
+  void
+  Colony::build(const utils::Sizei& dims,
+                const utils::Sizei& blockDims)
+  {
     // Create the cells' data.
-    m_cells = std::make_shared<CellsBlocks>(getCellBlockDims());
+    m_cells = std::make_shared<CellsBlocks>(blockDims);
 
     // Allocate initial blocks.
     m_cells->allocateTo(dims);
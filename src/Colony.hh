@@ -2,18 +2,35 @@
 # define   COLONY_HH
 
 # include <mutex>
+# include <atomic>
 # include <memory>
 # include <core_utils/CoreObject.hh>
 # include <maths_utils/Box.hh>
 # include <maths_utils/Size.hh>
 # include <maths_utils/Vector2.hh>
-# include "ColonyTile.hh"
 # include "CellsBlocks.hh"
 # include "CellEvolver.hh"
 # include "CellBrush.hh"
+# include "RleReader.hh"
+# include "Macrocell.hh"
+# include "Recorder.hh"
+# include "RecordingPlayer.hh"
+# include "TripleBuffer.hh"
 
 namespace cellulator {
 
+  /**
+   * @brief - Describes a copy of a part of the colony at a given generation. It
+   *          is published by the simulation and used to render the colony with
+   *          no contention with the computation of the next generations.
+   */
+  struct ColonySnapshot {
+    bool valid;                                       //< Whether this snapshot has been filled.
+    unsigned generation;                              //< The generation of the cells.
+    utils::Boxi area;                                 //< The area covered by the cells.
+    std::vector<std::pair<State, unsigned>> cells;    //< The states and ages of the cells.
+  };
+
   class Colony: public utils::CoreObject {
     public:
 
@@ -27,6 +44,20 @@ namespace cellulator {
       Colony(const utils::Sizei& dims,
              const std::string& name = std::string("Daddy's lil monster"));
 
+      /**
+       * @brief - Create a colony with the specified size and using blocks of the
+       *          provided dimensions to store the cells. This is mostly useful to
+       *          measure the influence of the size of the blocks on performance:
+       *          the default constructor picks a reasonable value.
+       *          An error is raised in case the blocks dimensions are not valid.
+       * @param dims - the dimensions of the colony.
+       * @param blockDims - the dimensions of a single block of cells.
+       * @param name - the lil' name of the colony.
+       */
+      Colony(const utils::Sizei& dims,
+             const utils::Sizei& blockDims,
+             const std::string& name = std::string("Daddy's lil monster"));
+
       /**
        * @brief - Destruction of the colony.
        */
@@ -70,13 +101,33 @@ namespace cellulator {
        *          The input dimensions are clamped to the lowest which means that
        *          for example if the box spans `x: 50, w: 25`, the actual cells
        *          will be `[37; 62]`.
+       *          The cells are fetched from the last snapshot published through
+       *          `publishSnapshot` so that this does not interfere with the simulation.
+       *          The area is recorded so that the next snapshots cover it: until then
+       *          the cells which are not part of the snapshot are reported as `Dead`
+       *          and the `complete` flag is reset.
+       *          Note that this method is assumed to always be called from the same
+       *          thread (typically the one rendering the colony).
        * @param cells - output vector where cells will be saved.
        * @param area - the area for which cells should be retrieved.
+       * @param complete - output value indicating whether the snapshot covered the
+       *                   whole area. Ignored if `null`.
        * @return - the actual box of the cells returned in the `cells` vector.
        */
       utils::Boxi
       fetchCells(std::vector<std::pair<State, unsigned>>& cells,
-                 const utils::Boxf& area);
+                 const utils::Boxf& area,
+                 bool* complete = nullptr);
+
+      /**
+       * @brief - Used to publish a copy of the area of the colony last requested through
+       *          the `fetchCells` method. This allows the readers to always access the
+       *          latest complete generation without blocking the simulation.
+       *          This should be called when no block is being evolved, typically after a
+       *          call to `step`. Nothing happens if no area was ever requested.
+       */
+      void
+      publishSnapshot();
 
       /**
        * @brief - Used to retrieve the state and age of the cell at the position
@@ -90,6 +141,14 @@ namespace cellulator {
       std::pair<State, int>
       getCellState(const utils::Vector2i& coord);
 
+      /**
+       * @brief - Used to retrieve the coordinates of all the live cells of the colony.
+       *          The order of the cells is not specified.
+       * @param cells - output vector receiving the coordinates of the live cells.
+       */
+      void
+      getLiveCells(std::vector<utils::Vector2i>& cells);
+
       /**
        * @brief - Used to simulate a single step of the colony's life. Nothing is
        *          done in case the colony is already running.
@@ -97,18 +156,21 @@ namespace cellulator {
        *          each individual cell to be updated with a consistent `next` state
        *          before calling it.
        *          Usually this is done through the `generateSchedule` interface to
-       *          generate a list of jobs that can be executed to evolve each cell
+       *          generate a list of blocks that can be evolved to update each cell
        *          of the colony.
        *          Once this is done this method only applies the modifications so
        *          as to make them current.
        * @param alive - pointer which will be filled with the number of alive cells
        *                in the colony if needed.
+       * @param generations - the number of generations the blocks have been evolved
+       *                      with (see `evolve`).
        * @return - the new generation of the colony (typically starts at `0`): note
        *           that the first value returned by this method is `1` (as the `0`
        *           generation is actually the starting point).
        */
       unsigned
-      step(unsigned* alive = nullptr);
+      step(unsigned* alive = nullptr,
+           unsigned generations = 1u);
 
       /**
        * @brief - Used to generate a random colony without modifying the dimensions
@@ -122,16 +184,92 @@ namespace cellulator {
       generate();
 
       /**
-       * @brief - Used to generate a list of tiles to schedule for evolving the cells
+       * @brief - Used to reset the colony to its initial dimensions with only dead
+       *          cells and to go back to the generation `0`. The memory allocated
+       *          for the cells is kept so that a colony can be used to run several
+       *          independent simulations without allocating memory each time.
+       */
+      void
+      reset();
+
+      /**
+       * @brief - Similar to `generate` but allows to specify the proportion of
+       *          cells that should be alive and the seed to use for the random
+       *          generation. Two colonies generated with the same seed and the
+       *          same density are guaranteed to be identical which is useful to
+       *          compare several runs.
+       * @param density - the probability for a cell to be alive, in `[0; 1]`.
+       * @param seed - the seed of the random generator.
+       * @return - the number of live cells created during the process.
+       */
+      unsigned
+      generate(float density,
+               unsigned seed);
+
+      /**
+       * @brief - Used to generate a list of blocks to schedule for evolving the cells
        *          composing the colony. This schedule is by no means executed and is
        *          used to reflect the internal structure of the colony to divide the
        *          workload efficiently.
-       *          The return value is a list of tiles that can be executed concurrently
-       *          and which allow to evolve the colony one step further in time.
-       * @return - a list of tiles to execute to evolve the colony.
+       *          The output vector is filled with the indices of blocks that can be
+       *          evolved concurrently (see `evolve`) and which allow to evolve the
+       *          colony one step further in time. An empty schedule indicates that
+       *          the colony does not have any active block anymore.
+       * @param blocks - output vector receiving the blocks to evolve.
+       */
+      void
+      generateSchedule(std::vector<unsigned>& blocks);
+
+      /**
+       * @brief - Used to perform the evolution of the block with the specified index.
+       *          This is meant to be called on each element produced by the method
+       *          `generateSchedule` and can be safely called concurrently for two
+       *          distinct blocks.
+       *          Note that the generation is not made current until `step` is called.
+       *          Several generations can be computed at once in which case the same
+       *          value should be provided for all the blocks and to `step`.
+       *          The evolution can be interrupted through the input flag in which case
+       *          the `rollback` method should be used to discard the generation.
+       * @param blockID - the index of the block to evolve.
+       * @param generations - the number of generations to compute for this block.
+       * @param interrupt - a flag polled to interrupt the evolution. Ignored if `null`.
+       * @return - `true` if the block was evolved and `false` if it was interrupted.
+       */
+      bool
+      evolve(unsigned blockID,
+             unsigned generations = 1u,
+             const std::atomic<bool>* interrupt = nullptr);
+
+      /**
+       * @brief - Used to evolve the colony for the specified number of generations in
+       *          the calling thread. This is meant for colonies which are simulated
+       *          without a scheduler, typically when a lot of small colonies are run
+       *          in parallel and each one of them is a unit of work.
+       *          The evolution stops early in case no blocks need to be evolved anymore
+       *          which indicates that all the cells are dead.
+       * @param generations - the number of generations to compute.
+       * @param temporal - the maximum number of generations computed for each block at
+       *                   once (see `evolve`).
+       * @return - the number of generations actually computed.
+       */
+      unsigned
+      simulate(unsigned generations,
+               unsigned temporal = 1u);
+
+      /**
+       * @brief - Used to discard the blocks evolved since the last call to `step`. The
+       *          colony stays at the last generation reached.
        */
-      std::vector<ColonyTileShPtr>
-      generateSchedule();
+      void
+      rollback();
+
+      /**
+       * @brief - Used to retrieve the maximum number of generations that can be computed
+       *          in a single call to `evolve`.
+       * @return - the maximum number of generations per evolution.
+       */
+      unsigned
+      getMaxGenerationsPerEvolution() const noexcept;
 
       /**
        * @brief - Used by external providers to update the ruleset used by this colony
@@ -141,6 +279,30 @@ namespace cellulator {
       void
       setRuleset(CellEvolverShPtr ruleset);
 
+      /**
+       * @brief - Retrieve the rules used to evolve cells.
+       * @return - the current ruleset.
+       */
+      CellEvolverShPtr
+      getRuleset();
+
+      /**
+       * @brief - Define the number of generations after which the blocks of cells
+       *          which did not change are compressed in memory. See the method of
+       *          `CellsBlocks` for more details.
+       * @param generations - the number of generations without changes needed for
+       *                      a block to be compressed, `0` to disable it.
+       */
+      void
+      setColdThreshold(unsigned generations);
+
+      /**
+       * @brief - Retrieve the memory used by the blocks of cells of the colony.
+       * @return - the description of the storage of the blocks.
+       */
+      CellsBlocks::Storage
+      getStorage();
+
       /**
        * @brief - Used to perform the creation of cells as described by the input brush
        *          at the coordinates in input. The needed blocks will be created to be
@@ -149,11 +311,128 @@ namespace cellulator {
        * @param brush - the brush to paint on this colony.
        * @param coord - the coordinate at which the brush should be painted. This info
        *                corresponds to the center of the brush.
+       * @param orientation - the orientation in which the brush is painted.
        * @return - the number of live cells after the paint operation.
        */
       unsigned
       paint(const CellBrush& brush,
-            const utils::Vector2i& coord);
+            const utils::Vector2i& coord,
+            const BrushOrientation& orientation = BrushOrientation::Identity);
+
+      /**
+       * @brief - Used to create the cells of the pattern decoded by the reader in input
+       *          at the coordinates in input. Unlike `paint` the pattern is not fully
+       *          loaded in memory: the cells are streamed from the file and created by
+       *          batches, which allows to load very large patterns.
+       *          The pattern is positioned as if it was painted with a brush loaded
+       *          from the same file.
+       * @param reader - the reader decoding the pattern to load.
+       * @param coord - the coordinate at which the pattern should be created. This info
+       *                corresponds to the center of the pattern.
+       * @return - the number of live cells after the operation.
+       */
+      unsigned
+      load(RleReader& reader,
+           const utils::Vector2i& coord);
+
+      /**
+       * @brief - Used to create the cells of the pattern in input at the coordinates
+       *          in input. Only the blocks containing live cells of the pattern are
+       *          created and the cells are provided by batches so that the operation
+       *          does not need to expand the whole pattern in memory.
+       *          The generation of the colony is set to the one of the pattern (as
+       *          saved by `save`), which is `0` for patterns without a `#G` line.
+       * @param pattern - the pattern to load.
+       * @param coord - the coordinate at which the origin of the pattern is placed.
+       * @return - the number of live cells after the operation.
+       */
+      unsigned
+      load(const Macrocell& pattern,
+           const utils::Vector2i& coord);
+
+      /**
+       * @brief - Used to save the live cells of the colony into the pattern in input
+       *          which is cleared beforehand. The cells are provided block by block
+       *          and identical sub-squares are shared in the resulting quadtree. The
+       *          rule and the generation of the colony are also saved.
+       * @param pattern - output pattern receiving the cells of the colony.
+       */
+      void
+      save(Macrocell& pattern);
+
+      /**
+       * @brief - Used to write the complete state of the colony to a checkpoint file
+       *          so that the simulation can be resumed later on exactly where it was
+       *          left. See `CellsBlocks::checkpoint` for more details.
+       * @param file - the name of the checkpoint file.
+       */
+      void
+      checkpoint(const std::string& file);
+
+      /**
+       * @brief - Used to resume the colony from the checkpoint file in argument: the
+       *          cells, the ruleset and the generation are replaced with the content
+       *          of the checkpoint.
+       * @param file - the name of the checkpoint file.
+       * @return - the number of live cells after the operation.
+       */
+      unsigned
+      restore(const std::string& file);
+
+      /**
+       * @brief - Used to append the state of the colony to the checkpoint log in
+       *          argument. Only the blocks modified since the previous record are
+       *          saved unless the log requests a base record. The record is then
+       *          written in the background by the log.
+       *          See `CellsBlocks::capture` for more details.
+       * @param log - the checkpoint log receiving the record.
+       */
+      void
+      capture(CheckpointLog& log);
+
+      /**
+       * @brief - Used to resume the colony from the checkpoint log in argument: the
+       *          cells, the ruleset and the generation are replaced with the ones of
+       *          the last complete record of the log.
+       * @param file - the name of the checkpoint log.
+       * @return - the number of live cells after the operation.
+       */
+      unsigned
+      replay(const std::string& file);
+
+      /**
+       * @brief - Used to append the current content of the colony to the recording in
+       *          argument. Only the blocks containing live cells are copied: they are
+       *          then compared to the previous frame and written in the background by
+       *          the recorder.
+       * @param recorder - the recorder receiving the frame.
+       */
+      void
+      record(Recorder& recorder);
+
+      /**
+       * @brief - Used to display a frame of a recording in the colony: the changes of
+       *          the frame are applied to the cells (or the cells are replaced by the
+       *          ones of the frame for a keyframe) and the generation is set to the
+       *          one of the frame. The colony is not simulated.
+       * @param frame - the frame to display.
+       * @return - the number of live cells after the operation.
+       */
+      unsigned
+      play(const RecordingFrame& frame);
+
+      /**
+       * @brief - Used to determine the dimensions of the blocks of a colony used to
+       *          run random soups of the specified dimensions. As the randomization
+       *          fills whole blocks the soup is covered exactly by the blocks. They
+       *          are also kept small so that the objects escaping the soup are cheap
+       *          to simulate. Soups should have even dimensions.
+       * @param soup - the dimensions of a soup.
+       * @return - the dimensions of the blocks.
+       */
+      static
+      utils::Sizei
+      getSoupBlockDims(const utils::Sizei& soup) noexcept;
 
     private:
 
@@ -172,14 +451,25 @@ namespace cellulator {
       utils::Sizei
       getCellBlockDims() noexcept;
 
+      /**
+       * @brief - The number of cells created at once when a pattern is loaded from a
+       *          file. This bounds the memory used by the operation.
+       * @return - the size of a batch of cells.
+       */
+      static
+      unsigned
+      getLoadBatchSize() noexcept;
+
       /**
        * @brief - Connect signals and build the scheduler to use to simulate the colony.
        *          Also perform the creation of the undelrying data used to keep the cells'
        *          data for this colony.
        * @param dims - the dimensions of the colony upon creation.
+       * @param blockDims - the dimensions of a single block of cells.
        */
       void
-      build(const utils::Sizei& dims);
+      build(const utils::Sizei& dims,
+            const utils::Sizei& blockDims);
 
       /**
        * @brief - Used to convert the input box from a floating point semantic to a
@@ -193,6 +483,13 @@ namespace cellulator {
       utils::Boxi
       fromFPCoordinates(const utils::Boxf& in) const noexcept;
 
+      /**
+       * @brief - Implementation of the `publishSnapshot` method which assumes that the
+       *          locker on the options is already acquired.
+       */
+      void
+      publishSnapshotPrivate();
+
     private:
 
       /**
@@ -218,6 +515,42 @@ namespace cellulator {
        * @brief - The internal container for the cells representing the colony.
        */
       CellsBlocksShPtr m_cells;
+
+      /**
+       * @brief - Protects the area requested by the readers of the colony. It is only
+       *          held for short durations to update or copy the area.
+       */
+      std::mutex m_viewportLocker;
+
+      /**
+       * @brief - The last area requested by the readers of the colony: this is the area
+       *          copied when a snapshot is published. Invalid until the first request.
+       */
+      utils::Boxi m_viewport;
+
+      /**
+       * @brief - Serializes the producers of snapshots. As snapshots are published when
+       *          the simulation is not running this is never contended by the workers.
+       */
+      std::mutex m_publishLocker;
+
+      /**
+       * @brief - Serializes the readers of snapshots. As the snapshots are consumed in a
+       *          lock-free way this never blocks the simulation.
+       */
+      std::mutex m_readLocker;
+
+      /**
+       * @brief - The snapshots of the colony exchanged between the simulation and the
+       *          readers of the colony.
+       */
+      TripleBuffer<ColonySnapshot> m_snapshots;
+
+      /**
+       * @brief - The blocks to evolve when the colony is simulated in the calling thread
+       *          (see `simulate`). Kept as a member to reuse the memory.
+       */
+      std::vector<unsigned> m_schedule;
   };
 
   using ColonyShPtr = std::shared_ptr<Colony>;
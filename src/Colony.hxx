@@ -1,6 +1,7 @@
 #ifndef    COLONY_HXX
 # define   COLONY_HXX
 
+# include <algorithm>
 # include "Colony.hh"
 
 namespace cellulator {
@@ -30,33 +31,38 @@ namespace cellulator {
   }
 
   inline
-  utils::Boxi
-  Colony::fetchCells(std::vector<std::pair<State, unsigned>>& cells,
-                     const utils::Boxf& area)
-  {
-    // Protect from concurrent accesses.
-    const std::lock_guard guard(m_propsLocker);
-
-    // Clamp the area to get only relevant cells.
-    utils::Boxi evenized = fromFPCoordinates(area);
+  std::pair<State, int>
+  Colony::getCellState(const utils::Vector2i& coord) {
+    return m_cells->getCellStatus(coord);
+  }
 
-    // Resize the output vector if needed.
-    if (cells.size() != static_cast<unsigned>(evenized.area())) {
-      cells.resize(evenized.area());
-    }
+  inline
+  void
+  Colony::getLiveCells(std::vector<utils::Vector2i>& cells) {
+    m_cells->getLiveCells(cells);
+  }
 
-    // Fetch the cells from the internal data.
-    m_cells->fetchCells(cells, evenized);
+  inline
+  bool
+  Colony::evolve(unsigned blockID,
+                 unsigned generations,
+                 const std::atomic<bool>* interrupt)
+  {
+    // Call the dedicated handler.
+    return m_cells->evolve(blockID, generations, interrupt);
+  }
 
-    // Return the area that is actually represented by the
-    // returns `cells` array.
-    return evenized;
+  inline
+  void
+  Colony::rollback() {
+    // Call the dedicated handler.
+    m_cells->rollback();
   }
 
   inline
-  std::pair<State, int>
-  Colony::getCellState(const utils::Vector2i& coord) {
-    return m_cells->getCellStatus(coord);
+  unsigned
+  Colony::getMaxGenerationsPerEvolution() const noexcept {
+    return m_cells->getMaxGenerationsPerEvolution();
   }
 
   inline
@@ -66,25 +72,71 @@ namespace cellulator {
     m_cells->setRuleset(ruleset);
   }
 
+  inline
+  CellEvolverShPtr
+  Colony::getRuleset() {
+    // Call the dedicated handler.
+    return m_cells->getRuleset();
+  }
+
+  inline
+  void
+  Colony::setColdThreshold(unsigned generations) {
+    // Call the dedicated handler.
+    m_cells->setColdThreshold(generations);
+  }
+
+  inline
+  CellsBlocks::Storage
+  Colony::getStorage() {
+    // Call the dedicated handler.
+    return m_cells->getStorage();
+  }
+
   inline
   unsigned
   Colony::paint(const CellBrush& brush,
-                const utils::Vector2i& coord)
+                const utils::Vector2i& coord,
+                const BrushOrientation& orientation)
   {
     // Protect from concurrent accesses.
     const std::lock_guard guard(m_propsLocker);
 
-    m_liveCells = m_cells->paint(brush, coord);
+    m_liveCells = m_cells->paint(brush, coord, orientation);
+
+    // Make the new cells visible to readers.
+    publishSnapshotPrivate();
 
     return m_liveCells;
   }
 
+  inline
+  utils::Sizei
+  Colony::getSoupBlockDims(const utils::Sizei& soup) noexcept {
+    int w = std::min(soup.w(), 8), h = std::min(soup.h(), 8);
+
+    while (w > 2 && (w % 2 != 0 || soup.w() % w != 0)) {
+      --w;
+    }
+    while (h > 2 && (h % 2 != 0 || soup.h() % h != 0)) {
+      --h;
+    }
+
+    return utils::Sizei(w, h);
+  }
+
   inline
   utils::Sizei
   Colony::getCellBlockDims() noexcept {
     return utils::Sizei(256, 256);
   }
 
+  inline
+  unsigned
+  Colony::getLoadBatchSize() noexcept {
+    return 65536u;
+  }
+
   inline
   utils::Boxi
   Colony::fromFPCoordinates(const utils::Boxf& in) const noexcept {
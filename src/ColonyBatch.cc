@@ -0,0 +1,141 @@
+
+# include "ColonyBatch.hh"
+# include <algorithm>
+# include <chrono>
+
+namespace cellulator {
+
+  ColonyBatch::ColonyBatch(unsigned threads):
+    utils::CoreObject(std::string("colony_batch")),
+
+    m_propsLocker(),
+    m_waiter(),
+
+    m_colonies(),
+    m_running(false),
+    m_pending(0u),
+    m_statistics{0u, 0u, 0ul, 0.0, 0.0},
+
+    m_pool(std::make_shared<utils::ThreadPool>(threads > 0u ? threads : getDefaultThreadCount()))
+  {
+    setService("batch");
+
+    m_pool->onJobsCompleted.connect_member<ColonyBatch>(
+      this,
+      &ColonyBatch::handleJobsCompleted
+    );
+
+    // Disable logging for the pool.
+    m_pool->setAllowLog(false);
+  }
+
+  std::vector<ColonyResult>
+  ColonyBatch::run(unsigned generations,
+                   unsigned temporal)
+  {
+    std::vector<ColonyJobShPtr> jobs;
+
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
+
+      if (m_running) {
+        error(
+          std::string("Could not run batch of ") + std::to_string(m_colonies.size()) + " colonies",
+          std::string("Batch is already running")
+        );
+      }
+
+      for (unsigned id = 0u ; id < m_colonies.size() ; ++id) {
+        jobs.push_back(std::make_shared<ColonyJob>(m_colonies[id], generations, temporal));
+      }
+
+      m_running = !jobs.empty();
+      m_pending = jobs.size();
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    if (!jobs.empty()) {
+      // Submit the most populated colonies first: they are likely to take the
+      // longest and we don't want them to be the last ones to complete.
+      std::vector<unsigned> alive(jobs.size());
+
+      for (unsigned id = 0u ; id < jobs.size() ; ++id) {
+        alive[id] = m_colonies[id]->getLiveCellsCount();
+      }
+
+      std::vector<unsigned> order(jobs.size());
+      for (unsigned id = 0u ; id < order.size() ; ++id) {
+        order[id] = id;
+      }
+
+      std::stable_sort(
+        order.begin(),
+        order.end(),
+        [&alive](unsigned lhs, unsigned rhs) {
+          return alive[lhs] > alive[rhs];
+        }
+      );
+
+      std::vector<utils::AsynchronousJobShPtr> submitted;
+      for (unsigned id = 0u ; id < order.size() ; ++id) {
+        submitted.push_back(jobs[order[id]]);
+      }
+
+      m_pool->enqueueJobs(submitted, false);
+      m_pool->notifyJobs();
+
+      // Wait for all the colonies to be simulated.
+      std::unique_lock lock(m_propsLocker);
+      m_waiter.wait(
+        lock,
+        [this]() {
+          return m_pending == 0u;
+        }
+      );
+
+      m_running = false;
+    }
+
+    // Gather the results.
+    std::vector<ColonyResult> results;
+    Statistics stats{static_cast<unsigned>(jobs.size()), 0u, 0ul, 0.0, 0.0};
+
+    for (unsigned id = 0u ; id < jobs.size() ; ++id) {
+      const ColonyResult& res = jobs[id]->getResult();
+
+      if (!res.success) {
+        warn("Failed to simulate colony \"" + res.name + "\": " + res.error);
+        ++stats.failures;
+      }
+
+      stats.generations += res.computed;
+      stats.busy += res.elapsed;
+
+      results.push_back(res);
+    }
+
+    stats.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    {
+      const std::lock_guard guard(m_propsLocker);
+      m_statistics = stats;
+    }
+
+    return results;
+  }
+
+  void
+  ColonyBatch::handleJobsCompleted(const std::vector<utils::AsynchronousJobShPtr>& jobs) {
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
+
+      m_pending -= std::min(m_pending, static_cast<unsigned>(jobs.size()));
+    }
+
+    m_waiter.notify_all();
+  }
+
+}
@@ -0,0 +1,141 @@
+#ifndef    COLONY_BATCH_HH
+# define   COLONY_BATCH_HH
+
+# include <mutex>
+# include <memory>
+# include <vector>
+# include <condition_variable>
+# include <core_utils/CoreObject.hh>
+# include <core_utils/ThreadPool.hh>
+# include "Colony.hh"
+# include "ColonyJob.hh"
+
+namespace cellulator {
+
+  class ColonyBatch: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Convenience structure describing the aggregated performance of
+       *          the last batch of colonies simulated.
+       */
+      struct Statistics {
+        unsigned colonies;          //< The number of colonies simulated.
+        unsigned failures;          //< The number of colonies which failed to simulate.
+        unsigned long generations;  //< The total number of generations computed.
+        double elapsed;             //< The wall-clock duration of the batch in seconds.
+        double busy;                //< The cumulated time spent simulating colonies in seconds.
+      };
+
+      /**
+       * @brief - Create a batch allowing to simulate many independent colonies with
+       *          a single pool of threads. Each colony is a unit of work: it will be
+       *          entirely simulated by one thread. This is much more efficient than
+       *          using a scheduler for each colony when colonies are small.
+       * @param threads - the number of threads of the pool. A value of `0` means
+       *                  that one thread per core is used.
+       */
+      ColonyBatch(unsigned threads = 0u);
+
+      ~ColonyBatch() = default;
+
+      /**
+       * @brief - Register a colony to simulate in the next batch.
+       * @param colony - the colony to register.
+       * @return - the index of the colony, which is also the index of its result
+       *           in the output of `run`.
+       */
+      unsigned
+      add(ColonyShPtr colony);
+
+      /**
+       * @brief - Remove all the colonies registered in the batch.
+       */
+      void
+      clear();
+
+      /**
+       * @brief - Simulate all the registered colonies for the specified number of
+       *          generations and wait for the simulation to complete. Colonies in
+       *          which all cells die stop early.
+       *          An error is raised in case a batch is already running.
+       * @param generations - the number of generations to simulate.
+       * @param temporal - the number of generations computed at once for each block
+       *                   of the colonies.
+       * @return - the results for each colony in the order they were registered.
+       */
+      std::vector<ColonyResult>
+      run(unsigned generations,
+          unsigned temporal = 1u);
+
+      /**
+       * @brief - Retrieve the statistics about the last batch of colonies.
+       * @return - the statistics of the last batch.
+       */
+      Statistics
+      getStatistics();
+
+    private:
+
+      /**
+       * @brief - Used to determine the number of threads to use when none is
+       *          specified.
+       * @return - the default number of threads of the pool.
+       */
+      static
+      unsigned
+      getDefaultThreadCount() noexcept;
+
+      /**
+       * @brief - Connected to the pool to be notified when some colonies have been
+       *          simulated.
+       * @param jobs - the jobs which have been computed.
+       */
+      void
+      handleJobsCompleted(const std::vector<utils::AsynchronousJobShPtr>& jobs);
+
+    private:
+
+      /**
+       * @brief - Protects the state of the batch from concurrent accesses.
+       */
+      std::mutex m_propsLocker;
+
+      /**
+       * @brief - Used to wait for the completion of the colonies of a batch.
+       */
+      std::condition_variable m_waiter;
+
+      /**
+       * @brief - The colonies registered in the batch.
+       */
+      std::vector<ColonyShPtr> m_colonies;
+
+      /**
+       * @brief - Whether a batch is currently running.
+       */
+      bool m_running;
+
+      /**
+       * @brief - The number of colonies of the current batch not yet simulated.
+       */
+      unsigned m_pending;
+
+      /**
+       * @brief - The statistics of the last batch.
+       */
+      Statistics m_statistics;
+
+      /**
+       * @brief - The pool of threads simulating the colonies. Declared last so that
+       *          the threads are joined before the rest of the batch is destroyed.
+       */
+      utils::ThreadPoolShPtr m_pool;
+  };
+
+  using ColonyBatchShPtr = std::shared_ptr<ColonyBatch>;
+}
+
+# include "ColonyBatch.hxx"
+
+#endif    /* COLONY_BATCH_HH */
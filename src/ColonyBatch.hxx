@@ -0,0 +1,60 @@
+#ifndef    COLONY_BATCH_HXX
+# define   COLONY_BATCH_HXX
+
+# include <thread>
+# include "ColonyBatch.hh"
+
+namespace cellulator {
+
+  inline
+  unsigned
+  ColonyBatch::add(ColonyShPtr colony) {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    if (colony == nullptr) {
+      error(
+        std::string("Could not register colony in batch"),
+        std::string("Invalid null colony")
+      );
+    }
+
+    m_colonies.push_back(colony);
+
+    return m_colonies.size() - 1u;
+  }
+
+  inline
+  void
+  ColonyBatch::clear() {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    if (m_running) {
+      error(
+        std::string("Could not clear batch"),
+        std::string("Batch is running")
+      );
+    }
+
+    m_colonies.clear();
+  }
+
+  inline
+  ColonyBatch::Statistics
+  ColonyBatch::getStatistics() {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    return m_statistics;
+  }
+
+  inline
+  unsigned
+  ColonyBatch::getDefaultThreadCount() noexcept {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+}
+
+#endif    /* COLONY_BATCH_HXX */
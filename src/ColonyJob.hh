@@ -0,0 +1,88 @@
+#ifndef    COLONY_JOB_HH
+# define   COLONY_JOB_HH
+
+# include <memory>
+# include <string>
+# include <core_utils/AsynchronousJob.hh>
+# include "Colony.hh"
+
+namespace cellulator {
+
+  /**
+   * @brief - The outcome of the simulation of a colony as part of a batch.
+   */
+  struct ColonyResult {
+    std::string name;     //< The name of the colony.
+    unsigned generation;  //< The generation reached by the colony.
+    unsigned computed;    //< The number of generations computed during the batch.
+    unsigned alive;       //< The number of live cells at the end of the simulation.
+    double elapsed;       //< The time spent simulating the colony in seconds.
+    bool success;         //< Whether the simulation completed without errors.
+    std::string error;    //< The description of the error if any.
+  };
+
+  class ColonyJob: public utils::AsynchronousJob {
+    public:
+
+      /**
+       * @brief - Creates a job simulating a whole colony for the specified number
+       *          of generations. The colony is evolved in the thread executing
+       *          the job: this is meant to process many small colonies where it
+       *          is more efficient to distribute the colonies among the threads
+       *          than the blocks of a single colony.
+       * @param colony - the colony to simulate.
+       * @param generations - the number of generations to simulate.
+       * @param temporal - the number of generations computed at once for each
+       *                   block of the colony.
+       */
+      ColonyJob(ColonyShPtr colony,
+                unsigned generations,
+                unsigned temporal = 1u);
+
+      ~ColonyJob() = default;
+
+      /**
+       * @brief - Reimplementation of the interface method allowing to perform
+       *          the simulation of the colony attached to this job. Errors are
+       *          not propagated but rather reported in the result.
+       */
+      void
+      compute() override;
+
+      /**
+       * @brief - Retrieve the result of the simulation. Only meaningful once the
+       *          job has been computed.
+       * @return - the result of the simulation.
+       */
+      const ColonyResult&
+      getResult() const noexcept;
+
+    private:
+
+      /**
+       * @brief - The colony to simulate.
+       */
+      ColonyShPtr m_colony;
+
+      /**
+       * @brief - The number of generations to simulate.
+       */
+      unsigned m_generations;
+
+      /**
+       * @brief - The number of generations computed at once for each block.
+       */
+      unsigned m_temporal;
+
+      /**
+       * @brief - The result of the simulation.
+       */
+      ColonyResult m_result;
+  };
+
+  using ColonyJobShPtr = std::shared_ptr<ColonyJob>;
+}
+
+# include "ColonyJob.hxx"
+
+#endif    /* COLONY_JOB_HH */
@@ -0,0 +1,61 @@
+#ifndef    COLONY_JOB_HXX
+# define   COLONY_JOB_HXX
+
+# include <chrono>
+# include "ColonyJob.hh"
+
+namespace cellulator {
+
+  inline
+  ColonyJob::ColonyJob(ColonyShPtr colony,
+                       unsigned generations,
+                       unsigned temporal):
+    utils::AsynchronousJob(std::string("job_for_") + (colony == nullptr ? std::string("null") : colony->getName())),
+
+    m_colony(colony),
+    m_generations(generations),
+    m_temporal(temporal),
+    m_result{getName(), 0u, 0u, 0u, 0.0, false, std::string("Not computed")}
+  {
+    setService("colony");
+
+    if (m_colony == nullptr) {
+      error(
+        std::string("Could not create simulation job"),
+        std::string("Invalid null colony")
+      );
+    }
+
+    m_result.name = m_colony->getName();
+  }
+
+  inline
+  void
+  ColonyJob::compute() {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    try {
+      m_result.computed = m_colony->simulate(m_generations, m_temporal);
+
+      m_result.success = true;
+      m_result.error.clear();
+    }
+    catch (const std::exception& e) {
+      m_result.success = false;
+      m_result.error = e.what();
+    }
+
+    m_result.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    m_result.generation = m_colony->getGeneration();
+    m_result.alive = m_colony->getLiveCellsCount();
+  }
+
+  inline
+  const ColonyResult&
+  ColonyJob::getResult() const noexcept {
+    return m_result;
+  }
+
+}
+
+#endif    /* COLONY_JOB_HXX */
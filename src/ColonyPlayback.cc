@@ -0,0 +1,226 @@
+
+# include "ColonyPlayback.hh"
+# include <cmath>
+# include <algorithm>
+
+namespace cellulator {
+
+  ColonyPlayback::ColonyPlayback(ColonyShPtr colony,
+                                 RecordingPlayerShPtr player):
+    utils::CoreObject("playback"),
+
+    m_propsLocker(),
+    m_waiter(),
+
+    m_colony(colony),
+    m_player(player),
+    m_frame(),
+
+    m_playing(false),
+    m_stop(false),
+    m_speed(getDefaultSpeed()),
+
+    m_thread(),
+
+    onFrameDisplayed(),
+    onPlaybackToggled()
+  {
+    setService("playback");
+
+    // Check consistency.
+    if (m_colony == nullptr) {
+      error(
+        std::string("Could not create playback"),
+        std::string("Invalid null colony")
+      );
+    }
+    if (m_player == nullptr) {
+      error(
+        std::string("Could not create playback"),
+        std::string("Invalid null recording")
+      );
+    }
+
+    display(0u);
+
+    m_thread = std::thread(&ColonyPlayback::run, this);
+  }
+
+  ColonyPlayback::~ColonyPlayback() {
+    {
+      const std::lock_guard guard(m_propsLocker);
+      m_stop = true;
+    }
+
+    m_waiter.notify_all();
+    m_thread.join();
+  }
+
+  void
+  ColonyPlayback::play() {
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
+      m_playing = true;
+    }
+
+    m_waiter.notify_all();
+  }
+
+  void
+  ColonyPlayback::pause() {
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
+      m_playing = false;
+    }
+
+    m_waiter.notify_all();
+  }
+
+  void
+  ColonyPlayback::toggle() {
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
+      m_playing = !m_playing;
+    }
+
+    m_waiter.notify_all();
+  }
+
+  void
+  ColonyPlayback::step() {
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
+      advance(1u);
+    }
+
+    notify();
+  }
+
+  void
+  ColonyPlayback::back() {
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
+
+      unsigned current = m_player->getPosition() - 1u;
+      display(current > 0u ? current - 1u : 0u);
+    }
+
+    notify();
+  }
+
+  void
+  ColonyPlayback::seek(std::uint64_t generation) {
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
+      display(m_player->find(generation));
+    }
+
+    notify();
+  }
+
+  void
+  ColonyPlayback::setSpeed(float framesPerSecond) {
+    if (framesPerSecond <= 0.0f) {
+      warn("Could not set playback speed of " + std::to_string(framesPerSecond) + " frame(s) per second, ignoring request");
+      return;
+    }
+
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
+      m_speed = framesPerSecond;
+    }
+
+    m_waiter.notify_all();
+  }
+
+  void
+  ColonyPlayback::run() {
+    std::unique_lock lock(m_propsLocker);
+
+    while (!m_stop) {
+      if (!m_playing) {
+        m_waiter.wait(lock);
+        continue;
+      }
+
+      // Above the display rate several frames are applied at once: this
+      // is cheap as only the changes are applied.
+      float rate = std::min(m_speed, getMaxDisplayRate());
+      unsigned frames = std::max(1u, static_cast<unsigned>(std::lround(m_speed / rate)));
+
+      std::chrono::duration<float> period(1.0f / rate);
+
+      // The wait is interrupted when the playback is paused, stopped or
+      // when its speed changes.
+      if (m_waiter.wait_for(lock, period) == std::cv_status::no_timeout) {
+        continue;
+      }
+
+      bool more = true;
+
+      try {
+        more = advance(frames);
+      }
+      catch (const std::exception& e) {
+        warn("Caught exception while playing recording: " + std::string(e.what()));
+        more = false;
+      }
+
+      if (!more) {
+        m_playing = false;
+      }
+
+      lock.unlock();
+
+      notify();
+
+      if (!more) {
+        onPlaybackToggled.safeEmit(
+          std::string("onPlaybackToggled(false)"),
+          false
+        );
+      }
+
+      lock.lock();
+    }
+  }
+
+  bool
+  ColonyPlayback::advance(unsigned frames) {
+    for (unsigned id = 0u ; id < frames ; ++id) {
+      if (!m_player->next(m_frame)) {
+        return false;
+      }
+
+      m_colony->play(m_frame);
+    }
+
+    return m_player->getPosition() < m_player->getFramesCount();
+  }
+
+  void
+  ColonyPlayback::display(unsigned index) {
+    m_player->seek(index, m_frame);
+    m_colony->play(m_frame);
+  }
+
+  void
+  ColonyPlayback::notify() {
+    unsigned generation = m_colony->getGeneration();
+    unsigned alive = m_colony->getLiveCellsCount();
+
+    onFrameDisplayed.safeEmit(
+      std::string("onFrameDisplayed(") + std::to_string(generation) + ", " + std::to_string(alive) + ")",
+      generation,
+      alive
+    );
+  }
+
+}
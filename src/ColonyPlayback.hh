@@ -0,0 +1,221 @@
+#ifndef    COLONY_PLAYBACK_HH
+# define   COLONY_PLAYBACK_HH
+
+# include <mutex>
+# include <thread>
+# include <chrono>
+# include <memory>
+# include <condition_variable>
+# include <core_utils/CoreObject.hh>
+# include <core_utils/Signal.hh>
+# include "Colony.hh"
+# include "RecordingPlayer.hh"
+
+namespace cellulator {
+
+  class ColonyPlayback: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Create a new playback displaying the frames of the recording in
+       *          argument in the colony. The first frame is displayed right away
+       *          and the playback is paused.
+       *          The colony should not be simulated while it is played back.
+       * @param colony - the colony receiving the frames.
+       * @param player - the recording to play.
+       */
+      ColonyPlayback(ColonyShPtr colony,
+                     RecordingPlayerShPtr player);
+
+      /**
+       * @brief - Stop the thread playing the recording.
+       */
+      ~ColonyPlayback();
+
+      /**
+       * @brief - Start playing the recording from the current frame. Nothing happens
+       *          if the playback is already running.
+       */
+      void
+      play();
+
+      /**
+       * @brief - Pause the playback on the current frame.
+       */
+      void
+      pause();
+
+      /**
+       * @brief - Toggle the playback between playing and paused.
+       */
+      void
+      toggle();
+
+      /**
+       * @brief - Display the frame following the current one. Nothing happens if the
+       *          last frame is displayed.
+       */
+      void
+      step();
+
+      /**
+       * @brief - Display the frame preceding the current one: the closest keyframe is
+       *          decoded and the following frames applied to it.
+       */
+      void
+      back();
+
+      /**
+       * @brief - Display the first frame reaching the generation in argument.
+       * @param generation - the generation to display.
+       */
+      void
+      seek(std::uint64_t generation);
+
+      /**
+       * @brief - Define the number of frames displayed per second when playing the
+       *          recording. Above the display rate several frames are applied each
+       *          time the colony is displayed.
+       * @param framesPerSecond - the speed of the playback.
+       */
+      void
+      setSpeed(float framesPerSecond);
+
+      /**
+       * @brief - Retrieve the number of frames displayed per second when playing.
+       * @return - the speed of the playback.
+       */
+      float
+      getSpeed() noexcept;
+
+      /**
+       * @brief - Retrieve the index of the frame currently displayed.
+       * @return - the index of the current frame.
+       */
+      unsigned
+      getFrame() noexcept;
+
+      /**
+       * @brief - Retrieve the number of frames of the recording.
+       * @return - the number of frames.
+       */
+      unsigned
+      getFramesCount() noexcept;
+
+    private:
+
+      /**
+       * @brief - The maximum number of times the colony is displayed per second. Over
+       *          this rate frames are skipped.
+       * @return - the display rate.
+       */
+      static
+      float
+      getMaxDisplayRate() noexcept;
+
+      /**
+       * @brief - Used to retrieve the default speed of the playback.
+       * @return - the default number of frames per second.
+       */
+      static
+      float
+      getDefaultSpeed() noexcept;
+
+      /**
+       * @brief - Main loop of the thread playing the recording.
+       */
+      void
+      run();
+
+      /**
+       * @brief - Apply the next frames of the recording to the colony. Note that the
+       *          locker is assumed to already be acquired.
+       * @param frames - the number of frames to apply.
+       * @return - `false` if the end of the recording was reached.
+       */
+      bool
+      advance(unsigned frames);
+
+      /**
+       * @brief - Display the frame in argument, seeking the recording. Note that the
+       *          locker is assumed to already be acquired.
+       * @param index - the index of the frame.
+       */
+      void
+      display(unsigned index);
+
+      /**
+       * @brief - Notify listeners of the frame currently displayed. Note that the
+       *          locker is assumed to *not* be acquired.
+       */
+      void
+      notify();
+
+    private:
+
+      /**
+       * @brief - Protect this object from concurrent accesses.
+       */
+      std::mutex m_propsLocker;
+
+      /**
+       * @brief - Used to wake the playback thread when the playback is toggled.
+       */
+      std::condition_variable m_waiter;
+
+      /**
+       * @brief - The colony receiving the frames.
+       */
+      ColonyShPtr m_colony;
+
+      /**
+       * @brief - The recording played.
+       */
+      RecordingPlayerShPtr m_player;
+
+      /**
+       * @brief - The last frame decoded, kept to reuse its memory.
+       */
+      RecordingFrame m_frame;
+
+      /**
+       * @brief - Whether the recording is currently playing.
+       */
+      bool m_playing;
+
+      /**
+       * @brief - Whether the playback thread should stop.
+       */
+      bool m_stop;
+
+      /**
+       * @brief - The number of frames displayed per second.
+       */
+      float m_speed;
+
+      /**
+       * @brief - The thread playing the recording.
+       */
+      std::thread m_thread;
+
+    public:
+
+      /**
+       * @brief - Signal emitted whenever a new frame is displayed, with the generation
+       *          and the number of live cells of the frame.
+       */
+      utils::Signal<unsigned, unsigned> onFrameDisplayed;
+
+      /**
+       * @brief - Signal emitted when the playback starts or stops on its own, i.e. when
+       *          the end of the recording is reached.
+       */
+      utils::Signal<bool> onPlaybackToggled;
+  };
+
+  using ColonyPlaybackShPtr = std::shared_ptr<ColonyPlayback>;
+}
+
+# include "ColonyPlayback.hxx"
+
+#endif    /* COLONY_PLAYBACK_HH */
@@ -0,0 +1,50 @@
+#ifndef    COLONY_PLAYBACK_HXX
+# define   COLONY_PLAYBACK_HXX
+
+# include "ColonyPlayback.hh"
+
+namespace cellulator {
+
+  inline
+  float
+  ColonyPlayback::getSpeed() noexcept {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    return m_speed;
+  }
+
+  inline
+  unsigned
+  ColonyPlayback::getFrame() noexcept {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    // The position is the index of the next frame to decode.
+    return m_player->getPosition() - 1u;
+  }
+
+  inline
+  unsigned
+  ColonyPlayback::getFramesCount() noexcept {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    return m_player->getFramesCount();
+  }
+
+  inline
+  float
+  ColonyPlayback::getMaxDisplayRate() noexcept {
+    return 60.0f;
+  }
+
+  inline
+  float
+  ColonyPlayback::getDefaultSpeed() noexcept {
+    return 10.0f;
+  }
+
+}
+
+#endif    /* COLONY_PLAYBACK_HXX */
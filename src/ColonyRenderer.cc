@@ -1,7 +1,9 @@
 
 # include "ColonyRenderer.hh"
+# include "PeriodDetector.hh"
 # include <sdl_engine/PaintEvent.hh>
 # include <sdl_engine/Color.hh>
+# include <core_utils/CoreException.hh>
 
 namespace cellulator {
 
@@ -21,6 +23,10 @@ namespace cellulator {
     m_scheduler(std::make_shared<ColonyScheduler>(colony)),
     m_colony(colony),
     m_generationComputedSignalID(utils::Signal<unsigned>::NO_ID),
+    m_playback(),
+    m_frameDisplayedSignalID(utils::Signal<unsigned, unsigned>::NO_ID),
+    m_exporter(),
+    m_rate(0u),
 
     m_lastKnownMousePos(),
 
@@ -37,7 +43,8 @@ namespace cellulator {
       sdl::core::engine::Color::NamedColor::Gray,
       0.5f,
       0.25f,
-      std::make_shared<CellBrush>(utils::Sizei(1, 1), State::Alive)
+      std::make_shared<CellBrush>(utils::Sizei(1, 1), State::Alive),
+      BrushOrientation::Identity
     }),
 
     onGenerationComputed(),
@@ -110,13 +117,36 @@ namespace cellulator {
   bool
   ColonyRenderer::keyPressEvent(const sdl::core::engine::KeyEvent& e) {
     // Check for simulation's state toggling key.
+    ColonyPlaybackShPtr playback = getPlayback();
+
     if (e.getRawKey() == getSimulationStateToggleKey()) {
-      // Toggle the scheduler's state.
-      m_scheduler->toggle();
+      // Toggle the playback or the scheduler's state.
+      if (playback != nullptr) {
+        playback->toggle();
+      }
+      else {
+        m_scheduler->toggle();
+      }
 
       return sdl::graphic::ScrollableWidget::keyPressEvent(e);
     }
 
+    // Check for the keys controlling the replay of a recording.
+    if (playback != nullptr) {
+      if (e.getRawKey() == getPlaybackNextKey()) {
+        playback->step();
+      }
+      if (e.getRawKey() == getPlaybackBackKey()) {
+        playback->back();
+      }
+      if (e.getRawKey() == getPlaybackFasterKey()) {
+        playback->setSpeed(playback->getSpeed() * 2.0f);
+      }
+      if (e.getRawKey() == getPlaybackSlowerKey()) {
+        playback->setSpeed(playback->getSpeed() / 2.0f);
+      }
+    }
+
     // Check for arrow keys.
     bool move = false;
     utils::Vector2f motion;
@@ -164,6 +194,27 @@ namespace cellulator {
 
   bool
   ColonyRenderer::keyReleaseEvent(const sdl::core::engine::KeyEvent& e) {
+    // Check for export toggle.
+    if (e.getRawKey() == getExportToggleKey()) {
+      bool exporting = false;
+      {
+        const std::lock_guard guard(m_propsLocker);
+        exporting = (m_exporter != nullptr);
+      }
+
+      if (exporting) {
+        stopExport();
+      }
+      else {
+        try {
+          startExport(getDefaultExportFile(), ExportFormat::Y4m);
+        }
+        catch (const utils::CoreException& err) {
+          warn(std::string("Could not start export: ") + err.what());
+        }
+      }
+    }
+
     // Check for toggle brush overlay.
     if (e.getRawKey() == getToggleBrushOverlayKey()) {
       const std::lock_guard guard(m_propsLocker);
@@ -178,6 +229,63 @@ namespace cellulator {
       }
     }
 
+    // Check for skip ahead: this only concerns the simulation and not the
+    // replay of a recording.
+    if (getPlayback() == nullptr && e.getRawKey() == getSkipAheadKey()) {
+      m_scheduler->advance(getSkipAheadGenerations());
+    }
+
+    if (getPlayback() == nullptr && e.getRawKey() == getSkipUntilStableKey()) {
+      PeriodDetector detector;
+      unsigned count = 0u;
+
+      m_scheduler->advanceUntil(
+        [detector, count](unsigned /*generation*/, unsigned alive) mutable {
+          ++count;
+          return detector.push(alive) > 0u || count >= getSkipUntilStableLimit();
+        }
+      );
+    }
+
+    // Check for rate control.
+    if (e.getRawKey() == getRateControlKey()) {
+      RatePreset preset;
+      {
+        const std::lock_guard guard(m_propsLocker);
+
+        m_rate = (m_rate + 1u) % getRatePresets().size();
+        preset = getRatePresets()[m_rate];
+      }
+
+      m_scheduler->setRateControl(preset.policy, preset.value);
+
+      switch (preset.policy) {
+        case ColonyScheduler::RateControl::FixedRate:
+          info("Simulating " + std::to_string(preset.value) + " generation(s) per second");
+          break;
+        case ColonyScheduler::RateControl::RenderEveryN:
+          info("Simulating as fast as possible, displaying every " + std::to_string(preset.value) + " generation(s)");
+          break;
+        case ColonyScheduler::RateControl::Unlimited:
+        default:
+          info("Simulating as fast as possible");
+          break;
+      }
+    }
+
+    // Check for brush orientation.
+    if (e.getRawKey() == getBrushOrientationKey()) {
+      const std::lock_guard guard(m_propsLocker);
+
+      unsigned next = (static_cast<unsigned>(m_display.orientation) + 1u) % CellBrush::getOrientationsCount();
+      m_display.orientation = static_cast<BrushOrientation>(next);
+
+      // The overlay needs to be updated if it is displayed.
+      if (m_display.bDisplay && m_display.brush != nullptr) {
+        setColonyChanged();
+      }
+    }
+
     return sdl::graphic::ScrollableWidget::keyReleaseEvent(e);
   }
 
@@ -281,6 +389,106 @@ namespace cellulator {
     updateGridResolution();
   }
 
+  void
+  ColonyRenderer::replay(const std::string& file) {
+    // Open the recording first: in case it can't be read the simulation
+    // is left untouched.
+    RecordingPlayerShPtr player = std::make_shared<RecordingPlayer>(file);
+
+    // The colony can't be simulated while it is played back.
+    m_scheduler->stop();
+    m_scheduler->waitUntilIdle();
+
+    // Release any previous playback: this makes sure that a single one
+    // applies its frames to the colony.
+    ColonyPlaybackShPtr previous;
+    {
+      const std::lock_guard guard(m_propsLocker);
+
+      previous.swap(m_playback);
+
+      if (previous != nullptr) {
+        previous->onFrameDisplayed.disconnect(m_frameDisplayedSignalID);
+        m_frameDisplayedSignalID = utils::Signal<unsigned, unsigned>::NO_ID;
+      }
+    }
+
+    previous.reset();
+
+    // The playback displays the first frame of the recording as soon as it
+    // is created: the colony will be repainted below.
+    ColonyPlaybackShPtr playback = std::make_shared<ColonyPlayback>(m_colony, player);
+
+    {
+      const std::lock_guard guard(m_propsLocker);
+
+      m_playback = playback;
+      m_frameDisplayedSignalID = m_playback->onFrameDisplayed.connect_member<ColonyRenderer>(
+        this,
+        &ColonyRenderer::handleGenerationComputed
+      );
+    }
+
+    debug(
+      "Replaying " + std::to_string(playback->getFramesCount()) + " frame(s) from \"" + file + "\""
+    );
+
+    handleGenerationComputed(
+      m_colony->getGeneration(),
+      m_colony->getLiveCellsCount()
+    );
+  }
+
+  void
+  ColonyRenderer::startExport(const std::string& output,
+                              const ExportFormat& format)
+  {
+    stopExport();
+
+    FrameExporterShPtr exporter = std::make_shared<FrameExporter>(output, format);
+
+    // Each generation should be notified so that no frame is skipped: this
+    // does not modify the rate chosen for the simulation.
+    m_scheduler->setExhaustiveNotifications(true);
+
+    // The current content of the colony is the first frame.
+    ExportedFrame frame;
+    {
+      const std::lock_guard guard(m_propsLocker);
+
+      m_exporter = exporter;
+      captureFrame(m_colony->getGeneration(), frame, false);
+    }
+
+    exporter->push(std::move(frame));
+
+    debug("Exporting colony to \"" + output + "\"");
+  }
+
+  void
+  ColonyRenderer::stopExport() {
+    FrameExporterShPtr exporter;
+    {
+      const std::lock_guard guard(m_propsLocker);
+      exporter.swap(m_exporter);
+    }
+
+    if (exporter == nullptr) {
+      return;
+    }
+
+    m_scheduler->setExhaustiveNotifications(false);
+
+    // Wait for the pending frames to be written.
+    exporter->flush();
+
+    FrameExporter::Statistics stats = exporter->getStatistics();
+    debug(
+      "Exported " + std::to_string(stats.written) + " frame(s) in " + std::to_string(stats.bytes) + " byte(s), producer " +
+      "waited " + std::to_string(stats.stalled) + "s in " + std::to_string(stats.stalls) + " stall(s)"
+    );
+  }
+
   void
   ColonyRenderer::loadColony() {
     // Clear any existing texture representing the colony.
@@ -296,7 +504,15 @@ namespace cellulator {
     // Fetch the cells that are visible. We need to convert the
     // input area.
     std::vector<std::pair<State, unsigned>> cells;
-    utils::Boxi out = m_colony->fetchCells(cells, m_settings.area);
+    bool complete = false;
+    utils::Boxi out = m_colony->fetchCells(cells, m_settings.area, &complete);
+
+    // In case the area is not covered by the last snapshot (typically after
+    // a zoom or a pan) ask for a new one: it is published right away if the
+    // simulation is paused and with the next generation otherwise.
+    if (!complete && m_scheduler->refresh()) {
+      out = m_colony->fetchCells(cells, m_settings.area);
+    }
 
     // Create the colors needed for the brush.
     sdl::core::engine::BrushShPtr brush = createBrushFromCells(cells, out);
@@ -324,35 +540,87 @@ namespace cellulator {
   ColonyRenderer::handleGenerationComputed(unsigned generation,
                                            unsigned liveCells)
   {
-    // Protect from concurrent accesses.
-    const std::lock_guard guard(m_propsLocker);
+    FrameExporterShPtr exporter;
+    ExportedFrame frame;
 
-    // The colony need to be rendered again.
-    setColonyChanged();
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
 
-    // Notify listeners.
-    onGenerationComputed.safeEmit(
-      std::string("onGenerationComputed(") + std::to_string(generation) + ")",
-      generation
-    );
+      // The colony need to be rendered again.
+      setColonyChanged();
 
-    onAliveCellsChanged.safeEmit(
-      std::string("onAliveCellsChanged(") + std::to_string(liveCells) + ")",
-      liveCells
-    );
+      // Capture the frame to export: this is done while the scheduler waits
+      // for the listeners so the cells can't change in the meantime. Only
+      // the cells are copied here, the exporter renders the frame.
+      if (m_exporter != nullptr) {
+        exporter = m_exporter;
+        captureFrame(generation, frame, true);
+      }
+
+      // Notify listeners.
+      onGenerationComputed.safeEmit(
+        std::string("onGenerationComputed(") + std::to_string(generation) + ")",
+        generation
+      );
+
+      onAliveCellsChanged.safeEmit(
+        std::string("onAliveCellsChanged(") + std::to_string(liveCells) + ")",
+        liveCells
+      );
+    }
+
+    // Hand the frame to the exporter outside of the lock: this might block
+    // in case the exporter lags behind.
+    if (exporter == nullptr) {
+      return;
+    }
+
+    try {
+      exporter->push(std::move(frame));
+    }
+    catch (const utils::CoreException& e) {
+      warn(std::string("Stopping export after failure: ") + e.what());
+
+      const std::lock_guard guard(m_propsLocker);
+      if (m_exporter == exporter) {
+        m_exporter.reset();
+      }
+    }
   }
 
-  sdl::core::engine::BrushShPtr
-  ColonyRenderer::createBrushFromCells(const std::vector<std::pair<State, unsigned>>& cells,
-                                       const utils::Boxi& area)
-  {
-    // Determine the size of a single cell.
+  ColonyRenderer::View
+  ColonyRenderer::captureView() {
+    // Determine the size of the canvas.
     utils::Sizef env = LayoutItem::getRenderingArea().toSize();
-    utils::Sizef cellsDims = getCellsDims();
-    utils::Sizei iEnv(
-      static_cast<int>(std::floor(env.w())),
-      static_cast<int>(std::floor(env.h()))
-    );
+
+    View view{
+      m_settings.area,
+      utils::Sizei(
+        static_cast<int>(std::floor(env.w())),
+        static_cast<int>(std::floor(env.h()))
+      ),
+      getCellsDims(),
+      utils::Vector2f(),
+      m_display
+    };
+
+    // The position of the mouse is only needed to display the brush.
+    if (m_display.bDisplay) {
+      view.mouse = convertPosToRealWorld(m_lastKnownMousePos, true);
+    }
+
+    return view;
+  }
+
+  std::vector<sdl::core::engine::Color>
+  ColonyRenderer::renderCells(const std::vector<std::pair<State, unsigned>>& cells,
+                              const utils::Boxi& area,
+                              const View& view)
+  {
+    // Retrieve the size of a single cell and of the canvas.
+    const utils::Sizef& cellsDims = view.cellsDims;
+    const utils::Sizei& iEnv = view.canvas;
 
     // Create a canvas of the expected size.
     std::vector<sdl::core::engine::Color> colors(
@@ -372,8 +640,8 @@ namespace cellulator {
         int off = (iEnv.h() - 1 - y) * iEnv.w() + x;
 
         // Compute the cell coordinate from the floating point coords.
-        int cX = static_cast<int>(std::floor(m_settings.area.getLeftBound() + rX));
-        int cY = static_cast<int>(std::floor(m_settings.area.getBottomBound() + rY));
+        int cX = static_cast<int>(std::floor(view.area.getLeftBound() + rX));
+        int cY = static_cast<int>(std::floor(view.area.getBottomBound() + rY));
 
         // Transform this using the provided area.
         utils::Vector2i c(cX - area.getLeftBound(), cY - area.getBottomBound());
@@ -385,11 +653,11 @@ namespace cellulator {
         sdl::core::engine::Color co = sdl::core::engine::Color::NamedColor::Pink;
         switch (ce.first) {
           case State::Alive:
-            co = m_display.cells->colorize(ce.second);
+            co = view.display.cells->colorize(ce.second);
             break;
           case State::Dead:
           default:
-            co = m_display.bgColor;
+            co = view.display.bgColor;
             break;
         }
 
@@ -399,22 +667,22 @@ namespace cellulator {
     }
 
     // Displayt grid if needed.
-    if (m_display.gDisplay) {
+    if (view.display.gDisplay) {
       // We need to overlay the grid based on the current desired resolution. This
       // include traversing the area and draw each line.
 
       // Compute integer coordinate of the left and right bound of the rendering
       // area: this will help determining the lines that we should display.
-      int sX = static_cast<int>(std::floor(m_settings.area.getLeftBound()));
-      int eX = static_cast<int>(std::ceil(m_settings.area.getRightBound()));
+      int sX = static_cast<int>(std::floor(view.area.getLeftBound()));
+      int eX = static_cast<int>(std::ceil(view.area.getRightBound()));
 
-      int sY = static_cast<int>(std::floor(m_settings.area.getBottomBound()));
-      int eY = static_cast<int>(std::ceil(m_settings.area.getTopBound()));
+      int sY = static_cast<int>(std::floor(view.area.getBottomBound()));
+      int eY = static_cast<int>(std::ceil(view.area.getTopBound()));
 
       // Account for the resolution: we only want to display grid lines for some
       // integer coordinates but not all.
-      utils::Vector2i res = m_display.gRes;
-      utils::Boxf a = m_settings.area;
+      utils::Vector2i res = view.display.gRes;
+      utils::Boxf a = view.area;
 
       int xMin = sX - sX % res.x();
       int yMin = sY - sY % res.y();
@@ -442,7 +710,7 @@ namespace cellulator {
         // for cells rendering we need to flip the `y` axis because the
         // underlying API expects a top-down image.
         for (int y = 0 ; y < iEnv.h() ; ++y) {
-          colors[(iEnv.h() - 1 - y) * iEnv.w() + pix] = m_display.gColor;
+          colors[(iEnv.h() - 1 - y) * iEnv.w() + pix] = view.display.gColor;
         }
       }
 
@@ -465,18 +733,18 @@ namespace cellulator {
         // for cells rendering we need to flip the `y` axis because the
         // underlying API expects a top-down image.
         for (int x = 0 ; x < iEnv.w() ; ++x) {
-          colors[(iEnv.h() - 1 - pix) * iEnv.w() + x] = m_display.gColor;
+          colors[(iEnv.h() - 1 - pix) * iEnv.w() + x] = view.display.gColor;
         }
       }
     }
 
     // Display brush overlay if needed.
-    if (m_display.bDisplay && m_display.brush != nullptr && m_display.brush->valid()) {
-      CellBrush& b = *m_display.brush;
-      utils::Sizei size = b.getSize();
+    if (view.display.bDisplay && view.display.brush != nullptr && view.display.brush->valid()) {
+      CellBrush& b = *view.display.brush;
+      utils::Sizei size = b.getSize(view.display.orientation);
 
-      // Compute the coordinate of the mouse in cell's reference frame.
-      utils::Vector2f mCoords = convertPosToRealWorld(m_lastKnownMousePos, true);
+      // Retrieve the coordinate of the mouse in cell's reference frame.
+      const utils::Vector2f& mCoords = view.mouse;
 
       // Round it to obtain integer coordinates.
       utils::Vector2i mICoords(
@@ -496,12 +764,12 @@ namespace cellulator {
 
       // Compute the pixels related to the area covered by the brush.
       utils::Vector2i areaLocalBL(
-        static_cast<int>(std::floor((bBL.x() - m_settings.area.getLeftBound()) * cellsDims.w())),
-        static_cast<int>(std::floor((bBL.y() - m_settings.area.getBottomBound()) * cellsDims.h()))
+        static_cast<int>(std::floor((bBL.x() - view.area.getLeftBound()) * cellsDims.w())),
+        static_cast<int>(std::floor((bBL.y() - view.area.getBottomBound()) * cellsDims.h()))
       );
       utils::Vector2i areaLocalTR(
-        static_cast<int>(std::floor((bTR.x() - m_settings.area.getLeftBound()) * cellsDims.w())),
-        static_cast<int>(std::floor((bTR.y() - m_settings.area.getBottomBound()) * cellsDims.h()))
+        static_cast<int>(std::floor((bTR.x() - view.area.getLeftBound()) * cellsDims.w())),
+        static_cast<int>(std::floor((bTR.y() - view.area.getBottomBound()) * cellsDims.h()))
       );
 
       // Traverse all the pixels covered by the brush.
@@ -534,12 +802,12 @@ namespace cellulator {
 
           // Fetch the state of the cell in the brush and assign the overlay color
           // if the cell is alive.
-          sdl::core::engine::Color c = m_display.bAColor;
-          float bl = m_display.bABlend;
+          sdl::core::engine::Color c = view.display.bAColor;
+          float bl = view.display.bABlend;
 
-          if (b.getStateAt(cX, cY) == State::Dead) {
-            c = m_display.bDColor;
-            bl = m_display.bDBlend;
+          if (b.getStateAt(cX, cY, view.display.orientation) == State::Dead) {
+            c = view.display.bDColor;
+            bl = view.display.bDBlend;
           }
 
           colors[off] = colors[off].blend(c, bl);
@@ -547,13 +815,63 @@ namespace cellulator {
       }
     }
 
+    return colors;
+  }
+
+  void
+  ColonyRenderer::captureFrame(unsigned generation,
+                               ExportedFrame& frame,
+                               bool notified)
+  {
+    std::vector<std::pair<State, unsigned>> cells;
+    bool complete = false;
+    utils::Boxi out = m_colony->fetchCells(cells, m_settings.area, &complete);
+
+    // The view might have changed since the snapshot was taken: publish a
+    // new one if the colony can be accessed.
+    if (!complete && notified) {
+      m_colony->publishSnapshot();
+      out = m_colony->fetchCells(cells, m_settings.area);
+    }
+    else if (!complete && m_scheduler->refresh()) {
+      out = m_colony->fetchCells(cells, m_settings.area);
+    }
+
+    View view = captureView();
+
+    frame.generation = generation;
+    frame.dims = view.canvas;
+    frame.pixels.clear();
+
+    // The frame is rendered by the exporter from a copy of the cells and of
+    // the view, which are not affected by the following generations.
+    frame.render = [cells = std::move(cells), out, view](ExportedFrame& f) {
+      std::vector<sdl::core::engine::Color> colors = renderCells(cells, out, view);
+
+      f.pixels.resize(3u * colors.size());
+
+      for (unsigned id = 0u ; id < colors.size() ; ++id) {
+        f.pixels[3u * id] = static_cast<std::uint8_t>(std::round(255.0f * colors[id].r()));
+        f.pixels[3u * id + 1u] = static_cast<std::uint8_t>(std::round(255.0f * colors[id].g()));
+        f.pixels[3u * id + 2u] = static_cast<std::uint8_t>(std::round(255.0f * colors[id].b()));
+      }
+    };
+  }
+
+  sdl::core::engine::BrushShPtr
+  ColonyRenderer::createBrushFromCells(const std::vector<std::pair<State, unsigned>>& cells,
+                                       const utils::Boxi& area)
+  {
+    View view = captureView();
+    std::vector<sdl::core::engine::Color> colors = renderCells(cells, area, view);
+
     // Create the brush and return it.
     sdl::core::engine::BrushShPtr brush = std::make_shared<sdl::core::engine::Brush>(
       std::string("brush_for_") + getName(),
       false
     );
 
-    brush->createFromRaw(iEnv, colors);
+    brush->createFromRaw(view.canvas, colors);
 
     return brush;
   }
@@ -576,7 +894,7 @@ namespace cellulator {
     );
 
     // Paint the brush at this coordinates.
-    unsigned liveCells = m_scheduler->paint(*m_display.brush, cell);
+    unsigned liveCells = m_scheduler->paint(m_display.brush, cell, m_display.orientation);
 
     // Notify of the new live cells count.
     onAliveCellsChanged.safeEmit(
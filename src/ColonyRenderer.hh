@@ -11,6 +11,8 @@
 # include "ColonyScheduler.hh"
 # include "ColorPalette.hh"
 # include "CellBrush.hh"
+# include "ColonyPlayback.hh"
+# include "FrameExporter.hh"
 
 namespace cellulator {
 
@@ -82,6 +84,42 @@ namespace cellulator {
       void
       generate(const std::string& dummy);
 
+      /**
+       * @brief - Used to replay a recording produced while simulating a colony. The
+       *          simulation is stopped and the frames of the recording are displayed
+       *          in place of the colony: while replaying, the `start`, `stop` and the
+       *          `nextStep` methods control the playback instead of the simulation.
+       *          Generating a new colony leaves the replay mode.
+       *          An error is raised if the recording can't be read, in which case the
+       *          current colony is left unchanged.
+       * @param file - the name of the file holding the recording.
+       */
+      void
+      replay(const std::string& file);
+
+      /**
+       * @brief - Used to export the rendering of the colony for each generation. The
+       *          pixels displayed by this renderer are handed to an exporter which is
+       *          encoding them in the background. In order not to miss generations
+       *          the scheduler is configured to notify each batch of generations: in
+       *          case the exporter lags behind the simulation is slowed down.
+       *          Any previous export is stopped.
+       *          An error is raised if the exporter can't be created.
+       * @param output - the prefix of the images or the name of the video.
+       * @param format - the format of the exported frames.
+       */
+      void
+      startExport(const std::string& output,
+                  const ExportFormat& format);
+
+      /**
+       * @brief - Stop the export started by `startExport` and wait for the pending
+       *          frames to be written. The scheduler is allowed to skip notifications
+       *          again. Nothing happens if no export is active.
+       */
+      void
+      stopExport();
+
       /**
        * @brief - Used to retrieve the internal scheduler used to evolve the colony
        *          within this renderer. It is mostly used to connect the simulation
@@ -91,6 +129,15 @@ namespace cellulator {
       ColonySchedulerShPtr
       getScheduler() noexcept;
 
+      /**
+       * @brief - Used to retrieve the playback of the recording replayed by this
+       *          renderer if any. It is mostly used to connect the signals of the
+       *          playback to external listeners.
+       * @return - the active playback or `null` if the colony is simulated.
+       */
+      ColonyPlaybackShPtr
+      getPlayback() noexcept;
+
       /**
        * @brief - Local slot connected to producers that are able to generate new
        *          palette to be used for the coloring of this colony.
@@ -278,6 +325,132 @@ namespace cellulator {
       sdl::core::engine::RawKey
       getToggleBrushOverlayKey() noexcept;
 
+      /**
+       * @brief - The key used to change the orientation in which the brush is painted
+       *          (and displayed as an overlay). Each hit selects the next orientation,
+       *          going through the rotations and then the flips of the brush.
+       * @return - a key representing the brush orientation command.
+       */
+      static
+      sdl::core::engine::RawKey
+      getBrushOrientationKey() noexcept;
+
+      /**
+       * @brief - The key used to skip ahead in the simulation: the colony is advanced
+       *          by `getSkipAheadGenerations` generations following the rate control
+       *          policy, so that with the default one only the last generation gets
+       *          displayed. Nothing happens if the simulation runs.
+       * @return - a key representing the skip ahead command.
+       */
+      static
+      sdl::core::engine::RawKey
+      getSkipAheadKey() noexcept;
+
+      /**
+       * @brief - The number of generations computed when skipping ahead.
+       * @return - the number of generations to skip.
+       */
+      static
+      unsigned
+      getSkipAheadGenerations() noexcept;
+
+      /**
+       * @brief - The key used to advance the simulation until the population of the
+       *          colony becomes periodic, or at most `getSkipUntilStableLimit`
+       *          generations. Nothing happens if the simulation runs.
+       * @return - a key representing the skip until stable command.
+       */
+      static
+      sdl::core::engine::RawKey
+      getSkipUntilStableKey() noexcept;
+
+      /**
+       * @brief - The maximum number of generations computed when skipping ahead until
+       *          the colony is stable.
+       * @return - the maximum number of generations to skip.
+       */
+      static
+      unsigned
+      getSkipUntilStableLimit() noexcept;
+
+      /**
+       * @brief - The key used to change the policy controlling the rate of the simulation.
+       *          Each hit selects the next preset returned by `getRatePresets`.
+       * @return - a key representing the rate control command.
+       */
+      static
+      sdl::core::engine::RawKey
+      getRateControlKey() noexcept;
+
+      /**
+       * @brief - Convenience structure describing a policy to control the rate of the
+       *          simulation along with its parameter.
+       */
+      struct RatePreset {
+        ColonyScheduler::RateControl policy;
+        unsigned value;
+      };
+
+      /**
+       * @brief - The policies to control the rate of the simulation that can be selected
+       *          with the rate control key, the first one being the default.
+       * @return - the available presets.
+       */
+      static
+      const std::vector<RatePreset>&
+      getRatePresets() noexcept;
+
+      /**
+       * @brief - The key used to display the frame following the current one when a
+       *          recording is replayed.
+       * @return - a key representing the next frame command.
+       */
+      static
+      sdl::core::engine::RawKey
+      getPlaybackNextKey() noexcept;
+
+      /**
+       * @brief - The key used to start and stop the export of the colony.
+       * @return - a key representing the export toggle command.
+       */
+      static
+      sdl::core::engine::RawKey
+      getExportToggleKey() noexcept;
+
+      /**
+       * @brief - The name of the video receiving the frames exported with the export
+       *          toggle key.
+       * @return - the name of the video.
+       */
+      static
+      const char*
+      getDefaultExportFile() noexcept;
+
+      /**
+       * @brief - The key used to display the frame preceding the current one when a
+       *          recording is replayed.
+       * @return - a key representing the previous frame command.
+       */
+      static
+      sdl::core::engine::RawKey
+      getPlaybackBackKey() noexcept;
+
+      /**
+       * @brief - The key used to double the speed of the playback of a recording.
+       * @return - a key representing the faster playback command.
+       */
+      static
+      sdl::core::engine::RawKey
+      getPlaybackFasterKey() noexcept;
+
+      /**
+       * @brief - The key used to halve the speed of the playback of a recording.
+       * @return - a key representing the slower playback command.
+       */
+      static
+      sdl::core::engine::RawKey
+      getPlaybackSlowerKey() noexcept;
+
       /**
        * @brief - Return a mouse button that can be used to detect whenever the brush
        *          should be painted at the current mouse coordinates in the colony.
@@ -402,10 +575,58 @@ namespace cellulator {
       handleGenerationComputed(unsigned generation,
                                unsigned liveCells);
 
+      /**
+       * @brief - The information needed to render cells, defined below.
+       */
+      struct View;
+
+      /**
+       * @brief - Used to capture the information needed to render the colony as it is
+       *          currently displayed. Note that we assume that the lock for this object
+       *          is already acquired.
+       * @return - the current view of the renderer.
+       */
+      View
+      captureView();
+
+      /**
+       * @brief - Used to compute the pixels representing the input cells given that they
+       *          should represent the input `area`. This takes into account the size of
+       *          the canvas and of the cells described by the view, and includes the grid
+       *          and the brush overlay if they are displayed. As this only relies on the
+       *          view, this method can be called from any thread.
+       * @param cells - the cells data to use to create the visual representation.
+       * @param area - the area represented by the cells.
+       * @param view - the view to render.
+       * @return - the colors of the pixels, starting with the top left corner.
+       */
+      static
+      std::vector<sdl::core::engine::Color>
+      renderCells(const std::vector<std::pair<State, unsigned>>& cells,
+                  const utils::Boxi& area,
+                  const View& view);
+
+      /**
+       * @brief - Used to capture the visible area of the colony into a frame which can be
+       *          exported. Only the cells and the view are copied: the frame is rendered
+       *          by the exporter so that the workers waiting for the listeners are not
+       *          slowed down by the rendering. Note that we assume that the lock for this
+       *          object is already acquired.
+       * @param generation - the generation of the colony.
+       * @param frame - output argument receiving the frame to render.
+       * @param notified - whether this is called upon the notification of a new
+       *                   generation: the workers wait for the listeners in this
+       *                   case so that a snapshot covering the visible area can be
+       *                   published if needed.
+       */
+      void
+      captureFrame(unsigned generation,
+                   ExportedFrame& frame,
+                   bool notified);
+
       /**
        * @brief - Used to create a brush representing the input cells given that it should
-       *          represent the input `area`. This takes into account the size of the canvas
-       *          for this object along with the number of cells visible.
+       *          represent the input `area`. See `renderCells` for more details.
        * @param cells - the cells data to use to create the visual representation.
        * @param area - the area represented by the cells.
        * @return - the brush representing the input cells given the cells' size for this item.
@@ -500,6 +721,19 @@ namespace cellulator {
         float bABlend;
         float bDBlend;
         CellBrushShPtr brush;
+        BrushOrientation orientation;
+      };
+
+      /**
+       * @brief - Convenience structure holding a copy of the properties needed to render
+       *          the cells, so that they can be rendered later on and on another thread.
+       */
+      struct View {
+        utils::Boxf area;           //< The area of the colony displayed.
+        utils::Sizei canvas;        //< The dimensions of the canvas in pixels.
+        utils::Sizef cellsDims;     //< The dimensions of a cell in pixels.
+        utils::Vector2f mouse;      //< The position of the mouse in cells coordinates.
+        Display display;            //< The display settings.
       };
 
       /**
@@ -548,6 +782,31 @@ namespace cellulator {
        */
       int m_generationComputedSignalID;
 
+      /**
+       * @brief - The playback of the recording displayed in place of the simulation of
+       *          the colony. This value is `null` when the colony is simulated.
+       */
+      ColonyPlaybackShPtr m_playback;
+
+      /**
+       * @brief - The index of the signal registered on the playback to be notified when
+       *          a new frame is displayed. Used to disconnect from the playback when the
+       *          replay mode is left.
+       */
+      int m_frameDisplayedSignalID;
+
+      /**
+       * @brief - The exporter receiving the rendering of each generation. This value is
+       *          `null` when the colony is not exported.
+       */
+      FrameExporterShPtr m_exporter;
+
+      /**
+       * @brief - The index of the preset used to control the rate of the simulation in
+       *          the list returned by `getRatePresets`.
+       */
+      unsigned m_rate;
+
       /**
        * @brief - Used to keep track internally of the last known position of the mouse inside
        *          this widget. Note that we have to use this in association with the base class
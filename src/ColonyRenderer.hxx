@@ -7,6 +7,7 @@ namespace cellulator {
 
   inline
   ColonyRenderer::~ColonyRenderer() {
+    m_playback.reset();
     m_scheduler.reset();
 
     // Protect from concurrent accesses
@@ -63,24 +64,60 @@ namespace cellulator {
   inline
   void
   ColonyRenderer::start() {
+    // Route the request to the playback in case a recording is replayed.
+    ColonyPlaybackShPtr playback = getPlayback();
+    if (playback != nullptr) {
+      playback->play();
+      return;
+    }
+
     m_scheduler->start();
   }
 
   inline
   void
   ColonyRenderer::stop() {
+    ColonyPlaybackShPtr playback = getPlayback();
+    if (playback != nullptr) {
+      playback->pause();
+      return;
+    }
+
     m_scheduler->stop();
   }
 
   inline
   void
   ColonyRenderer::nextStep() {
+    ColonyPlaybackShPtr playback = getPlayback();
+    if (playback != nullptr) {
+      playback->step();
+      return;
+    }
+
     m_scheduler->step();
   }
 
   inline
   void
   ColonyRenderer::generate(const std::string& /*dummy*/) {
+    // Generating a new colony leaves the replay mode: the playback is
+    // released before touching the colony so that no more frames are
+    // applied to it.
+    ColonyPlaybackShPtr playback;
+    {
+      const std::lock_guard guard(m_propsLocker);
+
+      playback.swap(m_playback);
+
+      if (playback != nullptr) {
+        playback->onFrameDisplayed.disconnect(m_frameDisplayedSignalID);
+        m_frameDisplayedSignalID = utils::Signal<unsigned, unsigned>::NO_ID;
+      }
+    }
+
+    playback.reset();
+
     // Generate random cells in the colony.
     m_scheduler->generate();
 
@@ -97,6 +134,15 @@ namespace cellulator {
     return m_scheduler;
   }
 
+  inline
+  ColonyPlaybackShPtr
+  ColonyRenderer::getPlayback() noexcept {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    return m_playback;
+  }
+
   inline
   void
   ColonyRenderer::onPaletteChanded(ColorPaletteShPtr palette) {
@@ -226,6 +272,93 @@ namespace cellulator {
     return sdl::core::engine::RawKey::O;
   }
 
+  inline
+  sdl::core::engine::RawKey
+  ColonyRenderer::getBrushOrientationKey() noexcept {
+    return sdl::core::engine::RawKey::R;
+  }
+
+  inline
+  sdl::core::engine::RawKey
+  ColonyRenderer::getSkipAheadKey() noexcept {
+    return sdl::core::engine::RawKey::A;
+  }
+
+  inline
+  unsigned
+  ColonyRenderer::getSkipAheadGenerations() noexcept {
+    return 100u;
+  }
+
+  inline
+  sdl::core::engine::RawKey
+  ColonyRenderer::getSkipUntilStableKey() noexcept {
+    return sdl::core::engine::RawKey::U;
+  }
+
+  inline
+  unsigned
+  ColonyRenderer::getSkipUntilStableLimit() noexcept {
+    return 10000u;
+  }
+
+  inline
+  sdl::core::engine::RawKey
+  ColonyRenderer::getRateControlKey() noexcept {
+    return sdl::core::engine::RawKey::P;
+  }
+
+  inline
+  const std::vector<ColonyRenderer::RatePreset>&
+  ColonyRenderer::getRatePresets() noexcept {
+    static const std::vector<RatePreset> presets = {
+      RatePreset{ColonyScheduler::RateControl::Unlimited, 0u},
+      RatePreset{ColonyScheduler::RateControl::FixedRate, 1u},
+      RatePreset{ColonyScheduler::RateControl::FixedRate, 10u},
+      RatePreset{ColonyScheduler::RateControl::FixedRate, 60u},
+      RatePreset{ColonyScheduler::RateControl::RenderEveryN, 10u},
+      RatePreset{ColonyScheduler::RateControl::RenderEveryN, 100u}
+    };
+
+    return presets;
+  }
+
+  inline
+  sdl::core::engine::RawKey
+  ColonyRenderer::getPlaybackNextKey() noexcept {
+    return sdl::core::engine::RawKey::N;
+  }
+
+  inline
+  sdl::core::engine::RawKey
+  ColonyRenderer::getExportToggleKey() noexcept {
+    return sdl::core::engine::RawKey::E;
+  }
+
+  inline
+  const char*
+  ColonyRenderer::getDefaultExportFile() noexcept {
+    return "colony.y4m";
+  }
+
+  inline
+  sdl::core::engine::RawKey
+  ColonyRenderer::getPlaybackBackKey() noexcept {
+    return sdl::core::engine::RawKey::B;
+  }
+
+  inline
+  sdl::core::engine::RawKey
+  ColonyRenderer::getPlaybackFasterKey() noexcept {
+    return sdl::core::engine::RawKey::F;
+  }
+
+  inline
+  sdl::core::engine::RawKey
+  ColonyRenderer::getPlaybackSlowerKey() noexcept {
+    return sdl::core::engine::RawKey::S;
+  }
+
   inline
   sdl::core::engine::mouse::Button
   ColonyRenderer::getBrushPaintButton() noexcept {
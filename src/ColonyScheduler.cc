@@ -1,21 +1,54 @@
 
 # include "ColonyScheduler.hh"
-# include "ColonyTile.hh"
+# ifdef __linux__
+#  include <pthread.h>
+# endif
 
 namespace cellulator {
 
-  ColonyScheduler::ColonyScheduler(ColonyShPtr colony):
+  ColonyScheduler::ColonyScheduler(ColonyShPtr colony,
+                                   unsigned threads,
+                                   bool pinned):
     utils::CoreObject(std::string("scheduler_for_") + colony->getName()),
 
     m_propsLocker(),
+    m_waiter(),
+    m_idleWaiter(),
+    m_rateWaiter(),
 
-    m_scheduler(std::make_shared<utils::ThreadPool>(getWorkerThreadCount())),
     m_simulationState(SimulationState::Stopped),
-    m_taskProgress(0u),
-    m_taskTotal(1u),
+    m_running(false),
+    m_idle(true),
+    m_terminate(false),
+
+    m_schedule(),
+    m_queues(threads > 0u ? threads : getWorkerThreadCount()),
+    m_owners(),
+    m_costs(),
+    m_interrupt(false),
+    m_interrupted(false),
+    m_temporalBlocking(1u),
+    m_exhaustive(false),
+    m_batch(1u),
+    m_remaining(0u),
+    m_until(),
+    m_lastNotification(),
+    m_lastNotifiedGeneration(0u),
+    m_lastAlive(0u),
+    m_rateControl(RateControl::Unlimited),
+    m_rateValue(1u),
+    m_lastCommit(),
+    m_batchStart(),
+    m_statistics{0u, 0u, 0ul, 0.0, 0.0, 0.0, 0.0},
+
+    m_commands(),
+    m_recorder(),
 
     m_colony(colony),
 
+    m_barrier(m_queues.size(), GenerationCompletion{this}),
+    m_workers(),
+
     onGenerationComputed(),
     onSimulationToggled()
   {
@@ -29,258 +62,874 @@ namespace cellulator {
       );
     }
 
+    m_lastAlive = m_colony->getLiveCellsCount();
+
     build();
+
+    // Pinning the workers is only possible once they are created. A failure
+    // is not fatal: the workers are just scheduled by the system.
+    if (pinned) {
+      pinWorkersToCores();
+    }
+  }
+
+  ColonyScheduler::~ColonyScheduler() {
+    // Stops the colony and request the workers to exit. In case a generation
+    // is being computed the workers will exit once it is completed.
+    {
+      const std::lock_guard guard(m_propsLocker);
+
+      m_simulationState = SimulationState::Stopped;
+      m_terminate = true;
+
+      m_interrupt.store(true);
+    }
+
+    m_waiter.notify_all();
+    m_rateWaiter.notify_all();
+
+    for (unsigned id = 0u ; id < m_workers.size() ; ++id) {
+      m_workers[id].join();
+    }
   }
 
   void
   ColonyScheduler::start() {
-    // Protect from concurrent accesses.
-    const std::lock_guard guard(m_propsLocker);
+    bool halted = false;
 
-    // Check whether the simulation is already started.
-    if (m_simulationState == SimulationState::Running) {
-      return;
-    }
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
+
+      // Check whether the simulation is already started.
+      if (m_simulationState == SimulationState::Running) {
+        return;
+      }
 
-    // Assign the new state.
-    m_simulationState = SimulationState::Running;
+      // Assign the new state.
+      m_simulationState = SimulationState::Running;
 
-    scheduleRendering();
+      // Wake up the workers if they are not already processing a generation:
+      // in this case they will just keep going.
+      if (!m_running) {
+        halted = !launch();
+      }
+    }
+
+    if (halted) {
+      onSimulationToggled.safeEmit(
+        std::string("onSimulationToggled(false)"),
+        false
+      );
+    }
   }
 
   void
   ColonyScheduler::step() {
+    bool halted = false;
+
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
+
+      // Check whether the simulation is already computing a next step.
+      if (m_simulationState != SimulationState::Stopped) {
+        return;
+      }
+
+      // Assign the new state.
+      m_simulationState = SimulationState::SingleStep;
+
+      if (!m_running) {
+        halted = !launch();
+      }
+    }
+
+    if (halted) {
+      onSimulationToggled.safeEmit(
+        std::string("onSimulationToggled(false)"),
+        false
+      );
+    }
+  }
+
+  void
+  ColonyScheduler::advance(unsigned generations) {
+    bool halted = false;
+
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
+
+      // Only advance the simulation if it is stopped.
+      if (m_simulationState != SimulationState::Stopped || m_running) {
+        warn("Could not advance colony by " + std::to_string(generations) + " generation(s), simulation is running");
+        return;
+      }
+
+      if (generations == 0u) {
+        return;
+      }
+
+      m_simulationState = SimulationState::Advancing;
+      m_remaining = generations;
+      m_until = AdvancePredicate();
+
+      halted = !launch();
+    }
+
+    if (halted) {
+      onSimulationToggled.safeEmit(
+        std::string("onSimulationToggled(false)"),
+        false
+      );
+    }
+  }
+
+  void
+  ColonyScheduler::advanceUntil(AdvancePredicate predicate) {
+    bool halted = false;
+
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
+
+      // Only advance the simulation if it is stopped.
+      if (m_simulationState != SimulationState::Stopped || m_running) {
+        warn("Could not advance colony until condition is reached, simulation is running");
+        return;
+      }
+
+      if (!predicate) {
+        warn("Could not advance colony with invalid predicate");
+        return;
+      }
+
+      m_simulationState = SimulationState::Advancing;
+      m_remaining = 0u;
+      m_until = predicate;
+
+      halted = !launch();
+    }
+
+    if (halted) {
+      onSimulationToggled.safeEmit(
+        std::string("onSimulationToggled(false)"),
+        false
+      );
+    }
+  }
+
+  void
+  ColonyScheduler::waitUntilIdle() {
+    std::unique_lock lock(m_propsLocker);
+    m_idleWaiter.wait(
+      lock,
+      [this]() {
+        return m_idle;
+      }
+    );
+  }
+
+  bool
+  ColonyScheduler::refresh() {
+    // Do not wait for the generation being computed: it will be published
+    // anyway once completed.
+    if (m_running.load()) {
+      return false;
+    }
+
     // Protect from concurrent accesses.
     const std::lock_guard guard(m_propsLocker);
 
-    // Check whether the simulation is already computing a next step.
-    if (m_simulationState != SimulationState::Stopped) {
-      return;
+    if (m_running) {
+      return false;
     }
 
-    // Assign the new state.
-    m_simulationState = SimulationState::SingleStep;
+    m_colony->publishSnapshot();
 
-    scheduleRendering();
+    return true;
   }
 
   void
   ColonyScheduler::stop() {
-    // Protect from concurrent accesses.
-    const std::lock_guard guard(m_propsLocker);
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
 
-    // Check whether the simulation is already stopped.
-    if (m_simulationState == SimulationState::Stopped) {
-      return;
+      // Check whether the simulation is already stopped.
+      if (m_simulationState == SimulationState::Stopped) {
+        return;
+      }
+
+      // Request the simulation to stop: in case the workers are processing
+      // a generation we interrupt them.
+      m_simulationState = SimulationState::Stopped;
+
+      if (m_running) {
+        m_interrupt.store(true);
+      }
     }
 
-    // Request the simulation to stop.
-    m_simulationState = SimulationState::Stopped;
+    // Do not wait for the next batch in case we're running at a fixed rate.
+    m_rateWaiter.notify_all();
   }
 
   void
   ColonyScheduler::toggle() {
-    // Protect from concurrent accesses.
-    const std::lock_guard guard(m_propsLocker);
-
-    // Toggle the simulation state.
     bool changed = true;
+    bool running = false;
 
-    switch (m_simulationState) {
-      case SimulationState::Running:
-        m_simulationState = SimulationState::Stopped;
-        break;
-      case SimulationState::Stopped:
-        m_simulationState = SimulationState::Running;
-        break;
-      case SimulationState::SingleStep:
-        // In case the simulation is set to `SingleStep` we can't
-        // really invert anything. Same for the default case where
-        // the state is not recognized. We thus won't do a thing.
-      default:
-        changed = false;
-        break;
-    }
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
 
-    // Scheduler a rendering if needed.
-    if (changed) {
-      // We only want to schedule a new rendering if we need to start
-      // the simulation.
-      if (m_simulationState == SimulationState::Running) {
-        scheduleRendering();
+      // Toggle the simulation state.
+      switch (m_simulationState) {
+        case SimulationState::Running:
+          m_simulationState = SimulationState::Stopped;
+          break;
+        case SimulationState::Stopped:
+          m_simulationState = SimulationState::Running;
+          break;
+        case SimulationState::SingleStep:
+        case SimulationState::Advancing:
+          // In case the simulation is set to `SingleStep` or is being
+          // advanced we can't really invert anything. Same for the
+          // default case where the state is not recognized. We thus
+          // won't do a thing.
+        default:
+          changed = false;
+          break;
       }
 
-      // Notify external listeners.
+      // We only want to wake up the workers if we need to start the
+      // simulation and if they're not already processing something.
+      if (changed && m_simulationState == SimulationState::Running && !m_running) {
+        launch();
+      }
+
+      // Interrupt the generation being computed when pausing.
+      if (changed && m_simulationState == SimulationState::Stopped && m_running) {
+        m_interrupt.store(true);
+      }
+
+      running = (m_simulationState == SimulationState::Running);
+    }
+
+    // Do not wait for the next batch in case we're running at a fixed rate.
+    if (changed && !running) {
+      m_rateWaiter.notify_all();
+    }
+
+    // Notify external listeners.
+    if (changed) {
       onSimulationToggled.safeEmit(
-        std::string("onSimulationToggled(") + std::to_string(m_simulationState == SimulationState::Running) + ")",
-        m_simulationState == SimulationState::Running
+        std::string("onSimulationToggled(") + std::to_string(running) + ")",
+        running
       );
     }
   }
 
   void
   ColonyScheduler::generate() {
-    // Protect from concurrent accesses.
-    const std::lock_guard guard(m_propsLocker);
+    m_commands.push(Command{CommandType::Randomize, nullptr, utils::Vector2i(), nullptr, BrushOrientation::Identity});
 
-    // Check whether the simulation is stopped.
-    if (m_simulationState != SimulationState::Stopped) {
-      warn("Could not generate new colony while current one is running");
+    // Apply the command right away if the workers are not processing any
+    // generation: otherwise it will be applied at the end of the current
+    // generation. Reset the generation count in the first case.
+    if (applyCommandsIfIdle()) {
+      notifyGeneration(0u, m_lastAlive.load());
+    }
+  }
+
+  void
+  ColonyScheduler::onRulesetChanged(CellEvolverShPtr ruleset) {
+    // Check consistency.
+    if (ruleset == nullptr) {
+      warn("Could not change ruleset to invalid null rules");
       return;
     }
 
-    // Use the dedicated handler to generate the colony.
-    unsigned alive = m_colony->generate();
+    m_commands.push(Command{CommandType::Ruleset, nullptr, utils::Vector2i(), ruleset, BrushOrientation::Identity});
 
-    // Reset the generation count.
-    onGenerationComputed.safeEmit(
-      std::string("onGenerationComputed(0, ") + std::to_string(alive) + ")",
-      0u,
-      alive
-    );
+    applyCommandsIfIdle();
+  }
+
+  unsigned
+  ColonyScheduler::paint(CellBrushShPtr brush,
+                         const utils::Vector2i& coord,
+                         const BrushOrientation& orientation)
+  {
+    // Check consistency.
+    if (brush == nullptr || !brush->valid()) {
+      warn("Could not paint invalid brush at " + coord.toString());
+      return m_lastAlive.load();
+    }
+
+    m_commands.push(Command{CommandType::Paint, brush, coord, nullptr, orientation});
+
+    // Do not query the colony for its population: it might be committing a
+    // generation which would block the caller.
+    applyCommandsIfIdle();
+
+    return m_lastAlive.load();
   }
 
   void
-  ColonyScheduler::onRulesetChanged(CellEvolverShPtr ruleset) {
-    // Protect from concurrent accesses.
-    const std::lock_guard guard(m_propsLocker);
+  ColonyScheduler::build() {
+    // Create the workers: they will wait until a simulation is requested.
+    for (unsigned id = 0u ; id < m_queues.size() ; ++id) {
+      m_workers.emplace_back(&ColonyScheduler::simulate, this, id);
+    }
+  }
 
-    // Check whether the simulation is stopped.
-    if (m_simulationState != SimulationState::Stopped) {
-      warn("Could not change ruleset, simulation is running");
-      return;
+  bool
+  ColonyScheduler::launch() {
+    // Generate the launch schedule.
+    m_colony->generateSchedule(m_schedule);
+
+    // Return early if nothing needs to be scheduled.
+    if (m_schedule.empty()) {
+      // The scheduling yields no blocks: this means that the colony is
+      // composed only of `Dead` cells. Nothing will happen anymore so we
+      // can stop the simulation.
+      m_simulationState = SimulationState::Stopped;
+
+      warn("Scheduled a rendering but no blocks are active, discarding request");
+
+      return false;
     }
 
-    m_colony->setRuleset(ruleset);
+    // Wake up the workers.
+    m_batch = computeBatchSize();
+    assignBlocks();
+    m_interrupt.store(false);
+    m_interrupted.store(false);
+    m_running = true;
+    m_idle = false;
+    m_lastCommit = std::chrono::steady_clock::now();
+    m_batchStart = m_lastCommit;
+
+    m_waiter.notify_all();
+
+    return true;
   }
 
   void
-  ColonyScheduler::build() {
-    // Connect the results provider signal of the thread pool to the local slot.
-    m_scheduler->onJobsCompleted.connect_member<ColonyScheduler>(
-      this,
-      &ColonyScheduler::handleTilesComputed
-    );
+  ColonyScheduler::assignBlocks() {
+    // Make sure we can register all the blocks of the schedule.
+    unsigned count = 0u;
+    float total = 0.0f;
+    unsigned known = 0u;
+
+    for (unsigned id = 0u ; id < m_schedule.size() ; ++id) {
+      count = std::max(count, m_schedule[id] + 1u);
+    }
+
+    if (m_owners.size() < count) {
+      m_owners.resize(count, -1);
+      m_costs.resize(count, 0.0f);
+    }
+
+    for (unsigned id = 0u ; id < m_schedule.size() ; ++id) {
+      if (m_costs[m_schedule[id]] > 0.0f) {
+        total += m_costs[m_schedule[id]];
+        ++known;
+      }
+    }
+
+    // Blocks which were never evolved are assumed to have an average cost.
+    float fallback = (known > 0u ? total / known : 1.0f);
+
+    for (unsigned id = 0u ; id < m_schedule.size() ; ++id) {
+      if (m_costs[m_schedule[id]] <= 0.0f) {
+        m_costs[m_schedule[id]] = fallback;
+      }
+    }
+
+    for (unsigned id = 0u ; id < m_queues.size() ; ++id) {
+      m_queues[id].blocks.clear();
+      m_queues[id].next.store(0u);
+      m_queues[id].load = 0.0f;
+    }
+
+    // Keep the blocks already assigned to a worker.
+    std::vector<unsigned> pending;
+
+    for (unsigned id = 0u ; id < m_schedule.size() ; ++id) {
+      unsigned block = m_schedule[id];
+      int owner = m_owners[block];
+
+      if (owner < 0 || owner >= static_cast<int>(m_queues.size())) {
+        pending.push_back(block);
+        continue;
+      }
+
+      m_queues[owner].blocks.push_back(block);
+      m_queues[owner].load += m_costs[block];
+    }
+
+    // Find the least and most loaded workers.
+    auto leastLoaded = [this]() {
+      unsigned best = 0u;
+      for (unsigned id = 1u ; id < m_queues.size() ; ++id) {
+        if (m_queues[id].load < m_queues[best].load) {
+          best = id;
+        }
+      }
+
+      return best;
+    };
+
+    auto mostLoaded = [this]() {
+      unsigned best = 0u;
+      for (unsigned id = 1u ; id < m_queues.size() ; ++id) {
+        if (m_queues[id].load > m_queues[best].load) {
+          best = id;
+        }
+      }
+
+      return best;
+    };
 
-    // Disable logging for the scheduler.
-    m_scheduler->setAllowLog(false);
+    // Assign new blocks to the least loaded worker.
+    for (unsigned id = 0u ; id < pending.size() ; ++id) {
+      unsigned owner = leastLoaded();
+
+      m_owners[pending[id]] = static_cast<int>(owner);
+      m_queues[owner].blocks.push_back(pending[id]);
+      m_queues[owner].load += m_costs[pending[id]];
+    }
+
+    // Move blocks from the most loaded worker to the least loaded one as
+    // long as the load is unbalanced and it improves the situation.
+    float mean = 0.0f;
+    for (unsigned id = 0u ; id < m_queues.size() ; ++id) {
+      mean += m_queues[id].load;
+    }
+    mean /= m_queues.size();
+
+    for (unsigned it = 0u ; it < m_schedule.size() ; ++it) {
+      unsigned from = mostLoaded();
+      unsigned to = leastLoaded();
+
+      float gap = m_queues[from].load - m_queues[to].load;
+
+      if (m_queues[from].load <= getLoadImbalanceThreshold() * mean) {
+        break;
+      }
+
+      // Pick the most expensive block which reduces the gap.
+      std::vector<unsigned>& blocks = m_queues[from].blocks;
+      int candidate = -1;
+
+      for (unsigned id = 0u ; id < blocks.size() ; ++id) {
+        float c = m_costs[blocks[id]];
+        if (c < gap && (candidate < 0 || c > m_costs[blocks[candidate]])) {
+          candidate = static_cast<int>(id);
+        }
+      }
+
+      if (candidate < 0) {
+        break;
+      }
+
+      unsigned block = blocks[candidate];
+      blocks.erase(blocks.begin() + candidate);
+
+      m_owners[block] = static_cast<int>(to);
+      m_queues[to].blocks.push_back(block);
+
+      m_queues[from].load -= m_costs[block];
+      m_queues[to].load += m_costs[block];
+    }
   }
 
   void
-  ColonyScheduler::scheduleRendering() {
-    // Cancel existing rendering operations.
-    m_scheduler->cancelJobs();
+  ColonyScheduler::simulate(unsigned worker) {
+    while (true) {
+      // Wait for a generation to be requested.
+      {
+        std::unique_lock lock(m_propsLocker);
+        m_waiter.wait(
+          lock,
+          [this]() {
+            return m_running || m_terminate;
+          }
+        );
 
-    // Generate the launch schedule.
-    std::vector<ColonyTileShPtr> tiles = m_colony->generateSchedule();
+        // In case we're woken up without a generation to compute it means
+        // that the scheduler is terminating.
+        if (!m_running) {
+          return;
+        }
+      }
 
-    // Convert to required pointer type.
-    std::vector<utils::AsynchronousJobShPtr> tilesAsJobs(tiles.begin(), tiles.end());
+      // Evolve the blocks assigned to this worker and then help the others
+      // with their remaining blocks.
+      for (unsigned id = 0u ; id < m_queues.size() ; ++id) {
+        processQueue((worker + id) % m_queues.size());
+      }
 
-    // Return early if nothing needs to be scheduled.
-    if (tilesAsJobs.empty()) {
-      // The scheduling yields no tiles: this usually means that the colony
-      // is composed only of `Dead` cells and still life patterns.
-      // We still need to move on to the next generation and notify listeners.
-      unsigned gen = m_colony->getGeneration();
-      unsigned alive = m_colony->getLiveCellsCount();
-
-      onGenerationComputed.safeEmit(
-        std::string("onGenerationComputed(") + std::to_string(gen) + ", " + std::to_string(alive) + ")",
-        gen,
-        alive
-      );
+      // Wait for the other workers: the last one to arrive will commit the
+      // generation and prepare the next one.
+      m_barrier.arrive_and_wait();
+    }
+  }
 
-      // Reset the internal simulation state.
-      m_simulationState = SimulationState::Stopped;
+  void
+  ColonyScheduler::processQueue(unsigned worker) {
+    WorkerQueue& queue = m_queues[worker];
 
-      warn("Scheduled a rendering but no jobs where created, discarding request");
-      return;
+    // Evolve blocks until the queue is exhausted or the generation is
+    // interrupted.
+    unsigned id = queue.next.fetch_add(1u);
+
+    while (id < queue.blocks.size() && !m_interrupt.load(std::memory_order_relaxed)) {
+      unsigned block = queue.blocks[id];
+
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+      if (!m_colony->evolve(block, m_batch, &m_interrupt)) {
+        m_interrupted.store(true);
+      }
+
+      // Update the cost of this block.
+      std::chrono::duration<float, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+      float alpha = getCostSmoothingFactor();
+
+      m_costs[block] = (1.0f - alpha) * m_costs[block] + alpha * std::max(elapsed.count(), 1.0f);
+
+      id = queue.next.fetch_add(1u);
+    }
+
+    // Blocks which were not evolved also invalidate the generation.
+    if (id < queue.blocks.size()) {
+      m_interrupted.store(true);
     }
+  }
+
+  bool
+  ColonyScheduler::pinWorkersToCores() {
+# ifdef __linux__
+    unsigned cores = std::thread::hardware_concurrency();
+    if (cores == 0u) {
+      warn("Could not pin workers to cores, unable to determine the number of cores");
+      return false;
+    }
+
+    bool success = true;
 
-    m_scheduler->enqueueJobs(tilesAsJobs, false);
+    for (unsigned id = 0u ; id < m_workers.size() ; ++id) {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(id % cores, &set);
 
-    // Notify listeners that the progression is now `0`.
-    m_taskProgress = 0u;
-    m_taskTotal = tilesAsJobs.size();
+      int ret = pthread_setaffinity_np(m_workers[id].native_handle(), sizeof(cpu_set_t), &set);
+      if (ret != 0) {
+        warn("Could not pin worker " + std::to_string(id) + " to core " + std::to_string(id % cores) + " (err: " + std::to_string(ret) + ")");
+        success = false;
+      }
+    }
 
-    // Start the computing.
-    m_scheduler->notifyJobs();
+    return success;
+# else
+    warn("Could not pin workers to cores, not supported on this platform");
+    return false;
+# endif
   }
 
   void
-  ColonyScheduler::handleTilesComputed(const std::vector<utils::AsynchronousJobShPtr>& tiles) {
-    // Protect from concurrent accesses.
-    const std::lock_guard guard(m_propsLocker);
+  ColonyScheduler::completeGeneration() noexcept {
+    try {
+      // All the workers are done with this batch.
+      std::chrono::steady_clock::time_point computed = std::chrono::steady_clock::now();
+      unsigned long blocks = m_schedule.size();
+
+      // Wait until the generations can be committed if the simulation runs at
+      // a fixed rate.
+      {
+        std::unique_lock lock(m_propsLocker);
+        pace(lock);
+      }
 
-    // Append the number of tiles to the internal count.
-    m_taskProgress += tiles.size();
+      unsigned alive = 0u;
+      unsigned gen = 0u;
+      bool reached = false;
+
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      bool interrupted = m_interrupted.exchange(false);
+
+      if (interrupted) {
+        // The generation was interrupted: discard it and stay at the last
+        // generation reached. The simulation was necessarily stopped.
+        m_colony->rollback();
+
+        alive = m_colony->getLiveCellsCount();
+        gen = m_colony->getGeneration();
+      }
+      else {
+        // Step the colony ahead in time by the number of generations that
+        // were computed in this batch.
+        gen = m_colony->step(&alive, m_batch);
+
+        // Evaluate the condition to reach if any: this is done without holding
+        // the locker so that it can't interfere with the predicate. It is safe
+        // as the predicate is only modified when workers are not processing a
+        // generation.
+        reached = (m_until && m_until(gen, alive));
+      }
+
+      bool notify = false;
+      bool halted = false;
+      bool idle = false;
 
-    // In case all the tiles have been computed for this generation, notify external
-    // listeners. Otherwise wait for the generation to complete.
-    if (m_taskProgress == m_taskTotal) {
-      // First thing to determine is to check whether a closure exists in the input
-      // tiles: if this is the case it means that we don't want to step the colony
-      // one step forward.
-      bool closure = false;
+      bool edited = false;
+      RecorderShPtr recorder;
 
-      unsigned id = 0u;
-      while (id < tiles.size() && !closure) {
-        ColonyTileShPtr t = std::dynamic_pointer_cast<ColonyTile>(tiles[id]);
+      std::chrono::steady_clock::time_point committed = std::chrono::steady_clock::now();
+      std::chrono::steady_clock::time_point scheduled;
 
-        // Check consistency.
-        if (t == nullptr) {
-          warn("Received completion for unknown job type \"" + tiles[id]->getName() + "\"");
+      {
+        const std::lock_guard guard(m_propsLocker);
 
-          continue;
+        // Account for the batch that was just completed.
+        if (!interrupted) {
+          ++m_statistics.batches;
+          m_statistics.generations += m_batch;
+          m_statistics.blocks += blocks * m_batch;
         }
 
-        closure = t->closure();
-        ++id;
+        m_statistics.compute += std::chrono::duration<double>(computed - m_batchStart).count();
+        m_statistics.commit += std::chrono::duration<double>(committed - start).count();
+
+        // Apply the modifications requested during this generation: this is
+        // done before generating the schedule so that the blocks created by
+        // the modifications are evolved.
+        edited = applyCommands();
+
+        recorder = m_recorder;
+
+        if (m_simulationState == SimulationState::SingleStep) {
+          // Reset the simulation to a waiting state.
+          m_simulationState = SimulationState::Stopped;
+        }
+
+        if (m_simulationState == SimulationState::Advancing) {
+          // Stop when the target generation or the condition is reached.
+          m_remaining -= std::min(m_remaining, m_batch);
+
+          if (reached || (!m_until && m_remaining == 0u)) {
+            m_simulationState = SimulationState::Stopped;
+          }
+        }
+
+        // Check whether we should schedule a new generation based on the status
+        // of the simulation.
+        bool advancing = (m_simulationState == SimulationState::Advancing);
+        bool more = ((m_simulationState == SimulationState::Running || advancing) && !m_terminate);
+
+        if (more) {
+          m_colony->generateSchedule(m_schedule);
+          m_batch = computeBatchSize();
+          assignBlocks();
+          m_interrupt.store(false);
+
+          // In case no blocks are active anymore the simulation is halted.
+          if (m_schedule.empty()) {
+            m_simulationState = SimulationState::Stopped;
+            more = false;
+            halted = true;
+          }
+        }
+
+        m_running = more;
+        idle = !more;
+
+        // Commands queued while `m_running` was still set were left to us by
+        // their callers: apply them now that new ones will be applied right
+        // away.
+        if (!more) {
+          edited = applyCommands() || edited;
+        }
+
+        if (edited) {
+          alive = m_colony->getLiveCellsCount();
+          gen = m_colony->getGeneration();
+        }
+
+        // Throttle the notifications while the simulation runs and skip them
+        // entirely while advancing as fast as possible unless all generations
+        // are requested: the last generation is always notified though.
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        bool skip = (advancing && m_rateControl == RateControl::Unlimited);
+
+        notify = (!more || edited || m_exhaustive || (!skip && shouldNotify(gen)));
+        if (notify) {
+          m_lastNotification = now;
+          m_lastNotifiedGeneration = gen;
+          m_lastAlive = alive;
+        }
+
+        if (!more) {
+          m_until = AdvancePredicate();
+          m_remaining = 0u;
+        }
+
+        scheduled = std::chrono::steady_clock::now();
+        m_statistics.schedule += std::chrono::duration<double>(scheduled - committed).count();
       }
 
-      // In case a closure is detected, stop the processing and notify that the
-      // simulation is halted.
-      if (closure) {
-        m_simulationState = SimulationState::Stopped;
+      // Record the generation: the recorder only copies the blocks with
+      // live cells so this is cheap compared to the simulation.
+      if (recorder != nullptr && (!interrupted || edited)) {
+        m_colony->record(*recorder);
+      }
 
+      // Publish the cells of this generation before notifying listeners so
+      // that they can access them. This is safe as the workers are blocked
+      // until we return.
+      if (notify) {
+        m_colony->publishSnapshot();
+        notifyGeneration(gen, alive);
+      }
+
+      // The next batch starts once the listeners are notified: this is the
+      // time at which the workers will be released.
+      {
+        const std::lock_guard guard(m_propsLocker);
+
+        m_batchStart = std::chrono::steady_clock::now();
+        m_statistics.publish += std::chrono::duration<double>(m_batchStart - scheduled).count();
+      }
+
+      if (halted) {
         onSimulationToggled.safeEmit(
           std::string("onSimulationToggled(false)"),
           false
         );
+      }
 
-        return;
+      // Notify threads waiting for the workers to be idle: this is done
+      // after all the notifications so that they're already processed.
+      if (idle) {
+        {
+          const std::lock_guard guard(m_propsLocker);
+          m_idle = !m_running;
+        }
+
+        m_idleWaiter.notify_all();
       }
+    }
+    catch (const std::exception& e) {
+      warn("Caught exception while completing generation: " + std::string(e.what()));
 
-      // Step the colony one generation ahead in time.
-      unsigned alive = 0u;
-      unsigned gen = m_colony->step(&alive);
+      // Halt the simulation: we can't really guarantee anything about the
+      // state of the colony anymore.
+      {
+        const std::lock_guard guard(m_propsLocker);
 
-      onGenerationComputed.safeEmit(
-        std::string("onGenerationComputed(") + std::to_string(gen) + ", " + std::to_string(alive) + ")",
-        gen,
-        alive
-      );
+        m_simulationState = SimulationState::Stopped;
+        m_running = false;
+        m_idle = true;
+        m_until = AdvancePredicate();
+        m_remaining = 0u;
+      }
 
-      // Check whether we should schedule a new generation based on the status of
-      // the simulation. We will also update the simulation state accordingly.
-      switch (m_simulationState) {
-        case SimulationState::Running:
-          scheduleRendering();
-          break;
-        case SimulationState::SingleStep:
-          // Reset the simulation to a waiting state.
-          m_simulationState = SimulationState::Stopped;
-          break;
-        case SimulationState::Stopped:
-          // Nothing to do, the simulation is already stopped we will not start a
-          // new rendering nor modify the state.
-        default:
-          // Same behavior as if the simulation was stopped.
-          break;
+      m_idleWaiter.notify_all();
+    }
+  }
+
+  void
+  ColonyScheduler::pace(std::unique_lock<std::mutex>& lock) {
+    bool simulating = (m_simulationState == SimulationState::Running || m_simulationState == SimulationState::Advancing);
+
+    if (m_rateControl != RateControl::FixedRate || !simulating) {
+      m_lastCommit = std::chrono::steady_clock::now();
+      return;
+    }
+
+    // Compute the date at which the batch should be committed.
+    std::chrono::steady_clock::duration period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(1.0 * m_batch / m_rateValue)
+    );
+
+    std::chrono::steady_clock::time_point deadline = m_lastCommit + period;
+
+    m_rateWaiter.wait_until(
+      lock,
+      deadline,
+      [this]() {
+        return (m_simulationState != SimulationState::Running && m_simulationState != SimulationState::Advancing) || m_terminate;
+      }
+    );
+
+    // In case we're late (typically because the generations take longer to
+    // compute than the requested rate) we don't try to catch up.
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    m_lastCommit = (now - deadline > period ? now : deadline);
+  }
+
+  bool
+  ColonyScheduler::applyCommands() {
+    bool edited = false;
+
+    m_commands.drain(
+      [this, &edited](const Command& command) {
+        switch (command.type) {
+          case CommandType::Paint:
+            m_lastAlive = m_colony->paint(*command.brush, command.coord, command.orientation);
+            edited = true;
+            break;
+          case CommandType::Ruleset:
+            m_colony->setRuleset(command.ruleset);
+            break;
+          case CommandType::Randomize:
+            m_lastAlive = m_colony->generate();
+            m_lastNotifiedGeneration = 0u;
+            edited = true;
+            break;
+          default:
+            warn("Discarding unknown command " + std::to_string(static_cast<int>(command.type)));
+            break;
+        }
       }
+    );
+
+    return edited;
+  }
+
+  bool
+  ColonyScheduler::applyCommandsIfIdle() {
+    // Make sure the command queued by the caller is visible before checking
+    // whether the workers are running: the completion of a generation drains
+    // the queue again after resetting `m_running` so that it is never lost.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_running.load()) {
+      return false;
+    }
+
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    if (m_running) {
+      return false;
     }
+
+    return applyCommands();
   }
 
-}
+  void
+  ColonyScheduler::notifyGeneration(unsigned generation,
+                                    unsigned alive)
+  {
+    onGenerationComputed.safeEmit(
+      std::string("onGenerationComputed(") + std::to_string(generation) + ", " + std::to_string(alive) + ")",
+      generation,
+      alive
+    );
+  }
 
+}
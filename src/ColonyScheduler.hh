@@ -2,21 +2,62 @@
 # define   COLONY_SCHEDULER_HH
 
 # include <mutex>
+# include <atomic>
+# include <chrono>
 # include <memory>
+# include <thread>
+# include <functional>
+# include <vector>
+# include <barrier>
+# include <condition_variable>
 # include <core_utils/CoreObject.hh>
+# include <core_utils/Signal.hh>
 # include <maths_utils/Box.hh>
 # include <maths_utils/Size.hh>
 # include <maths_utils/Vector2.hh>
-# include <core_utils/ThreadPool.hh>
 # include "Colony.hh"
 # include "CellEvolver.hh"
 # include "CellBrush.hh"
+# include "CommandQueue.hh"
 
 namespace cellulator {
 
   class ColonyScheduler: utils::CoreObject {
     public:
 
+      /**
+       * @brief - Convenience define for a predicate used to stop a simulation when
+       *          some condition is reached. It receives the generation reached by the
+       *          colony and the number of live cells at this generation.
+       */
+      using AdvancePredicate = std::function<bool(unsigned, unsigned)>;
+
+      /**
+       * @brief - Describe the possible policies to control the rate at which the colony
+       *          is simulated and at which listeners are notified of new generations.
+       */
+      enum class RateControl {
+        Unlimited,    //< Simulate as fast as possible and notify at most at the
+                      //< display rate.
+        FixedRate,    //< Simulate a fixed number of generations per second.
+        RenderEveryN  //< Simulate as fast as possible and notify every `N` gens.
+      };
+
+      /**
+       * @brief - Convenience structure describing where the time is spent while
+       *          simulating the colony. Durations are accumulated since the last
+       *          reset of the statistics and expressed in seconds.
+       */
+      struct Statistics {
+        unsigned batches;       //< The number of batches of generations committed.
+        unsigned generations;   //< The number of generations committed.
+        unsigned long blocks;   //< The number of blocks evolved, counted once per generation.
+        double compute;         //< Time spent by the workers evolving the blocks.
+        double commit;          //< Time spent swapping the states of the colony.
+        double schedule;        //< Time spent applying commands and assigning blocks.
+        double publish;         //< Time spent publishing snapshots and notifying listeners.
+      };
+
       /**
        * @brief - Create a colony scheduler for the specified colony. Note that
        *          this method is merely a wrapper to allow for easy scheduling
@@ -24,12 +65,18 @@ namespace cellulator {
        *          utilities method to acces general properties of the colony
        *          and notifications.
        * @param colony - the colony to simulate.
+       * @param threads - the number of worker threads to use. A value of `0`
+       *                  means that a default value is used.
+       * @param pinned - whether the worker threads should be pinned to distinct
+       *                 cores, see `pinWorkersToCores`.
        */
-      ColonyScheduler(ColonyShPtr colony);
+      ColonyScheduler(ColonyShPtr colony,
+                      unsigned threads = 0u,
+                      bool pinned = false);
 
       /**
        * @brief - Destruction of the colony. Stops the execution if the colony
-       *          is running.
+       *          is running and terminates the worker threads.
        */
       ~ColonyScheduler();
 
@@ -47,9 +94,61 @@ namespace cellulator {
       void
       step();
 
+      /**
+       * @brief - Used to fast forward the simulation of the colony by the specified
+       *          number of generations. The generations are computed back to back
+       *          without notifying listeners unless the rate control policy requires
+       *          it (see `setRateControl`): only the last generation is reported by
+       *          default through the `onGenerationComputed` signal.
+       *          This method returns immediately: the `waitUntilIdle` method can be
+       *          used to wait for the generations to be computed. Calling `stop` in
+       *          the meantime interrupts the process.
+       *          Nothing happens in case the simulation is not stopped.
+       * @param generations - the number of generations to compute.
+       */
+      void
+      advance(unsigned generations);
+
+      /**
+       * @brief - Similar to `advance` but runs the simulation until the predicate is
+       *          verified. The predicate is evaluated after each generation with the
+       *          index of the generation and the number of live cells and should be
+       *          `true` when the simulation should be stopped.
+       *          Note that the predicate is called from one of the worker threads and
+       *          should not call back into this scheduler.
+       *          The simulation is also stopped in case the colony does not evolve
+       *          anymore or if `stop` is called.
+       * @param predicate - the condition to reach to stop the simulation.
+       */
+      void
+      advanceUntil(AdvancePredicate predicate);
+
+      /**
+       * @brief - Blocks the calling thread until the workers are done computing the
+       *          generations requested so far. This is mostly useful in conjunction
+       *          with the `advance` methods.
+       *          Note that this method never returns if the simulation is running, and
+       *          that it should not be called from a listener of a signal emitted by
+       *          this scheduler.
+       */
+      void
+      waitUntilIdle();
+
+      /**
+       * @brief - Used to publish a new snapshot of the colony in case the workers are
+       *          idle, typically when readers requested an area which is not covered
+       *          by the last snapshot. While the simulation runs nothing happens: the
+       *          next notified generation will cover the new area.
+       * @return - `true` if a snapshot was published.
+       */
+      bool
+      refresh();
+
       /**
        * @brief - Attempt to stop the execution of the colony. Note that if the
        *          colony is not started, nothing happens.
+       *          In case a generation is being computed it is interrupted and
+       *          the colony is left at the last generation reached.
        */
       void
       stop();
@@ -64,8 +163,9 @@ namespace cellulator {
       /**
        * @brief - Wraps a call to the internal colony to generate random cells on
        *          all the available element.
-       *          An error is raised in case the simulation is started (usually we
-       *          want the user to call `stop` before calling this method).
+       *          In case the simulation is running, the request is queued and will
+       *          be applied at the end of the generation being computed. Listeners
+       *          are notified of the new generation in any case.
        */
       void
       generate();
@@ -73,9 +173,9 @@ namespace cellulator {
       /**
        * @brief - Used by external providers to update the ruleset used by this colony
        *          to perform the evolution of the cells.
-       *          A check is performed to verify that the simulation is stopped before
-       *          performing the update (as otherwise we would end up with some strange
-       *          results).
+       *          In case the simulation is running, the request is queued and will be
+       *          applied at the end of the generation being computed so that all cells
+       *          of a generation are evolved with the same rules.
        * @param ruleset - the rules to use to evolve cells.
        */
       void
@@ -83,18 +183,107 @@ namespace cellulator {
 
       /**
        * @brief - Used to perform the creation of cells as described by the input brush
-       *          at the coordinates in input. The simulation should be stopped before
-       *          using this method (which will be ensured upon calling it). The request
-       *          is transmitted to the underlying colony if this is the case.
+       *          at the coordinates in input. In case the simulation is running, the
+       *          request is queued and will be applied at the end of the generation
+       *          being computed: listeners will be notified of the result through the
+       *          `onGenerationComputed` signal.
        *          Nothing happens if the brush is not valid.
        * @param brush - the brush to paint on this colony.
        * @param coord - the coordinate at which the brush should be painted. This info
        *                corresponds to the center of the brush.
-       * @return - the number of live cells in the colony after the paint operation.
+       * @param orientation - the orientation in which the brush is painted.
+       * @return - the number of live cells in the colony after the paint operation if
+       *           it could be applied right away and the number of live cells of the
+       *           last notified generation otherwise.
        */
       unsigned
-      paint(const CellBrush& brush,
-            const utils::Vector2i& coord);
+      paint(CellBrushShPtr brush,
+            const utils::Vector2i& coord,
+            const BrushOrientation& orientation = BrushOrientation::Identity);
+
+      /**
+       * @brief - Used to define the number of generations computed by the workers for
+       *          each block before synchronizing with each other. Larger values reduce
+       *          the number of synchronizations at the cost of some redundant compute
+       *          on the borders of each block. The results are identical to computing
+       *          a single generation at a time.
+       *          The value is clamped to the maximum supported by the colony and only
+       *          applies when the simulation is running: single steps always compute
+       *          one generation. Notifications are only sent for generations which are
+       *          multiple of this value.
+       *          The change is taken into account starting from the next batch.
+       * @param generations - the number of generations to compute between two
+       *                      synchronizations. A value of `0` is interpreted as `1`.
+       */
+      void
+      setTemporalBlocking(unsigned generations);
+
+      /**
+       * @brief - Used to define the policy controlling the rate of the simulation when
+       *          it is running or advancing. The value is interpreted based on the policy:
+       *            - `Unlimited` ignores it.
+       *            - `FixedRate` uses it as the number of generations per second.
+       *            - `RenderEveryN` uses it as the number of generations between two
+       *              notifications.
+       *          In any case the last generation computed before the simulation stops
+       *          is always notified. The policy also applies when advancing the colony
+       *          except for `Unlimited` which does not notify intermediate generations
+       *          in this case.
+       * @param policy - the policy to use.
+       * @param value - the parameter of the policy.
+       */
+      void
+      setRateControl(RateControl policy,
+                     unsigned value = 0u);
+
+      /**
+       * @brief - Used to record the simulation: each time a batch of generations is
+       *          committed the content of the colony is appended to the recorder in
+       *          argument. With temporal blocking only the generations at the end of
+       *          each batch are recorded. The current content of the colony is also
+       *          recorded right away if the simulation is not running.
+       *          Use `nullptr` to stop recording.
+       * @param recorder - the recorder receiving the frames.
+       */
+      void
+      setRecorder(RecorderShPtr recorder);
+
+      /**
+       * @brief - Used to request listeners to be notified of each generation computed,
+       *          typically to export all of them. Temporal blocking is disabled and the
+       *          generations reached while advancing the colony are notified as well.
+       *          The rate control policy is left untouched: in case of a fixed rate the
+       *          simulation is still paced accordingly.
+       *          The change is taken into account starting from the next batch.
+       * @param exhaustive - `true` to notify each generation.
+       */
+      void
+      setExhaustiveNotifications(bool exhaustive);
+
+      /**
+       * @brief - Used to pin each worker thread to a distinct core of the machine. As the
+       *          blocks are mostly evolved by the same worker from one generation to the
+       *          next it helps keeping their data in the caches of the core.
+       *          This is only supported on Linux: the method does nothing otherwise.
+       * @return - `true` if all the workers could be pinned to a core.
+       */
+      bool
+      pinWorkersToCores();
+
+      /**
+       * @brief - Retrieve the statistics accumulated since the creation of the
+       *          scheduler or the last call to `resetStatistics`.
+       * @return - the statistics about the simulation.
+       */
+      Statistics
+      getStatistics();
+
+      /**
+       * @brief - Reset the statistics about the simulation. This is typically used
+       *          to exclude a warm-up phase from the measurements.
+       */
+      void
+      resetStatistics();
 
     private:
 
@@ -107,28 +296,158 @@ namespace cellulator {
       unsigned
       getWorkerThreadCount() noexcept;
 
+      /**
+       * @brief - Used to retrieve the ratio between the load of the most loaded worker
+       *          and the average load above which blocks are moved between workers. As
+       *          long as the load is balanced enough blocks are always assigned to the
+       *          same worker.
+       * @return - the imbalance ratio triggering a rebalancing.
+       */
+      static
+      float
+      getLoadImbalanceThreshold() noexcept;
+
+      /**
+       * @brief - Used to retrieve the weight of the last measure when updating the cost
+       *          of evolving a block.
+       * @return - a value in the range `[0; 1]`.
+       */
+      static
+      float
+      getCostSmoothingFactor() noexcept;
+
+      /**
+       * @brief - Used to retrieve the minimum interval between two notifications
+       *          of a new generation through the `onGenerationComputed` signal.
+       *          This allows to not flood listeners (typically a renderer which
+       *          does not need to display more generations than what the screen
+       *          can display) when the colony evolves very quickly.
+       * @return - the minimum duration between two notifications.
+       */
+      static
+      std::chrono::milliseconds
+      getNotificationInterval() noexcept;
+
       /**
        * @brief - Connect signals and build the scheduler to use to simulate the colony.
+       *          This includes the creation of the worker threads which will wait for a
+       *          simulation to be requested.
        */
       void
       build();
 
       /**
-       * @brief - Used to schedule a rendering of the colony using the internal thread
-       *          pool. Note that this function assumes that the locker on the options
-       *          is already acquired before calling the method.
+       * @brief - Used to launch the simulation of the next generation of the colony by
+       *          the worker threads. The schedule is generated and the workers are woken
+       *          up. Note that this method assumes that the locker on the options is
+       *          already acquired and that workers are not currently processing some
+       *          generation.
+       *          In case the colony does not contain any active block the simulation is
+       *          stopped right away.
+       * @return - `true` if the simulation could be launched and `false` if the colony
+       *           reached a steady state where nothing evolves anymore.
+       */
+      bool
+      launch();
+
+      /**
+       * @brief - Used to distribute the blocks of the schedule among the workers. Blocks
+       *          are assigned to the worker which evolved them in the previous generation
+       *          so that their data stays in the caches of the same core. New blocks are
+       *          given to the least loaded worker and blocks are only moved between two
+       *          workers in case the load is too unbalanced.
+       *          Assumes that the locker on the options is acquired and that workers are
+       *          not processing blocks.
+       */
+      void
+      assignBlocks();
+
+      /**
+       * @brief - Main loop of each worker thread. Workers wait until some generations are
+       *          requested and then evolve the blocks assigned to them. Once done they help
+       *          the other workers by stealing their remaining blocks. They then synchronize
+       *          on the internal barrier until the generation is committed and start again.
+       * @param worker - the index of the worker.
        */
       void
-      scheduleRendering();
+      simulate(unsigned worker);
 
       /**
-       * @brief - Internal slot used to handle the tiles computed by the thread
-       *          pool. The goal is to trigger the creation of the needed repaint
-       *          events to display the results of the computation.
-       * @param tiles - a list of tiles that just completed.
+       * @brief - Used to evolve the blocks of the queue of the specified worker until it
+       *          is exhausted or the generation is interrupted.
+       * @param worker - the index of the worker owning the queue.
        */
       void
-      handleTilesComputed(const std::vector<utils::AsynchronousJobShPtr>& tiles);
+      processQueue(unsigned worker);
+
+      /**
+       * @brief - Called by the last worker reaching the barrier once all the blocks of a
+       *          generation have been evolved. This commits the generation on the colony,
+       *          prepares the schedule for the next one and notifies listeners if needed.
+       *          All the other workers are blocked while this method executes.
+       */
+      void
+      completeGeneration() noexcept;
+
+      /**
+       * @brief - Used to notify external listeners that a new generation is available in
+       *          the colony through the `onGenerationComputed` signal.
+       *          Note that the locker on the options is assumed *not* to be acquired.
+       * @param generation - the generation reached by the colony.
+       * @param alive - the number of live cells in this generation.
+       */
+      void
+      notifyGeneration(unsigned generation,
+                       unsigned alive);
+
+      /**
+       * @brief - Used to compute the number of generations to evolve the blocks with in
+       *          the next batch based on the simulation state and the temporal blocking
+       *          requested. Assumes that the locker on the options is acquired.
+       * @return - the number of generations to compute in the next batch.
+       */
+      unsigned
+      computeBatchSize() const noexcept;
+
+      /**
+       * @brief - Used to block the calling thread until the next batch of generations
+       *          can be committed when the simulation runs at a fixed rate. Returns as
+       *          soon as the simulation is stopped. Nothing happens for other policies.
+       *          Assumes that the locker on the options is acquired through the input
+       *          `lock`.
+       * @param lock - the lock acquired on the options.
+       */
+      void
+      pace(std::unique_lock<std::mutex>& lock);
+
+      /**
+       * @brief - Determine whether listeners should be notified of the input generation
+       *          while the simulation runs based on the rate control policy. Assumes the
+       *          locker on the options is acquired.
+       * @param generation - the generation reached by the colony.
+       * @return - `true` if listeners should be notified.
+       */
+      bool
+      shouldNotify(unsigned generation) const noexcept;
+
+      /**
+       * @brief - Used to apply the commands queued so far to the colony. This should be
+       *          called when the workers are not evolving blocks. Assumes that the locker
+       *          on the options is acquired.
+       * @return - `true` if at least one command modified the cells of the colony.
+       */
+      bool
+      applyCommands();
+
+      /**
+       * @brief - Used to apply the commands queued so far in case the workers are not
+       *          processing a generation. The locker on the options is only acquired
+       *          if the workers seem idle: while the simulation runs the commands are
+       *          left to the completion of the current generation.
+       * @return - `true` if the commands were applied and modified the colony.
+       */
+      bool
+      applyCommandsIfIdle();
 
     private:
 
@@ -138,7 +457,54 @@ namespace cellulator {
       enum class SimulationState {
         Stopped,
         Running,
-        SingleStep
+        SingleStep,
+        Advancing
+      };
+
+      /**
+       * @brief - Convenience structure holding the blocks assigned to a worker. The index
+       *          of the next block to evolve is shared so that other workers can steal the
+       *          remaining blocks once they're done with their own.
+       */
+      struct WorkerQueue {
+        std::vector<unsigned> blocks;   //< The blocks assigned to the worker.
+        std::atomic<unsigned> next;     //< The index of the next block to evolve.
+        float load;                     //< The expected cost of evolving the blocks.
+      };
+
+      /**
+       * @brief - Describe the possible modifications of the colony that can be queued
+       *          while the simulation is running.
+       */
+      enum class CommandType {
+        Paint,
+        Ruleset,
+        Randomize
+      };
+
+      /**
+       * @brief - Convenience structure describing a modification of the colony to be
+       *          applied at the end of a generation. Only the fields relevant for the
+       *          type of command are set.
+       */
+      struct Command {
+        CommandType type;             //< The type of the command.
+        CellBrushShPtr brush;         //< The brush to paint (for `Paint` commands).
+        utils::Vector2i coord;        //< The position of the brush (for `Paint` commands).
+        CellEvolverShPtr ruleset;     //< The new ruleset (for `Ruleset` commands).
+        BrushOrientation orientation; //< The orientation of the brush (for `Paint` commands).
+      };
+
+      /**
+       * @brief - Convenience structure used as completion function for the barrier
+       *          used to synchronize the workers. It just forwards the call to the
+       *          scheduler.
+       */
+      struct GenerationCompletion {
+        ColonyScheduler* scheduler;
+
+        void
+        operator()() noexcept;
       };
 
       /**
@@ -147,9 +513,25 @@ namespace cellulator {
       std::mutex m_propsLocker;
 
       /**
-       * @brief - Convenience object allowing to schedule the simulation of the colony.
+       * @brief - Used by the worker threads to wait for a new generation to compute. It
+       *          is notified whenever the simulation is started (or stepped) and when
+       *          the scheduler is terminated.
+       */
+      std::condition_variable m_waiter;
+
+      /**
+       * @brief - Used by external threads to wait for the workers to be done with the
+       *          generations requested so far. It is notified whenever the workers stop
+       *          processing generations.
        */
-      utils::ThreadPoolShPtr m_scheduler;
+      std::condition_variable m_idleWaiter;
+
+      /**
+       * @brief - Used to wait until the next batch of generations can be committed when
+       *          the simulation runs at a fixed rate. It is notified when the simulation
+       *          is stopped.
+       */
+      std::condition_variable m_rateWaiter;
 
       /**
        * @brief - Holds the current simulation status. Checking this value allows to
@@ -158,25 +540,170 @@ namespace cellulator {
       SimulationState m_simulationState;
 
       /**
-       * @brief - Used to keep track of the tiles already rendered so far in the current
-       *          rendering operation. This allows to compute some sort of percentage of
-       *          completion of the task.
+       * @brief - Indicates whether the workers are currently processing a generation.
+       *          This value is only set to `true` when the workers are waiting for a
+       *          new generation and only reset by the completion of a generation: it
+       *          guarantees that all workers agree on whether they should process the
+       *          next generation.
+       *          It is only modified with the locker acquired but can be read without
+       *          it, which allows to queue commands without waiting for the commit of
+       *          a generation.
+       */
+      std::atomic<bool> m_running;
+
+      /**
+       * @brief - Indicates whether the workers are idle: unlike `m_running` it is only
+       *          set back to `true` once the listeners have been notified of the last
+       *          generation computed.
+       */
+      bool m_idle;
+
+      /**
+       * @brief - Set to `true` when the scheduler is destroyed to indicate to workers
+       *          that they should exit.
+       */
+      bool m_terminate;
+
+      /**
+       * @brief - The list of blocks to evolve for the current generation. It is only
+       *          modified while workers are either waiting for a generation or all
+       *          blocked on the barrier.
+       */
+      std::vector<unsigned> m_schedule;
+
+      /**
+       * @brief - The blocks of the schedule assigned to each worker.
+       */
+      std::vector<WorkerQueue> m_queues;
+
+      /**
+       * @brief - The index of the worker owning each block or a negative value if the
+       *          block is not assigned yet. Indexed by the identifier of the block.
+       */
+      std::vector<int> m_owners;
+
+      /**
+       * @brief - The measured cost (in microseconds) of evolving each block, smoothed
+       *          over several generations. Indexed by the identifier of the block. As
+       *          a block is evolved by a single worker in a generation each entry is
+       *          only ever accessed by a single thread.
+       */
+      std::vector<float> m_costs;
+
+      /**
+       * @brief - Set to `true` to request the workers to interrupt the evolution of the
+       *          current generation. It is polled during the evolution of each block.
+       */
+      std::atomic<bool> m_interrupt;
+
+      /**
+       * @brief - Set by the workers when the evolution of at least one block has been
+       *          interrupted: in this case the generation should be discarded.
+       */
+      std::atomic<bool> m_interrupted;
+
+      /**
+       * @brief - The number of generations requested by the user to be computed before
+       *          workers synchronize with each other.
+       */
+      unsigned m_temporalBlocking;
+
+      /**
+       * @brief - Whether listeners should be notified of each generation computed.
+       */
+      bool m_exhaustive;
+
+      /**
+       * @brief - The number of generations each block of the current schedule should be
+       *          evolved with. Computed along with the schedule.
+       */
+      unsigned m_batch;
+
+      /**
+       * @brief - The number of generations still to compute when the simulation has been
+       *          requested to advance by a given number of generations.
+       */
+      unsigned m_remaining;
+
+      /**
+       * @brief - The predicate to evaluate after each generation when the simulation has
+       *          been requested to advance until some condition is reached. Only modified
+       *          when the workers are not processing generations.
+       */
+      AdvancePredicate m_until;
+
+      /**
+       * @brief - The date at which the last notification of a computed generation has
+       *          been sent. Used to throttle the notifications.
+       */
+      std::chrono::steady_clock::time_point m_lastNotification;
+
+      /**
+       * @brief - The generation notified to listeners through the last notification.
        */
-      unsigned m_taskProgress;
+      unsigned m_lastNotifiedGeneration;
 
       /**
-       * @brief - Keep track of the total size of the batch of tasks that were generated
-       *          to be scheduled.
-       *          Useful in conjunction with the `m_taskProgress` to provide some sort of
-       *          completion percentage.
+       * @brief - The number of live cells in the colony as of the last notification
+       *          or the last modification applied while the workers were idle. Used
+       *          to answer callers without locking the colony which may be busy with
+       *          committing a generation.
        */
-      unsigned m_taskTotal;
+      std::atomic<unsigned> m_lastAlive;
+
+      /**
+       * @brief - The policy used to control the rate of the simulation along with its
+       *          parameter.
+       */
+      RateControl m_rateControl;
+      unsigned m_rateValue;
+
+      /**
+       * @brief - The date at which the last batch of generations was committed. Used to
+       *          compute when the next one should be when running at a fixed rate.
+       */
+      std::chrono::steady_clock::time_point m_lastCommit;
+
+      /**
+       * @brief - The date at which the workers started to process the current batch of
+       *          generations. Used to measure the time spent evolving the blocks.
+       */
+      std::chrono::steady_clock::time_point m_batchStart;
+
+      /**
+       * @brief - The statistics accumulated about the simulation. Updated each time a
+       *          batch of generations is committed.
+       */
+      Statistics m_statistics;
+
+      /**
+       * @brief - The modifications of the colony requested by external elements and not
+       *          yet applied. They are applied at generation boundaries.
+       */
+      CommandQueue<Command> m_commands;
+
+      /**
+       * @brief - The recorder receiving the generations committed if any.
+       */
+      RecorderShPtr m_recorder;
 
       /**
        * @brief - The internal colony which is scheduled by this object.
        */
       ColonyShPtr m_colony;
 
+      /**
+       * @brief - The barrier used to separate two generations: all the workers wait on it
+       *          once they can't find any block to evolve anymore. The completion of the
+       *          barrier commits the generation.
+       */
+      std::barrier<GenerationCompletion> m_barrier;
+
+      /**
+       * @brief - The persistent worker threads evolving the blocks of the colony.
+       */
+      std::vector<std::thread> m_workers;
+
     public:
 
       /**
@@ -185,6 +712,10 @@ namespace cellulator {
        *          generation of cells displayed on screen.
        *          We provide both the current generation along with the number of alive
        *          cells in the colony.
+       *          Note that the notifications are throttled when the simulation runs: not
+       *          all generations are notified but the last one before the simulation is
+       *          stopped always is. When advancing the colony, only the last generation
+       *          is notified.
        */
       utils::Signal<unsigned, unsigned> onGenerationComputed;
 
@@ -6,28 +6,71 @@
 namespace cellulator {
 
   inline
-  ColonyScheduler::~ColonyScheduler() {
-    // Stops the colony.
-    stop();
+  void
+  ColonyScheduler::setTemporalBlocking(unsigned generations) {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    m_temporalBlocking = std::max(generations, 1u);
   }
 
   inline
-  unsigned
-  ColonyScheduler::paint(const CellBrush& brush,
-                         const utils::Vector2i& coord)
+  void
+  ColonyScheduler::setRateControl(RateControl policy,
+                                  unsigned value)
   {
     // Protect from concurrent accesses.
     const std::lock_guard guard(m_propsLocker);
 
-    // In case the simulation is not stopped, we can't paint the brush.
-    if (m_simulationState != SimulationState::Stopped) {
-      warn("Could not paint brush " + brush.getName() + " at " + coord.toString() + ", simulation is running");
+    if (policy == RateControl::FixedRate && value == 0u) {
+      warn("Could not set fixed rate of 0 generation per second, ignoring request");
+      return;
+    }
+
+    m_rateControl = policy;
+    m_rateValue = std::max(value, 1u);
+  }
+
+  inline
+  void
+  ColonyScheduler::setRecorder(RecorderShPtr recorder) {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    m_recorder = recorder;
 
-      return m_colony->getLiveCellsCount();
+    // The colony can't be modified by the workers while the simulation
+    // is not running.
+    if (m_recorder != nullptr && !m_running) {
+      m_colony->record(*m_recorder);
     }
+  }
+
+  inline
+  void
+  ColonyScheduler::setExhaustiveNotifications(bool exhaustive) {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    m_exhaustive = exhaustive;
+  }
+
+  inline
+  ColonyScheduler::Statistics
+  ColonyScheduler::getStatistics() {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    return m_statistics;
+  }
+
+  inline
+  void
+  ColonyScheduler::resetStatistics() {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
 
-    // Call the dedicated method on the scheduler.
-    return m_colony->paint(brush, coord);
+    m_statistics = Statistics{0u, 0u, 0ul, 0.0, 0.0, 0.0, 0.0};
   }
 
   inline
@@ -36,6 +79,67 @@ namespace cellulator {
     return 3u;
   }
 
+  inline
+  float
+  ColonyScheduler::getLoadImbalanceThreshold() noexcept {
+    return 1.25f;
+  }
+
+  inline
+  float
+  ColonyScheduler::getCostSmoothingFactor() noexcept {
+    return 0.25f;
+  }
+
+  inline
+  std::chrono::milliseconds
+  ColonyScheduler::getNotificationInterval() noexcept {
+    // Roughly matches a display refreshed at 60 fps.
+    return std::chrono::milliseconds(16);
+  }
+
+  inline
+  unsigned
+  ColonyScheduler::computeBatchSize() const noexcept {
+    // Each generation should be notified so none can be skipped.
+    if (m_exhaustive) {
+      return 1u;
+    }
+
+    unsigned batch = std::max(std::min(m_temporalBlocking, m_colony->getMaxGenerationsPerEvolution()), 1u);
+
+    switch (m_simulationState) {
+      case SimulationState::Running:
+        return batch;
+      case SimulationState::Advancing:
+        // The predicate should be evaluated at each generation so we can't
+        // batch them. Otherwise we don't want to go past the target.
+        return (m_until ? 1u : std::max(std::min(batch, m_remaining), 1u));
+      case SimulationState::SingleStep:
+      case SimulationState::Stopped:
+      default:
+        // Single steps are not batched.
+        return 1u;
+    }
+  }
+
+  inline
+  bool
+  ColonyScheduler::shouldNotify(unsigned generation) const noexcept {
+    if (m_rateControl == RateControl::RenderEveryN) {
+      return generation >= m_lastNotifiedGeneration + m_rateValue;
+    }
+
+    // Both other policies are throttled to the display rate.
+    return std::chrono::steady_clock::now() - m_lastNotification >= getNotificationInterval();
+  }
+
+  inline
+  void
+  ColonyScheduler::GenerationCompletion::operator()() noexcept {
+    scheduler->completeGeneration();
+  }
+
 }
 
 #endif    /* COLONY_SCHEDULER_HXX */
@@ -0,0 +1,92 @@
+#ifndef    COMMAND_QUEUE_HH
+# define   COMMAND_QUEUE_HH
+
+# include <atomic>
+
+namespace cellulator {
+
+  /**
+   * @brief - A lock-free queue allowing any number of producers to push some
+   *          commands to be processed by a single consumer. Producers never
+   *          wait for each other nor for the consumer: each command is pushed
+   *          on an intrusive stack with a single atomic operation.
+   *          The consumer retrieves all the pending commands at once and then
+   *          processes them in the order they were pushed.
+   */
+  template <typename T>
+  class CommandQueue {
+    public:
+
+      /**
+       * @brief - Create a new empty command queue.
+       */
+      CommandQueue();
+
+      /**
+       * @brief - Destruction of the queue: any pending command is discarded.
+       */
+      ~CommandQueue();
+
+      CommandQueue(const CommandQueue&) = delete;
+
+      CommandQueue&
+      operator=(const CommandQueue&) = delete;
+
+      /**
+       * @brief - Used to register a new command in the queue. This method can be
+       *          called concurrently from any thread.
+       * @param command - the command to push.
+       */
+      void
+      push(T command);
+
+      /**
+       * @brief - Used to determine whether some commands are pending. Note that
+       *          the result can be outdated right after being returned.
+       * @return - `true` if no commands are pending.
+       */
+      bool
+      empty() const noexcept;
+
+      /**
+       * @brief - Used to process all the commands pushed so far, in the order in
+       *          which they were pushed. Commands pushed while the processing is
+       *          running will be handled by the next call.
+       *          Should only be called by a single consumer at a time.
+       * @param process - the function to apply on each command.
+       * @return - the number of commands processed.
+       */
+      template <typename Processor>
+      unsigned
+      drain(Processor&& process);
+
+    private:
+
+      /**
+       * @brief - A node of the internal stack.
+       */
+      struct Node {
+        T command;
+        Node* next;
+      };
+
+      /**
+       * @brief - Used to release the list of nodes starting at the input node.
+       * @param node - the first node of the list to release.
+       */
+      static
+      void
+      release(Node* node) noexcept;
+
+      /**
+       * @brief - The head of the stack of pending commands: the last command to
+       *          be pushed is at the top.
+       */
+      std::atomic<Node*> m_head;
+  };
+
+}
+
+# include "CommandQueue.hxx"
+
+#endif    /* COMMAND_QUEUE_HH */
@@ -0,0 +1,94 @@
+#ifndef    COMMAND_QUEUE_HXX
+# define   COMMAND_QUEUE_HXX
+
+# include <utility>
+# include "CommandQueue.hh"
+
+namespace cellulator {
+
+  template <typename T>
+  inline
+  CommandQueue<T>::CommandQueue():
+    m_head(nullptr)
+  {}
+
+  template <typename T>
+  inline
+  CommandQueue<T>::~CommandQueue() {
+    release(m_head.exchange(nullptr));
+  }
+
+  template <typename T>
+  inline
+  void
+  CommandQueue<T>::push(T command) {
+    Node* node = new Node{std::move(command), m_head.load(std::memory_order_relaxed)};
+
+    // Attempt to set the node as the new head until no other producer (or
+    // the consumer) modified it concurrently.
+    while (!m_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+  }
+
+  template <typename T>
+  inline
+  bool
+  CommandQueue<T>::empty() const noexcept {
+    return m_head.load(std::memory_order_acquire) == nullptr;
+  }
+
+  template <typename T>
+  template <typename Processor>
+  inline
+  unsigned
+  CommandQueue<T>::drain(Processor&& process) {
+    // Retrieve all the pending commands at once.
+    Node* head = m_head.exchange(nullptr, std::memory_order_acquire);
+
+    // The stack holds the commands in reverse order: restore the order in
+    // which they were pushed.
+    Node* ordered = nullptr;
+    while (head != nullptr) {
+      Node* next = head->next;
+      head->next = ordered;
+      ordered = head;
+      head = next;
+    }
+
+    unsigned count = 0u;
+
+    while (ordered != nullptr) {
+      Node* next = ordered->next;
+
+      // Make sure the remaining commands are released even if the processing
+      // of this command fails.
+      try {
+        process(ordered->command);
+      }
+      catch (...) {
+        delete ordered;
+        release(next);
+        throw;
+      }
+
+      delete ordered;
+      ordered = next;
+      ++count;
+    }
+
+    return count;
+  }
+
+  template <typename T>
+  inline
+  void
+  CommandQueue<T>::release(Node* node) noexcept {
+    while (node != nullptr) {
+      Node* next = node->next;
+      delete node;
+      node = next;
+    }
+  }
+
+}
+
+#endif    /* COMMAND_QUEUE_HXX */
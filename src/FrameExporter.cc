@@ -0,0 +1,640 @@
+
+# include "FrameExporter.hh"
+# include <array>
+# include <cerrno>
+# include <chrono>
+# include <cstring>
+# include <exception>
+# include <algorithm>
+# include <fcntl.h>
+# include <unistd.h>
+
+namespace cellulator {
+
+  FrameExporter::FrameExporter(const std::string& output,
+                               const ExportFormat& format,
+                               unsigned threads,
+                               unsigned capacity):
+    utils::CoreObject(output),
+
+    m_propsLocker(),
+    m_waiter(),
+    m_videoLocker(),
+
+    m_output(output),
+    m_format(format),
+    m_capacity(std::max(capacity, 1u)),
+
+    m_pending(),
+    m_inFlight(0u),
+
+    m_dims(),
+    m_encoded(),
+    m_nextFrame(0u),
+    m_fd(-1),
+
+    m_stop(false),
+    m_error(),
+    m_statistics{0u, 0u, 0ull, 0u, 0.0},
+
+    m_encoders()
+  {
+    setService("frame_exporter");
+
+    if (m_format == ExportFormat::Y4m) {
+      m_fd = ::open(m_output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+      if (m_fd < 0) {
+        error(
+          std::string("Could not create exporter to \"") + m_output + "\"",
+          std::string("Cannot open file: ") + std::strerror(errno)
+        );
+      }
+    }
+
+    for (unsigned id = 0u ; id < std::max(threads, 1u) ; ++id) {
+      m_encoders.push_back(std::thread(&FrameExporter::encode, this));
+    }
+  }
+
+  FrameExporter::~FrameExporter() {
+    {
+      const std::lock_guard guard(m_propsLocker);
+      m_stop = true;
+    }
+
+    m_waiter.notify_all();
+
+    for (unsigned id = 0u ; id < m_encoders.size() ; ++id) {
+      m_encoders[id].join();
+    }
+
+    if (m_fd >= 0) {
+      ::close(m_fd);
+    }
+  }
+
+  void
+  FrameExporter::push(ExportedFrame&& frame) {
+    // Frames rendered by the encoders can only be checked once rendered.
+    if (frame.dims.w() <= 0 || frame.dims.h() <= 0 ||
+        (!frame.render && frame.pixels.size() != 3u * static_cast<std::size_t>(frame.dims.area())))
+    {
+      error(
+        std::string("Could not export frame for generation ") + std::to_string(frame.generation),
+        std::string("Invalid ") + std::to_string(frame.pixels.size()) + " byte(s) for " + frame.dims.toString() + " pixel(s)"
+      );
+    }
+
+    {
+      std::unique_lock lock(m_propsLocker);
+
+      // Apply the backpressure: the producer waits for the encoders in
+      // case too many frames are already pending.
+      if (m_inFlight >= m_capacity && m_error.empty()) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        m_waiter.wait(
+          lock,
+          [this]() {
+            return m_inFlight < m_capacity || !m_error.empty();
+          }
+        );
+
+        ++m_statistics.stalls;
+        m_statistics.stalled += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      }
+
+      if (!m_error.empty()) {
+        error(
+          std::string("Could not export frame for generation ") + std::to_string(frame.generation),
+          m_error
+        );
+      }
+
+      // The first frame defines the dimensions of the video.
+      if (m_statistics.frames == 0u) {
+        m_dims = frame.dims;
+      }
+
+      m_pending.push_back(Job{m_statistics.frames, std::move(frame)});
+      ++m_statistics.frames;
+      ++m_inFlight;
+    }
+
+    m_waiter.notify_all();
+  }
+
+  void
+  FrameExporter::flush() {
+    std::unique_lock lock(m_propsLocker);
+    m_waiter.wait(
+      lock,
+      [this]() {
+        return m_inFlight == 0u || !m_error.empty();
+      }
+    );
+  }
+
+  FrameExporter::Statistics
+  FrameExporter::getStatistics() noexcept {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    return m_statistics;
+  }
+
+  void
+  FrameExporter::encode() {
+    std::vector<std::uint8_t> data;
+
+    while (true) {
+      Job job;
+      utils::Sizei dims;
+
+      {
+        std::unique_lock lock(m_propsLocker);
+        m_waiter.wait(
+          lock,
+          [this]() {
+            return !m_pending.empty() || m_stop;
+          }
+        );
+
+        // Pending frames are written before stopping.
+        if (m_pending.empty()) {
+          return;
+        }
+
+        job = std::move(m_pending.front());
+        m_pending.pop_front();
+        dims = m_dims;
+      }
+
+      prepare(job.frame);
+
+      data.clear();
+
+      if (m_format == ExportFormat::Y4m) {
+        // The frames of the video should be written in order: the frame
+        // is handed to the thread currently writing if any.
+        encodeY4m(job.frame, dims, data);
+
+        {
+          const std::lock_guard guard(m_propsLocker);
+          m_encoded[job.index].swap(data);
+        }
+
+        writeVideo();
+
+        continue;
+      }
+
+      encodePng(job.frame, data);
+
+      std::string index = std::to_string(job.index);
+      index.insert(0u, getIndexDigits() - std::min<std::size_t>(index.size(), getIndexDigits()), '0');
+
+      bool success = writeFile(m_output + "_" + index + ".png", data);
+
+      {
+        const std::lock_guard guard(m_propsLocker);
+
+        --m_inFlight;
+
+        if (success) {
+          ++m_statistics.written;
+          m_statistics.bytes += data.size();
+        }
+        else if (m_error.empty()) {
+          m_error = std::string("Failed to write frame: ") + std::strerror(errno);
+        }
+      }
+
+      m_waiter.notify_all();
+    }
+  }
+
+  void
+  FrameExporter::prepare(ExportedFrame& frame) {
+    std::string failure;
+
+    if (frame.render) {
+      try {
+        frame.render(frame);
+      }
+      catch (const std::exception& err) {
+        failure = std::string("Failed to render frame: ") + err.what();
+      }
+
+      frame.render = nullptr;
+    }
+
+    const std::size_t expected = 3u * static_cast<std::size_t>(frame.dims.area());
+
+    if (failure.empty() && frame.pixels.size() != expected) {
+      failure = std::string("Invalid ") + std::to_string(frame.pixels.size()) + " byte(s) for " + frame.dims.toString() + " pixel(s)";
+    }
+
+    if (failure.empty()) {
+      return;
+    }
+
+    // Export a black frame so that the following ones are still written
+    // in order: the error is reported by the next push.
+    frame.pixels.assign(expected, 0u);
+
+    const std::lock_guard guard(m_propsLocker);
+    if (m_error.empty()) {
+      m_error = failure;
+    }
+  }
+
+  void
+  FrameExporter::writeVideo() {
+    const std::lock_guard video(m_videoLocker);
+
+    while (true) {
+      std::vector<std::uint8_t> data;
+      utils::Sizei dims;
+      bool first = false;
+
+      {
+        const std::lock_guard guard(m_propsLocker);
+
+        std::map<unsigned, std::vector<std::uint8_t>>::iterator it = m_encoded.find(m_nextFrame);
+        if (it == m_encoded.end()) {
+          return;
+        }
+
+        data.swap(it->second);
+        m_encoded.erase(it);
+
+        first = (m_nextFrame == 0u);
+        dims = m_dims;
+        ++m_nextFrame;
+      }
+
+      std::string header;
+      if (first) {
+        header = "YUV4MPEG2 W" + std::to_string(dims.w()) + " H" + std::to_string(dims.h()) + " F30:1 Ip A1:1 C420jpeg\n";
+      }
+      header += "FRAME\n";
+
+      bool success = (
+        append(m_fd, std::vector<std::uint8_t>(header.begin(), header.end())) &&
+        append(m_fd, data)
+      );
+
+      {
+        const std::lock_guard guard(m_propsLocker);
+
+        --m_inFlight;
+
+        if (success) {
+          ++m_statistics.written;
+          m_statistics.bytes += header.size() + data.size();
+        }
+        else if (m_error.empty()) {
+          m_error = std::string("Failed to write frame: ") + std::strerror(errno);
+        }
+      }
+
+      m_waiter.notify_all();
+    }
+  }
+
+  bool
+  FrameExporter::writeFile(const std::string& file,
+                           const std::vector<std::uint8_t>& data)
+  {
+    int fd = ::open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      return false;
+    }
+
+    bool success = append(fd, data);
+    ::close(fd);
+
+    return success;
+  }
+
+  bool
+  FrameExporter::append(int fd,
+                        const std::vector<std::uint8_t>& data)
+  {
+    if (fd < 0) {
+      errno = EBADF;
+      return false;
+    }
+
+    std::size_t written = 0u;
+
+    while (written < data.size()) {
+      ssize_t count = ::write(fd, data.data() + written, data.size() - written);
+
+      if (count < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+
+        return false;
+      }
+
+      written += static_cast<std::size_t>(count);
+    }
+
+    return true;
+  }
+
+  void
+  FrameExporter::encodePng(const ExportedFrame& frame,
+                           std::vector<std::uint8_t>& out)
+  {
+    const unsigned w = static_cast<unsigned>(frame.dims.w());
+    const unsigned h = static_cast<unsigned>(frame.dims.h());
+    const unsigned stride = 1u + 3u * w;
+
+    // Each row is preceded by its filter type: no filter is used as the
+    // compression already looks for repetitions of the previous row.
+    std::vector<std::uint8_t> raw(static_cast<std::size_t>(stride) * h);
+    for (unsigned y = 0u ; y < h ; ++y) {
+      raw[y * stride] = 0u;
+      std::memcpy(&raw[y * stride + 1u], &frame.pixels[3u * y * w], 3u * w);
+    }
+
+    auto be32 = [](std::vector<std::uint8_t>& v, std::uint32_t value) {
+      v.push_back(static_cast<std::uint8_t>(value >> 24u));
+      v.push_back(static_cast<std::uint8_t>(value >> 16u));
+      v.push_back(static_cast<std::uint8_t>(value >> 8u));
+      v.push_back(static_cast<std::uint8_t>(value));
+    };
+
+    static const std::uint8_t signature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+    out.insert(out.end(), signature, signature + sizeof(signature));
+
+    // 8 bits per channel, RGB, default compression, filtering and no
+    // interlacing.
+    std::vector<std::uint8_t> chunk;
+    be32(chunk, w);
+    be32(chunk, h);
+    chunk.insert(chunk.end(), {8u, 2u, 0u, 0u, 0u});
+    appendChunk("IHDR", chunk, out);
+
+    chunk.clear();
+    deflate(raw, stride, chunk);
+    appendChunk("IDAT", chunk, out);
+
+    chunk.clear();
+    appendChunk("IEND", chunk, out);
+  }
+
+  void
+  FrameExporter::encodeY4m(const ExportedFrame& frame,
+                           const utils::Sizei& dims,
+                           std::vector<std::uint8_t>& out)
+  {
+    const int w = dims.w();
+    const int h = dims.h();
+    const int cw = (w + 1) / 2;
+    const int ch = (h + 1) / 2;
+
+    out.resize(static_cast<std::size_t>(w) * h + 2u * static_cast<std::size_t>(cw) * ch);
+
+    std::uint8_t* lum = out.data();
+    std::uint8_t* cb = lum + static_cast<std::size_t>(w) * h;
+    std::uint8_t* cr = cb + static_cast<std::size_t>(cw) * ch;
+
+    // Pixels outside of the frame are black.
+    auto pixel = [&frame](int x, int y, int c) {
+      if (x >= frame.dims.w() || y >= frame.dims.h()) {
+        return 0;
+      }
+
+      return static_cast<int>(frame.pixels[3u * (static_cast<std::size_t>(y) * frame.dims.w() + x) + c]);
+    };
+
+    // Conversion to the studio range of BT.601.
+    for (int y = 0 ; y < h ; ++y) {
+      for (int x = 0 ; x < w ; ++x) {
+        int r = pixel(x, y, 0), g = pixel(x, y, 1), b = pixel(x, y, 2);
+        lum[y * w + x] = static_cast<std::uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+      }
+    }
+
+    // The chroma is computed from the average color of each 2x2 square.
+    for (int y = 0 ; y < ch ; ++y) {
+      for (int x = 0 ; x < cw ; ++x) {
+        int r = 0, g = 0, b = 0, count = 0;
+
+        for (int dy = 0 ; dy < 2 && 2 * y + dy < h ; ++dy) {
+          for (int dx = 0 ; dx < 2 && 2 * x + dx < w ; ++dx) {
+            r += pixel(2 * x + dx, 2 * y + dy, 0);
+            g += pixel(2 * x + dx, 2 * y + dy, 1);
+            b += pixel(2 * x + dx, 2 * y + dy, 2);
+            ++count;
+          }
+        }
+
+        r /= count;
+        g /= count;
+        b /= count;
+
+        cb[y * cw + x] = static_cast<std::uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        cr[y * cw + x] = static_cast<std::uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+      }
+    }
+  }
+
+  void
+  FrameExporter::deflate(const std::vector<std::uint8_t>& data,
+                         unsigned stride,
+                         std::vector<std::uint8_t>& out)
+  {
+    static const unsigned lengthBase[29] = {
+      3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+      35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+    };
+    static const unsigned lengthExtra[29] = {
+      0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+      3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+    };
+    static const unsigned distanceBase[30] = {
+      1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+      257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+    };
+    static const unsigned distanceExtra[30] = {
+      0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+      7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+    };
+
+    // The bits are packed starting with the least significant bit of each
+    // byte while the Huffman codes start with their most significant bit.
+    std::uint32_t bits = 0u;
+    unsigned count = 0u;
+
+    auto write = [&out, &bits, &count](std::uint32_t value, unsigned length) {
+      bits |= (value << count);
+      count += length;
+
+      while (count >= 8u) {
+        out.push_back(static_cast<std::uint8_t>(bits));
+        bits >>= 8u;
+        count -= 8u;
+      }
+    };
+
+    auto code = [&write](std::uint32_t value, unsigned length) {
+      std::uint32_t reversed = 0u;
+      for (unsigned id = 0u ; id < length ; ++id) {
+        reversed |= ((value >> id) & 1u) << (length - 1u - id);
+      }
+
+      write(reversed, length);
+    };
+
+    // Fixed codes of the literals and lengths.
+    auto symbol = [&code](unsigned value) {
+      if (value < 144u) {
+        code(0x30u + value, 8u);
+      }
+      else if (value < 256u) {
+        code(0x190u + value - 144u, 9u);
+      }
+      else if (value < 280u) {
+        code(value - 256u, 7u);
+      }
+      else {
+        code(0xC0u + value - 280u, 8u);
+      }
+    };
+
+    // Header of the zlib stream: deflate with a window of 32kB and the
+    // fastest compression level.
+    out.push_back(0x78u);
+    out.push_back(0x01u);
+
+    // A single final block using the fixed codes.
+    write(1u, 1u);
+    write(1u, 2u);
+
+    const unsigned candidates[3] = {1u, 3u, stride};
+    const std::size_t size = data.size();
+    std::size_t pos = 0u;
+
+    while (pos < size) {
+      unsigned best = 0u;
+      unsigned distance = 0u;
+
+      for (unsigned id = 0u ; id < 3u ; ++id) {
+        unsigned d = candidates[id];
+        if (d > pos || d > getMaxMatchDistance()) {
+          continue;
+        }
+
+        unsigned length = 0u;
+        while (length < getMaxMatchLength() && pos + length < size && data[pos + length] == data[pos + length - d]) {
+          ++length;
+        }
+
+        if (length > best) {
+          best = length;
+          distance = d;
+        }
+      }
+
+      if (best < 3u) {
+        symbol(data[pos]);
+        ++pos;
+        continue;
+      }
+
+      unsigned l = 28u;
+      while (lengthBase[l] > best) {
+        --l;
+      }
+
+      symbol(257u + l);
+      write(best - lengthBase[l], lengthExtra[l]);
+
+      unsigned d = 29u;
+      while (distanceBase[d] > distance) {
+        --d;
+      }
+
+      code(d, 5u);
+      write(distance - distanceBase[d], distanceExtra[d]);
+
+      pos += best;
+    }
+
+    // End of the block and padding of the last byte.
+    symbol(256u);
+    if (count > 0u) {
+      write(0u, 8u - count);
+    }
+
+    // Checksum of the uncompressed data.
+    std::uint32_t a = 1u, b = 0u;
+    for (std::size_t id = 0u ; id < size ; ++id) {
+      a = (a + data[id]) % 65521u;
+      b = (b + a) % 65521u;
+    }
+
+    std::uint32_t adler = (b << 16u) | a;
+    out.push_back(static_cast<std::uint8_t>(adler >> 24u));
+    out.push_back(static_cast<std::uint8_t>(adler >> 16u));
+    out.push_back(static_cast<std::uint8_t>(adler >> 8u));
+    out.push_back(static_cast<std::uint8_t>(adler));
+  }
+
+  void
+  FrameExporter::appendChunk(const char* type,
+                             const std::vector<std::uint8_t>& data,
+                             std::vector<std::uint8_t>& out)
+  {
+    auto be32 = [&out](std::uint32_t value) {
+      out.push_back(static_cast<std::uint8_t>(value >> 24u));
+      out.push_back(static_cast<std::uint8_t>(value >> 16u));
+      out.push_back(static_cast<std::uint8_t>(value >> 8u));
+      out.push_back(static_cast<std::uint8_t>(value));
+    };
+
+    be32(static_cast<std::uint32_t>(data.size()));
+
+    // The CRC covers the type and the content of the chunk.
+    std::size_t start = out.size();
+    out.insert(out.end(), type, type + 4u);
+    out.insert(out.end(), data.begin(), data.end());
+
+    be32(crc(out.data() + start, out.size() - start));
+  }
+
+  std::uint32_t
+  FrameExporter::crc(const std::uint8_t* data,
+                     std::size_t size) noexcept
+  {
+    static const std::array<std::uint32_t, 256> table = []() {
+      std::array<std::uint32_t, 256> t;
+
+      for (std::uint32_t n = 0u ; n < 256u ; ++n) {
+        std::uint32_t c = n;
+        for (unsigned k = 0u ; k < 8u ; ++k) {
+          c = (c & 1u ? 0xEDB88320u ^ (c >> 1u) : c >> 1u);
+        }
+
+        t[n] = c;
+      }
+
+      return t;
+    }();
+
+    std::uint32_t c = 0xFFFFFFFFu;
+    for (std::size_t id = 0u ; id < size ; ++id) {
+      c = table[(c ^ data[id]) & 0xFFu] ^ (c >> 8u);
+    }
+
+    return c ^ 0xFFFFFFFFu;
+  }
+
+}
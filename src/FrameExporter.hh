@@ -0,0 +1,348 @@
+#ifndef    FRAME_EXPORTER_HH
+# define   FRAME_EXPORTER_HH
+
+# include <map>
+# include <mutex>
+# include <deque>
+# include <thread>
+# include <memory>
+# include <string>
+# include <vector>
+# include <cstdint>
+# include <functional>
+# include <condition_variable>
+# include <maths_utils/Size.hh>
+# include <core_utils/CoreObject.hh>
+
+namespace cellulator {
+
+  /**
+   * @brief - The formats available to export frames.
+   */
+  enum class ExportFormat {
+    Png,          //< One PNG image per frame.
+    Y4m           //< A single raw YUV4MPEG2 video holding all the frames.
+  };
+
+  /**
+   * @brief - A frame to export: the pixels are stored as 8 bits RGB triplets
+   *          starting with the top left corner of the image, one row after
+   *          the other.
+   *          The pixels can either be provided directly or produced by the
+   *          `render` function, which is then called by the thread encoding
+   *          the frame: this allows the producer to only capture the data to
+   *          represent and to leave the expensive rendering to the exporter.
+   */
+  struct ExportedFrame {
+    std::uint64_t generation;
+    utils::Sizei dims;
+    std::vector<std::uint8_t> pixels;
+    std::function<void(ExportedFrame&)> render;
+  };
+
+  class FrameExporter: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Create a new exporter writing the frames pushed to it in the
+       *          format in argument. The frames are encoded by a pool of threads
+       *          and at most `capacity` frames can be waiting to be written: when
+       *          this limit is reached, pushing a new frame blocks until one of
+       *          them is written. This bounds the memory used by the export while
+       *          only slowing down the producer when the encoders lag behind: in
+       *          this case the producer runs at the pace of the export, so a slow
+       *          disk or too few encoders bound the speed of the simulation when
+       *          each generation is exported.
+       *          When exporting PNG images, the `output` is used as a prefix for
+       *          the files, which are suffixed by the index of the frame. A video
+       *          is written in the `output` file directly at 30 frames per second:
+       *          all its frames have the dimensions of the first one.
+       * @param output - the prefix of the images or the name of the video.
+       * @param format - the format of the exported frames.
+       * @param threads - the number of threads encoding frames.
+       * @param capacity - the maximum number of frames waiting to be written.
+       */
+      FrameExporter(const std::string& output,
+                    const ExportFormat& format,
+                    unsigned threads = 2u,
+                    unsigned capacity = 16u);
+
+      /**
+       * @brief - Wait for all the pending frames to be written and stop the threads
+       *          encoding the frames.
+       */
+      ~FrameExporter();
+
+      /**
+       * @brief - Register a new frame to export. The method returns as soon as the
+       *          frame is queued, which might require to wait for previous frames to
+       *          be written in case too many of them are pending.
+       *          An error is raised in case a previous frame could not be written or
+       *          if the frame is not consistent with its dimensions. In case the frame
+       *          defines a `render` function, it is only checked once rendered and an
+       *          inconsistent frame is exported as a black image and reported by the
+       *          next call to this method.
+       * @param frame - the frame to export, moved into the exporter.
+       */
+      void
+      push(ExportedFrame&& frame);
+
+      /**
+       * @brief - Wait until all the frames pushed so far are written to the disk.
+       */
+      void
+      flush();
+
+      /**
+       * @brief - Convenience structure describing the activity of the exporter.
+       */
+      struct Statistics {
+        unsigned frames;          //< The number of frames pushed.
+        unsigned written;         //< The number of frames written.
+        std::uint64_t bytes;      //< The number of bytes written.
+        unsigned stalls;          //< The number of pushes which had to wait.
+        double stalled;           //< The time spent waiting in `push` in seconds.
+      };
+
+      /**
+       * @brief - Retrieve the activity of the exporter so far.
+       * @return - the statistics of the exporter.
+       */
+      Statistics
+      getStatistics() noexcept;
+
+    private:
+
+      /**
+       * @brief - The number of digits used to suffix the name of images with the
+       *          index of the frame.
+       * @return - the number of digits of the index.
+       */
+      static
+      unsigned
+      getIndexDigits() noexcept;
+
+      /**
+       * @brief - The longest match that can be encoded by the deflate format.
+       * @return - the maximum length of a match.
+       */
+      static
+      unsigned
+      getMaxMatchLength() noexcept;
+
+      /**
+       * @brief - The farthest match that can be encoded by the deflate format.
+       * @return - the maximum distance of a match.
+       */
+      static
+      unsigned
+      getMaxMatchDistance() noexcept;
+
+      /**
+       * @brief - Main loop of the threads encoding the frames.
+       */
+      void
+      encode();
+
+      /**
+       * @brief - Render the frame in argument if needed and make sure that its
+       *          pixels are consistent with its dimensions. An inconsistent frame
+       *          is replaced by a black image and the error is recorded.
+       * @param frame - the frame to prepare.
+       */
+      void
+      prepare(ExportedFrame& frame);
+
+      /**
+       * @brief - Write the encoded frames of the video in order, as long as the one
+       *          following the last written frame is available. Only one thread at
+       *          a time writes to the video.
+       */
+      void
+      writeVideo();
+
+      /**
+       * @brief - Write the data in argument to a file.
+       * @param file - the name of the file.
+       * @param data - the data to write.
+       * @return - `false` if the file could not be written.
+       */
+      static
+      bool
+      writeFile(const std::string& file,
+                const std::vector<std::uint8_t>& data);
+
+      /**
+       * @brief - Append the data in argument to an opened file.
+       * @param fd - the descriptor of the file.
+       * @param data - the data to write.
+       * @return - `false` if the data could not be written.
+       */
+      static
+      bool
+      append(int fd,
+             const std::vector<std::uint8_t>& data);
+
+      /**
+       * @brief - Encode a frame as a PNG image. The pixels are compressed with the
+       *          fixed codes of the deflate format, only looking for repetitions of
+       *          the previous pixel and of the previous row: this is cheap and works
+       *          well for the large uniform areas of a colony.
+       * @param frame - the frame to encode.
+       * @param out - output vector receiving the image.
+       */
+      static
+      void
+      encodePng(const ExportedFrame& frame,
+                std::vector<std::uint8_t>& out);
+
+      /**
+       * @brief - Convert a frame to the planes of a YUV4MPEG2 frame with chroma
+       *          subsampling. The frame is cropped or padded with black pixels to
+       *          match the dimensions of the video.
+       * @param frame - the frame to convert.
+       * @param dims - the dimensions of the video.
+       * @param out - output vector receiving the frame.
+       */
+      static
+      void
+      encodeY4m(const ExportedFrame& frame,
+                const utils::Sizei& dims,
+                std::vector<std::uint8_t>& out);
+
+      /**
+       * @brief - Compress the data in argument with the deflate format wrapped in a
+       *          zlib stream.
+       * @param data - the data to compress.
+       * @param stride - the size of a row of the data.
+       * @param out - output vector receiving the compressed data.
+       */
+      static
+      void
+      deflate(const std::vector<std::uint8_t>& data,
+              unsigned stride,
+              std::vector<std::uint8_t>& out);
+
+      /**
+       * @brief - Append a chunk to a PNG image.
+       * @param type - the type of the chunk, made of 4 characters.
+       * @param data - the content of the chunk.
+       * @param out - the image receiving the chunk.
+       */
+      static
+      void
+      appendChunk(const char* type,
+                  const std::vector<std::uint8_t>& data,
+                  std::vector<std::uint8_t>& out);
+
+      /**
+       * @brief - Compute the CRC of the data in argument as defined by the PNG format.
+       * @param data - the data to process.
+       * @param size - the number of bytes of the data.
+       * @return - the CRC of the data.
+       */
+      static
+      std::uint32_t
+      crc(const std::uint8_t* data,
+          std::size_t size) noexcept;
+
+    private:
+
+      /**
+       * @brief - A frame waiting to be encoded.
+       */
+      struct Job {
+        unsigned index;
+        ExportedFrame frame;
+      };
+
+      /**
+       * @brief - Protect this object from concurrent accesses.
+       */
+      std::mutex m_propsLocker;
+
+      /**
+       * @brief - Used to notify the encoders when a frame is pushed and the producer
+       *          when a frame is written.
+       */
+      std::condition_variable m_waiter;
+
+      /**
+       * @brief - Make sure that a single thread writes to the video at a time.
+       */
+      std::mutex m_videoLocker;
+
+      /**
+       * @brief - The prefix of the images or the name of the video.
+       */
+      std::string m_output;
+
+      /**
+       * @brief - The format of the exported frames.
+       */
+      ExportFormat m_format;
+
+      /**
+       * @brief - The maximum number of frames pushed but not yet written.
+       */
+      unsigned m_capacity;
+
+      /**
+       * @brief - The frames waiting to be encoded.
+       */
+      std::deque<Job> m_pending;
+
+      /**
+       * @brief - The number of frames pushed but not yet written, including the ones
+       *          being encoded.
+       */
+      unsigned m_inFlight;
+
+      /**
+       * @brief - The dimensions of the video, defined by its first frame.
+       */
+      utils::Sizei m_dims;
+
+      /**
+       * @brief - The encoded frames of the video waiting for the previous frames to
+       *          be written, indexed by their position in the video.
+       */
+      std::map<unsigned, std::vector<std::uint8_t>> m_encoded;
+
+      /**
+       * @brief - The index of the next frame to write to the video.
+       */
+      unsigned m_nextFrame;
+
+      /**
+       * @brief - The descriptor of the video, only accessed by the thread writing it.
+       */
+      int m_fd;
+
+      /**
+       * @brief - Whether the encoders should stop.
+       */
+      bool m_stop;
+
+      /**
+       * @brief - The error which occurred while writing a frame if any.
+       */
+      std::string m_error;
+
+      /**
+       * @brief - The activity of the exporter.
+       */
+      Statistics m_statistics;
+
+      /**
+       * @brief - The threads encoding the frames.
+       */
+      std::vector<std::thread> m_encoders;
+  };
+
+  using FrameExporterShPtr = std::shared_ptr<FrameExporter>;
+}
+
+# include "FrameExporter.hxx"
+
+#endif    /* FRAME_EXPORTER_HH */
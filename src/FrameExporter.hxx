@@ -0,0 +1,28 @@
+#ifndef    FRAME_EXPORTER_HXX
+# define   FRAME_EXPORTER_HXX
+
+# include "FrameExporter.hh"
+
+namespace cellulator {
+
+  inline
+  unsigned
+  FrameExporter::getIndexDigits() noexcept {
+    return 6u;
+  }
+
+  inline
+  unsigned
+  FrameExporter::getMaxMatchLength() noexcept {
+    return 258u;
+  }
+
+  inline
+  unsigned
+  FrameExporter::getMaxMatchDistance() noexcept {
+    return 32768u;
+  }
+
+}
+
+#endif    /* FRAME_EXPORTER_HXX */
@@ -0,0 +1,561 @@
+
+# include "Macrocell.hh"
+# include <fstream>
+# include <sstream>
+# include <limits>
+# include <algorithm>
+# include <core_utils/CoreException.hh>
+
+namespace {
+
+  /**
+   * @brief - Floor division of a coordinate by two, used to find the parent
+   *          of a node: the usual division rounds toward zero.
+   */
+  inline
+  std::int64_t
+  parentOf(std::int64_t c) noexcept {
+    return (c >= 0 ? c / 2 : (c - 1) / 2);
+  }
+
+}
+
+namespace cellulator {
+
+  Macrocell::Macrocell():
+    utils::CoreObject(std::string("macrocell")),
+
+    m_nodes(),
+    m_root(0u),
+    m_unique(),
+    m_staged(),
+
+    m_rule(),
+    m_ruleset(),
+    m_generation(0u)
+  {
+    setService("macrocell");
+
+    clear();
+  }
+
+  void
+  Macrocell::load(const std::string& file) {
+    clear();
+
+    std::ifstream in(file.c_str());
+
+    if (!in.good()) {
+      error(
+        std::string("Could not read pattern from \"") + file + "\"",
+        std::string("Cannot open file")
+      );
+    }
+
+    std::string line;
+    std::getline(in, line);
+
+    if (line.compare(0u, 4u, "[M2]") != 0) {
+      error(
+        std::string("Could not read pattern from \"") + file + "\"",
+        std::string("Invalid header \"") + line + "\", expected \"[M2]\""
+      );
+    }
+
+    unsigned number = 1u;
+
+    try {
+      while (std::getline(in, line)) {
+        ++number;
+
+        if (!line.empty() && line.back() == '\r') {
+          line.pop_back();
+        }
+
+        if (line.empty()) {
+          continue;
+        }
+
+        if (line[0] != '#') {
+          parseNode(line, number, file);
+          continue;
+        }
+
+        if (line.compare(0u, 2u, "#R") == 0) {
+          std::string rule = line.substr(2u);
+          rule.erase(0u, rule.find_first_not_of(" \t"));
+          rule.erase(rule.find_last_not_of(" \t") + 1u);
+
+          setRule(rule);
+        }
+        else if (line.compare(0u, 2u, "#G") == 0) {
+          m_generation = std::stoull(line.substr(2u));
+        }
+      }
+    }
+    catch (const utils::CoreException&) {
+      clear();
+      throw;
+    }
+    catch (const std::exception&) {
+      clear();
+      error(
+        std::string("Could not read pattern from \"") + file + "\"",
+        std::string("Invalid line ") + std::to_string(number) + " \"" + line + "\""
+      );
+    }
+
+    // The root is the last node of the file.
+    m_root = static_cast<unsigned>(m_nodes.size() - 1u);
+  }
+
+  void
+  Macrocell::save(const std::string& file) {
+    compact();
+
+    std::ofstream out(file.c_str(), std::ios::binary);
+
+    if (!out.good()) {
+      error(
+        std::string("Could not write pattern to \"") + file + "\"",
+        std::string("Cannot open file")
+      );
+    }
+
+    out << "[M2] (cellulator)" << "\n";
+    if (!m_rule.empty()) {
+      out << "#R " << m_rule << "\n";
+    }
+    if (m_generation > 0u) {
+      out << "#G " << m_generation << "\n";
+    }
+
+    // The nodes are already ordered so that children come before their
+    // parents: the index of a node in the file is its index here.
+    std::string row;
+
+    for (unsigned id = 1u ; id < m_nodes.size() ; ++id) {
+      const Node& n = m_nodes[id];
+
+      if (n.level > getLeafLevel()) {
+        out
+          << n.level << " "
+          << n.children[0] << " " << n.children[1] << " "
+          << n.children[2] << " " << n.children[3] << "\n";
+
+        continue;
+      }
+
+      // Leaves are written row by row from the top, each row being
+      // terminated by a `$`. Trailing dead cells and trailing empty
+      // rows are omitted.
+      row.clear();
+      unsigned rows = 8u;
+      while (rows > 0u && ((n.leaf >> (8u * (rows - 1u))) & 0xFFu) == 0u) {
+        --rows;
+      }
+
+      for (unsigned y = 0u ; y < rows ; ++y) {
+        unsigned bits = static_cast<unsigned>((n.leaf >> (8u * y)) & 0xFFu);
+
+        for (unsigned x = 0u ; bits != 0u ; ++x, bits >>= 1u) {
+          row += ((bits & 1u) != 0u ? '*' : '.');
+        }
+
+        row += '$';
+      }
+
+      out << row << "\n";
+    }
+
+    // An empty pattern still needs a root.
+    if (m_root == 0u) {
+      out << getLeafLevel() + 1u << " 0 0 0 0" << "\n";
+    }
+
+    if (!out.good()) {
+      error(
+        std::string("Could not write pattern to \"") + file + "\"",
+        std::string("Failed to write data")
+      );
+    }
+  }
+
+  void
+  Macrocell::clear() {
+    m_nodes.clear();
+    m_unique.clear();
+    m_staged.clear();
+
+    // The empty node.
+    m_nodes.push_back(Node{0u, 0ull, {0u, 0u, 0u, 0u}});
+    m_root = 0u;
+  }
+
+  void
+  Macrocell::add(const std::vector<utils::Vector2i>& cells) {
+    for (unsigned id = 0u ; id < cells.size() ; ++id) {
+      // The `y` axis of the pattern goes down.
+      std::int64_t x = cells[id].x();
+      std::int64_t y = -1 - static_cast<std::int64_t>(cells[id].y());
+
+      std::uint64_t bit = 1ull << (8u * static_cast<unsigned>(y & 7) + static_cast<unsigned>(x & 7));
+
+      m_staged[packCoords(x >> 3, y >> 3)] |= bit;
+    }
+  }
+
+  void
+  Macrocell::compact() {
+    if (m_staged.empty()) {
+      return;
+    }
+
+    // Merge the existing quadtree with the staged cells: the tree is
+    // rebuilt from scratch.
+    if (m_root != 0u) {
+      // Leaves are staged with 32 bits coordinates.
+      if (m_nodes[m_root].level > getLeafLevel() + 32u) {
+        error(
+          std::string("Could not add cells to pattern"),
+          std::string("Pattern of level ") + std::to_string(m_nodes[m_root].level) + " is too large"
+        );
+      }
+
+      std::int64_t half = std::int64_t(1) << (m_nodes[m_root].level - 1u);
+      stage(m_root, -half, -half);
+    }
+
+    std::unordered_map<std::uint64_t, std::uint64_t> staged;
+    staged.swap(m_staged);
+    clear();
+
+    // Create the leaves and then each level of the tree from the nodes
+    // of the previous one, until the nodes fit in the four quadrants of
+    // a root centered on the origin.
+    std::unordered_map<std::uint64_t, unsigned> level;
+    level.reserve(staged.size());
+
+    bool fits = true;
+
+    for (std::unordered_map<std::uint64_t, std::uint64_t>::const_iterator it = staged.cbegin() ;
+         it != staged.cend() ;
+         ++it)
+    {
+      std::int32_t x = static_cast<std::int32_t>(it->first >> 32u);
+      std::int32_t y = static_cast<std::int32_t>(it->first & 0xFFFFFFFFull);
+
+      fits = fits && x >= -1 && x <= 0 && y >= -1 && y <= 0;
+
+      level[it->first] = intern(getLeafLevel(), it->second, {0u, 0u, 0u, 0u});
+    }
+
+    staged.clear();
+
+    unsigned depth = getLeafLevel();
+
+    while (!fits) {
+      std::unordered_map<std::uint64_t, std::array<unsigned, 4>> parents;
+      parents.reserve(level.size() / 2u + 1u);
+
+      for (std::unordered_map<std::uint64_t, unsigned>::const_iterator it = level.cbegin() ;
+           it != level.cend() ;
+           ++it)
+      {
+        std::int64_t x = static_cast<std::int32_t>(it->first >> 32u);
+        std::int64_t y = static_cast<std::int32_t>(it->first & 0xFFFFFFFFull);
+
+        std::array<unsigned, 4>& children = parents.emplace(
+          packCoords(parentOf(x), parentOf(y)),
+          std::array<unsigned, 4>{0u, 0u, 0u, 0u}
+        ).first->second;
+
+        children[(x & 1) + 2 * (y & 1)] = it->second;
+      }
+
+      ++depth;
+      level.clear();
+      fits = true;
+
+      for (std::unordered_map<std::uint64_t, std::array<unsigned, 4>>::const_iterator it = parents.cbegin() ;
+           it != parents.cend() ;
+           ++it)
+      {
+        std::int32_t x = static_cast<std::int32_t>(it->first >> 32u);
+        std::int32_t y = static_cast<std::int32_t>(it->first & 0xFFFFFFFFull);
+
+        fits = fits && x >= -1 && x <= 0 && y >= -1 && y <= 0;
+
+        level[it->first] = intern(depth, 0ull, it->second);
+      }
+    }
+
+    // The root gathers the four quadrants around the origin.
+    std::array<unsigned, 4> quadrants = {0u, 0u, 0u, 0u};
+    const std::int64_t coords[4][2] = {{-1, -1}, {0, -1}, {-1, 0}, {0, 0}};
+
+    for (unsigned id = 0u ; id < quadrants.size() ; ++id) {
+      std::unordered_map<std::uint64_t, unsigned>::const_iterator it = level.find(
+        packCoords(coords[id][0], coords[id][1])
+      );
+
+      if (it != level.cend()) {
+        quadrants[id] = it->second;
+      }
+    }
+
+    m_root = intern(depth + 1u, 0ull, quadrants);
+
+    // The table is only needed while building the tree.
+    m_unique.clear();
+  }
+
+  void
+  Macrocell::visit(const utils::Vector2i& coord,
+                   unsigned batch,
+                   const CellsVisitor& visitor) const
+  {
+    if (m_root == 0u) {
+      return;
+    }
+
+    Traversal traversal{coord, std::max(batch, 1u), &visitor, std::vector<utils::Vector2i>(), 0ull};
+    traversal.cells.reserve(traversal.batch);
+
+    std::int64_t half = std::int64_t(1) << (m_nodes[m_root].level - 1u);
+    visitNode(m_root, -half, -half, traversal);
+
+    if (!traversal.cells.empty()) {
+      visitor(traversal.cells);
+    }
+
+    if (traversal.dropped > 0u) {
+      warn(
+        "Dropped " + std::to_string(traversal.dropped) + " cell(s) which can't be " +
+        "represented at " + coord.toString()
+      );
+    }
+  }
+
+  void
+  Macrocell::setRule(const std::string& rule) {
+    m_rule = rule;
+    m_ruleset.reset();
+
+    if (m_rule.empty()) {
+      return;
+    }
+
+    try {
+      // Strip the description of the topology if any.
+      m_ruleset = CellEvolver::fromRule(m_rule.substr(0u, m_rule.find(':')));
+    }
+    catch (const utils::CoreException& e) {
+      warn("Ignoring unsupported rule \"" + m_rule + "\": " + e.what());
+    }
+  }
+
+  std::uint64_t
+  Macrocell::getLiveCellsCount() const noexcept {
+    // Children come before their parents so a single pass is enough.
+    std::vector<std::uint64_t> counts(m_nodes.size(), 0ull);
+
+    for (unsigned id = 1u ; id < m_nodes.size() ; ++id) {
+      const Node& n = m_nodes[id];
+
+      if (n.level == getLeafLevel()) {
+        counts[id] = static_cast<std::uint64_t>(__builtin_popcountll(n.leaf));
+        continue;
+      }
+
+      for (unsigned c = 0u ; c < n.children.size() ; ++c) {
+        counts[id] += counts[n.children[c]];
+      }
+    }
+
+    return counts[m_root];
+  }
+
+  unsigned
+  Macrocell::intern(unsigned level,
+                    std::uint64_t leaf,
+                    const std::array<unsigned, 4>& children)
+  {
+    Node n{level, leaf, children};
+
+    std::unordered_map<Node, unsigned, NodeHasher, NodeEqual>::const_iterator it = m_unique.find(n);
+    if (it != m_unique.cend()) {
+      return it->second;
+    }
+
+    unsigned id = static_cast<unsigned>(m_nodes.size());
+    m_nodes.push_back(n);
+    m_unique.emplace(n, id);
+
+    return id;
+  }
+
+  void
+  Macrocell::stage(unsigned node,
+                   std::int64_t x,
+                   std::int64_t y)
+  {
+    if (node == 0u) {
+      return;
+    }
+
+    const Node& n = m_nodes[node];
+
+    if (n.level == getLeafLevel()) {
+      // Only a root can be a leaf not aligned on the grid of leaves.
+      if (((x | y) & 7) == 0) {
+        m_staged[packCoords(x >> 3, y >> 3)] |= n.leaf;
+        return;
+      }
+
+      for (unsigned bit = 0u ; bit < 64u ; ++bit) {
+        if ((n.leaf >> bit) & 1ull) {
+          std::int64_t cx = x + (bit & 7u), cy = y + (bit >> 3u);
+          m_staged[packCoords(cx >> 3, cy >> 3)] |= 1ull << (8u * static_cast<unsigned>(cy & 7) + static_cast<unsigned>(cx & 7));
+        }
+      }
+
+      return;
+    }
+
+    std::int64_t half = std::int64_t(1) << (n.level - 1u);
+
+    stage(n.children[0], x, y);
+    stage(n.children[1], x + half, y);
+    stage(n.children[2], x, y + half);
+    stage(n.children[3], x + half, y + half);
+  }
+
+  void
+  Macrocell::visitNode(unsigned node,
+                       std::int64_t x,
+                       std::int64_t y,
+                       Traversal& traversal) const
+  {
+    if (node == 0u) {
+      return;
+    }
+
+    const Node& n = m_nodes[node];
+
+    if (n.level > getLeafLevel()) {
+      std::int64_t half = std::int64_t(1) << (n.level - 1u);
+
+      visitNode(n.children[0], x, y, traversal);
+      visitNode(n.children[1], x + half, y, traversal);
+      visitNode(n.children[2], x, y + half, traversal);
+      visitNode(n.children[3], x + half, y + half, traversal);
+
+      return;
+    }
+
+    std::uint64_t bits = n.leaf;
+
+    while (bits != 0ull) {
+      unsigned bit = static_cast<unsigned>(__builtin_ctzll(bits));
+      bits &= bits - 1ull;
+
+      // Convert to the frame of the colony where the `y` axis goes up.
+      std::int64_t cx = traversal.origin.x() + x + (bit & 7u);
+      std::int64_t cy = traversal.origin.y() - 1 - (y + (bit >> 3u));
+
+      if (cx < std::numeric_limits<int>::min() || cx > std::numeric_limits<int>::max() ||
+          cy < std::numeric_limits<int>::min() || cy > std::numeric_limits<int>::max())
+      {
+        ++traversal.dropped;
+        continue;
+      }
+
+      traversal.cells.push_back(utils::Vector2i(static_cast<int>(cx), static_cast<int>(cy)));
+
+      if (traversal.cells.size() >= traversal.batch) {
+        (*traversal.visitor)(traversal.cells);
+        traversal.cells.clear();
+      }
+    }
+  }
+
+  void
+  Macrocell::parseNode(const std::string& line,
+                       unsigned number,
+                       const std::string& file)
+  {
+    unsigned id = static_cast<unsigned>(m_nodes.size());
+
+    // Leaves describe `8x8` cells row by row with `.` for dead cells, `*`
+    // for live cells and `$` to terminate a row.
+    if (line[0] == '.' || line[0] == '*' || line[0] == '$') {
+      std::uint64_t leaf = 0ull;
+      unsigned x = 0u, y = 0u;
+
+      for (unsigned c = 0u ; c < line.size() ; ++c) {
+        switch (line[c]) {
+          case '$':
+            x = 0u;
+            ++y;
+            break;
+          case '*':
+            if (x >= 8u || y >= 8u) {
+              error(
+                std::string("Could not read pattern from \"") + file + "\"",
+                std::string("Leaf exceeds 8x8 cells at line ") + std::to_string(number)
+              );
+            }
+            leaf |= 1ull << (8u * y + x);
+            ++x;
+            break;
+          case '.':
+            ++x;
+            break;
+          default:
+            error(
+              std::string("Could not read pattern from \"") + file + "\"",
+              std::string("Invalid character '") + line[c] + "' at line " + std::to_string(number)
+            );
+        }
+      }
+
+      m_nodes.push_back(Node{getLeafLevel(), leaf, {0u, 0u, 0u, 0u}});
+      return;
+    }
+
+    Node n{0u, 0ull, {0u, 0u, 0u, 0u}};
+    std::istringstream in(line);
+
+    in >> n.level >> n.children[0] >> n.children[1] >> n.children[2] >> n.children[3];
+
+    if (in.fail()) {
+      error(
+        std::string("Could not read pattern from \"") + file + "\"",
+        std::string("Invalid node \"") + line + "\" at line " + std::to_string(number)
+      );
+    }
+
+    // Multi-states patterns use nodes of level `1` as leaves.
+    if (n.level <= getLeafLevel() || n.level > getMaxLevel()) {
+      error(
+        std::string("Could not read pattern from \"") + file + "\"",
+        std::string("Unsupported level ") + std::to_string(n.level) + " at line " + std::to_string(number)
+      );
+    }
+
+    for (unsigned c = 0u ; c < n.children.size() ; ++c) {
+      unsigned child = n.children[c];
+
+      if (child >= id || (child != 0u && m_nodes[child].level + 1u != n.level)) {
+        error(
+          std::string("Could not read pattern from \"") + file + "\"",
+          std::string("Invalid child ") + std::to_string(child) + " at line " + std::to_string(number)
+        );
+      }
+    }
+
+    m_nodes.push_back(n);
+  }
+
+}
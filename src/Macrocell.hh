@@ -0,0 +1,327 @@
+#ifndef    MACROCELL_HH
+# define   MACROCELL_HH
+
+# include <array>
+# include <memory>
+# include <string>
+# include <vector>
+# include <cstdint>
+# include <unordered_map>
+# include <core_utils/CoreObject.hh>
+# include <maths_utils/Vector2.hh>
+# include "CellEvolver.hh"
+# include "CellsBlocks.hh"
+
+namespace cellulator {
+
+  class Macrocell: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Create an empty pattern. A pattern is stored as a quadtree where
+       *          identical sub-squares are shared, which is the representation of
+       *          the macrocell format (`.mc` files): patterns with billions of
+       *          cells usually only need a few thousands of distinct nodes.
+       *          The leaves of the tree are squares of `8x8` cells. The root of
+       *          the tree is centered on the origin and the `y` axis of the tree
+       *          goes down, as in the files.
+       */
+      Macrocell();
+
+      ~Macrocell() = default;
+
+      /**
+       * @brief - Used to create a pattern from the macrocell file in argument.
+       * @param file - the name of the file describing the pattern.
+       * @return - a pointer to the created pattern.
+       */
+      static
+      std::shared_ptr<Macrocell>
+      fromFile(const std::string& file);
+
+      /**
+       * @brief - Replace the content of this pattern with the content of the file
+       *          in argument. Only two-states patterns are supported.
+       *          An error is raised if the file can't be read or is not valid, in
+       *          which case the pattern is left empty.
+       * @param file - the name of the file to read.
+       */
+      void
+      load(const std::string& file);
+
+      /**
+       * @brief - Write this pattern to the file in argument. Cells added since the
+       *          last compaction are included.
+       *          An error is raised if the file can't be written.
+       * @param file - the name of the file to write.
+       */
+      void
+      save(const std::string& file);
+
+      /**
+       * @brief - Remove all the cells of the pattern.
+       */
+      void
+      clear();
+
+      /**
+       * @brief - Register the live cells in argument to the pattern. The cells are
+       *          expressed in the coordinate frame of a colony (where the `y` axis
+       *          goes up) and are staged in leaves: the quadtree is only rebuilt on
+       *          the next call to `compact`.
+       * @param cells - the coordinates of the live cells to add.
+       */
+      void
+      add(const std::vector<utils::Vector2i>& cells);
+
+      /**
+       * @brief - Rebuild the quadtree with the cells added since the last call. The
+       *          nodes are hash-consed: each distinct sub-square is only created
+       *          once and shared by all the nodes containing it.
+       */
+      void
+      compact();
+
+      /**
+       * @brief - Provide the live cells of the pattern to the visitor, by batches of
+       *          at most the specified number of cells. The cells are expressed in
+       *          the coordinate frame of a colony and the pattern is translated so
+       *          that its origin lies at `coord`. Cells which can't be represented
+       *          in this frame are dropped with a warning.
+       *          Note that cells added since the last compaction are not visited.
+       * @param coord - the position of the origin of the pattern.
+       * @param batch - the maximum number of cells provided at once.
+       * @param visitor - the callback receiving the cells.
+       */
+      void
+      visit(const utils::Vector2i& coord,
+            unsigned batch,
+            const CellsVisitor& visitor) const;
+
+      /**
+       * @brief - Retrieve the rule of the pattern.
+       * @return - the rule of the pattern or an empty string if none is known.
+       */
+      const std::string&
+      getRule() const noexcept;
+
+      /**
+       * @brief - Retrieve the evolver corresponding to the rule of the pattern.
+       * @return - the evolver or `null` if the rule is unknown or not supported.
+       */
+      CellEvolverShPtr
+      getRuleset() const noexcept;
+
+      /**
+       * @brief - Define the rule of the pattern, written in the `#R` line of files.
+       * @param rule - the rule of the pattern.
+       */
+      void
+      setRule(const std::string& rule);
+
+      /**
+       * @brief - Retrieve the generation of the pattern as described in the `#G`
+       *          line of files.
+       * @return - the generation of the pattern.
+       */
+      std::uint64_t
+      getGeneration() const noexcept;
+
+      /**
+       * @brief - Define the generation of the pattern.
+       * @param generation - the generation of the pattern.
+       */
+      void
+      setGeneration(std::uint64_t generation) noexcept;
+
+      /**
+       * @brief - Retrieve the number of distinct nodes of the quadtree, which is
+       *          also the number of lines of the corresponding file.
+       * @return - the number of nodes.
+       */
+      unsigned
+      getNodesCount() const noexcept;
+
+      /**
+       * @brief - Retrieve the level of the root of the quadtree: the pattern covers
+       *          a square of `2^level` cells.
+       * @return - the level of the root or `0` if the pattern is empty.
+       */
+      unsigned
+      getLevel() const noexcept;
+
+      /**
+       * @brief - Compute the number of live cells of the pattern. Each node is only
+       *          counted once so this is cheap even for enormous patterns.
+       * @return - the number of live cells.
+       */
+      std::uint64_t
+      getLiveCellsCount() const noexcept;
+
+    private:
+
+      /**
+       * @brief - The level of the leaves of the quadtree.
+       * @return - the level of the leaves.
+       */
+      static
+      unsigned
+      getLeafLevel() noexcept;
+
+      /**
+       * @brief - The largest level supported for a node: cells are expressed with
+       *          signed 64 bits coordinates.
+       * @return - the largest level of a node.
+       */
+      static
+      unsigned
+      getMaxLevel() noexcept;
+
+      /**
+       * @brief - Used to pack the coordinates of a leaf into a single key.
+       * @param x - the abscissa of the leaf.
+       * @param y - the ordinate of the leaf.
+       * @return - the key for this leaf.
+       */
+      static
+      std::uint64_t
+      packCoords(std::int64_t x,
+                 std::int64_t y) noexcept;
+
+      /**
+       * @brief - Register a node with the specified properties, unless an identical
+       *          node already exists.
+       * @param level - the level of the node.
+       * @param leaf - the cells of the node if it is a leaf.
+       * @param children - the children of the node if it is not a leaf.
+       * @return - the index of the node.
+       */
+      unsigned
+      intern(unsigned level,
+             std::uint64_t leaf,
+             const std::array<unsigned, 4>& children);
+
+      /**
+       * @brief - Register the leaves of the node in argument to the staged leaves.
+       *          Used to merge the existing quadtree with new cells.
+       * @param node - the index of the node to stage.
+       * @param x - the abscissa of the top left corner of the node.
+       * @param y - the ordinate of the top left corner of the node.
+       */
+      void
+      stage(unsigned node,
+            std::int64_t x,
+            std::int64_t y);
+
+      /**
+       * @brief - Convenience structure describing the state of a traversal of the
+       *          quadtree by `visit`.
+       */
+      struct Traversal {
+        utils::Vector2i origin;
+        unsigned batch;
+        const CellsVisitor* visitor;
+        std::vector<utils::Vector2i> cells;
+        std::uint64_t dropped;
+      };
+
+      /**
+       * @brief - Provide the cells of the node in argument to the traversal.
+       * @param node - the index of the node to visit.
+       * @param x - the abscissa of the top left corner of the node.
+       * @param y - the ordinate of the top left corner of the node.
+       * @param traversal - the state of the traversal.
+       */
+      void
+      visitNode(unsigned node,
+                std::int64_t x,
+                std::int64_t y,
+                Traversal& traversal) const;
+
+      /**
+       * @brief - Interpret a line of a file describing a node.
+       * @param line - the line to interpret.
+       * @param number - the number of the line, used to report errors.
+       * @param file - the name of the file, used to report errors.
+       */
+      void
+      parseNode(const std::string& line,
+                unsigned number,
+                const std::string& file);
+
+    private:
+
+      /**
+       * @brief - Description of a node of the quadtree. The index `0` is reserved for
+       *          the empty node of any level. Children always have a smaller index
+       *          than their parent.
+       */
+      struct Node {
+        unsigned level;                 //< The level of the node: it covers `2^level`
+                                        //< cells in each direction.
+        std::uint64_t leaf;             //< For leaves, the cells of the node with the
+                                        //< bit `8 * y + x` for the cell at `x, y`.
+        std::array<unsigned, 4> children; //< For other nodes, the indices of the north
+                                        //< west, north east, south west and south east
+                                        //< children.
+      };
+
+      /**
+       * @brief - Hash of a node, used to find identical nodes.
+       */
+      struct NodeHasher {
+        std::size_t
+        operator()(const Node& node) const noexcept;
+      };
+
+      /**
+       * @brief - Equality of nodes, used to find identical nodes.
+       */
+      struct NodeEqual {
+        bool
+        operator()(const Node& lhs, const Node& rhs) const noexcept;
+      };
+
+      /**
+       * @brief - The nodes of the quadtree, where the first one is the empty node.
+       */
+      std::vector<Node> m_nodes;
+
+      /**
+       * @brief - The index of the root of the quadtree, `0` for an empty pattern.
+       */
+      unsigned m_root;
+
+      /**
+       * @brief - Table used to find identical nodes while building the quadtree.
+       */
+      std::unordered_map<Node, unsigned, NodeHasher, NodeEqual> m_unique;
+
+      /**
+       * @brief - The cells added since the last compaction, indexed by the packed
+       *          coordinates of their leaf.
+       */
+      std::unordered_map<std::uint64_t, std::uint64_t> m_staged;
+
+      /**
+       * @brief - The rule of the pattern.
+       */
+      std::string m_rule;
+
+      /**
+       * @brief - The evolver corresponding to the rule of the pattern.
+       */
+      CellEvolverShPtr m_ruleset;
+
+      /**
+       * @brief - The generation of the pattern.
+       */
+      std::uint64_t m_generation;
+  };
+
+  using MacrocellShPtr = std::shared_ptr<Macrocell>;
+}
+
+# include "Macrocell.hxx"
+
+#endif    /* MACROCELL_HH */
@@ -0,0 +1,94 @@
+#ifndef    MACROCELL_HXX
+# define   MACROCELL_HXX
+
+# include "Macrocell.hh"
+
+namespace cellulator {
+
+  inline
+  MacrocellShPtr
+  Macrocell::fromFile(const std::string& file) {
+    MacrocellShPtr pattern = std::make_shared<Macrocell>();
+    pattern->load(file);
+
+    return pattern;
+  }
+
+  inline
+  const std::string&
+  Macrocell::getRule() const noexcept {
+    return m_rule;
+  }
+
+  inline
+  CellEvolverShPtr
+  Macrocell::getRuleset() const noexcept {
+    return m_ruleset;
+  }
+
+  inline
+  std::uint64_t
+  Macrocell::getGeneration() const noexcept {
+    return m_generation;
+  }
+
+  inline
+  void
+  Macrocell::setGeneration(std::uint64_t generation) noexcept {
+    m_generation = generation;
+  }
+
+  inline
+  unsigned
+  Macrocell::getNodesCount() const noexcept {
+    return static_cast<unsigned>(m_nodes.size() - 1u);
+  }
+
+  inline
+  unsigned
+  Macrocell::getLevel() const noexcept {
+    return (m_root == 0u ? 0u : m_nodes[m_root].level);
+  }
+
+  inline
+  unsigned
+  Macrocell::getLeafLevel() noexcept {
+    return 3u;
+  }
+
+  inline
+  unsigned
+  Macrocell::getMaxLevel() noexcept {
+    return 62u;
+  }
+
+  inline
+  std::uint64_t
+  Macrocell::packCoords(std::int64_t x,
+                        std::int64_t y) noexcept
+  {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32u) |
+            static_cast<std::uint64_t>(static_cast<std::uint32_t>(y));
+  }
+
+  inline
+  std::size_t
+  Macrocell::NodeHasher::operator()(const Node& node) const noexcept {
+    std::uint64_t h = node.leaf * 0x9E3779B97F4A7C15ull + node.level;
+
+    for (unsigned id = 0u ; id < node.children.size() ; ++id) {
+      h = (h ^ node.children[id]) * 0x100000001B3ull;
+    }
+
+    return static_cast<std::size_t>(h ^ (h >> 29u));
+  }
+
+  inline
+  bool
+  Macrocell::NodeEqual::operator()(const Node& lhs, const Node& rhs) const noexcept {
+    return lhs.level == rhs.level && lhs.leaf == rhs.leaf && lhs.children == rhs.children;
+  }
+
+}
+
+#endif    /* MACROCELL_HXX */
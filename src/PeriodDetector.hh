@@ -0,0 +1,105 @@
+#ifndef    PERIOD_DETECTOR_HH
+# define   PERIOD_DETECTOR_HH
+
+# include <vector>
+
+namespace cellulator {
+
+  /**
+   * @brief - Used to detect when the population of a colony becomes periodic,
+   *          which is a cheap way to determine whether a random soup became
+   *          stable: the population of each generation is pushed and the
+   *          detector reports the smallest period for which the population
+   *          repeated itself over several cycles.
+   *          The populations are kept in a ring buffer allocated once so that
+   *          the detector can be reused without allocating any memory.
+   */
+  class PeriodDetector {
+    public:
+
+      /**
+       * @brief - Create a new detector able to detect periods up to the value
+       *          in argument.
+       * @param maxPeriod - the largest period detected.
+       */
+      PeriodDetector(unsigned maxPeriod = 30u);
+
+      ~PeriodDetector() = default;
+
+      /**
+       * @brief - Retrieve the largest period detected.
+       * @return - the largest period detected.
+       */
+      unsigned
+      getMaxPeriod() const noexcept;
+
+      /**
+       * @brief - Define the largest period that can be detected. This also resets
+       *          the detector.
+       * @param maxPeriod - the largest period detected.
+       */
+      void
+      setMaxPeriod(unsigned maxPeriod);
+
+      /**
+       * @brief - Forget all the populations registered so far, typically before
+       *          running a new soup.
+       */
+      void
+      reset() noexcept;
+
+      /**
+       * @brief - Register the population of a new generation and determine whether
+       *          the population is periodic.
+       * @param population - the population of the new generation.
+       * @return - the smallest period of the population or `0` if it is not yet
+       *           periodic.
+       */
+      unsigned
+      push(unsigned population) noexcept;
+
+    private:
+
+      /**
+       * @brief - The number of periods during which the population should repeat
+       *          for it to be considered periodic.
+       * @return - the number of periods to observe.
+       */
+      static
+      unsigned
+      getCycles() noexcept;
+
+      /**
+       * @brief - The minimum number of generations during which the population
+       *          should repeat for it to be considered periodic. This avoids to
+       *          consider a soup stable because its population happens to be
+       *          constant for a couple of generations.
+       * @return - the minimum number of generations to observe.
+       */
+      static
+      unsigned
+      getMinimumWindow() noexcept;
+
+    private:
+
+      /**
+       * @brief - The largest period detected.
+       */
+      unsigned m_maxPeriod;
+
+      /**
+       * @brief - The populations of the last generations, used as a ring buffer.
+       */
+      std::vector<unsigned> m_populations;
+
+      /**
+       * @brief - The number of populations registered since the last reset.
+       */
+      unsigned m_count;
+  };
+
+}
+
+# include "PeriodDetector.hxx"
+
+#endif    /* PERIOD_DETECTOR_HH */
@@ -0,0 +1,89 @@
+#ifndef    PERIOD_DETECTOR_HXX
+# define   PERIOD_DETECTOR_HXX
+
+# include <algorithm>
+# include "PeriodDetector.hh"
+
+namespace cellulator {
+
+  inline
+  PeriodDetector::PeriodDetector(unsigned maxPeriod):
+    m_maxPeriod(0u),
+    m_populations(),
+    m_count(0u)
+  {
+    setMaxPeriod(maxPeriod);
+  }
+
+  inline
+  unsigned
+  PeriodDetector::getMaxPeriod() const noexcept {
+    return m_maxPeriod;
+  }
+
+  inline
+  void
+  PeriodDetector::setMaxPeriod(unsigned maxPeriod) {
+    m_maxPeriod = std::max(maxPeriod, 1u);
+
+    // Keep enough generations to observe the largest period for the
+    // required number of cycles, and a minimum window for small ones.
+    m_populations.resize((getCycles() + 1u) * m_maxPeriod + getMinimumWindow());
+
+    reset();
+  }
+
+  inline
+  void
+  PeriodDetector::reset() noexcept {
+    m_count = 0u;
+  }
+
+  inline
+  unsigned
+  PeriodDetector::push(unsigned population) noexcept {
+    unsigned size = m_populations.size();
+    unsigned generation = m_count++;
+
+    m_populations[generation % size] = population;
+
+    // Search for a period for which the population repeated itself over
+    // the observation window. Note that we consider generations going
+    // back in time from the current one.
+    for (unsigned period = 1u ; period <= m_maxPeriod ; ++period) {
+      unsigned window = std::max(getCycles() * period, getMinimumWindow());
+
+      if (m_count < window + period) {
+        // Not enough generations to detect this period nor any larger one.
+        return 0u;
+      }
+
+      bool periodic = true;
+      for (unsigned k = 0u ; k < window && periodic ; ++k) {
+        unsigned cur = generation - k;
+        periodic = (m_populations[cur % size] == m_populations[(cur - period) % size]);
+      }
+
+      if (periodic) {
+        return period;
+      }
+    }
+
+    return 0u;
+  }
+
+  inline
+  unsigned
+  PeriodDetector::getCycles() noexcept {
+    return 3u;
+  }
+
+  inline
+  unsigned
+  PeriodDetector::getMinimumWindow() noexcept {
+    return 12u;
+  }
+
+}
+
+#endif    /* PERIOD_DETECTOR_HXX */
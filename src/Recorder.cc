@@ -0,0 +1,283 @@
+
+# include "Recorder.hh"
+# include <cstring>
+# include <algorithm>
+
+namespace cellulator {
+
+  Recorder::Recorder(const std::string& file,
+                     unsigned keyframes):
+    utils::CoreObject(file),
+
+    m_propsLocker(),
+    m_waiter(),
+
+    m_file(file),
+    m_keyframes(std::max(keyframes, 1u)),
+
+    m_pending(),
+    m_writing(false),
+    m_stop(false),
+    m_error(),
+    m_statistics{0u, 0u, 0ull, 0ull},
+
+    m_out(),
+    m_previous{0ull, 0u, std::vector<utils::Boxi>(), std::vector<std::uint8_t>()},
+    m_previousIndex(),
+    m_previousOffsets(),
+    m_buffer(),
+    m_blocks(0u),
+    m_births(),
+    m_deaths(),
+
+    m_writer()
+  {
+    setService("recorder");
+
+    m_out.open(m_file.c_str(), std::ios::binary | std::ios::trunc);
+    if (!m_out.good()) {
+      error(
+        std::string("Could not create recording \"") + m_file + "\"",
+        std::string("Cannot open file")
+      );
+    }
+
+    RecordingHeader header;
+    std::memset(&header, 0, sizeof(RecordingHeader));
+
+    std::memcpy(header.magic, getMagic(), sizeof(header.magic));
+    header.version = getVersion();
+    header.keyframes = m_keyframes;
+
+    m_out.write(reinterpret_cast<const char*>(&header), sizeof(RecordingHeader));
+    m_statistics.bytes = sizeof(RecordingHeader);
+
+    m_writer = std::thread(&Recorder::write, this);
+  }
+
+  Recorder::~Recorder() {
+    {
+      const std::lock_guard guard(m_propsLocker);
+      m_stop = true;
+    }
+
+    m_waiter.notify_all();
+    m_writer.join();
+  }
+
+  void
+  Recorder::push(RecordedFrame&& frame) {
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
+
+      if (!m_error.empty()) {
+        error(
+          std::string("Could not append frame to \"") + m_file + "\"",
+          m_error
+        );
+      }
+
+      m_pending.push_back(std::move(frame));
+    }
+
+    m_waiter.notify_all();
+  }
+
+  void
+  Recorder::flush() {
+    std::unique_lock lock(m_propsLocker);
+    m_waiter.wait(
+      lock,
+      [this]() {
+        return m_pending.empty() && !m_writing;
+      }
+    );
+  }
+
+  Recorder::Statistics
+  Recorder::getStatistics() noexcept {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    return m_statistics;
+  }
+
+  void
+  Recorder::write() {
+    unsigned frames = 0u;
+
+    while (true) {
+      RecordedFrame frame;
+
+      {
+        std::unique_lock lock(m_propsLocker);
+        m_waiter.wait(
+          lock,
+          [this]() {
+            return !m_pending.empty() || m_stop;
+          }
+        );
+
+        // Pending frames are written before stopping.
+        if (m_pending.empty()) {
+          return;
+        }
+
+        frame = std::move(m_pending.front());
+        m_pending.pop_front();
+        m_writing = true;
+      }
+
+      bool keyframe = (frames % m_keyframes == 0u);
+
+      FrameHeader header;
+      std::memset(&header, 0, sizeof(FrameHeader));
+
+      std::memcpy(header.marker, getFrameMarker(), sizeof(header.marker));
+      header.keyframe = (keyframe ? 1u : 0u);
+      header.generation = frame.generation;
+      header.alive = frame.alive;
+
+      std::uint64_t changes = encodeFrame(frame, keyframe);
+
+      header.size = m_buffer.size();
+      header.blocks = m_blocks;
+
+      // The frame is written at once so that an interrupted recording can
+      // be detected by an incomplete last frame.
+      m_out.write(reinterpret_cast<const char*>(&header), sizeof(FrameHeader));
+      m_out.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size());
+      m_out.flush();
+
+      ++frames;
+
+      {
+        const std::lock_guard guard(m_propsLocker);
+
+        m_writing = false;
+
+        if (m_out.good()) {
+          ++m_statistics.frames;
+          m_statistics.keyframes += (keyframe ? 1u : 0u);
+          m_statistics.changes += changes;
+          m_statistics.bytes += sizeof(FrameHeader) + m_buffer.size();
+        }
+        else if (m_error.empty()) {
+          m_error = std::string("Failed to write frame for generation ") + std::to_string(frame.generation);
+        }
+      }
+
+      m_waiter.notify_all();
+    }
+  }
+
+  std::uint64_t
+  Recorder::encodeFrame(RecordedFrame& frame,
+                        bool keyframe)
+  {
+    m_buffer.clear();
+    m_blocks = 0u;
+
+    std::uint64_t changes = 0u;
+
+    std::unordered_map<std::uint64_t, unsigned> index;
+    std::vector<std::size_t> offsets(frame.areas.size());
+    std::vector<bool> matched(m_previous.areas.size(), false);
+
+    std::size_t offset = 0u;
+
+    for (unsigned id = 0u ; id < frame.areas.size() ; ++id) {
+      const utils::Boxi& area = frame.areas[id];
+      const std::uint64_t key = keyOf(area);
+
+      offsets[id] = offset;
+      index[key] = id;
+
+      const std::uint8_t* cur = frame.cells.data() + offset;
+      const std::uint8_t* prev = nullptr;
+
+      offset += static_cast<std::size_t>(area.area());
+
+      // Blocks are matched on their area: if the dimensions of the blocks
+      // changed the old ones are considered empty.
+      std::unordered_map<std::uint64_t, unsigned>::const_iterator it = m_previousIndex.find(key);
+      if (it != m_previousIndex.cend()) {
+        const utils::Boxi& old = m_previous.areas[it->second];
+
+        if (old.w() == area.w() && old.h() == area.h()) {
+          prev = m_previous.cells.data() + m_previousOffsets[it->second];
+          matched[it->second] = true;
+        }
+      }
+
+      changes += encodeBlock(area, cur, keyframe ? nullptr : prev);
+    }
+
+    // Blocks which are not part of the frame anymore are empty: all
+    // their cells died.
+    if (!keyframe) {
+      for (unsigned id = 0u ; id < m_previous.areas.size() ; ++id) {
+        if (!matched[id]) {
+          changes += encodeBlock(m_previous.areas[id], nullptr, m_previous.cells.data() + m_previousOffsets[id]);
+        }
+      }
+    }
+
+    m_previous = std::move(frame);
+    m_previousIndex.swap(index);
+    m_previousOffsets.swap(offsets);
+
+    return changes;
+  }
+
+  std::uint64_t
+  Recorder::encodeBlock(const utils::Boxi& area,
+                        const std::uint8_t* cur,
+                        const std::uint8_t* prev)
+  {
+    const unsigned count = static_cast<unsigned>(area.area());
+
+    // Most blocks of a running simulation are identical from one frame
+    // to the next.
+    if (cur != nullptr && prev != nullptr && std::memcmp(cur, prev, count) == 0) {
+      return 0u;
+    }
+
+    m_births.clear();
+    m_deaths.clear();
+
+    for (unsigned id = 0u ; id < count ; ++id) {
+      std::uint8_t c = (cur != nullptr ? cur[id] : 0u);
+      std::uint8_t p = (prev != nullptr ? prev[id] : 0u);
+
+      if (c != p) {
+        (c != 0u ? m_births : m_deaths).push_back(id);
+      }
+    }
+
+    if (m_births.empty() && m_deaths.empty()) {
+      return 0u;
+    }
+
+    encodeSigned(m_buffer, area.x());
+    encodeSigned(m_buffer, area.y());
+    encode(m_buffer, static_cast<std::uint64_t>(area.w()));
+    encode(m_buffer, static_cast<std::uint64_t>(area.h()));
+
+    for (const std::vector<unsigned>* cells : {&m_births, &m_deaths}) {
+      encode(m_buffer, cells->size());
+
+      unsigned last = 0u;
+      for (unsigned id = 0u ; id < cells->size() ; ++id) {
+        encode(m_buffer, (*cells)[id] - last);
+        last = (*cells)[id];
+      }
+    }
+
+    ++m_blocks;
+
+    return m_births.size() + m_deaths.size();
+  }
+
+}
@@ -0,0 +1,306 @@
+#ifndef    RECORDER_HH
+# define   RECORDER_HH
+
+# include <mutex>
+# include <deque>
+# include <thread>
+# include <memory>
+# include <string>
+# include <vector>
+# include <cstdint>
+# include <fstream>
+# include <unordered_map>
+# include <condition_variable>
+# include <core_utils/CoreObject.hh>
+# include <maths_utils/Box.hh>
+
+namespace cellulator {
+
+  /**
+   * @brief - The header of a recording. It is followed by the frames of the
+   *          recording, each one starting with a `FrameHeader`.
+   */
+  struct RecordingHeader {
+    char magic[8];                //< Identifies recordings.
+    std::uint32_t version;        //< The version of the layout.
+    std::uint32_t keyframes;      //< The number of frames between two keyframes.
+  };
+
+  /**
+   * @brief - The header of a frame of a recording. It is followed by `size`
+   *          bytes describing the blocks of cells which changed since the
+   *          previous frame: for each block the position and dimensions of
+   *          its area followed by the indices of the cells which were born
+   *          and the ones which died, all of them encoded as variable length
+   *          integers. Indices are stored as the difference with the index
+   *          of the previous cell of the list.
+   *          A keyframe lists all the live cells as births so that it can be
+   *          displayed without reading the previous frames.
+   */
+  struct FrameHeader {
+    char marker[4];               //< Identifies the start of a frame.
+    std::uint32_t keyframe;       //< `1` if the frame is a keyframe.
+    std::uint64_t generation;     //< The generation of the colony.
+    std::uint64_t size;           //< The size of the blocks section in bytes.
+    std::uint32_t alive;          //< The number of live cells in the colony.
+    std::uint32_t blocks;         //< The number of blocks described by the frame.
+  };
+
+  /**
+   * @brief - The content of a colony to append to a recording: the states of
+   *          the cells of the blocks containing at least a live cell.
+   */
+  struct RecordedFrame {
+    std::uint64_t generation;         //< The generation of the colony.
+    unsigned alive;                   //< The number of live cells in the colony.
+    std::vector<utils::Boxi> areas;   //< The area of each block.
+    std::vector<std::uint8_t> cells;  //< The states of the cells of the blocks one
+                                      //< after the other, `1` for a live cell.
+  };
+
+  class Recorder: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Create a new recorder writing to the file in argument. Frames are
+       *          compared to the previous one and only the cells which changed are
+       *          written: this happens in a background thread so that recording a
+       *          simulation only costs the copy of the blocks containing cells.
+       *          An error is raised if the file can't be created.
+       * @param file - the name of the file receiving the recording.
+       * @param keyframes - the number of frames between two keyframes. Lower values
+       *                    allow faster seeking at the expense of larger files.
+       */
+      Recorder(const std::string& file,
+               unsigned keyframes = 64u);
+
+      /**
+       * @brief - Wait for all the pending frames to be written and stop the thread
+       *          writing the frames.
+       */
+      ~Recorder();
+
+      /**
+       * @brief - Register a new frame to append to the recording. The method returns
+       *          as soon as the frame is queued.
+       *          An error is raised in case a previous frame could not be written.
+       * @param frame - the frame to append, moved into the recorder.
+       */
+      void
+      push(RecordedFrame&& frame);
+
+      /**
+       * @brief - Wait until all the frames pushed so far are written to the disk.
+       */
+      void
+      flush();
+
+      /**
+       * @brief - Convenience structure describing the activity of the recorder.
+       */
+      struct Statistics {
+        unsigned frames;          //< The number of frames written.
+        unsigned keyframes;       //< The number of keyframes written.
+        std::uint64_t changes;    //< The number of births and deaths recorded.
+        std::uint64_t bytes;      //< The number of bytes written.
+      };
+
+      /**
+       * @brief - Retrieve the activity of the recorder so far.
+       * @return - the statistics of the recorder.
+       */
+      Statistics
+      getStatistics() noexcept;
+
+      /**
+       * @brief - The magic string identifying recordings.
+       * @return - the magic string, made of 8 characters.
+       */
+      static
+      const char*
+      getMagic() noexcept;
+
+      /**
+       * @brief - The version of the layout of recordings.
+       * @return - the current version of the layout.
+       */
+      static
+      std::uint32_t
+      getVersion() noexcept;
+
+      /**
+       * @brief - The marker written at the start of each frame.
+       * @return - the marker, made of 4 characters.
+       */
+      static
+      const char*
+      getFrameMarker() noexcept;
+
+      /**
+       * @brief - Append the value in argument to the buffer as a variable length
+       *          integer: 7 bits per byte, the high bit indicating that more bytes
+       *          follow.
+       * @param out - the buffer receiving the value.
+       * @param value - the value to encode.
+       */
+      static
+      void
+      encode(std::vector<std::uint8_t>& out,
+             std::uint64_t value);
+
+      /**
+       * @brief - Append the signed value in argument to the buffer as a variable
+       *          length integer. Small negative values are kept short by mapping
+       *          them to odd values.
+       * @param out - the buffer receiving the value.
+       * @param value - the value to encode.
+       */
+      static
+      void
+      encodeSigned(std::vector<std::uint8_t>& out,
+                   std::int64_t value);
+
+      /**
+       * @brief - Compute a key identifying the block with the area in argument.
+       * @param area - the area of the block.
+       * @return - the key of the block.
+       */
+      static
+      std::uint64_t
+      keyOf(const utils::Boxi& area) noexcept;
+
+    private:
+
+      /**
+       * @brief - Main loop of the thread writing the frames.
+       */
+      void
+      write();
+
+      /**
+       * @brief - Compare the frame in argument with the previous one and encode the
+       *          cells which changed in the internal buffer. The frame then becomes
+       *          the previous frame.
+       * @param frame - the frame to encode.
+       * @param keyframe - `true` if all the live cells should be encoded.
+       * @return - the number of births and deaths encoded.
+       */
+      std::uint64_t
+      encodeFrame(RecordedFrame& frame,
+                  bool keyframe);
+
+      /**
+       * @brief - Encode the changes of a single block in the internal buffer. The
+       *          current or the previous states might be missing, in which case the
+       *          cells are considered dead.
+       * @param area - the area of the block.
+       * @param cur - the current states of the cells of the block or `nullptr`.
+       * @param prev - the previous states of the cells of the block or `nullptr`.
+       * @return - the number of births and deaths encoded.
+       */
+      std::uint64_t
+      encodeBlock(const utils::Boxi& area,
+                  const std::uint8_t* cur,
+                  const std::uint8_t* prev);
+
+    private:
+
+      /**
+       * @brief - Protect this object from concurrent accesses.
+       */
+      std::mutex m_propsLocker;
+
+      /**
+       * @brief - Used to notify the writer when a frame is pushed and the callers of
+       *          `flush` when the frames are written.
+       */
+      std::condition_variable m_waiter;
+
+      /**
+       * @brief - The name of the file receiving the recording.
+       */
+      std::string m_file;
+
+      /**
+       * @brief - The number of frames between two keyframes.
+       */
+      unsigned m_keyframes;
+
+      /**
+       * @brief - The frames waiting to be written.
+       */
+      std::deque<RecordedFrame> m_pending;
+
+      /**
+       * @brief - Whether the writer is currently writing a frame.
+       */
+      bool m_writing;
+
+      /**
+       * @brief - Whether the writer should stop.
+       */
+      bool m_stop;
+
+      /**
+       * @brief - The error which occurred while writing a frame if any.
+       */
+      std::string m_error;
+
+      /**
+       * @brief - The activity of the recorder.
+       */
+      Statistics m_statistics;
+
+      /**
+       * @brief - The stream to the file of the recording, only accessed by the writer.
+       */
+      std::ofstream m_out;
+
+      /**
+       * @brief - The previous frame, used to compute the changes of the next one. Only
+       *          accessed by the writer.
+       */
+      RecordedFrame m_previous;
+
+      /**
+       * @brief - The index of the blocks of the previous frame, from the key of their
+       *          area to their index in the frame. Only accessed by the writer.
+       */
+      std::unordered_map<std::uint64_t, unsigned> m_previousIndex;
+
+      /**
+       * @brief - The offset of the cells of each block of the previous frame. Only
+       *          accessed by the writer.
+       */
+      std::vector<std::size_t> m_previousOffsets;
+
+      /**
+       * @brief - The blocks section of the frame being encoded. Only accessed by the
+       *          writer.
+       */
+      std::vector<std::uint8_t> m_buffer;
+
+      /**
+       * @brief - The number of blocks in `m_buffer`. Only accessed by the writer.
+       */
+      unsigned m_blocks;
+
+      /**
+       * @brief - Temporary lists of the indices of the cells born and died in the block
+       *          being encoded. Only accessed by the writer.
+       */
+      std::vector<unsigned> m_births;
+      std::vector<unsigned> m_deaths;
+
+      /**
+       * @brief - The thread writing the frames.
+       */
+      std::thread m_writer;
+  };
+
+  using RecorderShPtr = std::shared_ptr<Recorder>;
+}
+
+# include "Recorder.hxx"
+
+#endif    /* RECORDER_HH */
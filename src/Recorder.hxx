@@ -0,0 +1,56 @@
+#ifndef    RECORDER_HXX
+# define   RECORDER_HXX
+
+# include "Recorder.hh"
+
+namespace cellulator {
+
+  inline
+  const char*
+  Recorder::getMagic() noexcept {
+    return "CELLRECD";
+  }
+
+  inline
+  std::uint32_t
+  Recorder::getVersion() noexcept {
+    return 1u;
+  }
+
+  inline
+  const char*
+  Recorder::getFrameMarker() noexcept {
+    return "FRAM";
+  }
+
+  inline
+  void
+  Recorder::encode(std::vector<std::uint8_t>& out,
+                   std::uint64_t value)
+  {
+    while (value >= 0x80u) {
+      out.push_back(static_cast<std::uint8_t>(value | 0x80u));
+      value >>= 7u;
+    }
+
+    out.push_back(static_cast<std::uint8_t>(value));
+  }
+
+  inline
+  void
+  Recorder::encodeSigned(std::vector<std::uint8_t>& out,
+                         std::int64_t value)
+  {
+    encode(out, (static_cast<std::uint64_t>(value) << 1u) ^ static_cast<std::uint64_t>(value >> 63));
+  }
+
+  inline
+  std::uint64_t
+  Recorder::keyOf(const utils::Boxi& area) noexcept {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(area.x())) << 32u) |
+           static_cast<std::uint32_t>(area.y());
+  }
+
+}
+
+#endif    /* RECORDER_HXX */
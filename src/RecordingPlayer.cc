@@ -0,0 +1,315 @@
+
+# include "RecordingPlayer.hh"
+# include <cerrno>
+# include <cstring>
+# include <algorithm>
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+
+namespace {
+
+  /**
+   * @brief - Decode a variable length integer as written by `Recorder::encode`.
+   * @param data - the position of the value, moved after the value.
+   * @param end - the end of the data available.
+   * @param value - output argument receiving the value.
+   * @return - `false` if the value is not complete.
+   */
+  bool
+  decodeValue(const std::uint8_t*& data,
+              const std::uint8_t* end,
+              std::uint64_t& value)
+  {
+    value = 0u;
+
+    for (unsigned shift = 0u ; data < end && shift < 64u ; shift += 7u) {
+      std::uint8_t byte = *data++;
+      value |= static_cast<std::uint64_t>(byte & 0x7Fu) << shift;
+
+      if ((byte & 0x80u) == 0u) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+}
+
+namespace cellulator {
+
+  RecordingPlayer::RecordingPlayer(const std::string& file):
+    utils::CoreObject(file),
+
+    m_file(file),
+    m_data(nullptr),
+    m_size(0u),
+    m_frames(),
+    m_position(0u),
+    m_blocks(),
+    m_births(),
+    m_deaths()
+  {
+    setService("recording_player");
+
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+      error(
+        std::string("Could not read recording from \"") + m_file + "\"",
+        std::string("Cannot open file")
+      );
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(RecordingHeader))) {
+      ::close(fd);
+      error(
+        std::string("Could not read recording from \"") + m_file + "\"",
+        std::string("File is too small to contain a recording")
+      );
+    }
+
+    m_size = static_cast<std::uint64_t>(info.st_size);
+
+    // The mapping stays valid once the file is closed.
+    void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (data == MAP_FAILED) {
+      error(
+        std::string("Could not read recording from \"") + m_file + "\"",
+        std::string("Cannot map file: ") + std::strerror(errno)
+      );
+    }
+
+    m_data = static_cast<const std::uint8_t*>(data);
+
+    try {
+      scan();
+    }
+    catch (...) {
+      ::munmap(const_cast<std::uint8_t*>(m_data), m_size);
+      m_data = nullptr;
+      throw;
+    }
+  }
+
+  RecordingPlayer::~RecordingPlayer() {
+    if (m_data != nullptr) {
+      ::munmap(const_cast<std::uint8_t*>(m_data), m_size);
+    }
+  }
+
+  unsigned
+  RecordingPlayer::find(std::uint64_t generation) const noexcept {
+    for (unsigned id = 0u ; id < m_frames.size() ; ++id) {
+      if (m_frames[id].generation >= generation) {
+        return id;
+      }
+    }
+
+    return m_frames.empty() ? 0u : m_frames.size() - 1u;
+  }
+
+  bool
+  RecordingPlayer::next(RecordingFrame& frame) {
+    if (m_position >= m_frames.size()) {
+      return false;
+    }
+
+    const FrameIndex& index = m_frames[m_position];
+
+    frame.generation = index.generation;
+    frame.alive = index.alive;
+    frame.keyframe = index.keyframe;
+    frame.births.clear();
+    frame.deaths.clear();
+
+    decode(
+      m_position,
+      [&frame](const utils::Boxi& area, const std::vector<unsigned>& births, const std::vector<unsigned>& deaths) {
+        for (unsigned id = 0u ; id < births.size() ; ++id) {
+          frame.births.push_back(coordOf(area, births[id]));
+        }
+        for (unsigned id = 0u ; id < deaths.size() ; ++id) {
+          frame.deaths.push_back(coordOf(area, deaths[id]));
+        }
+      }
+    );
+
+    ++m_position;
+
+    return true;
+  }
+
+  void
+  RecordingPlayer::seek(unsigned index,
+                        RecordingFrame& frame)
+  {
+    index = std::min(index, static_cast<unsigned>(m_frames.size() - 1u));
+
+    // The first frame is always a keyframe so this terminates.
+    unsigned start = index;
+    while (!m_frames[start].keyframe) {
+      --start;
+    }
+
+    m_blocks.clear();
+
+    for (unsigned id = start ; id <= index ; ++id) {
+      decode(
+        id,
+        [this](const utils::Boxi& area, const std::vector<unsigned>& births, const std::vector<unsigned>& deaths) {
+          BlockCells& b = m_blocks[Recorder::keyOf(area)];
+          if (b.area.w() != area.w() || b.area.h() != area.h() || b.cells.empty()) {
+            b.area = area;
+            b.cells.assign(static_cast<std::size_t>(area.area()), 0u);
+          }
+
+          for (unsigned cell = 0u ; cell < deaths.size() ; ++cell) {
+            b.cells[deaths[cell]] = 0u;
+          }
+          for (unsigned cell = 0u ; cell < births.size() ; ++cell) {
+            b.cells[births[cell]] = 1u;
+          }
+        }
+      );
+    }
+
+    frame.generation = m_frames[index].generation;
+    frame.alive = m_frames[index].alive;
+    frame.keyframe = true;
+    frame.births.clear();
+    frame.deaths.clear();
+
+    for (const std::pair<const std::uint64_t, BlockCells>& b : m_blocks) {
+      for (unsigned cell = 0u ; cell < b.second.cells.size() ; ++cell) {
+        if (b.second.cells[cell] != 0u) {
+          frame.births.push_back(coordOf(b.second.area, cell));
+        }
+      }
+    }
+
+    m_position = index + 1u;
+  }
+
+  void
+  RecordingPlayer::scan() {
+    const RecordingHeader& header = *reinterpret_cast<const RecordingHeader*>(m_data);
+
+    if (std::memcmp(header.magic, Recorder::getMagic(), sizeof(header.magic)) != 0) {
+      error(
+        std::string("Could not read recording from \"") + m_file + "\"",
+        std::string("File is not a recording")
+      );
+    }
+
+    if (header.version != Recorder::getVersion()) {
+      error(
+        std::string("Could not read recording from \"") + m_file + "\"",
+        std::string("Unsupported version ") + std::to_string(header.version) +
+        " (expected " + std::to_string(Recorder::getVersion()) + ")"
+      );
+    }
+
+    // Any frame which does not look valid is considered as the end of
+    // the recording: this is what happens when the program is stopped
+    // while a frame is written.
+    std::uint64_t offset = sizeof(RecordingHeader);
+
+    while (offset + sizeof(FrameHeader) <= m_size) {
+      FrameHeader frame;
+      std::memcpy(&frame, m_data + offset, sizeof(FrameHeader));
+
+      if (std::memcmp(frame.marker, Recorder::getFrameMarker(), sizeof(frame.marker)) != 0 ||
+          frame.size > m_size - offset - sizeof(FrameHeader) ||
+          (m_frames.empty() && frame.keyframe == 0u))
+      {
+        break;
+      }
+
+      m_frames.push_back(FrameIndex{offset, frame.generation, frame.alive, frame.keyframe != 0u});
+      offset += sizeof(FrameHeader) + frame.size;
+    }
+
+    if (offset < m_size) {
+      warn(
+        "Ignored " + std::to_string(m_size - offset) + " byte(s) at the end of recording \"" +
+        m_file + "\""
+      );
+    }
+
+    if (m_frames.empty()) {
+      error(
+        std::string("Could not read recording from \"") + m_file + "\"",
+        std::string("Recording does not contain any frame")
+      );
+    }
+  }
+
+  void
+  RecordingPlayer::decode(unsigned index,
+                          const BlockHandler& handler)
+  {
+    FrameHeader header;
+    std::memcpy(&header, m_data + m_frames[index].offset, sizeof(FrameHeader));
+
+    const std::uint8_t* data = m_data + m_frames[index].offset + sizeof(FrameHeader);
+    const std::uint8_t* end = data + header.size;
+
+    auto corrupted = [this, &header]() {
+      error(
+        std::string("Could not read recording from \"") + m_file + "\"",
+        std::string("Corrupted frame for generation ") + std::to_string(header.generation)
+      );
+    };
+
+    for (unsigned block = 0u ; block < header.blocks ; ++block) {
+      std::uint64_t x, y, w, h;
+
+      if (!decodeValue(data, end, x) || !decodeValue(data, end, y) ||
+          !decodeValue(data, end, w) || !decodeValue(data, end, h) ||
+          w == 0u || h == 0u || w * h > (1u << 24u))
+      {
+        corrupted();
+      }
+
+      // Undo the mapping of signed values to unsigned ones.
+      utils::Boxi area(
+        static_cast<int>(static_cast<std::int64_t>(x >> 1u) ^ -static_cast<std::int64_t>(x & 1u)),
+        static_cast<int>(static_cast<std::int64_t>(y >> 1u) ^ -static_cast<std::int64_t>(y & 1u)),
+        static_cast<int>(w),
+        static_cast<int>(h)
+      );
+
+      for (std::vector<unsigned>* cells : {&m_births, &m_deaths}) {
+        cells->clear();
+
+        std::uint64_t count;
+        if (!decodeValue(data, end, count) || count > w * h) {
+          corrupted();
+        }
+
+        std::uint64_t cell = 0u;
+        for (unsigned id = 0u ; id < count ; ++id) {
+          std::uint64_t delta;
+          if (!decodeValue(data, end, delta)) {
+            corrupted();
+          }
+
+          cell += delta;
+          if (cell >= w * h) {
+            corrupted();
+          }
+
+          cells->push_back(static_cast<unsigned>(cell));
+        }
+      }
+
+      handler(area, m_births, m_deaths);
+    }
+  }
+
+}
@@ -0,0 +1,210 @@
+#ifndef    RECORDING_PLAYER_HH
+# define   RECORDING_PLAYER_HH
+
+# include <memory>
+# include <string>
+# include <vector>
+# include <cstdint>
+# include <functional>
+# include <unordered_map>
+# include <core_utils/CoreObject.hh>
+# include <maths_utils/Box.hh>
+# include <maths_utils/Vector2.hh>
+# include "Recorder.hh"
+
+namespace cellulator {
+
+  /**
+   * @brief - A frame read from a recording: the cells which were born and the
+   *          ones which died since the previous frame. For a keyframe all the
+   *          live cells are listed as births and any existing cell should be
+   *          discarded before applying the frame.
+   */
+  struct RecordingFrame {
+    std::uint64_t generation;               //< The generation of the colony.
+    unsigned alive;                         //< The number of live cells.
+    bool keyframe;                          //< `true` if the frame lists all the
+                                            //< live cells.
+    std::vector<utils::Vector2i> births;    //< The cells which were born.
+    std::vector<utils::Vector2i> deaths;    //< The cells which died.
+  };
+
+  class RecordingPlayer: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Open the recording in argument. The file is mapped in memory and
+       *          scanned to index its frames: they are only decoded when they are
+       *          played. A frame which was not completely written (typically when
+       *          the recording was interrupted) ends the recording.
+       *          An error is raised if the file can't be mapped or if it is not a
+       *          valid recording.
+       * @param file - the name of the recording.
+       */
+      RecordingPlayer(const std::string& file);
+
+      /**
+       * @brief - Release the mapping of the file.
+       */
+      ~RecordingPlayer();
+
+      RecordingPlayer(const RecordingPlayer&) = delete;
+
+      RecordingPlayer&
+      operator=(const RecordingPlayer&) = delete;
+
+      /**
+       * @brief - Retrieve the number of frames of the recording.
+       * @return - the number of frames.
+       */
+      unsigned
+      getFramesCount() const noexcept;
+
+      /**
+       * @brief - Retrieve the generation of the frame in argument.
+       * @param frame - the index of the frame, assumed to be valid.
+       * @return - the generation of the frame.
+       */
+      std::uint64_t
+      getGeneration(unsigned frame) const noexcept;
+
+      /**
+       * @brief - Retrieve the index of the frame returned by the next call to `next`.
+       * @return - the position of the player in the recording.
+       */
+      unsigned
+      getPosition() const noexcept;
+
+      /**
+       * @brief - Find the first frame reaching the generation in argument. Note that
+       *          the generations of a recording are not necessarily increasing: the
+       *          colony might have been regenerated during the recording.
+       * @param generation - the generation to reach.
+       * @return - the index of the frame or the index of the last frame if none of
+       *           them reaches the generation.
+       */
+      unsigned
+      find(std::uint64_t generation) const noexcept;
+
+      /**
+       * @brief - Decode the next frame of the recording, i.e. the changes to apply to
+       *          the previous frame.
+       *          An error is raised if the frame is corrupted.
+       * @param frame - output argument receiving the frame.
+       * @return - `false` if the end of the recording was reached, in which case the
+       *           frame is not modified.
+       */
+      bool
+      next(RecordingFrame& frame);
+
+      /**
+       * @brief - Move to the frame in argument and retrieve its complete content: the
+       *          closest keyframe before it is decoded and the following frames are
+       *          applied to it. The output frame is thus always a keyframe. The next
+       *          call to `next` returns the frame following the requested one.
+       *          An error is raised if a frame is corrupted.
+       * @param index - the index of the frame to reach, clamped to the last frame.
+       * @param frame - output argument receiving the content of the frame.
+       */
+      void
+      seek(unsigned index,
+           RecordingFrame& frame);
+
+    private:
+
+      /**
+       * @brief - Callback receiving the changes of a block of a frame: the area of
+       *          the block and the indices of the cells born and died in the block.
+       */
+      using BlockHandler = std::function<void(const utils::Boxi&, const std::vector<unsigned>&, const std::vector<unsigned>&)>;
+
+      /**
+       * @brief - Scan the frames of the recording to build the index of the frames.
+       */
+      void
+      scan();
+
+      /**
+       * @brief - Decode the blocks of the frame in argument.
+       * @param index - the index of the frame.
+       * @param handler - the callback receiving the changes of each block.
+       */
+      void
+      decode(unsigned index,
+             const BlockHandler& handler);
+
+      /**
+       * @brief - Convert the index of a cell of a block to a coordinate.
+       * @param area - the area of the block.
+       * @param cell - the index of the cell in the block.
+       * @return - the coordinate of the cell in the colony.
+       */
+      static
+      utils::Vector2i
+      coordOf(const utils::Boxi& area,
+              unsigned cell) noexcept;
+
+      /**
+       * @brief - Convenience structure describing a frame of the recording.
+       */
+      struct FrameIndex {
+        std::uint64_t offset;       //< The offset of the header of the frame.
+        std::uint64_t generation;   //< The generation of the frame.
+        std::uint32_t alive;        //< The number of live cells.
+        bool keyframe;              //< Whether the frame is a keyframe.
+      };
+
+      /**
+       * @brief - The cells of a block, used to rebuild the content of a frame.
+       */
+      struct BlockCells {
+        utils::Boxi area;
+        std::vector<std::uint8_t> cells;
+      };
+
+    private:
+
+      /**
+       * @brief - The name of the file, used to report errors.
+       */
+      std::string m_file;
+
+      /**
+       * @brief - The mapping of the file.
+       */
+      const std::uint8_t* m_data;
+
+      /**
+       * @brief - The size of the mapping in bytes.
+       */
+      std::uint64_t m_size;
+
+      /**
+       * @brief - The frames of the recording.
+       */
+      std::vector<FrameIndex> m_frames;
+
+      /**
+       * @brief - The index of the next frame to decode.
+       */
+      unsigned m_position;
+
+      /**
+       * @brief - The blocks rebuilt when seeking a frame, indexed by their area.
+       */
+      std::unordered_map<std::uint64_t, BlockCells> m_blocks;
+
+      /**
+       * @brief - Temporary lists of the indices of the cells born and died in the block
+       *          being decoded.
+       */
+      std::vector<unsigned> m_births;
+      std::vector<unsigned> m_deaths;
+  };
+
+  using RecordingPlayerShPtr = std::shared_ptr<RecordingPlayer>;
+}
+
+# include "RecordingPlayer.hxx"
+
+#endif    /* RECORDING_PLAYER_HH */
@@ -0,0 +1,39 @@
+#ifndef    RECORDING_PLAYER_HXX
+# define   RECORDING_PLAYER_HXX
+
+# include "RecordingPlayer.hh"
+
+namespace cellulator {
+
+  inline
+  unsigned
+  RecordingPlayer::getFramesCount() const noexcept {
+    return m_frames.size();
+  }
+
+  inline
+  std::uint64_t
+  RecordingPlayer::getGeneration(unsigned frame) const noexcept {
+    return m_frames[frame].generation;
+  }
+
+  inline
+  unsigned
+  RecordingPlayer::getPosition() const noexcept {
+    return m_position;
+  }
+
+  inline
+  utils::Vector2i
+  RecordingPlayer::coordOf(const utils::Boxi& area,
+                           unsigned cell) noexcept
+  {
+    return utils::Vector2i(
+      area.getLeftBound() + static_cast<int>(cell % area.w()),
+      area.getBottomBound() + static_cast<int>(cell / area.w())
+    );
+  }
+
+}
+
+#endif    /* RECORDING_PLAYER_HXX */
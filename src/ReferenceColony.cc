@@ -0,0 +1,116 @@
+
+# include "ReferenceColony.hh"
+
+namespace cellulator {
+
+  ReferenceColony::ReferenceColony(CellEvolverShPtr ruleset):
+    utils::CoreObject(std::string("reference_colony")),
+
+    m_ruleset(ruleset),
+    m_generation(0u),
+    m_cells(),
+    m_neighbors()
+  {
+    setService("reference");
+
+    // Check consistency.
+    if (m_ruleset == nullptr) {
+      error(
+        std::string("Could not create reference colony"),
+        std::string("Invalid null ruleset")
+      );
+    }
+  }
+
+  void
+  ReferenceColony::assign(const std::vector<utils::Vector2i>& cells) {
+    m_cells.clear();
+
+    for (unsigned id = 0u ; id < cells.size() ; ++id) {
+      m_cells.insert(toKey(cells[id].x(), cells[id].y()));
+    }
+
+    m_generation = 0u;
+  }
+
+  unsigned
+  ReferenceColony::step(unsigned generations) {
+    // A sparse colony can't represent an infinite number of live cells.
+    if (m_ruleset->isBorn(0u)) {
+      warn("Rules allowing cells to be born without neighbors are not supported, ignoring them");
+    }
+
+    for (unsigned id = 0u ; id < generations ; ++id) {
+      evolve();
+    }
+
+    return m_cells.size();
+  }
+
+  void
+  ReferenceColony::getLiveCells(std::vector<utils::Vector2i>& cells) const {
+    cells.clear();
+    cells.reserve(m_cells.size());
+
+    for (std::uint64_t key : m_cells) {
+      cells.push_back(fromKey(key));
+    }
+  }
+
+  std::uint64_t
+  ReferenceColony::hash(const std::vector<utils::Vector2i>& cells) noexcept {
+    // Mix each key independently and combine them with a commutative operation
+    // so that the order of the cells does not matter.
+    std::uint64_t out = 0u;
+
+    for (unsigned id = 0u ; id < cells.size() ; ++id) {
+      std::uint64_t z = toKey(cells[id].x(), cells[id].y()) + 0x9E3779B97F4A7C15ull;
+
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+      z = z ^ (z >> 31);
+
+      out += z;
+    }
+
+    return out;
+  }
+
+  void
+  ReferenceColony::evolve() {
+    // Count the live neighbors of each cell adjacent to a live cell: other
+    // cells have no live neighbors and stay dead.
+    m_neighbors.clear();
+
+    for (std::uint64_t key : m_cells) {
+      utils::Vector2i c = fromKey(key);
+
+      // Make sure that live cells without any neighbor are considered.
+      m_neighbors.try_emplace(key, 0u);
+
+      for (int dy = -1 ; dy <= 1 ; ++dy) {
+        for (int dx = -1 ; dx <= 1 ; ++dx) {
+          if (dx != 0 || dy != 0) {
+            ++m_neighbors[toKey(c.x() + dx, c.y() + dy)];
+          }
+        }
+      }
+    }
+
+    // Apply the rules to each candidate cell.
+    std::unordered_set<std::uint64_t> next;
+    next.reserve(m_cells.size());
+
+    for (const std::pair<const std::uint64_t, unsigned>& n : m_neighbors) {
+      bool alive = (m_cells.count(n.first) > 0);
+
+      if ((alive && m_ruleset->survives(n.second)) || (!alive && m_ruleset->isBorn(n.second))) {
+        next.insert(n.first);
+      }
+    }
+
+    m_cells.swap(next);
+    ++m_generation;
+  }
+
+}
@@ -0,0 +1,139 @@
+#ifndef    REFERENCE_COLONY_HH
+# define   REFERENCE_COLONY_HH
+
+# include <cstdint>
+# include <memory>
+# include <vector>
+# include <unordered_map>
+# include <unordered_set>
+# include <core_utils/CoreObject.hh>
+# include <maths_utils/Vector2.hh>
+# include "CellEvolver.hh"
+
+namespace cellulator {
+
+  class ReferenceColony: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Create a reference colony evolving with the specified ruleset.
+       *          This colony is a deliberately simple implementation of the rules
+       *          of the simulation: the live cells are kept in a sparse set and
+       *          each generation is computed by counting the neighbors of each
+       *          live cell. It is not meant to be fast but rather to be obviously
+       *          correct so that the optimized engines can be checked against it.
+       *          The colony is not protected against concurrent accesses.
+       * @param ruleset - the rules to use to evolve the cells.
+       */
+      ReferenceColony(CellEvolverShPtr ruleset);
+
+      ~ReferenceColony() = default;
+
+      /**
+       * @brief - Replace the content of the colony with the live cells provided in
+       *          input. The generation is reset to `0`.
+       * @param cells - the coordinates of the live cells.
+       */
+      void
+      assign(const std::vector<utils::Vector2i>& cells);
+
+      /**
+       * @brief - Evolve the colony for the specified number of generations.
+       * @param generations - the number of generations to compute.
+       * @return - the number of live cells after the evolution.
+       */
+      unsigned
+      step(unsigned generations = 1u);
+
+      /**
+       * @brief - Retrieve the current generation of the colony.
+       * @return - the number of generations computed since the last `assign`.
+       */
+      unsigned
+      getGeneration() const noexcept;
+
+      /**
+       * @brief - Retrieve the number of live cells of the colony.
+       * @return - the number of live cells.
+       */
+      unsigned
+      getLiveCellsCount() const noexcept;
+
+      /**
+       * @brief - Retrieve the coordinates of all the live cells of the colony. The
+       *          order of the cells is not specified.
+       * @param cells - output vector receiving the coordinates of the live cells.
+       */
+      void
+      getLiveCells(std::vector<utils::Vector2i>& cells) const;
+
+      /**
+       * @brief - Compute a hash of the live cells in input. The hash does not depend
+       *          on the order of the cells so that engines storing the cells in any
+       *          order can be compared.
+       * @param cells - the coordinates of the live cells.
+       * @return - a hash of the cells.
+       */
+      static
+      std::uint64_t
+      hash(const std::vector<utils::Vector2i>& cells) noexcept;
+
+    private:
+
+      /**
+       * @brief - Convert a coordinate into a key used to index the cells.
+       * @param x - the abscissa of the cell.
+       * @param y - the ordinate of the cell.
+       * @return - a key uniquely identifying the cell.
+       */
+      static
+      std::uint64_t
+      toKey(int x,
+            int y) noexcept;
+
+      /**
+       * @brief - Convert a key back into the coordinate of a cell.
+       * @param key - the key of the cell.
+       * @return - the coordinate of the cell.
+       */
+      static
+      utils::Vector2i
+      fromKey(std::uint64_t key) noexcept;
+
+      /**
+       * @brief - Compute the next generation of the colony.
+       */
+      void
+      evolve();
+
+    private:
+
+      /**
+       * @brief - The rules used to evolve the cells.
+       */
+      CellEvolverShPtr m_ruleset;
+
+      /**
+       * @brief - The current generation of the colony.
+       */
+      unsigned m_generation;
+
+      /**
+       * @brief - The keys of the live cells of the colony.
+       */
+      std::unordered_set<std::uint64_t> m_cells;
+
+      /**
+       * @brief - Temporary table used to count the neighbors of the cells when
+       *          computing the next generation. Kept as a member to reuse the
+       *          memory from one generation to the next.
+       */
+      std::unordered_map<std::uint64_t, unsigned> m_neighbors;
+  };
+
+  using ReferenceColonyShPtr = std::shared_ptr<ReferenceColony>;
+}
+
+# include "ReferenceColony.hxx"
+
+#endif    /* REFERENCE_COLONY_HH */
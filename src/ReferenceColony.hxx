@@ -0,0 +1,39 @@
+#ifndef    REFERENCE_COLONY_HXX
+# define   REFERENCE_COLONY_HXX
+
+# include "ReferenceColony.hh"
+
+namespace cellulator {
+
+  inline
+  unsigned
+  ReferenceColony::getGeneration() const noexcept {
+    return m_generation;
+  }
+
+  inline
+  unsigned
+  ReferenceColony::getLiveCellsCount() const noexcept {
+    return m_cells.size();
+  }
+
+  inline
+  std::uint64_t
+  ReferenceColony::toKey(int x,
+                         int y) noexcept
+  {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+  }
+
+  inline
+  utils::Vector2i
+  ReferenceColony::fromKey(std::uint64_t key) noexcept {
+    return utils::Vector2i(
+      static_cast<int>(static_cast<std::uint32_t>(key >> 32)),
+      static_cast<int>(static_cast<std::uint32_t>(key & 0xFFFFFFFFu))
+    );
+  }
+
+}
+
+#endif    /* REFERENCE_COLONY_HXX */
@@ -0,0 +1,284 @@
+
+# include "RleReader.hh"
+# include <cctype>
+# include <cstdint>
+# include <algorithm>
+# include <core_utils/CoreException.hh>
+
+namespace {
+
+  inline
+  std::string
+  trimmed(const std::string& s) {
+    std::string::size_type first = s.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+      return std::string();
+    }
+
+    std::string::size_type last = s.find_last_not_of(" \t\r\n");
+    return s.substr(first, last - first + 1u);
+  }
+
+}
+
+namespace cellulator {
+
+  RleReader::RleReader(const std::string& file):
+    utils::CoreObject(file),
+
+    m_file(file),
+    m_in(file.c_str(), std::ios::binary),
+    m_buffer(getChunkSize()),
+    m_position(0u),
+    m_available(0u),
+    m_line(1u),
+
+    m_size(),
+    m_rule(),
+    m_ruleset(),
+
+    m_x(0),
+    m_y(0),
+    m_done(false),
+    m_overflow(false),
+    m_multistate(false)
+  {
+    setService("rle");
+
+    if (!m_in.good()) {
+      error(
+        std::string("Could not read pattern from \"") + m_file + "\"",
+        std::string("Cannot open file")
+      );
+    }
+
+    readHeader();
+  }
+
+  bool
+  RleReader::next(CellsRun& run) {
+    if (m_done) {
+      return false;
+    }
+
+    // No run can be longer than the dimensions of the pattern: this also
+    // prevents the count from overflowing.
+    const std::uint64_t limit = static_cast<std::uint64_t>(std::max(m_size.w(), m_size.h()));
+
+    std::uint64_t count = 0u;
+    char c;
+
+    while (fetch(c)) {
+      // Accumulate the count preceding a tag.
+      if (c >= '0' && c <= '9') {
+        count = 10u * count + static_cast<unsigned>(c - '0');
+
+        if (count > limit) {
+          invalidCount();
+        }
+
+        continue;
+      }
+
+      if (std::isspace(static_cast<unsigned char>(c))) {
+        continue;
+      }
+
+      int n = (count == 0u ? 1 : static_cast<int>(count));
+      count = 0u;
+
+      switch (c) {
+        case 'b':
+        case '.':
+          if (n > m_size.w()) {
+            invalidCount();
+          }
+
+          m_x += n;
+          break;
+        case '$':
+          if (n > m_size.h()) {
+            invalidCount();
+          }
+
+          m_x = 0;
+          m_y += n;
+          break;
+        case '!':
+          m_done = true;
+          return false;
+        default:
+          // Multi-states patterns use upper case letters for the live
+          // states, optionally prefixed by a lower case letter in the
+          // range 'p' to 'y' for states beyond 24: we consider all of
+          // them alive.
+          if (c >= 'p' && c <= 'y') {
+            const char prefix = c;
+            if (!fetch(c) || c < 'A' || c > 'X') {
+              error(
+                std::string("Could not read pattern from \"") + m_file + "\"",
+                std::string("Invalid state '") + prefix + "' at line " + std::to_string(m_line)
+              );
+            }
+          }
+          else if (c != 'o' && (c < 'A' || c > 'X')) {
+            error(
+              std::string("Could not read pattern from \"") + m_file + "\"",
+              std::string("Invalid character '") + c + "' at line " + std::to_string(m_line)
+            );
+          }
+
+          if (c != 'o' && !m_multistate) {
+            warn(
+              "Pattern in \"" + m_file + "\" uses multiple states, all non-zero " +
+              "states are considered alive"
+            );
+
+            m_multistate = true;
+          }
+
+          if (n > m_size.w()) {
+            invalidCount();
+          }
+
+          run.x = m_x;
+          run.y = m_y;
+          run.length = static_cast<unsigned>(n);
+
+          m_x += n;
+
+          if (!m_overflow && (m_x > m_size.w() || m_y >= m_size.h())) {
+            warn(
+              "Pattern in \"" + m_file + "\" has cells outside of its dimensions " +
+              m_size.toString() + " at line " + std::to_string(m_line)
+            );
+
+            m_overflow = true;
+          }
+
+          return true;
+      }
+    }
+
+    // Some files don't terminate the pattern: consider the end of the
+    // file as the end of the pattern.
+    m_done = true;
+
+    return false;
+  }
+
+  void
+  RleReader::invalidCount() {
+    error(
+      std::string("Could not read pattern from \"") + m_file + "\"",
+      std::string("Run length exceeding dimensions ") + m_size.toString() + " at line " + std::to_string(m_line)
+    );
+  }
+
+  void
+  RleReader::readHeader() {
+    std::string line;
+    char c;
+    bool eof = false;
+
+    // Skip comments and empty lines until the header line: it is the
+    // first line not starting with a `#`.
+    while (!eof) {
+      line.clear();
+
+      while ((eof = !fetch(c)) == false && c != '\n') {
+        line += c;
+      }
+
+      line = trimmed(line);
+
+      if (!line.empty() && line[0] != '#') {
+        break;
+      }
+    }
+
+    if (line.empty() || line[0] != 'x') {
+      error(
+        std::string("Could not read pattern from \"") + m_file + "\"",
+        std::string("Could not find header line")
+      );
+    }
+
+    // The header is a list of `key = value` entries separated by commas.
+    // The topology of the rule may also contain commas (as in `B3/S23:T10,10`)
+    // so a segment without `=` is considered part of the previous entry.
+    std::string::size_type start = 0u;
+    std::string entry;
+
+    while (start < line.size()) {
+      std::string::size_type end = line.find(',', start);
+      if (end == std::string::npos) {
+        end = line.size();
+      }
+
+      std::string segment = line.substr(start, end - start);
+      start = end + 1u;
+
+      if (!entry.empty() && segment.find('=') == std::string::npos) {
+        entry += "," + segment;
+        continue;
+      }
+
+      if (!entry.empty()) {
+        parseHeaderEntry(entry);
+      }
+
+      entry = segment;
+    }
+
+    if (!entry.empty()) {
+      parseHeaderEntry(entry);
+    }
+
+    if (!m_size.valid()) {
+      error(
+        std::string("Could not read pattern from \"") + m_file + "\"",
+        std::string("Invalid dimensions ") + m_size.toString() + " in header \"" + line + "\""
+      );
+    }
+  }
+
+  void
+  RleReader::parseHeaderEntry(const std::string& entry) {
+    std::string::size_type sep = entry.find('=');
+    if (sep == std::string::npos) {
+      warn("Ignoring invalid header entry \"" + entry + "\" in \"" + m_file + "\"");
+      return;
+    }
+
+    std::string key = trimmed(entry.substr(0u, sep));
+    std::string value = trimmed(entry.substr(sep + 1u));
+
+    std::transform(key.begin(), key.end(), key.begin(), [](unsigned char ch) { return std::tolower(ch); });
+
+    try {
+      if (key == "x") {
+        m_size.w() = std::stoi(value);
+      }
+      else if (key == "y") {
+        m_size.h() = std::stoi(value);
+      }
+      else if (key == "rule") {
+        // Strip the description of the topology if any.
+        m_rule = value.substr(0u, value.find(':'));
+        m_ruleset = CellEvolver::fromRule(m_rule);
+      }
+    }
+    catch (const utils::CoreException& e) {
+      warn("Ignoring unsupported rule \"" + m_rule + "\" in \"" + m_file + "\": " + e.what());
+      m_ruleset.reset();
+    }
+    catch (const std::exception&) {
+      error(
+        std::string("Could not read pattern from \"") + m_file + "\"",
+        std::string("Invalid header entry \"") + entry + "\""
+      );
+    }
+  }
+
+}
@@ -0,0 +1,198 @@
+#ifndef    RLE_READER_HH
+# define   RLE_READER_HH
+
+# include <memory>
+# include <string>
+# include <vector>
+# include <fstream>
+# include <core_utils/CoreObject.hh>
+# include <maths_utils/Size.hh>
+# include "CellEvolver.hh"
+
+namespace cellulator {
+
+  /**
+   * @brief - A horizontal run of live cells decoded from a pattern. The
+   *          coordinates are expressed in the frame of the file: `[0; 0]`
+   *          is the top left corner of the pattern and the `y` axis goes
+   *          down.
+   */
+  struct CellsRun {
+    int x;            //< The abscissa of the first cell of the run.
+    int y;            //< The ordinate of the run.
+    unsigned length;  //< The number of live cells of the run.
+  };
+
+  class RleReader: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Open the file in argument describing a pattern in the RLE format
+       *          and read its header. The body of the pattern is then decoded on
+       *          demand through `next`: the file is read in chunks of fixed size
+       *          so that even very large patterns can be loaded without keeping
+       *          their text in memory.
+       *          An error is raised if the file can't be opened or if its header
+       *          is not valid.
+       * @param file - the name of the file to read.
+       */
+      RleReader(const std::string& file);
+
+      ~RleReader() = default;
+
+      /**
+       * @brief - Retrieve the dimensions of the pattern as described in the header
+       *          of the file.
+       * @return - the dimensions of the pattern.
+       */
+      const utils::Sizei&
+      getSize() const noexcept;
+
+      /**
+       * @brief - Retrieve the rule described by the `rule = ...` entry of the header
+       *          if any.
+       * @return - the rule of the pattern or an empty string if the file does not
+       *           specify any.
+       */
+      const std::string&
+      getRule() const noexcept;
+
+      /**
+       * @brief - Retrieve the evolver corresponding to the rule of the header. Note
+       *          that rules which can't be represented by an evolver are reported
+       *          with a warning and ignored.
+       * @return - the evolver for the rule of the pattern or `null` if the header
+       *           does not specify any supported rule.
+       */
+      CellEvolverShPtr
+      getRuleset() const noexcept;
+
+      /**
+       * @brief - Decode the next run of live cells of the pattern. Runs are produced
+       *          in the order of the file, that is row by row from the top.
+       *          An error is raised in case the body of the pattern is not valid,
+       *          including when a run is longer than the width of the pattern (or
+       *          skips more rows than its height) as described by the header.
+       * @param run - output argument receiving the run.
+       * @return - `true` if a run was decoded and `false` if the end of the pattern
+       *           was reached.
+       */
+      bool
+      next(CellsRun& run);
+
+    private:
+
+      /**
+       * @brief - The size of the chunks read from the file.
+       * @return - the size of a chunk in bytes.
+       */
+      static
+      unsigned
+      getChunkSize() noexcept;
+
+      /**
+       * @brief - Fetch the next character of the file, refilling the internal buffer
+       *          when needed. The line counter is updated on new lines.
+       * @param c - output argument receiving the character.
+       * @return - `false` if the end of the file was reached.
+       */
+      bool
+      fetch(char& c);
+
+      /**
+       * @brief - Raise an error for a run longer than the dimensions of the pattern
+       *          allow at the current line.
+       */
+      void
+      invalidCount();
+
+      /**
+       * @brief - Skip the comments and interpret the header line of the file.
+       */
+      void
+      readHeader();
+
+      /**
+       * @brief - Interpret a single `key = value` entry of the header.
+       * @param entry - the entry to interpret.
+       */
+      void
+      parseHeaderEntry(const std::string& entry);
+
+    private:
+
+      /**
+       * @brief - The name of the file being read, used to report errors.
+       */
+      std::string m_file;
+
+      /**
+       * @brief - The stream to the file being read.
+       */
+      std::ifstream m_in;
+
+      /**
+       * @brief - The chunk of the file being decoded.
+       */
+      std::vector<char> m_buffer;
+
+      /**
+       * @brief - The position of the next character to decode in the buffer.
+       */
+      std::size_t m_position;
+
+      /**
+       * @brief - The number of valid characters in the buffer.
+       */
+      std::size_t m_available;
+
+      /**
+       * @brief - The current line in the file, used to report errors.
+       */
+      unsigned m_line;
+
+      /**
+       * @brief - The dimensions of the pattern as described by the header.
+       */
+      utils::Sizei m_size;
+
+      /**
+       * @brief - The rule of the pattern as described by the header.
+       */
+      std::string m_rule;
+
+      /**
+       * @brief - The evolver corresponding to the rule of the pattern.
+       */
+      CellEvolverShPtr m_ruleset;
+
+      /**
+       * @brief - The position of the next cell to decode.
+       */
+      int m_x;
+      int m_y;
+
+      /**
+       * @brief - Whether the end of the pattern was reached.
+       */
+      bool m_done;
+
+      /**
+       * @brief - Whether a warning was already emitted for cells outside of the
+       *          dimensions of the pattern.
+       */
+      bool m_overflow;
+
+      /**
+       * @brief - Whether a warning was already emitted for a pattern using
+       *          more than two states.
+       */
+      bool m_multistate;
+  };
+
+  using RleReaderShPtr = std::shared_ptr<RleReader>;
+}
+
+# include "RleReader.hxx"
+
+#endif    /* RLE_READER_HH */
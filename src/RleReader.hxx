@@ -0,0 +1,57 @@
+#ifndef    RLE_READER_HXX
+# define   RLE_READER_HXX
+
+# include "RleReader.hh"
+
+namespace cellulator {
+
+  inline
+  const utils::Sizei&
+  RleReader::getSize() const noexcept {
+    return m_size;
+  }
+
+  inline
+  const std::string&
+  RleReader::getRule() const noexcept {
+    return m_rule;
+  }
+
+  inline
+  CellEvolverShPtr
+  RleReader::getRuleset() const noexcept {
+    return m_ruleset;
+  }
+
+  inline
+  unsigned
+  RleReader::getChunkSize() noexcept {
+    return 64u * 1024u;
+  }
+
+  inline
+  bool
+  RleReader::fetch(char& c) {
+    if (m_position >= m_available) {
+      m_in.read(m_buffer.data(), m_buffer.size());
+
+      m_available = static_cast<std::size_t>(m_in.gcount());
+      m_position = 0u;
+
+      if (m_available == 0u) {
+        return false;
+      }
+    }
+
+    c = m_buffer[m_position++];
+
+    if (c == '\n') {
+      ++m_line;
+    }
+
+    return true;
+  }
+
+}
+
+#endif    /* RLE_READER_HXX */
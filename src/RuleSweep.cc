@@ -0,0 +1,156 @@
+
+# include "RuleSweep.hh"
+# include <chrono>
+
+namespace cellulator {
+
+  RuleSweep::RuleSweep(unsigned threads):
+    utils::CoreObject(std::string("rule_sweep")),
+
+    m_propsLocker(),
+    m_waiter(),
+
+    m_settings{utils::Sizei(16, 16), 0.5f, 0u, 16u, 2000u, 30u, 4.0f},
+    m_jobs(),
+    m_running(false),
+    m_pending(0u),
+    m_statistics{0u, 0u, 0ul, 0ul, 0.0},
+
+    m_pool(std::make_shared<utils::ThreadPool>(threads > 0u ? threads : getDefaultThreadCount()))
+  {
+    setService("sweep");
+
+    unsigned count = (threads > 0u ? threads : getDefaultThreadCount());
+    for (unsigned id = 0u ; id < count ; ++id) {
+      m_jobs.push_back(std::make_shared<SweepJob>(std::string("sweep_job_") + std::to_string(id)));
+    }
+
+    m_pool->onJobsCompleted.connect_member<RuleSweep>(
+      this,
+      &RuleSweep::handleJobsCompleted
+    );
+
+    // Disable logging for the pool.
+    m_pool->setAllowLog(false);
+  }
+
+  std::vector<RuleStatistics>
+  RuleSweep::run(const std::vector<CellEvolverShPtr>& rules) {
+    SweepQueueShPtr queue = std::make_shared<SweepQueue>();
+
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
+
+      if (m_running) {
+        error(
+          std::string("Could not run sweep of ") + std::to_string(rules.size()) + " rule(s)",
+          std::string("Sweep is already running")
+        );
+      }
+
+      for (unsigned id = 0u ; id < rules.size() ; ++id) {
+        if (rules[id] == nullptr) {
+          error(
+            std::string("Could not run sweep of ") + std::to_string(rules.size()) + " rule(s)",
+            std::string("Invalid null rule at index ") + std::to_string(id)
+          );
+        }
+
+        // Births without neighbors would fill the whole plane.
+        if (rules[id]->isBorn(0u)) {
+          error(
+            std::string("Could not run sweep of ") + std::to_string(rules.size()) + " rule(s)",
+            std::string("Rule ") + rules[id]->toRule() + " is not supported"
+          );
+        }
+      }
+
+      queue->rules = rules;
+      queue->results.resize(rules.size());
+      queue->next = 0u;
+
+      for (unsigned id = 0u ; id < m_jobs.size() ; ++id) {
+        m_jobs[id]->prepare(m_settings, queue);
+      }
+
+      m_running = !rules.empty();
+      m_pending = (rules.empty() ? 0u : m_jobs.size());
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    if (!rules.empty()) {
+      // All the jobs share the queue of rules: each one evaluates rules
+      // until none is left.
+      std::vector<utils::AsynchronousJobShPtr> submitted(m_jobs.cbegin(), m_jobs.cend());
+
+      m_pool->enqueueJobs(submitted, false);
+      m_pool->notifyJobs();
+
+      // Wait for all the rules to be evaluated.
+      std::unique_lock lock(m_propsLocker);
+      m_waiter.wait(
+        lock,
+        [this]() {
+          return m_pending == 0u;
+        }
+      );
+
+      m_running = false;
+    }
+
+    // Gather the statistics.
+    Statistics stats{static_cast<unsigned>(rules.size()), 0u, 0ul, 0ul, 0.0};
+
+    for (unsigned id = 0u ; id < queue->results.size() ; ++id) {
+      const RuleStatistics& res = queue->results[id];
+
+      if (!res.error.empty()) {
+        warn("Failed to evaluate rule " + res.rule + ": " + res.error);
+        ++stats.failures;
+      }
+
+      stats.soups += res.soups;
+    }
+
+    for (unsigned id = 0u ; id < m_jobs.size() ; ++id) {
+      stats.generations += m_jobs[id]->getGenerations();
+    }
+
+    stats.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    {
+      const std::lock_guard guard(m_propsLocker);
+      m_statistics = stats;
+    }
+
+    return queue->results;
+  }
+
+  std::vector<CellEvolverShPtr>
+  RuleSweep::getAllRules() {
+    std::vector<CellEvolverShPtr> rules;
+
+    // The first bit of the table describes births without neighbors:
+    // only consider tables where it is not set.
+    for (std::uint32_t table = 0u ; table < CellEvolver::getRulesCount() ; table += 2u) {
+      rules.push_back(CellEvolver::fromTable(table));
+    }
+
+    return rules;
+  }
+
+  void
+  RuleSweep::handleJobsCompleted(const std::vector<utils::AsynchronousJobShPtr>& jobs) {
+    {
+      // Protect from concurrent accesses.
+      const std::lock_guard guard(m_propsLocker);
+
+      m_pending -= std::min(m_pending, static_cast<unsigned>(jobs.size()));
+    }
+
+    m_waiter.notify_all();
+  }
+
+}
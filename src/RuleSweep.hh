@@ -0,0 +1,171 @@
+#ifndef    RULE_SWEEP_HH
+# define   RULE_SWEEP_HH
+
+# include <mutex>
+# include <memory>
+# include <vector>
+# include <condition_variable>
+# include <core_utils/CoreObject.hh>
+# include <core_utils/ThreadPool.hh>
+# include "CellEvolver.hh"
+# include "SweepJob.hh"
+
+namespace cellulator {
+
+  class RuleSweep: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Convenience structure describing the work performed during the
+       *          last sweep.
+       */
+      struct Statistics {
+        unsigned rules;             //< The number of rules evaluated.
+        unsigned failures;          //< The number of rules which could not be evaluated.
+        unsigned long soups;        //< The total number of soups run.
+        unsigned long generations;  //< The total number of generations computed.
+        double elapsed;             //< The wall-clock duration of the sweep in seconds.
+      };
+
+      /**
+       * @brief - Create a sweep allowing to evaluate many rules on the same set of
+       *          random soups. Each soup is stopped as soon as all its cells die,
+       *          its population explodes or becomes periodic, so that most rules
+       *          are evaluated quickly.
+       *          The rules are evaluated concurrently by a pool of threads. Each
+       *          thread reuses a single colony for all the soups it runs, so that
+       *          the blocks are allocated once for the whole sweep.
+       * @param threads - the number of threads of the pool. A value of `0` means
+       *                  that one thread per core is used.
+       */
+      RuleSweep(unsigned threads = 0u);
+
+      ~RuleSweep() = default;
+
+      /**
+       * @brief - Define the soups to run for each rule.
+       * @param soup - the dimensions of the soups, which should be even.
+       * @param density - the proportion of live cells in the soups.
+       * @param seed - the seed of the first soup, incremented for each soup.
+       * @param count - the number of soups to run for each rule.
+       */
+      void
+      setSoups(const utils::Sizei& soup,
+               float density,
+               unsigned seed,
+               unsigned count);
+
+      /**
+       * @brief - Define the limits used to stop the soups early.
+       * @param maxGenerations - the number of generations after which a soup is
+       *                         abandoned.
+       * @param maxPeriod - the largest period of the population of the soups that is
+       *                    detected. This is the period of the sequence of populations
+       *                    and not of the objects of the soups: a field of blinkers has
+       *                    a population of period `1`.
+       * @param explosion - the factor of the area of a soup beyond which its
+       *                    population is considered to explode.
+       */
+      void
+      setLimits(unsigned maxGenerations,
+                unsigned maxPeriod,
+                float explosion);
+
+      /**
+       * @brief - Evaluate all the rules in argument and wait for the sweep to
+       *          complete. Rules where a cell is born without neighbors can't
+       *          be simulated by the colony and raise an error, as well as
+       *          trying to run a sweep while another one is running.
+       * @param rules - the rules to evaluate.
+       * @return - the statistics for each rule in the order they were given.
+       */
+      std::vector<RuleStatistics>
+      run(const std::vector<CellEvolverShPtr>& rules);
+
+      /**
+       * @brief - Retrieve the statistics about the last sweep.
+       * @return - the statistics of the last sweep.
+       */
+      Statistics
+      getStatistics();
+
+      /**
+       * @brief - Generate all the rules that can be evaluated by a sweep, that is
+       *          all the rules where a cell is not born without neighbors.
+       * @return - the list of all the rules.
+       */
+      static
+      std::vector<CellEvolverShPtr>
+      getAllRules();
+
+    private:
+
+      /**
+       * @brief - Used to determine the number of threads to use when none is
+       *          specified.
+       * @return - the default number of threads of the pool.
+       */
+      static
+      unsigned
+      getDefaultThreadCount() noexcept;
+
+      /**
+       * @brief - Connected to the pool to be notified when some jobs have been
+       *          completed.
+       * @param jobs - the jobs which have been computed.
+       */
+      void
+      handleJobsCompleted(const std::vector<utils::AsynchronousJobShPtr>& jobs);
+
+    private:
+
+      /**
+       * @brief - Protects the state of the sweep from concurrent accesses.
+       */
+      std::mutex m_propsLocker;
+
+      /**
+       * @brief - Used to wait for the completion of the jobs of a sweep.
+       */
+      std::condition_variable m_waiter;
+
+      /**
+       * @brief - The description of the soups and limits of the sweep.
+       */
+      SweepSettings m_settings;
+
+      /**
+       * @brief - The jobs evaluating the rules, one per thread of the pool. They
+       *          are kept from one sweep to the next so that their colonies are
+       *          reused.
+       */
+      std::vector<SweepJobShPtr> m_jobs;
+
+      /**
+       * @brief - Whether a sweep is currently running.
+       */
+      bool m_running;
+
+      /**
+       * @brief - The number of jobs of the current sweep not yet completed.
+       */
+      unsigned m_pending;
+
+      /**
+       * @brief - The statistics of the last sweep.
+       */
+      Statistics m_statistics;
+
+      /**
+       * @brief - The pool of threads running the jobs. Declared last so that the
+       *          threads are joined before the rest of the sweep is destroyed.
+       */
+      utils::ThreadPoolShPtr m_pool;
+  };
+
+  using RuleSweepShPtr = std::shared_ptr<RuleSweep>;
+}
+
+# include "RuleSweep.hxx"
+
+#endif    /* RULE_SWEEP_HH */
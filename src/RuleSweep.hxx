@@ -0,0 +1,63 @@
+#ifndef    RULE_SWEEP_HXX
+# define   RULE_SWEEP_HXX
+
+# include <thread>
+# include "RuleSweep.hh"
+
+namespace cellulator {
+
+  inline
+  void
+  RuleSweep::setSoups(const utils::Sizei& soup,
+                      float density,
+                      unsigned seed,
+                      unsigned count)
+  {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    if (!soup.valid() || soup.w() % 2 != 0 || soup.h() % 2 != 0) {
+      error(
+        std::string("Could not define soups of sweep"),
+        std::string("Invalid soup dimensions ") + soup.toString()
+      );
+    }
+
+    m_settings.soup = soup;
+    m_settings.density = density;
+    m_settings.seed = seed;
+    m_settings.soups = count;
+  }
+
+  inline
+  void
+  RuleSweep::setLimits(unsigned maxGenerations,
+                       unsigned maxPeriod,
+                       float explosion)
+  {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    m_settings.maxGenerations = maxGenerations;
+    m_settings.maxPeriod = maxPeriod;
+    m_settings.explosion = explosion;
+  }
+
+  inline
+  RuleSweep::Statistics
+  RuleSweep::getStatistics() {
+    // Protect from concurrent accesses.
+    const std::lock_guard guard(m_propsLocker);
+
+    return m_statistics;
+  }
+
+  inline
+  unsigned
+  RuleSweep::getDefaultThreadCount() noexcept {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+}
+
+#endif    /* RULE_SWEEP_HXX */
@@ -0,0 +1,477 @@
+
+# include "SoupCensus.hh"
+# include <algorithm>
+# include <cmath>
+# include <numeric>
+# include "ReferenceColony.hh"
+
+namespace {
+
+  inline
+  bool
+  lessThan(const utils::Vector2i& lhs,
+           const utils::Vector2i& rhs) noexcept
+  {
+    return lhs.x() < rhs.x() || (lhs.x() == rhs.x() && lhs.y() < rhs.y());
+  }
+
+  inline
+  unsigned
+  findRoot(std::vector<unsigned>& parents,
+           unsigned id) noexcept
+  {
+    while (parents[id] != id) {
+      // Path halving: attach each visited cell to its grand parent.
+      parents[id] = parents[parents[id]];
+      id = parents[id];
+    }
+
+    return id;
+  }
+
+  /**
+   * @brief - The well-known objects which can be named by the census,
+   *          described with one string per row where a `o` denotes a
+   *          live cell.
+   */
+  struct KnownObject {
+    const char* name;
+    std::vector<std::string> rows;
+  };
+
+  const std::vector<KnownObject>&
+  getKnownObjects() {
+    static const std::vector<KnownObject> objects = {
+      {"block", {"oo", "oo"}},
+      {"beehive", {".oo.", "o..o", ".oo."}},
+      {"loaf", {".oo.", "o..o", ".o.o", "..o."}},
+      {"boat", {"oo.", "o.o", ".o."}},
+      {"tub", {".o.", "o.o", ".o."}},
+      {"pond", {".oo.", "o..o", "o..o", ".oo."}},
+      {"ship", {"oo.", "o.o", ".oo"}},
+      {"long boat", {"oo..", "o.o.", ".o.o", "..o."}},
+      {"blinker", {"ooo"}},
+      {"toad", {".ooo", "ooo."}},
+      {"beacon", {"oo..", "oo..", "..oo", "..oo"}},
+      {"glider", {".o.", "..o", "ooo"}},
+      {"lightweight spaceship", {".o..o", "o....", "o...o", "oooo."}}
+    };
+
+    return objects;
+  }
+
+}
+
+namespace cellulator {
+
+  SoupCensus::SoupCensus(CellEvolverShPtr ruleset,
+                         const utils::Sizei& soup,
+                         float density,
+                         unsigned firstSeed,
+                         unsigned count):
+    utils::AsynchronousJob(std::string("census_from_") + std::to_string(firstSeed)),
+
+    m_ruleset(ruleset),
+    m_soup(soup),
+    m_density(density),
+    m_firstSeed(firstSeed),
+    m_count(count),
+
+    m_maxGenerations(0u),
+    m_maxPeriod(0u),
+
+    m_colony(),
+    m_detector(),
+    m_cells(),
+    m_parents(),
+    m_components(),
+    m_object(),
+    m_key(),
+    m_classified(),
+    m_names(),
+
+    m_tally(),
+    m_statistics{0u, 0u, 0u, 0u}
+  {
+    setService("census");
+
+    // Check consistency.
+    if (m_ruleset == nullptr) {
+      error(
+        std::string("Could not create soup census"),
+        std::string("Invalid null ruleset")
+      );
+    }
+    if (!m_soup.valid() || m_soup.w() % 2 != 0 || m_soup.h() % 2 != 0) {
+      error(
+        std::string("Could not create soup census"),
+        std::string("Invalid soup dimensions ") + m_soup.toString()
+      );
+    }
+
+    setLimits(10000u, 30u);
+
+    // The colony is created once and reset before each soup so that
+    // the memory of its blocks is reused.
+    m_colony = std::make_shared<Colony>(m_soup, Colony::getSoupBlockDims(m_soup), getName());
+    m_colony->setRuleset(m_ruleset);
+
+    registerNames();
+  }
+
+  void
+  SoupCensus::compute() {
+    for (unsigned id = 0u ; id < m_count ; ++id) {
+      runSoup(m_firstSeed + id);
+    }
+  }
+
+  bool
+  SoupCensus::runSoup(unsigned seed) {
+    m_colony->reset();
+    m_detector.reset();
+
+    unsigned alive = m_colony->generate(m_density, seed);
+    unsigned generation = 0u;
+    bool stable = (m_detector.push(alive) > 0u);
+
+    while (!stable && generation < m_maxGenerations) {
+      // An empty schedule means that all the cells are dead.
+      if (m_colony->simulate(1u) == 0u) {
+        stable = true;
+        break;
+      }
+
+      ++generation;
+      stable = (m_detector.push(m_colony->getLiveCellsCount()) > 0u);
+    }
+
+    ++m_statistics.soups;
+    m_statistics.generations += generation;
+
+    if (!stable) {
+      warn("Soup " + std::to_string(seed) + " did not stabilize in " + std::to_string(m_maxGenerations) + " generation(s)");
+      return false;
+    }
+
+    ++m_statistics.stabilized;
+    tallyObjects();
+
+    return true;
+  }
+
+  void
+  SoupCensus::tallyObjects() {
+    m_colony->getLiveCells(m_cells);
+
+    if (m_cells.empty()) {
+      return;
+    }
+
+    std::sort(m_cells.begin(), m_cells.end(), lessThan);
+
+    // Group cells which are close enough to interact with a union-find.
+    m_parents.resize(m_cells.size());
+    std::iota(m_parents.begin(), m_parents.end(), 0u);
+
+    int sep = getObjectsSeparation();
+
+    for (unsigned id = 0u ; id < m_cells.size() ; ++id) {
+      const utils::Vector2i& c = m_cells[id];
+
+      // Cells are sorted by abscissa: only consider neighbors located after
+      // the current one as the others already handled the link.
+      for (int x = c.x() ; x <= c.x() + sep ; ++x) {
+        utils::Vector2i low(x, c.y() - sep);
+        utils::Vector2i high(x, c.y() + sep);
+
+        std::vector<utils::Vector2i>::const_iterator first = std::lower_bound(m_cells.cbegin(), m_cells.cend(), low, lessThan);
+
+        for (std::vector<utils::Vector2i>::const_iterator it = first ; it != m_cells.cend() && !lessThan(high, *it) ; ++it) {
+          unsigned lhs = findRoot(m_parents, id);
+          unsigned rhs = findRoot(m_parents, static_cast<unsigned>(it - m_cells.cbegin()));
+
+          if (lhs != rhs) {
+            m_parents[std::max(lhs, rhs)] = std::min(lhs, rhs);
+          }
+        }
+      }
+    }
+
+    m_components.resize(m_cells.size());
+    for (unsigned id = 0u ; id < m_cells.size() ; ++id) {
+      m_components[id] = std::make_pair(findRoot(m_parents, id), id);
+    }
+
+    std::sort(m_components.begin(), m_components.end());
+
+    // Classify each object.
+    unsigned start = 0u;
+    while (start < m_components.size()) {
+      unsigned end = start;
+      m_object.clear();
+
+      while (end < m_components.size() && m_components[end].first == m_components[start].first) {
+        m_object.push_back(m_cells[m_components[end].second]);
+        ++end;
+      }
+
+      normalize(m_object);
+
+      // Build the key of the object from its normalized cells and use it
+      // to check whether it was already classified.
+      m_key.clear();
+      for (unsigned id = 0u ; id < m_object.size() ; ++id) {
+        m_key += std::to_string(m_object[id].x()) + "," + std::to_string(m_object[id].y()) + ";";
+      }
+
+      std::unordered_map<std::string, std::vector<std::string>>::const_iterator it = m_classified.find(m_key);
+      if (it == m_classified.cend()) {
+        it = m_classified.emplace(m_key, split(m_object)).first;
+      }
+
+      for (unsigned id = 0u ; id < it->second.size() ; ++id) {
+        ++m_tally[it->second[id]];
+      }
+
+      m_statistics.objects += it->second.size();
+
+      start = end;
+    }
+  }
+
+  std::vector<std::string>
+  SoupCensus::split(const std::vector<utils::Vector2i>& cells) const {
+    // Gather the cells which are touching each other: the cells are not
+    // numerous so a simple flood fill is enough.
+    std::vector<int> parts(cells.size(), -1);
+    int count = 0;
+
+    for (unsigned id = 0u ; id < cells.size() ; ++id) {
+      if (parts[id] >= 0) {
+        continue;
+      }
+
+      std::vector<unsigned> stack(1u, id);
+      parts[id] = count;
+
+      while (!stack.empty()) {
+        const utils::Vector2i& c = cells[stack.back()];
+        stack.pop_back();
+
+        for (unsigned o = 0u ; o < cells.size() ; ++o) {
+          if (parts[o] < 0 && std::abs(cells[o].x() - c.x()) <= 1 && std::abs(cells[o].y() - c.y()) <= 1) {
+            parts[o] = count;
+            stack.push_back(o);
+          }
+        }
+      }
+
+      ++count;
+    }
+
+    if (count == 1) {
+      return std::vector<std::string>(1u, classify(cells));
+    }
+
+    // Evolve the group and each part in isolation: if the union of the
+    // parts always matches the group they don't interact.
+    std::vector<std::vector<utils::Vector2i>> objects(count);
+    for (unsigned id = 0u ; id < cells.size() ; ++id) {
+      objects[parts[id]].push_back(cells[id]);
+    }
+
+    ReferenceColony group(m_ruleset);
+    group.assign(cells);
+
+    std::vector<ReferenceColonyShPtr> isolated;
+    for (int id = 0 ; id < count ; ++id) {
+      isolated.push_back(std::make_shared<ReferenceColony>(m_ruleset));
+      isolated.back()->assign(objects[id]);
+    }
+
+    std::vector<utils::Vector2i> expected, merged, part;
+    bool independent = true;
+
+    for (unsigned gen = 0u ; gen < 2u * m_maxPeriod && independent ; ++gen) {
+      group.step();
+      group.getLiveCells(expected);
+
+      merged.clear();
+      for (int id = 0 ; id < count ; ++id) {
+        isolated[id]->step();
+        isolated[id]->getLiveCells(part);
+        merged.insert(merged.end(), part.begin(), part.end());
+      }
+
+      std::sort(expected.begin(), expected.end(), lessThan);
+      std::sort(merged.begin(), merged.end(), lessThan);
+
+      independent = (expected == merged);
+    }
+
+    if (!independent) {
+      return std::vector<std::string>(1u, classify(cells));
+    }
+
+    std::vector<std::string> codes;
+    for (int id = 0 ; id < count ; ++id) {
+      normalize(objects[id]);
+      codes.push_back(classify(objects[id]));
+    }
+
+    return codes;
+  }
+
+  std::string
+  SoupCensus::classify(const std::vector<utils::Vector2i>& cells) const {
+    ReferenceColony ref(m_ruleset);
+    ref.assign(cells);
+
+    std::vector<utils::Vector2i> phases(cells);
+    std::vector<utils::Vector2i> current;
+    std::string code = encode(cells);
+
+    for (unsigned period = 1u ; period <= m_maxPeriod ; ++period) {
+      ref.step();
+      ref.getLiveCells(current);
+
+      if (current.empty()) {
+        return std::string("zz_dies");
+      }
+
+      utils::Vector2i offset = normalize(current);
+
+      if (current == cells) {
+        // The object came back to its initial configuration: the code is
+        // the smallest encoding across all the phases.
+        std::string prefix;
+        if (offset.x() != 0 || offset.y() != 0) {
+          prefix = "xq" + std::to_string(period);
+        }
+        else if (period > 1u) {
+          prefix = "xp" + std::to_string(period);
+        }
+        else {
+          prefix = "xs" + std::to_string(cells.size());
+        }
+
+        return prefix + "_" + code;
+      }
+
+      std::string phase = encode(current);
+      if (phase.size() < code.size() || (phase.size() == code.size() && phase < code)) {
+        code.swap(phase);
+      }
+    }
+
+    // The object did not repeat: it is probably made of several objects
+    // interacting or a larger oscillator.
+    return std::string("zz_") + encode(cells);
+  }
+
+  utils::Vector2i
+  SoupCensus::normalize(std::vector<utils::Vector2i>& cells) {
+    if (cells.empty()) {
+      return utils::Vector2i();
+    }
+
+    int minX = cells.front().x(), minY = cells.front().y();
+    for (unsigned id = 1u ; id < cells.size() ; ++id) {
+      minX = std::min(minX, cells[id].x());
+      minY = std::min(minY, cells[id].y());
+    }
+
+    for (unsigned id = 0u ; id < cells.size() ; ++id) {
+      cells[id].x() -= minX;
+      cells[id].y() -= minY;
+    }
+
+    std::sort(cells.begin(), cells.end(), lessThan);
+
+    return utils::Vector2i(minX, minY);
+  }
+
+  std::string
+  SoupCensus::encode(const std::vector<utils::Vector2i>& cells) {
+    static const char* digits = "0123456789abcdef";
+
+    std::string best;
+    std::vector<utils::Vector2i> oriented(cells.size());
+
+    // Try each one of the 8 symmetries of the square and keep the smallest
+    // encoding, shorter ones first.
+    for (unsigned sym = 0u ; sym < 8u ; ++sym) {
+      for (unsigned id = 0u ; id < cells.size() ; ++id) {
+        int x = cells[id].x(), y = cells[id].y();
+
+        if (sym & 4u) {
+          std::swap(x, y);
+        }
+
+        oriented[id] = utils::Vector2i((sym & 1u) ? -x : x, (sym & 2u) ? -y : y);
+      }
+
+      normalize(oriented);
+
+      int w = 0, h = 0;
+      for (unsigned id = 0u ; id < oriented.size() ; ++id) {
+        w = std::max(w, oriented[id].x() + 1);
+        h = std::max(h, oriented[id].y() + 1);
+      }
+
+      // Each row is encoded as hexadecimal digits, each one representing
+      // four consecutive columns. Rows are separated by a `z`.
+      int digitsPerRow = (w + 3) / 4;
+      std::string rows(h * (digitsPerRow + 1) - 1, 'z');
+
+      for (unsigned id = 0u ; id < oriented.size() ; ++id) {
+        int x = oriented[id].x(), y = oriented[id].y();
+        char& d = rows[y * (digitsPerRow + 1) + x / 4];
+
+        unsigned val = (d == 'z' ? 0u : static_cast<unsigned>(d <= '9' ? d - '0' : d - 'a' + 10));
+        d = digits[val | (1u << (x % 4))];
+      }
+
+      for (unsigned id = 0u ; id < rows.size() ; ++id) {
+        if (rows[id] == 'z' && (id + 1u) % (digitsPerRow + 1) != 0u) {
+          rows[id] = '0';
+        }
+      }
+
+      if (best.empty() || rows.size() < best.size() || (rows.size() == best.size() && rows < best)) {
+        best.swap(rows);
+      }
+    }
+
+    return best;
+  }
+
+  void
+  SoupCensus::registerNames() {
+    // The names only make sense for the rules of the game of life.
+    if (m_ruleset->toRule() != CellEvolver().toRule()) {
+      return;
+    }
+
+    const std::vector<KnownObject>& objects = getKnownObjects();
+
+    for (unsigned id = 0u ; id < objects.size() ; ++id) {
+      std::vector<utils::Vector2i> cells;
+      const std::vector<std::string>& rows = objects[id].rows;
+
+      for (unsigned y = 0u ; y < rows.size() ; ++y) {
+        for (unsigned x = 0u ; x < rows[y].size() ; ++x) {
+          if (rows[y][x] == 'o') {
+            cells.push_back(utils::Vector2i(x, y));
+          }
+        }
+      }
+
+      normalize(cells);
+
+      m_names[classify(cells)] = objects[id].name;
+    }
+  }
+
+}
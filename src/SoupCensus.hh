@@ -0,0 +1,279 @@
+#ifndef    SOUP_CENSUS_HH
+# define   SOUP_CENSUS_HH
+
+# include <map>
+# include <utility>
+# include <memory>
+# include <string>
+# include <vector>
+# include <unordered_map>
+# include <core_utils/AsynchronousJob.hh>
+# include <maths_utils/Size.hh>
+# include <maths_utils/Vector2.hh>
+# include "Colony.hh"
+# include "CellEvolver.hh"
+# include "PeriodDetector.hh"
+
+namespace cellulator {
+
+  class SoupCensus: public utils::AsynchronousJob {
+    public:
+
+      /**
+       * @brief - The number of occurrences of each object found in the soups,
+       *          indexed by the canonical code of the object.
+       */
+      using Tally = std::map<std::string, unsigned long>;
+
+      /**
+       * @brief - Convenience structure describing the work performed by the
+       *          census.
+       */
+      struct Statistics {
+        unsigned long soups;        //< The number of soups simulated.
+        unsigned long stabilized;   //< The number of soups which stabilized.
+        unsigned long generations;  //< The total number of generations simulated.
+        unsigned long objects;      //< The total number of objects found.
+      };
+
+      /**
+       * @brief - Create a census running the random soups generated from the seeds
+       *          in the range `[firstSeed; firstSeed + count[`. Each soup is run
+       *          until its population becomes periodic, at which point the objects
+       *          remaining are extracted, classified and tallied.
+       *          A single colony is used for all the soups so that the memory of
+       *          the cells is reused from one soup to the next. Several census can
+       *          be computed in parallel (typically in a `utils::ThreadPool`) and
+       *          their tallies merged afterwards.
+       * @param ruleset - the rules used to evolve the soups.
+       * @param soup - the dimensions of the soups, which should be even.
+       * @param density - the proportion of live cells in the soups.
+       * @param firstSeed - the seed of the first soup.
+       * @param count - the number of soups to run.
+       */
+      SoupCensus(CellEvolverShPtr ruleset,
+                 const utils::Sizei& soup,
+                 float density,
+                 unsigned firstSeed,
+                 unsigned count);
+
+      ~SoupCensus() = default;
+
+      /**
+       * @brief - Define the limits used to detect the stabilization of the soups.
+       * @param maxGenerations - the number of generations after which a soup that
+       *                         did not stabilize is abandoned.
+       * @param maxPeriod - the largest period detected, both for the soups and
+       *                    for the objects.
+       */
+      void
+      setLimits(unsigned maxGenerations,
+                unsigned maxPeriod);
+
+      /**
+       * @brief - Reimplementation of the interface method running all the soups
+       *          of this census.
+       */
+      void
+      compute() override;
+
+      /**
+       * @brief - Run a single soup and tally the objects it produced.
+       * @param seed - the seed of the soup.
+       * @return - `true` if the soup stabilized.
+       */
+      bool
+      runSoup(unsigned seed);
+
+      /**
+       * @brief - Retrieve the objects found so far.
+       * @return - the tally of the objects.
+       */
+      const Tally&
+      getTally() const noexcept;
+
+      /**
+       * @brief - Retrieve the statistics of the census so far.
+       * @return - the statistics of the census.
+       */
+      const Statistics&
+      getStatistics() const noexcept;
+
+      /**
+       * @brief - Retrieve the common name of the object described by the code in
+       *          argument if it is a well-known one.
+       * @param code - the canonical code of the object.
+       * @return - the name of the object or an empty string if it's not known.
+       */
+      std::string
+      getObjectName(const std::string& code) const;
+
+    private:
+
+      /**
+       * @brief - The maximum distance between two cells for them to be considered
+       *          part of the same object.
+       * @return - the distance used to separate objects.
+       */
+      static
+      int
+      getObjectsSeparation() noexcept;
+
+      /**
+       * @brief - Separate the live cells of the colony into objects and tally
+       *          each one of them.
+       */
+      void
+      tallyObjects();
+
+      /**
+       * @brief - Split the group of cells in argument into the objects composing
+       *          it and classify each one of them. Cells which are close to each
+       *          other are only considered as distinct objects if they evolve in
+       *          the exact same way when isolated as when they are together.
+       * @param cells - the cells to split, normalized.
+       * @return - the codes of the objects composing the group.
+       */
+      std::vector<std::string>
+      split(const std::vector<utils::Vector2i>& cells) const;
+
+      /**
+       * @brief - Determine the canonical code of the object composed of the cells
+       *          in argument. The object is evolved in isolation to determine its
+       *          period and displacement.
+       * @param cells - the cells of the object, normalized.
+       * @return - the code of the object.
+       */
+      std::string
+      classify(const std::vector<utils::Vector2i>& cells) const;
+
+      /**
+       * @brief - Translate the cells so that their bounding box starts at the origin
+       *          and sort them.
+       * @param cells - the cells to normalize.
+       * @return - the position of the bottom left corner of the bounding box before
+       *           the translation.
+       */
+      static
+      utils::Vector2i
+      normalize(std::vector<utils::Vector2i>& cells);
+
+      /**
+       * @brief - Encode the normalized cells in argument as a string, in the
+       *          orientation which yields the smallest encoding.
+       * @param cells - the cells to encode, normalized.
+       * @return - the encoding of the cells.
+       */
+      static
+      std::string
+      encode(const std::vector<utils::Vector2i>& cells);
+
+      /**
+       * @brief - Register the well-known objects so that they can be named.
+       */
+      void
+      registerNames();
+
+    private:
+
+      /**
+       * @brief - The rules used to evolve the soups.
+       */
+      CellEvolverShPtr m_ruleset;
+
+      /**
+       * @brief - The dimensions of a soup.
+       */
+      utils::Sizei m_soup;
+
+      /**
+       * @brief - The proportion of live cells of the soups.
+       */
+      float m_density;
+
+      /**
+       * @brief - The seed of the first soup.
+       */
+      unsigned m_firstSeed;
+
+      /**
+       * @brief - The number of soups to run.
+       */
+      unsigned m_count;
+
+      /**
+       * @brief - The number of generations after which a soup is abandoned.
+       */
+      unsigned m_maxGenerations;
+
+      /**
+       * @brief - The largest period detected for the soups and the objects.
+       */
+      unsigned m_maxPeriod;
+
+      /**
+       * @brief - The colony used to run the soups. Reset before each soup.
+       */
+      ColonyShPtr m_colony;
+
+      /**
+       * @brief - Used to detect when the population of a soup becomes periodic.
+       */
+      PeriodDetector m_detector;
+
+      /**
+       * @brief - The live cells of the colony once stabilized.
+       */
+      std::vector<utils::Vector2i> m_cells;
+
+      /**
+       * @brief - The parent of each cell when grouping cells into objects.
+       */
+      std::vector<unsigned> m_parents;
+
+      /**
+       * @brief - The root of each cell associated to its index, used to gather
+       *          the cells of each object.
+       */
+      std::vector<std::pair<unsigned, unsigned>> m_components;
+
+      /**
+       * @brief - The cells of the object being classified.
+       */
+      std::vector<utils::Vector2i> m_object;
+
+      /**
+       * @brief - The key of the object being classified.
+       */
+      std::string m_key;
+
+      /**
+       * @brief - The codes of the objects composing the groups of cells already
+       *          classified, indexed by the key of their normalized cells. As most
+       *          soups produce the same few objects this avoids to evolve them
+       *          again.
+       */
+      std::unordered_map<std::string, std::vector<std::string>> m_classified;
+
+      /**
+       * @brief - The names of the well-known objects indexed by their code.
+       */
+      std::unordered_map<std::string, std::string> m_names;
+
+      /**
+       * @brief - The objects found so far.
+       */
+      Tally m_tally;
+
+      /**
+       * @brief - The statistics of the census.
+       */
+      Statistics m_statistics;
+  };
+
+  using SoupCensusShPtr = std::shared_ptr<SoupCensus>;
+}
+
+# include "SoupCensus.hxx"
+
+#endif    /* SOUP_CENSUS_HH */
@@ -0,0 +1,46 @@
+#ifndef    SOUP_CENSUS_HXX
+# define   SOUP_CENSUS_HXX
+
+# include "SoupCensus.hh"
+
+namespace cellulator {
+
+  inline
+  void
+  SoupCensus::setLimits(unsigned maxGenerations,
+                        unsigned maxPeriod)
+  {
+    m_maxGenerations = maxGenerations;
+    m_maxPeriod = std::max(maxPeriod, 1u);
+
+    m_detector.setMaxPeriod(m_maxPeriod);
+  }
+
+  inline
+  const SoupCensus::Tally&
+  SoupCensus::getTally() const noexcept {
+    return m_tally;
+  }
+
+  inline
+  const SoupCensus::Statistics&
+  SoupCensus::getStatistics() const noexcept {
+    return m_statistics;
+  }
+
+  inline
+  std::string
+  SoupCensus::getObjectName(const std::string& code) const {
+    std::unordered_map<std::string, std::string>::const_iterator it = m_names.find(code);
+    return (it == m_names.cend() ? std::string() : it->second);
+  }
+
+  inline
+  int
+  SoupCensus::getObjectsSeparation() noexcept {
+    return 2;
+  }
+
+}
+
+#endif    /* SOUP_CENSUS_HXX */
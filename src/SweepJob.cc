@@ -0,0 +1,146 @@
+
+# include "SweepJob.hh"
+# include <algorithm>
+
+namespace cellulator {
+
+  SweepJob::SweepJob(const std::string& name):
+    utils::AsynchronousJob(name),
+
+    m_settings{utils::Sizei(), 0.5f, 0u, 0u, 0u, 0u, 0.0f},
+    m_queue(),
+
+    m_colony(),
+    m_detector(),
+    m_periods(),
+
+    m_generations(0u)
+  {
+    setService("sweep");
+  }
+
+  void
+  SweepJob::prepare(const SweepSettings& settings,
+                    SweepQueueShPtr queue)
+  {
+    if (queue == nullptr) {
+      error(
+        std::string("Could not prepare sweep job"),
+        std::string("Invalid null queue")
+      );
+    }
+
+    // Only create a new colony in case the soups changed: otherwise the
+    // memory of the existing one is reused.
+    if (m_colony == nullptr || settings.soup != m_settings.soup) {
+      m_colony = std::make_shared<Colony>(settings.soup, Colony::getSoupBlockDims(settings.soup), getName());
+    }
+
+    m_settings = settings;
+    m_queue = queue;
+
+    m_detector.setMaxPeriod(m_settings.maxPeriod);
+    m_periods.resize(m_detector.getMaxPeriod() + 1u);
+
+    m_generations = 0u;
+  }
+
+  void
+  SweepJob::compute() {
+    if (m_queue == nullptr) {
+      return;
+    }
+
+    unsigned id = m_queue->next.fetch_add(1u, std::memory_order_relaxed);
+
+    while (id < m_queue->rules.size()) {
+      CellEvolverShPtr rule = m_queue->rules[id];
+
+      try {
+        m_queue->results[id] = evaluate(rule);
+      }
+      catch (const std::exception& e) {
+        m_queue->results[id].rule = rule->toRule();
+        m_queue->results[id].table = rule->getTable();
+        m_queue->results[id].error = e.what();
+      }
+
+      id = m_queue->next.fetch_add(1u, std::memory_order_relaxed);
+    }
+  }
+
+  RuleStatistics
+  SweepJob::evaluate(CellEvolverShPtr rule) {
+    RuleStatistics stats{rule->toRule(), rule->getTable(), 0u, 0u, 0u, 0u, 0u, 0.0, 0.0, 0.0, 0u, std::string()};
+
+    m_colony->setRuleset(rule);
+    std::fill(m_periods.begin(), m_periods.end(), 0u);
+
+    unsigned limit = static_cast<unsigned>(m_settings.explosion * m_settings.soup.area());
+
+    for (unsigned soup = 0u ; soup < m_settings.soups ; ++soup) {
+      m_colony->reset();
+      m_detector.reset();
+
+      unsigned initial = m_colony->generate(m_settings.density, m_settings.seed + soup);
+      unsigned population = initial;
+      unsigned generation = 0u;
+      unsigned period = m_detector.push(population);
+
+      bool done = (population == 0u || period > 0u);
+
+      while (!done && generation < m_settings.maxGenerations) {
+        // An empty schedule means that all the cells are dead.
+        if (m_colony->simulate(1u) == 0u) {
+          population = 0u;
+          break;
+        }
+
+        ++generation;
+        population = m_colony->getLiveCellsCount();
+
+        period = m_detector.push(population);
+        done = (population == 0u || population > limit || period > 0u);
+      }
+
+      ++stats.soups;
+
+      if (population == 0u) {
+        ++stats.died;
+      }
+      else if (population > limit) {
+        ++stats.exploded;
+      }
+      else if (period > 0u) {
+        ++stats.stabilized;
+        ++m_periods[period];
+      }
+      else {
+        ++stats.unresolved;
+      }
+
+      stats.population += population;
+      stats.generations += generation;
+      if (generation > 0u) {
+        stats.growth += (1.0 * population - 1.0 * initial) / generation;
+      }
+
+      m_generations += generation;
+    }
+
+    if (stats.soups > 0u) {
+      stats.population /= stats.soups;
+      stats.growth /= stats.soups;
+      stats.generations /= stats.soups;
+    }
+
+    // Keep the most frequent period: ties are resolved with the smallest.
+    std::vector<unsigned>::const_iterator best = std::max_element(m_periods.cbegin() + 1, m_periods.cend());
+    if (best != m_periods.cend() && *best > 0u) {
+      stats.period = static_cast<unsigned>(best - m_periods.cbegin());
+    }
+
+    return stats;
+  }
+
+}
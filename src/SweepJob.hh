@@ -0,0 +1,154 @@
+#ifndef    SWEEP_JOB_HH
+# define   SWEEP_JOB_HH
+
+# include <atomic>
+# include <memory>
+# include <string>
+# include <vector>
+# include <cstdint>
+# include <core_utils/AsynchronousJob.hh>
+# include <maths_utils/Size.hh>
+# include "Colony.hh"
+# include "CellEvolver.hh"
+# include "PeriodDetector.hh"
+
+namespace cellulator {
+
+  /**
+   * @brief - Describes the soups run for each rule of a sweep and the limits
+   *          used to stop them early.
+   */
+  struct SweepSettings {
+    utils::Sizei soup;        //< The dimensions of the soups, which should be even.
+    float density;            //< The proportion of live cells in the soups.
+    unsigned seed;            //< The seed of the first soup, incremented for each soup.
+    unsigned soups;           //< The number of soups run for each rule.
+    unsigned maxGenerations;  //< The number of generations after which a soup is abandoned.
+    unsigned maxPeriod;       //< The largest period of the population detected when a soup stabilizes.
+    float explosion;          //< A soup explodes when its population exceeds this factor times its area.
+  };
+
+  /**
+   * @brief - The outcome of the soups run for a single rule of a sweep.
+   */
+  struct RuleStatistics {
+    std::string rule;         //< The rule in the `B3/S23` notation.
+    std::uint32_t table;      //< The compiled rule, see `CellEvolver::getTable`.
+    unsigned soups;           //< The number of soups run.
+    unsigned died;            //< The number of soups in which all cells died.
+    unsigned exploded;        //< The number of soups whose population exploded.
+    unsigned stabilized;      //< The number of soups whose population became periodic.
+    unsigned unresolved;      //< The number of soups abandoned after the maximum number of generations.
+    double population;        //< The average final population of the soups.
+    double growth;            //< The average growth of the population per generation.
+    double generations;       //< The average number of generations simulated per soup.
+    unsigned period;          //< The most frequent period of the population of the stabilized soups,
+                              //< `0` if none. This is not the period of the objects left in the soup:
+                              //< for example a field of blinkers has a constant population.
+    std::string error;        //< The description of the error if the rule could not be evaluated.
+  };
+
+  /**
+   * @brief - The rules of a sweep shared by all the jobs evaluating them. Each
+   *          job fetches the next rule to evaluate so that the rules which are
+   *          long to evaluate don't delay the others.
+   */
+  struct SweepQueue {
+    std::vector<CellEvolverShPtr> rules;  //< The rules to evaluate.
+    std::vector<RuleStatistics> results;  //< The outcome of each rule, in the same order.
+    std::atomic<unsigned> next;           //< The index of the next rule to evaluate.
+  };
+
+  using SweepQueueShPtr = std::shared_ptr<SweepQueue>;
+
+  class SweepJob: public utils::AsynchronousJob {
+    public:
+
+      /**
+       * @brief - Create a job evaluating rules on random soups. The job owns a
+       *          colony which is reused for all the soups of all the rules it
+       *          evaluates, including across sweeps, so that the memory of the
+       *          blocks is only allocated once.
+       * @param name - the name of the job.
+       */
+      SweepJob(const std::string& name);
+
+      ~SweepJob() = default;
+
+      /**
+       * @brief - Prepare the job for a new sweep. Should not be called while the
+       *          job is computed.
+       * @param settings - the description of the soups to run.
+       * @param queue - the rules to evaluate.
+       */
+      void
+      prepare(const SweepSettings& settings,
+              SweepQueueShPtr queue);
+
+      /**
+       * @brief - Reimplementation of the interface method evaluating rules from
+       *          the queue until none is left. Errors are not propagated but
+       *          rather reported in the statistics of the rule.
+       */
+      void
+      compute() override;
+
+      /**
+       * @brief - Retrieve the total number of generations computed by this job
+       *          during the last sweep.
+       * @return - the number of generations computed.
+       */
+      unsigned long
+      getGenerations() const noexcept;
+
+    private:
+
+      /**
+       * @brief - Run all the soups for the rule in argument.
+       * @param rule - the rule to evaluate.
+       * @return - the statistics of the soups.
+       */
+      RuleStatistics
+      evaluate(CellEvolverShPtr rule);
+
+    private:
+
+      /**
+       * @brief - The description of the soups to run.
+       */
+      SweepSettings m_settings;
+
+      /**
+       * @brief - The rules to evaluate.
+       */
+      SweepQueueShPtr m_queue;
+
+      /**
+       * @brief - The colony used to run the soups, reset before each one. Only
+       *          created again when the dimensions of the soups change.
+       */
+      ColonyShPtr m_colony;
+
+      /**
+       * @brief - Used to detect when a soup stabilizes.
+       */
+      PeriodDetector m_detector;
+
+      /**
+       * @brief - The number of soups which stabilized with each period for the
+       *          rule being evaluated.
+       */
+      std::vector<unsigned> m_periods;
+
+      /**
+       * @brief - The number of generations computed during the last sweep.
+       */
+      unsigned long m_generations;
+  };
+
+  using SweepJobShPtr = std::shared_ptr<SweepJob>;
+}
+
+# include "SweepJob.hxx"
+
+#endif    /* SWEEP_JOB_HH */
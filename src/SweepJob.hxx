@@ -0,0 +1,16 @@
+#ifndef    SWEEP_JOB_HXX
+# define   SWEEP_JOB_HXX
+
+# include "SweepJob.hh"
+
+namespace cellulator {
+
+  inline
+  unsigned long
+  SweepJob::getGenerations() const noexcept {
+    return m_generations;
+  }
+
+}
+
+#endif    /* SWEEP_JOB_HXX */
@@ -0,0 +1,114 @@
+#ifndef    TRIPLE_BUFFER_HH
+# define   TRIPLE_BUFFER_HH
+
+# include <array>
+# include <atomic>
+
+namespace cellulator {
+
+  /**
+   * @brief - A lock-free triple buffer allowing a single producer to publish
+   *          data to a single consumer without any of them ever waiting for
+   *          the other. The producer always writes in a buffer that is never
+   *          accessed by the consumer, and the consumer always reads the last
+   *          buffer completely written by the producer.
+   *          The third buffer is used as an exchange slot between them: its
+   *          index is swapped atomically along with a flag indicating whether
+   *          it contains data that was not yet seen by the consumer.
+   *          Note that the buffers are reused so that the memory allocated by
+   *          the producer in a buffer can be kept from one publication to the
+   *          next.
+   */
+  template <typename T>
+  class TripleBuffer {
+    public:
+
+      /**
+       * @brief - Create a new triple buffer with default constructed values in
+       *          all the buffers.
+       */
+      TripleBuffer();
+
+      /**
+       * @brief - Destruction of the triple buffer.
+       */
+      ~TripleBuffer() = default;
+
+      /**
+       * @brief - Used to retrieve the buffer to fill by the producer. It is not
+       *          visible to the consumer until `publish` is called.
+       *          Should only be called by the producer.
+       * @return - the buffer to fill with the data to publish.
+       */
+      T&
+      getBackBuffer() noexcept;
+
+      /**
+       * @brief - Make the content of the back buffer available to the consumer.
+       *          The producer receives a new back buffer which can contain some
+       *          previously published data.
+       *          Should only be called by the producer.
+       */
+      void
+      publish() noexcept;
+
+      /**
+       * @brief - Used by the consumer to fetch the last data published by the
+       *          producer if any. The front buffer is only updated in case some
+       *          new data is available.
+       *          Should only be called by the consumer.
+       * @return - `true` if the front buffer has been updated.
+       */
+      bool
+      update() noexcept;
+
+      /**
+       * @brief - Used to retrieve the buffer containing the last published data
+       *          as of the last call to `update`.
+       *          Should only be called by the consumer.
+       * @return - the front buffer.
+       */
+      const T&
+      getFrontBuffer() const noexcept;
+
+    private:
+
+      /**
+       * @brief - Flag set in the index of the exchange buffer to indicate that
+       *          it contains data not yet seen by the consumer.
+       */
+      static constexpr unsigned FreshBit = 0x4u;
+
+      /**
+       * @brief - Mask used to extract the index of the buffer from the exchange
+       *          buffer value.
+       */
+      static constexpr unsigned IndexMask = 0x3u;
+
+      /**
+       * @brief - The buffers holding the data.
+       */
+      std::array<T, 3u> m_buffers;
+
+      /**
+       * @brief - The index of the buffer used by the producer.
+       */
+      unsigned m_back;
+
+      /**
+       * @brief - The index of the exchange buffer along with a flag indicating that
+       *          it contains fresh data.
+       */
+      std::atomic<unsigned> m_middle;
+
+      /**
+       * @brief - The index of the buffer used by the consumer.
+       */
+      unsigned m_front;
+  };
+
+}
+
+# include "TripleBuffer.hxx"
+
+#endif    /* TRIPLE_BUFFER_HH */
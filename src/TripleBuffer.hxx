@@ -0,0 +1,61 @@
+#ifndef    TRIPLE_BUFFER_HXX
+# define   TRIPLE_BUFFER_HXX
+
+# include "TripleBuffer.hh"
+
+namespace cellulator {
+
+  template <typename T>
+  inline
+  TripleBuffer<T>::TripleBuffer():
+    m_buffers(),
+
+    m_back(0u),
+    m_middle(1u),
+    m_front(2u)
+  {}
+
+  template <typename T>
+  inline
+  T&
+  TripleBuffer<T>::getBackBuffer() noexcept {
+    return m_buffers[m_back];
+  }
+
+  template <typename T>
+  inline
+  void
+  TripleBuffer<T>::publish() noexcept {
+    // Exchange the back buffer with the middle one and mark it as fresh. The
+    // release semantic guarantees that the consumer will see the writes to
+    // the buffer while the acquire semantic makes sure that we don't write
+    // in the new back buffer before the consumer is done with it.
+    m_back = m_middle.exchange(m_back | FreshBit, std::memory_order_acq_rel) & IndexMask;
+  }
+
+  template <typename T>
+  inline
+  bool
+  TripleBuffer<T>::update() noexcept {
+    // Nothing to do in case no new data has been published.
+    if ((m_middle.load(std::memory_order_relaxed) & FreshBit) == 0u) {
+      return false;
+    }
+
+    // Exchange the front buffer with the middle one: this clears the fresh
+    // flag at the same time.
+    m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & IndexMask;
+
+    return true;
+  }
+
+  template <typename T>
+  inline
+  const T&
+  TripleBuffer<T>::getFrontBuffer() const noexcept {
+    return m_buffers[m_front];
+  }
+
+}
+
+#endif    /* TRIPLE_BUFFER_HXX */
@@ -0,0 +1,271 @@
+/**
+ * @brief - Sweep of the space of rules: evaluates a set of rules (or all of
+ *          them) on the same seeded random soups and reports for each rule
+ *          how the soups ended, their final population, growth and the period
+ *          of their population once it repeats (which is not necessarily the
+ *          period of the objects left: a field of blinkers reports `1`).
+ *          This allows to find interesting rules without having to try them
+ *          one by one in the ruleset view.
+ */
+
+# include <fstream>
+# include <iostream>
+# include <sstream>
+# include <core_utils/log/Locator.hh>
+# include <core_utils/log/PrefixedLogger.hh>
+# include <core_utils/log/StdLogger.hh>
+# include <core_utils/CoreException.hh>
+# include "RuleSweep.hh"
+# include "CellEvolver.hh"
+
+namespace {
+
+  /**
+   * @brief - Convenience structure holding the options of the sweep.
+   */
+  struct Options {
+    std::vector<std::string> rules;
+    bool all;
+    unsigned soups;
+    utils::Sizei size;
+    float density;
+    unsigned seed;
+    unsigned threads;
+    unsigned maxGenerations;
+    unsigned maxPeriod;
+    float explosion;
+    std::string output;
+  };
+
+  void
+  usage(const std::string& program) {
+    std::cout
+      << "Usage: " << program << " [options]" << std::endl
+      << "  -r, --rules LIST        comma separated rules to evaluate, e.g. B3/S23,B36/S23" << std::endl
+      << "      --all               evaluate all the rules where cells are not born without neighbors" << std::endl
+      << "  -n, --soups N           number of soups run for each rule (default: 16)" << std::endl
+      << "  -s, --size WxH          dimensions of the soups (default: 16x16)" << std::endl
+      << "      --density D         proportion of live cells in the soups (default: 0.5)" << std::endl
+      << "      --seed S            seed of the first soup, incremented for each soup (default: 0)" << std::endl
+      << "  -t, --threads T         number of threads evaluating rules (default: one per core)" << std::endl
+      << "      --max-generations N generations after which a soup is abandoned (default: 2000)" << std::endl
+      << "      --max-period P      largest period of the population sequence detected (default: 30)" << std::endl
+      << "      --explosion F       population, relative to the soup area, beyond which a soup explodes (default: 4)" << std::endl
+      << "  -o, --output FILE       file receiving the statistics as CSV (default: standard output)" << std::endl
+      << "  -h, --help              display this message" << std::endl;
+  }
+
+  utils::Sizei
+  parseSize(const std::string& str) {
+    std::string::size_type sep = str.find('x');
+    if (sep == std::string::npos) {
+      throw std::invalid_argument("Invalid size \"" + str + "\", expected WxH");
+    }
+
+    return utils::Sizei(std::stoi(str.substr(0u, sep)), std::stoi(str.substr(sep + 1u)));
+  }
+
+  std::vector<std::string>
+  parseRules(const std::string& str) {
+    std::vector<std::string> rules;
+    std::stringstream in(str);
+    std::string rule;
+
+    while (std::getline(in, rule, ',')) {
+      if (!rule.empty()) {
+        rules.push_back(rule);
+      }
+    }
+
+    return rules;
+  }
+
+  /**
+   * @brief - Parse the arguments provided to the program.
+   * @param argc - the number of arguments.
+   * @param argv - the arguments.
+   * @param options - output options filled from the arguments.
+   * @return - `false` if the program should exit right away.
+   */
+  bool
+  parseArguments(int argc,
+                 char** argv,
+                 Options& options)
+  {
+    for (int id = 1 ; id < argc ; ++id) {
+      std::string arg(argv[id]);
+
+      if (arg == "-h" || arg == "--help") {
+        usage(argv[0]);
+        return false;
+      }
+
+      if (arg == "--all") {
+        options.all = true;
+        continue;
+      }
+
+      // All other options expect a value.
+      if (id + 1 >= argc) {
+        throw std::invalid_argument("Missing value for option \"" + arg + "\"");
+      }
+
+      std::string value(argv[++id]);
+
+      if (arg == "-r" || arg == "--rules") {
+        std::vector<std::string> rules = parseRules(value);
+        options.rules.insert(options.rules.end(), rules.cbegin(), rules.cend());
+      }
+      else if (arg == "-n" || arg == "--soups") {
+        options.soups = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "-s" || arg == "--size") {
+        options.size = parseSize(value);
+      }
+      else if (arg == "--density") {
+        options.density = std::stof(value);
+      }
+      else if (arg == "--seed") {
+        options.seed = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "-t" || arg == "--threads") {
+        options.threads = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "--max-generations") {
+        options.maxGenerations = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "--max-period") {
+        options.maxPeriod = static_cast<unsigned>(std::stoul(value));
+      }
+      else if (arg == "--explosion") {
+        options.explosion = std::stof(value);
+      }
+      else if (arg == "-o" || arg == "--output") {
+        options.output = value;
+      }
+      else {
+        throw std::invalid_argument("Unknown option \"" + arg + "\"");
+      }
+    }
+
+    if (options.rules.empty() && !options.all) {
+      throw std::invalid_argument("No rules to evaluate, use either --rules or --all");
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief - Write the statistics of each rule as CSV.
+   * @param out - the stream to write to.
+   * @param results - the statistics of each rule.
+   */
+  void
+  writeResults(std::ostream& out,
+               const std::vector<cellulator::RuleStatistics>& results)
+  {
+    out << "rule,table,soups,died,exploded,stabilized,unresolved,population,growth,generations,population_period" << std::endl;
+
+    for (const cellulator::RuleStatistics& r : results) {
+      if (!r.error.empty()) {
+        continue;
+      }
+
+      out
+        << r.rule << "," << r.table << "," << r.soups << ","
+        << r.died << "," << r.exploded << "," << r.stabilized << "," << r.unresolved << ","
+        << r.population << "," << r.growth << "," << r.generations << "," << r.period
+        << std::endl;
+    }
+  }
+
+}
+
+int main(int argc, char** argv) {
+  // Create the logger.
+  utils::log::StdLogger raw;
+  raw.setLevel(utils::log::Severity::WARNING);
+  utils::log::PrefixedLogger logger("automaton", "sweep");
+  utils::log::Locator::provide(&raw);
+
+  Options options{
+    std::vector<std::string>(),
+    false,
+    16u,
+    utils::Sizei(16, 16),
+    0.5f,
+    0u,
+    0u,
+    2000u,
+    30u,
+    4.0f,
+    std::string()
+  };
+
+  try {
+    if (!parseArguments(argc, argv, options)) {
+      return EXIT_SUCCESS;
+    }
+  }
+  catch (const std::exception& e) {
+    logger.error("Invalid arguments", e.what());
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  try {
+    // Compile the rules once: they are shared by all the threads.
+    std::vector<cellulator::CellEvolverShPtr> rules;
+
+    if (options.all) {
+      rules = cellulator::RuleSweep::getAllRules();
+    }
+    for (const std::string& rule : options.rules) {
+      rules.push_back(cellulator::CellEvolver::fromRule(rule));
+    }
+
+    cellulator::RuleSweep sweep(options.threads);
+
+    sweep.setSoups(options.size, options.density, options.seed, options.soups);
+    sweep.setLimits(options.maxGenerations, options.maxPeriod, options.explosion);
+
+    std::vector<cellulator::RuleStatistics> results = sweep.run(rules);
+
+    if (options.output.empty()) {
+      writeResults(std::cout, results);
+    }
+    else {
+      std::ofstream out(options.output);
+      if (!out.good()) {
+        throw std::invalid_argument("Could not open output file \"" + options.output + "\"");
+      }
+
+      writeResults(out, results);
+
+      cellulator::RuleSweep::Statistics stats = sweep.getStatistics();
+
+      std::cout
+        << "rules:       " << stats.rules << " (failed: " << stats.failures << ")" << std::endl
+        << "soups:       " << stats.soups << std::endl
+        << "generations: " << stats.generations << std::endl
+        << "elapsed:     " << stats.elapsed << "s" << std::endl
+        << "rate:        " << (stats.elapsed > 0.0 ? stats.rules / stats.elapsed : 0.0) << " rules/s, "
+        << (stats.elapsed > 0.0 ? stats.generations / stats.elapsed : 0.0) << " gen/s" << std::endl;
+    }
+  }
+  catch (const utils::CoreException& e) {
+    logger.error("Caught internal exception while running sweep", e.what());
+    return EXIT_FAILURE;
+  }
+  catch (const std::exception& e) {
+    logger.error("Caught internal exception while running sweep", e.what());
+    return EXIT_FAILURE;
+  }
+  catch (...) {
+    logger.error("Unexpected error while running sweep");
+    return EXIT_FAILURE;
+  }
+
+  // All is good.
+  return EXIT_SUCCESS;
+}